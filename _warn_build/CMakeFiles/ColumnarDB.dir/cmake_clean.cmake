@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/ColumnarDB.dir/main.cpp.o"
+  "CMakeFiles/ColumnarDB.dir/main.cpp.o.d"
+  "ColumnarDB"
+  "ColumnarDB.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/ColumnarDB.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,23 @@
+
+# Consider dependencies only in project.
+set(CMAKE_DEPENDS_IN_PROJECT_ONLY OFF)
+
+# The set of languages for which implicit dependencies are needed:
+set(CMAKE_DEPENDS_LANGUAGES
+  )
+
+# The set of dependency files which are needed:
+set(CMAKE_DEPENDS_DEPENDENCY_FILES
+  "/root/repo/src/engine/batch/batch.cpp" "CMakeFiles/batch.dir/src/engine/batch/batch.cpp.o" "gcc" "CMakeFiles/batch.dir/src/engine/batch/batch.cpp.o.d"
+  "/root/repo/src/engine/batch/csv_batch_writer.cpp" "CMakeFiles/batch.dir/src/engine/batch/csv_batch_writer.cpp.o" "gcc" "CMakeFiles/batch.dir/src/engine/batch/csv_batch_writer.cpp.o.d"
+  "/root/repo/src/engine/batch/parallel_csv.cpp" "CMakeFiles/batch.dir/src/engine/batch/parallel_csv.cpp.o" "gcc" "CMakeFiles/batch.dir/src/engine/batch/parallel_csv.cpp.o.d"
+  )
+
+# Targets to which this target links.
+set(CMAKE_TARGET_LINKED_INFO_FILES
+  "/root/repo/_warn_build/CMakeFiles/csv.dir/DependInfo.cmake"
+  "/root/repo/_warn_build/CMakeFiles/schema.dir/DependInfo.cmake"
+  )
+
+# Fortran module output directory.
+set(CMAKE_Fortran_TARGET_MODULE_DIR "")
@@ -0,0 +1,15 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/batch.dir/src/engine/batch/batch.cpp.o"
+  "CMakeFiles/batch.dir/src/engine/batch/batch.cpp.o.d"
+  "CMakeFiles/batch.dir/src/engine/batch/csv_batch_writer.cpp.o"
+  "CMakeFiles/batch.dir/src/engine/batch/csv_batch_writer.cpp.o.d"
+  "CMakeFiles/batch.dir/src/engine/batch/parallel_csv.cpp.o"
+  "CMakeFiles/batch.dir/src/engine/batch/parallel_csv.cpp.o.d"
+  "libbatch.a"
+  "libbatch.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/batch.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
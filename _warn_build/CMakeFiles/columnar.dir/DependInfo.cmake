@@ -0,0 +1,32 @@
+
+# Consider dependencies only in project.
+set(CMAKE_DEPENDS_IN_PROJECT_ONLY OFF)
+
+# The set of languages for which implicit dependencies are needed:
+set(CMAKE_DEPENDS_LANGUAGES
+  )
+
+# The set of dependency files which are needed:
+set(CMAKE_DEPENDS_DEPENDENCY_FILES
+  "/root/repo/src/engine/columnar/batch_view.cpp" "CMakeFiles/columnar.dir/src/engine/columnar/batch_view.cpp.o" "gcc" "CMakeFiles/columnar.dir/src/engine/columnar/batch_view.cpp.o.d"
+  "/root/repo/src/engine/columnar/bloom_filter.cpp" "CMakeFiles/columnar.dir/src/engine/columnar/bloom_filter.cpp.o" "gcc" "CMakeFiles/columnar.dir/src/engine/columnar/bloom_filter.cpp.o.d"
+  "/root/repo/src/engine/columnar/chunk_stats.cpp" "CMakeFiles/columnar.dir/src/engine/columnar/chunk_stats.cpp.o" "gcc" "CMakeFiles/columnar.dir/src/engine/columnar/chunk_stats.cpp.o.d"
+  "/root/repo/src/engine/columnar/codec.cpp" "CMakeFiles/columnar.dir/src/engine/columnar/codec.cpp.o" "gcc" "CMakeFiles/columnar.dir/src/engine/columnar/codec.cpp.o.d"
+  "/root/repo/src/engine/columnar/columnar_reader.cpp" "CMakeFiles/columnar.dir/src/engine/columnar/columnar_reader.cpp.o" "gcc" "CMakeFiles/columnar.dir/src/engine/columnar/columnar_reader.cpp.o.d"
+  "/root/repo/src/engine/columnar/columnar_writer.cpp" "CMakeFiles/columnar.dir/src/engine/columnar/columnar_writer.cpp.o" "gcc" "CMakeFiles/columnar.dir/src/engine/columnar/columnar_writer.cpp.o.d"
+  "/root/repo/src/engine/columnar/csv_export.cpp" "CMakeFiles/columnar.dir/src/engine/columnar/csv_export.cpp.o" "gcc" "CMakeFiles/columnar.dir/src/engine/columnar/csv_export.cpp.o.d"
+  "/root/repo/src/engine/columnar/encoding.cpp" "CMakeFiles/columnar.dir/src/engine/columnar/encoding.cpp.o" "gcc" "CMakeFiles/columnar.dir/src/engine/columnar/encoding.cpp.o.d"
+  "/root/repo/src/engine/columnar/ingest.cpp" "CMakeFiles/columnar.dir/src/engine/columnar/ingest.cpp.o" "gcc" "CMakeFiles/columnar.dir/src/engine/columnar/ingest.cpp.o.d"
+  "/root/repo/src/engine/columnar/mapped_file.cpp" "CMakeFiles/columnar.dir/src/engine/columnar/mapped_file.cpp.o" "gcc" "CMakeFiles/columnar.dir/src/engine/columnar/mapped_file.cpp.o.d"
+  "/root/repo/src/engine/columnar/secondary_index.cpp" "CMakeFiles/columnar.dir/src/engine/columnar/secondary_index.cpp.o" "gcc" "CMakeFiles/columnar.dir/src/engine/columnar/secondary_index.cpp.o.d"
+  )
+
+# Targets to which this target links.
+set(CMAKE_TARGET_LINKED_INFO_FILES
+  "/root/repo/_warn_build/CMakeFiles/batch.dir/DependInfo.cmake"
+  "/root/repo/_warn_build/CMakeFiles/schema.dir/DependInfo.cmake"
+  "/root/repo/_warn_build/CMakeFiles/csv.dir/DependInfo.cmake"
+  )
+
+# Fortran module output directory.
+set(CMAKE_Fortran_TARGET_MODULE_DIR "")
@@ -0,0 +1,31 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/columnar.dir/src/engine/columnar/batch_view.cpp.o"
+  "CMakeFiles/columnar.dir/src/engine/columnar/batch_view.cpp.o.d"
+  "CMakeFiles/columnar.dir/src/engine/columnar/bloom_filter.cpp.o"
+  "CMakeFiles/columnar.dir/src/engine/columnar/bloom_filter.cpp.o.d"
+  "CMakeFiles/columnar.dir/src/engine/columnar/chunk_stats.cpp.o"
+  "CMakeFiles/columnar.dir/src/engine/columnar/chunk_stats.cpp.o.d"
+  "CMakeFiles/columnar.dir/src/engine/columnar/codec.cpp.o"
+  "CMakeFiles/columnar.dir/src/engine/columnar/codec.cpp.o.d"
+  "CMakeFiles/columnar.dir/src/engine/columnar/columnar_reader.cpp.o"
+  "CMakeFiles/columnar.dir/src/engine/columnar/columnar_reader.cpp.o.d"
+  "CMakeFiles/columnar.dir/src/engine/columnar/columnar_writer.cpp.o"
+  "CMakeFiles/columnar.dir/src/engine/columnar/columnar_writer.cpp.o.d"
+  "CMakeFiles/columnar.dir/src/engine/columnar/csv_export.cpp.o"
+  "CMakeFiles/columnar.dir/src/engine/columnar/csv_export.cpp.o.d"
+  "CMakeFiles/columnar.dir/src/engine/columnar/encoding.cpp.o"
+  "CMakeFiles/columnar.dir/src/engine/columnar/encoding.cpp.o.d"
+  "CMakeFiles/columnar.dir/src/engine/columnar/ingest.cpp.o"
+  "CMakeFiles/columnar.dir/src/engine/columnar/ingest.cpp.o.d"
+  "CMakeFiles/columnar.dir/src/engine/columnar/mapped_file.cpp.o"
+  "CMakeFiles/columnar.dir/src/engine/columnar/mapped_file.cpp.o.d"
+  "CMakeFiles/columnar.dir/src/engine/columnar/secondary_index.cpp.o"
+  "CMakeFiles/columnar.dir/src/engine/columnar/secondary_index.cpp.o.d"
+  "libcolumnar.a"
+  "libcolumnar.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/columnar.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
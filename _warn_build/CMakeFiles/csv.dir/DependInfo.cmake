@@ -0,0 +1,21 @@
+
+# Consider dependencies only in project.
+set(CMAKE_DEPENDS_IN_PROJECT_ONLY OFF)
+
+# The set of languages for which implicit dependencies are needed:
+set(CMAKE_DEPENDS_LANGUAGES
+  )
+
+# The set of dependency files which are needed:
+set(CMAKE_DEPENDS_DEPENDENCY_FILES
+  "/root/repo/src/csv/csvreader.cpp" "CMakeFiles/csv.dir/src/csv/csvreader.cpp.o" "gcc" "CMakeFiles/csv.dir/src/csv/csvreader.cpp.o.d"
+  "/root/repo/src/csv/csvscan.cpp" "CMakeFiles/csv.dir/src/csv/csvscan.cpp.o" "gcc" "CMakeFiles/csv.dir/src/csv/csvscan.cpp.o.d"
+  "/root/repo/src/csv/csvwriter.cpp" "CMakeFiles/csv.dir/src/csv/csvwriter.cpp.o" "gcc" "CMakeFiles/csv.dir/src/csv/csvwriter.cpp.o.d"
+  )
+
+# Targets to which this target links.
+set(CMAKE_TARGET_LINKED_INFO_FILES
+  )
+
+# Fortran module output directory.
+set(CMAKE_Fortran_TARGET_MODULE_DIR "")
@@ -0,0 +1,15 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/csv.dir/src/csv/csvreader.cpp.o"
+  "CMakeFiles/csv.dir/src/csv/csvreader.cpp.o.d"
+  "CMakeFiles/csv.dir/src/csv/csvscan.cpp.o"
+  "CMakeFiles/csv.dir/src/csv/csvscan.cpp.o.d"
+  "CMakeFiles/csv.dir/src/csv/csvwriter.cpp.o"
+  "CMakeFiles/csv.dir/src/csv/csvwriter.cpp.o.d"
+  "libcsv.a"
+  "libcsv.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/csv.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,29 @@
+
+# Consider dependencies only in project.
+set(CMAKE_DEPENDS_IN_PROJECT_ONLY OFF)
+
+# The set of languages for which implicit dependencies are needed:
+set(CMAKE_DEPENDS_LANGUAGES
+  )
+
+# The set of dependency files which are needed:
+set(CMAKE_DEPENDS_DEPENDENCY_FILES
+  "/root/repo/src/engine/exec/aggregate.cpp" "CMakeFiles/exec.dir/src/engine/exec/aggregate.cpp.o" "gcc" "CMakeFiles/exec.dir/src/engine/exec/aggregate.cpp.o.d"
+  "/root/repo/src/engine/exec/expr.cpp" "CMakeFiles/exec.dir/src/engine/exec/expr.cpp.o" "gcc" "CMakeFiles/exec.dir/src/engine/exec/expr.cpp.o.d"
+  "/root/repo/src/engine/exec/filter.cpp" "CMakeFiles/exec.dir/src/engine/exec/filter.cpp.o" "gcc" "CMakeFiles/exec.dir/src/engine/exec/filter.cpp.o.d"
+  "/root/repo/src/engine/exec/join.cpp" "CMakeFiles/exec.dir/src/engine/exec/join.cpp.o" "gcc" "CMakeFiles/exec.dir/src/engine/exec/join.cpp.o.d"
+  "/root/repo/src/engine/exec/query.cpp" "CMakeFiles/exec.dir/src/engine/exec/query.cpp.o" "gcc" "CMakeFiles/exec.dir/src/engine/exec/query.cpp.o.d"
+  "/root/repo/src/engine/exec/sort.cpp" "CMakeFiles/exec.dir/src/engine/exec/sort.cpp.o" "gcc" "CMakeFiles/exec.dir/src/engine/exec/sort.cpp.o.d"
+  "/root/repo/src/engine/exec/spill_dir.cpp" "CMakeFiles/exec.dir/src/engine/exec/spill_dir.cpp.o" "gcc" "CMakeFiles/exec.dir/src/engine/exec/spill_dir.cpp.o.d"
+  )
+
+# Targets to which this target links.
+set(CMAKE_TARGET_LINKED_INFO_FILES
+  "/root/repo/_warn_build/CMakeFiles/batch.dir/DependInfo.cmake"
+  "/root/repo/_warn_build/CMakeFiles/columnar.dir/DependInfo.cmake"
+  "/root/repo/_warn_build/CMakeFiles/schema.dir/DependInfo.cmake"
+  "/root/repo/_warn_build/CMakeFiles/csv.dir/DependInfo.cmake"
+  )
+
+# Fortran module output directory.
+set(CMAKE_Fortran_TARGET_MODULE_DIR "")
@@ -0,0 +1,23 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/exec.dir/src/engine/exec/aggregate.cpp.o"
+  "CMakeFiles/exec.dir/src/engine/exec/aggregate.cpp.o.d"
+  "CMakeFiles/exec.dir/src/engine/exec/expr.cpp.o"
+  "CMakeFiles/exec.dir/src/engine/exec/expr.cpp.o.d"
+  "CMakeFiles/exec.dir/src/engine/exec/filter.cpp.o"
+  "CMakeFiles/exec.dir/src/engine/exec/filter.cpp.o.d"
+  "CMakeFiles/exec.dir/src/engine/exec/join.cpp.o"
+  "CMakeFiles/exec.dir/src/engine/exec/join.cpp.o.d"
+  "CMakeFiles/exec.dir/src/engine/exec/query.cpp.o"
+  "CMakeFiles/exec.dir/src/engine/exec/query.cpp.o.d"
+  "CMakeFiles/exec.dir/src/engine/exec/sort.cpp.o"
+  "CMakeFiles/exec.dir/src/engine/exec/sort.cpp.o.d"
+  "CMakeFiles/exec.dir/src/engine/exec/spill_dir.cpp.o"
+  "CMakeFiles/exec.dir/src/engine/exec/spill_dir.cpp.o.d"
+  "libexec.a"
+  "libexec.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/exec.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
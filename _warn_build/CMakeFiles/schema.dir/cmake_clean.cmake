@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/schema.dir/src/schema/schema.cpp.o"
+  "CMakeFiles/schema.dir/src/schema/schema.cpp.o.d"
+  "libschema.a"
+  "libschema.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/schema.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
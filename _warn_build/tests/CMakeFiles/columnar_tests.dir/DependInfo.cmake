@@ -0,0 +1,26 @@
+
+# Consider dependencies only in project.
+set(CMAKE_DEPENDS_IN_PROJECT_ONLY OFF)
+
+# The set of languages for which implicit dependencies are needed:
+set(CMAKE_DEPENDS_LANGUAGES
+  )
+
+# The set of dependency files which are needed:
+set(CMAKE_DEPENDS_DEPENDENCY_FILES
+  "/root/repo/tests/test_roundtrip.cpp" "tests/CMakeFiles/columnar_tests.dir/test_roundtrip.cpp.o" "gcc" "tests/CMakeFiles/columnar_tests.dir/test_roundtrip.cpp.o.d"
+  )
+
+# Targets to which this target links.
+set(CMAKE_TARGET_LINKED_INFO_FILES
+  "/root/repo/_warn_build/CMakeFiles/csv.dir/DependInfo.cmake"
+  "/root/repo/_warn_build/CMakeFiles/schema.dir/DependInfo.cmake"
+  "/root/repo/_warn_build/CMakeFiles/batch.dir/DependInfo.cmake"
+  "/root/repo/_warn_build/CMakeFiles/columnar.dir/DependInfo.cmake"
+  "/root/repo/_warn_build/CMakeFiles/exec.dir/DependInfo.cmake"
+  "/root/repo/_warn_build/_deps/googletest-build/googletest/CMakeFiles/gtest_main.dir/DependInfo.cmake"
+  "/root/repo/_warn_build/_deps/googletest-build/googletest/CMakeFiles/gtest.dir/DependInfo.cmake"
+  )
+
+# Fortran module output directory.
+set(CMAKE_Fortran_TARGET_MODULE_DIR "")
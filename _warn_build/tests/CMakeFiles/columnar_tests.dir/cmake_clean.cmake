@@ -0,0 +1,12 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/columnar_tests.dir/test_roundtrip.cpp.o"
+  "CMakeFiles/columnar_tests.dir/test_roundtrip.cpp.o.d"
+  "columnar_tests"
+  "columnar_tests.pdb"
+  "columnar_tests[1]_tests.cmake"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/columnar_tests.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,12 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/csv_tests.dir/test_csv.cpp.o"
+  "CMakeFiles/csv_tests.dir/test_csv.cpp.o.d"
+  "csv_tests"
+  "csv_tests.pdb"
+  "csv_tests[1]_tests.cmake"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/csv_tests.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,9 @@
+# CMake generated Testfile for 
+# Source directory: /root/repo/tests
+# Build directory: /root/repo/_warn_build/tests
+# 
+# This file includes the relevant testing commands required for 
+# testing this directory and lists subdirectories to be tested as well.
+include("/root/repo/_warn_build/tests/csv_tests[1]_include.cmake")
+include("/root/repo/_warn_build/tests/columnar_tests[1]_include.cmake")
+subdirs("../_deps/googletest-build")
@@ -0,0 +1,5 @@
+if(EXISTS "/root/repo/_warn_build/tests/columnar_tests[1]_tests.cmake")
+  include("/root/repo/_warn_build/tests/columnar_tests[1]_tests.cmake")
+else()
+  add_test(columnar_tests_NOT_BUILT columnar_tests_NOT_BUILT)
+endif()
@@ -0,0 +1,119 @@
+add_test([=[ColumnarRoundTrip.MultiRowGroupAndCsvEscaping]=]  /root/repo/_warn_build/tests/columnar_tests [==[--gtest_filter=ColumnarRoundTrip.MultiRowGroupAndCsvEscaping]==] --gtest_also_run_disabled_tests)
+set_tests_properties([=[ColumnarRoundTrip.MultiRowGroupAndCsvEscaping]=]  PROPERTIES WORKING_DIRECTORY /root/repo/_warn_build/tests SKIP_REGULAR_EXPRESSION [==[\[  SKIPPED \]]==])
+add_test([=[ColumnarRoundTrip.SingleRowGroup_Int64BoundariesAndWeirdStrings]=]  /root/repo/_warn_build/tests/columnar_tests [==[--gtest_filter=ColumnarRoundTrip.SingleRowGroup_Int64BoundariesAndWeirdStrings]==] --gtest_also_run_disabled_tests)
+set_tests_properties([=[ColumnarRoundTrip.SingleRowGroup_Int64BoundariesAndWeirdStrings]=]  PROPERTIES WORKING_DIRECTORY /root/repo/_warn_build/tests SKIP_REGULAR_EXPRESSION [==[\[  SKIPPED \]]==])
+add_test([=[ColumnarRoundTrip.CRLFAndNoFinalNewline]=]  /root/repo/_warn_build/tests/columnar_tests [==[--gtest_filter=ColumnarRoundTrip.CRLFAndNoFinalNewline]==] --gtest_also_run_disabled_tests)
+set_tests_properties([=[ColumnarRoundTrip.CRLFAndNoFinalNewline]=]  PROPERTIES WORKING_DIRECTORY /root/repo/_warn_build/tests SKIP_REGULAR_EXPRESSION [==[\[  SKIPPED \]]==])
+add_test([=[ColumnarRoundTrip.EmptyDataFileProducesZeroRowGroups]=]  /root/repo/_warn_build/tests/columnar_tests [==[--gtest_filter=ColumnarRoundTrip.EmptyDataFileProducesZeroRowGroups]==] --gtest_also_run_disabled_tests)
+set_tests_properties([=[ColumnarRoundTrip.EmptyDataFileProducesZeroRowGroups]=]  PROPERTIES WORKING_DIRECTORY /root/repo/_warn_build/tests SKIP_REGULAR_EXPRESSION [==[\[  SKIPPED \]]==])
+add_test([=[ColumnarRoundTrip.SkipsAllEmptyLinesInData]=]  /root/repo/_warn_build/tests/columnar_tests [==[--gtest_filter=ColumnarRoundTrip.SkipsAllEmptyLinesInData]==] --gtest_also_run_disabled_tests)
+set_tests_properties([=[ColumnarRoundTrip.SkipsAllEmptyLinesInData]=]  PROPERTIES WORKING_DIRECTORY /root/repo/_warn_build/tests SKIP_REGULAR_EXPRESSION [==[\[  SKIPPED \]]==])
+add_test([=[ColumnarRoundTrip.VeryLongStrings]=]  /root/repo/_warn_build/tests/columnar_tests [==[--gtest_filter=ColumnarRoundTrip.VeryLongStrings]==] --gtest_also_run_disabled_tests)
+set_tests_properties([=[ColumnarRoundTrip.VeryLongStrings]=]  PROPERTIES WORKING_DIRECTORY /root/repo/_warn_build/tests SKIP_REGULAR_EXPRESSION [==[\[  SKIPPED \]]==])
+add_test([=[ColumnarRoundTrip.StringChunkWithManyValuesLoadsInBulk]=]  /root/repo/_warn_build/tests/columnar_tests [==[--gtest_filter=ColumnarRoundTrip.StringChunkWithManyValuesLoadsInBulk]==] --gtest_also_run_disabled_tests)
+set_tests_properties([=[ColumnarRoundTrip.StringChunkWithManyValuesLoadsInBulk]=]  PROPERTIES WORKING_DIRECTORY /root/repo/_warn_build/tests SKIP_REGULAR_EXPRESSION [==[\[  SKIPPED \]]==])
+add_test([=[ParallelCsv.MatchesSequentialBatchesAcrossQuotedNewlines]=]  /root/repo/_warn_build/tests/columnar_tests [==[--gtest_filter=ParallelCsv.MatchesSequentialBatchesAcrossQuotedNewlines]==] --gtest_also_run_disabled_tests)
+set_tests_properties([=[ParallelCsv.MatchesSequentialBatchesAcrossQuotedNewlines]=]  PROPERTIES WORKING_DIRECTORY /root/repo/_warn_build/tests SKIP_REGULAR_EXPRESSION [==[\[  SKIPPED \]]==])
+add_test([=[ParallelCsv.ReportsSameErrorLineAsSequential]=]  /root/repo/_warn_build/tests/columnar_tests [==[--gtest_filter=ParallelCsv.ReportsSameErrorLineAsSequential]==] --gtest_also_run_disabled_tests)
+set_tests_properties([=[ParallelCsv.ReportsSameErrorLineAsSequential]=]  PROPERTIES WORKING_DIRECTORY /root/repo/_warn_build/tests SKIP_REGULAR_EXPRESSION [==[\[  SKIPPED \]]==])
+add_test([=[SchemaErrors.DuplicateColumnNameThrows]=]  /root/repo/_warn_build/tests/columnar_tests [==[--gtest_filter=SchemaErrors.DuplicateColumnNameThrows]==] --gtest_also_run_disabled_tests)
+set_tests_properties([=[SchemaErrors.DuplicateColumnNameThrows]=]  PROPERTIES WORKING_DIRECTORY /root/repo/_warn_build/tests SKIP_REGULAR_EXPRESSION [==[\[  SKIPPED \]]==])
+add_test([=[SchemaErrors.UnknownTypeThrows]=]  /root/repo/_warn_build/tests/columnar_tests [==[--gtest_filter=SchemaErrors.UnknownTypeThrows]==] --gtest_also_run_disabled_tests)
+set_tests_properties([=[SchemaErrors.UnknownTypeThrows]=]  PROPERTIES WORKING_DIRECTORY /root/repo/_warn_build/tests SKIP_REGULAR_EXPRESSION [==[\[  SKIPPED \]]==])
+add_test([=[CsvBatchReaderErrors.InvalidInt64Throws]=]  /root/repo/_warn_build/tests/columnar_tests [==[--gtest_filter=CsvBatchReaderErrors.InvalidInt64Throws]==] --gtest_also_run_disabled_tests)
+set_tests_properties([=[CsvBatchReaderErrors.InvalidInt64Throws]=]  PROPERTIES WORKING_DIRECTORY /root/repo/_warn_build/tests SKIP_REGULAR_EXPRESSION [==[\[  SKIPPED \]]==])
+add_test([=[CsvBatchReaderErrors.WrongFieldCountThrows]=]  /root/repo/_warn_build/tests/columnar_tests [==[--gtest_filter=CsvBatchReaderErrors.WrongFieldCountThrows]==] --gtest_also_run_disabled_tests)
+set_tests_properties([=[CsvBatchReaderErrors.WrongFieldCountThrows]=]  PROPERTIES WORKING_DIRECTORY /root/repo/_warn_build/tests SKIP_REGULAR_EXPRESSION [==[\[  SKIPPED \]]==])
+add_test([=[CsvBatchReader.Int64FastPathMatchesCheckedParse]=]  /root/repo/_warn_build/tests/columnar_tests [==[--gtest_filter=CsvBatchReader.Int64FastPathMatchesCheckedParse]==] --gtest_also_run_disabled_tests)
+set_tests_properties([=[CsvBatchReader.Int64FastPathMatchesCheckedParse]=]  PROPERTIES WORKING_DIRECTORY /root/repo/_warn_build/tests SKIP_REGULAR_EXPRESSION [==[\[  SKIPPED \]]==])
+add_test([=[ColumnarErrors.ReaderRejectsBadMagic]=]  /root/repo/_warn_build/tests/columnar_tests [==[--gtest_filter=ColumnarErrors.ReaderRejectsBadMagic]==] --gtest_also_run_disabled_tests)
+set_tests_properties([=[ColumnarErrors.ReaderRejectsBadMagic]=]  PROPERTIES WORKING_DIRECTORY /root/repo/_warn_build/tests SKIP_REGULAR_EXPRESSION [==[\[  SKIPPED \]]==])
+add_test([=[ColumnarErrors.ReaderRejectsBadVersion]=]  /root/repo/_warn_build/tests/columnar_tests [==[--gtest_filter=ColumnarErrors.ReaderRejectsBadVersion]==] --gtest_also_run_disabled_tests)
+set_tests_properties([=[ColumnarErrors.ReaderRejectsBadVersion]=]  PROPERTIES WORKING_DIRECTORY /root/repo/_warn_build/tests SKIP_REGULAR_EXPRESSION [==[\[  SKIPPED \]]==])
+add_test([=[ColumnarErrors.ReaderRejectsZeroFooterOffset]=]  /root/repo/_warn_build/tests/columnar_tests [==[--gtest_filter=ColumnarErrors.ReaderRejectsZeroFooterOffset]==] --gtest_also_run_disabled_tests)
+set_tests_properties([=[ColumnarErrors.ReaderRejectsZeroFooterOffset]=]  PROPERTIES WORKING_DIRECTORY /root/repo/_warn_build/tests SKIP_REGULAR_EXPRESSION [==[\[  SKIPPED \]]==])
+add_test([=[ColumnarErrors.ReaderRejectsChunkOverlapsFooter]=]  /root/repo/_warn_build/tests/columnar_tests [==[--gtest_filter=ColumnarErrors.ReaderRejectsChunkOverlapsFooter]==] --gtest_also_run_disabled_tests)
+set_tests_properties([=[ColumnarErrors.ReaderRejectsChunkOverlapsFooter]=]  PROPERTIES WORKING_DIRECTORY /root/repo/_warn_build/tests SKIP_REGULAR_EXPRESSION [==[\[  SKIPPED \]]==])
+add_test([=[StringColumnTests.AppendAndSliceKeepOffsetsContiguous]=]  /root/repo/_warn_build/tests/columnar_tests [==[--gtest_filter=StringColumnTests.AppendAndSliceKeepOffsetsContiguous]==] --gtest_also_run_disabled_tests)
+set_tests_properties([=[StringColumnTests.AppendAndSliceKeepOffsetsContiguous]=]  PROPERTIES WORKING_DIRECTORY /root/repo/_warn_build/tests SKIP_REGULAR_EXPRESSION [==[\[  SKIPPED \]]==])
+add_test([=[MappedReader.ViewsMatchStreamReader]=]  /root/repo/_warn_build/tests/columnar_tests [==[--gtest_filter=MappedReader.ViewsMatchStreamReader]==] --gtest_also_run_disabled_tests)
+set_tests_properties([=[MappedReader.ViewsMatchStreamReader]=]  PROPERTIES WORKING_DIRECTORY /root/repo/_warn_build/tests SKIP_REGULAR_EXPRESSION [==[\[  SKIPPED \]]==])
+add_test([=[MappedReader.UnalignedChunksFromUnpaddedFilesAreCopied]=]  /root/repo/_warn_build/tests/columnar_tests [==[--gtest_filter=MappedReader.UnalignedChunksFromUnpaddedFilesAreCopied]==] --gtest_also_run_disabled_tests)
+set_tests_properties([=[MappedReader.UnalignedChunksFromUnpaddedFilesAreCopied]=]  PROPERTIES WORKING_DIRECTORY /root/repo/_warn_build/tests SKIP_REGULAR_EXPRESSION [==[\[  SKIPPED \]]==])
+add_test([=[ColumnarProjection.ReadsOnlyRequestedColumnsInRequestedOrder]=]  /root/repo/_warn_build/tests/columnar_tests [==[--gtest_filter=ColumnarProjection.ReadsOnlyRequestedColumnsInRequestedOrder]==] --gtest_also_run_disabled_tests)
+set_tests_properties([=[ColumnarProjection.ReadsOnlyRequestedColumnsInRequestedOrder]=]  PROPERTIES WORKING_DIRECTORY /root/repo/_warn_build/tests SKIP_REGULAR_EXPRESSION [==[\[  SKIPPED \]]==])
+add_test([=[ChunkStatsTests.MinMaxAndDistinctEstimate]=]  /root/repo/_warn_build/tests/columnar_tests [==[--gtest_filter=ChunkStatsTests.MinMaxAndDistinctEstimate]==] --gtest_also_run_disabled_tests)
+set_tests_properties([=[ChunkStatsTests.MinMaxAndDistinctEstimate]=]  PROPERTIES WORKING_DIRECTORY /root/repo/_warn_build/tests SKIP_REGULAR_EXPRESSION [==[\[  SKIPPED \]]==])
+add_test([=[ChunkStatsTests.CandidateBatchesSkipBatchesOutsideRange]=]  /root/repo/_warn_build/tests/columnar_tests [==[--gtest_filter=ChunkStatsTests.CandidateBatchesSkipBatchesOutsideRange]==] --gtest_also_run_disabled_tests)
+set_tests_properties([=[ChunkStatsTests.CandidateBatchesSkipBatchesOutsideRange]=]  PROPERTIES WORKING_DIRECTORY /root/repo/_warn_build/tests SKIP_REGULAR_EXPRESSION [==[\[  SKIPPED \]]==])
+add_test([=[ChunkStatsTests.VersionOneFilesAreNeverPruned]=]  /root/repo/_warn_build/tests/columnar_tests [==[--gtest_filter=ChunkStatsTests.VersionOneFilesAreNeverPruned]==] --gtest_also_run_disabled_tests)
+set_tests_properties([=[ChunkStatsTests.VersionOneFilesAreNeverPruned]=]  PROPERTIES WORKING_DIRECTORY /root/repo/_warn_build/tests SKIP_REGULAR_EXPRESSION [==[\[  SKIPPED \]]==])
+add_test([=[SecondaryIndexes.FindRowsInUnsortedFilesAndDetectStaleIndexes]=]  /root/repo/_warn_build/tests/columnar_tests [==[--gtest_filter=SecondaryIndexes.FindRowsInUnsortedFilesAndDetectStaleIndexes]==] --gtest_also_run_disabled_tests)
+set_tests_properties([=[SecondaryIndexes.FindRowsInUnsortedFilesAndDetectStaleIndexes]=]  PROPERTIES WORKING_DIRECTORY /root/repo/_warn_build/tests SKIP_REGULAR_EXPRESSION [==[\[  SKIPPED \]]==])
+add_test([=[BloomFilters.NoFalseNegativesAndFewFalsePositives]=]  /root/repo/_warn_build/tests/columnar_tests [==[--gtest_filter=BloomFilters.NoFalseNegativesAndFewFalsePositives]==] --gtest_also_run_disabled_tests)
+set_tests_properties([=[BloomFilters.NoFalseNegativesAndFewFalsePositives]=]  PROPERTIES WORKING_DIRECTORY /root/repo/_warn_build/tests SKIP_REGULAR_EXPRESSION [==[\[  SKIPPED \]]==])
+add_test([=[BloomFilters.ReaderProbesRuleOutBatchesBeforeReadingThem]=]  /root/repo/_warn_build/tests/columnar_tests [==[--gtest_filter=BloomFilters.ReaderProbesRuleOutBatchesBeforeReadingThem]==] --gtest_also_run_disabled_tests)
+set_tests_properties([=[BloomFilters.ReaderProbesRuleOutBatchesBeforeReadingThem]=]  PROPERTIES WORKING_DIRECTORY /root/repo/_warn_build/tests SKIP_REGULAR_EXPRESSION [==[\[  SKIPPED \]]==])
+add_test([=[SortedFiles.LookupAndRangeMatchScanAndWriterRejectsUnsortedRows]=]  /root/repo/_warn_build/tests/columnar_tests [==[--gtest_filter=SortedFiles.LookupAndRangeMatchScanAndWriterRejectsUnsortedRows]==] --gtest_also_run_disabled_tests)
+set_tests_properties([=[SortedFiles.LookupAndRangeMatchScanAndWriterRejectsUnsortedRows]=]  PROPERTIES WORKING_DIRECTORY /root/repo/_warn_build/tests SKIP_REGULAR_EXPRESSION [==[\[  SKIPPED \]]==])
+add_test([=[Int64Encoding.EveryEncodingRoundTripsEdgeValues]=]  /root/repo/_warn_build/tests/columnar_tests [==[--gtest_filter=Int64Encoding.EveryEncodingRoundTripsEdgeValues]==] --gtest_also_run_disabled_tests)
+set_tests_properties([=[Int64Encoding.EveryEncodingRoundTripsEdgeValues]=]  PROPERTIES WORKING_DIRECTORY /root/repo/_warn_build/tests SKIP_REGULAR_EXPRESSION [==[\[  SKIPPED \]]==])
+add_test([=[Int64Encoding.ChoosesCompactEncodingsForTypicalShapes]=]  /root/repo/_warn_build/tests/columnar_tests [==[--gtest_filter=Int64Encoding.ChoosesCompactEncodingsForTypicalShapes]==] --gtest_also_run_disabled_tests)
+set_tests_properties([=[Int64Encoding.ChoosesCompactEncodingsForTypicalShapes]=]  PROPERTIES WORKING_DIRECTORY /root/repo/_warn_build/tests SKIP_REGULAR_EXPRESSION [==[\[  SKIPPED \]]==])
+add_test([=[Int64Encoding.EncodedFilesShrinkAndReadBackInBothModes]=]  /root/repo/_warn_build/tests/columnar_tests [==[--gtest_filter=Int64Encoding.EncodedFilesShrinkAndReadBackInBothModes]==] --gtest_also_run_disabled_tests)
+set_tests_properties([=[Int64Encoding.EncodedFilesShrinkAndReadBackInBothModes]=]  PROPERTIES WORKING_DIRECTORY /root/repo/_warn_build/tests SKIP_REGULAR_EXPRESSION [==[\[  SKIPPED \]]==])
+add_test([=[StringDictionaryEncoding.RoundTripsAndFallsBackOnHighCardinality]=]  /root/repo/_warn_build/tests/columnar_tests [==[--gtest_filter=StringDictionaryEncoding.RoundTripsAndFallsBackOnHighCardinality]==] --gtest_also_run_disabled_tests)
+set_tests_properties([=[StringDictionaryEncoding.RoundTripsAndFallsBackOnHighCardinality]=]  PROPERTIES WORKING_DIRECTORY /root/repo/_warn_build/tests SKIP_REGULAR_EXPRESSION [==[\[  SKIPPED \]]==])
+add_test([=[StringDictionaryEncoding.ReaderExposesCodesAndMaterializesValues]=]  /root/repo/_warn_build/tests/columnar_tests [==[--gtest_filter=StringDictionaryEncoding.ReaderExposesCodesAndMaterializesValues]==] --gtest_also_run_disabled_tests)
+set_tests_properties([=[StringDictionaryEncoding.ReaderExposesCodesAndMaterializesValues]=]  PROPERTIES WORKING_DIRECTORY /root/repo/_warn_build/tests SKIP_REGULAR_EXPRESSION [==[\[  SKIPPED \]]==])
+add_test([=[Codecs.LzRoundTripsEdgeInputsAndRejectsCorruption]=]  /root/repo/_warn_build/tests/columnar_tests [==[--gtest_filter=Codecs.LzRoundTripsEdgeInputsAndRejectsCorruption]==] --gtest_also_run_disabled_tests)
+set_tests_properties([=[Codecs.LzRoundTripsEdgeInputsAndRejectsCorruption]=]  PROPERTIES WORKING_DIRECTORY /root/repo/_warn_build/tests SKIP_REGULAR_EXPRESSION [==[\[  SKIPPED \]]==])
+add_test([=[Codecs.CompressedFilesReadBackInBothModes]=]  /root/repo/_warn_build/tests/columnar_tests [==[--gtest_filter=Codecs.CompressedFilesReadBackInBothModes]==] --gtest_also_run_disabled_tests)
+set_tests_properties([=[Codecs.CompressedFilesReadBackInBothModes]=]  PROPERTIES WORKING_DIRECTORY /root/repo/_warn_build/tests SKIP_REGULAR_EXPRESSION [==[\[  SKIPPED \]]==])
+add_test([=[SpscQueueTests.DeliversInOrderAndCloseUnblocksBothSides]=]  /root/repo/_warn_build/tests/columnar_tests [==[--gtest_filter=SpscQueueTests.DeliversInOrderAndCloseUnblocksBothSides]==] --gtest_also_run_disabled_tests)
+set_tests_properties([=[SpscQueueTests.DeliversInOrderAndCloseUnblocksBothSides]=]  PROPERTIES WORKING_DIRECTORY /root/repo/_warn_build/tests SKIP_REGULAR_EXPRESSION [==[\[  SKIPPED \]]==])
+add_test([=[PipelinedIngest.WritesSameFileAsSequentialWriter]=]  /root/repo/_warn_build/tests/columnar_tests [==[--gtest_filter=PipelinedIngest.WritesSameFileAsSequentialWriter]==] --gtest_also_run_disabled_tests)
+set_tests_properties([=[PipelinedIngest.WritesSameFileAsSequentialWriter]=]  PROPERTIES WORKING_DIRECTORY /root/repo/_warn_build/tests SKIP_REGULAR_EXPRESSION [==[\[  SKIPPED \]]==])
+add_test([=[PipelinedIngest.ParseErrorStopsAllStagesAndIsRethrown]=]  /root/repo/_warn_build/tests/columnar_tests [==[--gtest_filter=PipelinedIngest.ParseErrorStopsAllStagesAndIsRethrown]==] --gtest_also_run_disabled_tests)
+set_tests_properties([=[PipelinedIngest.ParseErrorStopsAllStagesAndIsRethrown]=]  PROPERTIES WORKING_DIRECTORY /root/repo/_warn_build/tests SKIP_REGULAR_EXPRESSION [==[\[  SKIPPED \]]==])
+add_test([=[ParallelEncoding.WideBatchesMatchSingleThreadedWriter]=]  /root/repo/_warn_build/tests/columnar_tests [==[--gtest_filter=ParallelEncoding.WideBatchesMatchSingleThreadedWriter]==] --gtest_also_run_disabled_tests)
+set_tests_properties([=[ParallelEncoding.WideBatchesMatchSingleThreadedWriter]=]  PROPERTIES WORKING_DIRECTORY /root/repo/_warn_build/tests SKIP_REGULAR_EXPRESSION [==[\[  SKIPPED \]]==])
+add_test([=[CsvExport.MatchesCsvWriterBytesForAnyThreadCount]=]  /root/repo/_warn_build/tests/columnar_tests [==[--gtest_filter=CsvExport.MatchesCsvWriterBytesForAnyThreadCount]==] --gtest_also_run_disabled_tests)
+set_tests_properties([=[CsvExport.MatchesCsvWriterBytesForAnyThreadCount]=]  PROPERTIES WORKING_DIRECTORY /root/repo/_warn_build/tests SKIP_REGULAR_EXPRESSION [==[\[  SKIPPED \]]==])
+add_test([=[CsvWriterBatch.MatchesWriteNextBytes]=]  /root/repo/_warn_build/tests/columnar_tests [==[--gtest_filter=CsvWriterBatch.MatchesWriteNextBytes]==] --gtest_also_run_disabled_tests)
+set_tests_properties([=[CsvWriterBatch.MatchesWriteNextBytes]=]  PROPERTIES WORKING_DIRECTORY /root/repo/_warn_build/tests SKIP_REGULAR_EXPRESSION [==[\[  SKIPPED \]]==])
+add_test([=[CsvWriterBatch.MatchesWriteNextAcrossFlushesAndTypes]=]  /root/repo/_warn_build/tests/columnar_tests [==[--gtest_filter=CsvWriterBatch.MatchesWriteNextAcrossFlushesAndTypes]==] --gtest_also_run_disabled_tests)
+set_tests_properties([=[CsvWriterBatch.MatchesWriteNextAcrossFlushesAndTypes]=]  PROPERTIES WORKING_DIRECTORY /root/repo/_warn_build/tests SKIP_REGULAR_EXPRESSION [==[\[  SKIPPED \]]==])
+add_test([=[ExecFilter.ParsesPushesNotDownAndReportsErrors]=]  /root/repo/_warn_build/tests/columnar_tests [==[--gtest_filter=ExecFilter.ParsesPushesNotDownAndReportsErrors]==] --gtest_also_run_disabled_tests)
+set_tests_properties([=[ExecFilter.ParsesPushesNotDownAndReportsErrors]=]  PROPERTIES WORKING_DIRECTORY /root/repo/_warn_build/tests SKIP_REGULAR_EXPRESSION [==[\[  SKIPPED \]]==])
+add_test([=[ExecFilter.Int64KernelMatchesScalarForEveryOperator]=]  /root/repo/_warn_build/tests/columnar_tests [==[--gtest_filter=ExecFilter.Int64KernelMatchesScalarForEveryOperator]==] --gtest_also_run_disabled_tests)
+set_tests_properties([=[ExecFilter.Int64KernelMatchesScalarForEveryOperator]=]  PROPERTIES WORKING_DIRECTORY /root/repo/_warn_build/tests SKIP_REGULAR_EXPRESSION [==[\[  SKIPPED \]]==])
+add_test([=[ExecQuery.StreamsMatchingRowsAndPrunesBatches]=]  /root/repo/_warn_build/tests/columnar_tests [==[--gtest_filter=ExecQuery.StreamsMatchingRowsAndPrunesBatches]==] --gtest_also_run_disabled_tests)
+set_tests_properties([=[ExecQuery.StreamsMatchingRowsAndPrunesBatches]=]  PROPERTIES WORKING_DIRECTORY /root/repo/_warn_build/tests SKIP_REGULAR_EXPRESSION [==[\[  SKIPPED \]]==])
+add_test([=[ExecAggregate.MatchesReferenceAcrossThreadsAndRadixPartitioning]=]  /root/repo/_warn_build/tests/columnar_tests [==[--gtest_filter=ExecAggregate.MatchesReferenceAcrossThreadsAndRadixPartitioning]==] --gtest_also_run_disabled_tests)
+set_tests_properties([=[ExecAggregate.MatchesReferenceAcrossThreadsAndRadixPartitioning]=]  PROPERTIES WORKING_DIRECTORY /root/repo/_warn_build/tests SKIP_REGULAR_EXPRESSION [==[\[  SKIPPED \]]==])
+add_test([=[ExecAggregate.QueryOrdersColumnsAsSelectedAndFormatsAverages]=]  /root/repo/_warn_build/tests/columnar_tests [==[--gtest_filter=ExecAggregate.QueryOrdersColumnsAsSelectedAndFormatsAverages]==] --gtest_also_run_disabled_tests)
+set_tests_properties([=[ExecAggregate.QueryOrdersColumnsAsSelectedAndFormatsAverages]=]  PROPERTIES WORKING_DIRECTORY /root/repo/_warn_build/tests SKIP_REGULAR_EXPRESSION [==[\[  SKIPPED \]]==])
+add_test([=[ExecAggregate.SumOverflowDoesNotDependOnThreads]=]  /root/repo/_warn_build/tests/columnar_tests [==[--gtest_filter=ExecAggregate.SumOverflowDoesNotDependOnThreads]==] --gtest_also_run_disabled_tests)
+set_tests_properties([=[ExecAggregate.SumOverflowDoesNotDependOnThreads]=]  PROPERTIES WORKING_DIRECTORY /root/repo/_warn_build/tests SKIP_REGULAR_EXPRESSION [==[\[  SKIPPED \]]==])
+add_test([=[ExecJoin.InnerAndLeftJoinsMatchNestedLoopInAnyMode]=]  /root/repo/_warn_build/tests/columnar_tests [==[--gtest_filter=ExecJoin.InnerAndLeftJoinsMatchNestedLoopInAnyMode]==] --gtest_also_run_disabled_tests)
+set_tests_properties([=[ExecJoin.InnerAndLeftJoinsMatchNestedLoopInAnyMode]=]  PROPERTIES WORKING_DIRECTORY /root/repo/_warn_build/tests SKIP_REGULAR_EXPRESSION [==[\[  SKIPPED \]]==])
+add_test([=[ExecJoin.RepartitionsBuildPartitionsOverTheBudget]=]  /root/repo/_warn_build/tests/columnar_tests [==[--gtest_filter=ExecJoin.RepartitionsBuildPartitionsOverTheBudget]==] --gtest_also_run_disabled_tests)
+set_tests_properties([=[ExecJoin.RepartitionsBuildPartitionsOverTheBudget]=]  PROPERTIES WORKING_DIRECTORY /root/repo/_warn_build/tests SKIP_REGULAR_EXPRESSION [==[\[  SKIPPED \]]==])
+add_test([=[SpillDir.CreatesAFreshDirectoryAndRemovesOnlyItsOwn]=]  /root/repo/_warn_build/tests/columnar_tests [==[--gtest_filter=SpillDir.CreatesAFreshDirectoryAndRemovesOnlyItsOwn]==] --gtest_also_run_disabled_tests)
+set_tests_properties([=[SpillDir.CreatesAFreshDirectoryAndRemovesOnlyItsOwn]=]  PROPERTIES WORKING_DIRECTORY /root/repo/_warn_build/tests SKIP_REGULAR_EXPRESSION [==[\[  SKIPPED \]]==])
+add_test([=[ExecSort.MatchesStableSortInMemoryAndAcrossSpilledMergePasses]=]  /root/repo/_warn_build/tests/columnar_tests [==[--gtest_filter=ExecSort.MatchesStableSortInMemoryAndAcrossSpilledMergePasses]==] --gtest_also_run_disabled_tests)
+set_tests_properties([=[ExecSort.MatchesStableSortInMemoryAndAcrossSpilledMergePasses]=]  PROPERTIES WORKING_DIRECTORY /root/repo/_warn_build/tests SKIP_REGULAR_EXPRESSION [==[\[  SKIPPED \]]==])
+add_test([=[NarrowTypes.ParseFilterAndExportEveryIntegerType]=]  /root/repo/_warn_build/tests/columnar_tests [==[--gtest_filter=NarrowTypes.ParseFilterAndExportEveryIntegerType]==] --gtest_also_run_disabled_tests)
+set_tests_properties([=[NarrowTypes.ParseFilterAndExportEveryIntegerType]=]  PROPERTIES WORKING_DIRECTORY /root/repo/_warn_build/tests SKIP_REGULAR_EXPRESSION [==[\[  SKIPPED \]]==])
+add_test([=[NarrowTypes.NarrowedSchemaFromStatsAndRewriteKeepsValues]=]  /root/repo/_warn_build/tests/columnar_tests [==[--gtest_filter=NarrowTypes.NarrowedSchemaFromStatsAndRewriteKeepsValues]==] --gtest_also_run_disabled_tests)
+set_tests_properties([=[NarrowTypes.NarrowedSchemaFromStatsAndRewriteKeepsValues]=]  PROPERTIES WORKING_DIRECTORY /root/repo/_warn_build/tests SKIP_REGULAR_EXPRESSION [==[\[  SKIPPED \]]==])
+add_test([=[NullableColumns.ValidityIsStoredOnlyForMixedChunksAndRoundTrips]=]  /root/repo/_warn_build/tests/columnar_tests [==[--gtest_filter=NullableColumns.ValidityIsStoredOnlyForMixedChunksAndRoundTrips]==] --gtest_also_run_disabled_tests)
+set_tests_properties([=[NullableColumns.ValidityIsStoredOnlyForMixedChunksAndRoundTrips]=]  PROPERTIES WORKING_DIRECTORY /root/repo/_warn_build/tests SKIP_REGULAR_EXPRESSION [==[\[  SKIPPED \]]==])
+add_test([=[NullableColumns.FiltersAggregatesJoinsAndSortsSkipOrGroupNulls]=]  /root/repo/_warn_build/tests/columnar_tests [==[--gtest_filter=NullableColumns.FiltersAggregatesJoinsAndSortsSkipOrGroupNulls]==] --gtest_also_run_disabled_tests)
+set_tests_properties([=[NullableColumns.FiltersAggregatesJoinsAndSortsSkipOrGroupNulls]=]  PROPERTIES WORKING_DIRECTORY /root/repo/_warn_build/tests SKIP_REGULAR_EXPRESSION [==[\[  SKIPPED \]]==])
+add_test([=[AppendMode.AddsBatchesUnderTheFileOrderAndKeepsOldFooterUntilFinish]=]  /root/repo/_warn_build/tests/columnar_tests [==[--gtest_filter=AppendMode.AddsBatchesUnderTheFileOrderAndKeepsOldFooterUntilFinish]==] --gtest_also_run_disabled_tests)
+set_tests_properties([=[AppendMode.AddsBatchesUnderTheFileOrderAndKeepsOldFooterUntilFinish]=]  PROPERTIES WORKING_DIRECTORY /root/repo/_warn_build/tests SKIP_REGULAR_EXPRESSION [==[\[  SKIPPED \]]==])
+add_test([=[AppendMode.NarrowedFileAcceptsItsDeclaredSchemaAndRangeChecksValues]=]  /root/repo/_warn_build/tests/columnar_tests [==[--gtest_filter=AppendMode.NarrowedFileAcceptsItsDeclaredSchemaAndRangeChecksValues]==] --gtest_also_run_disabled_tests)
+set_tests_properties([=[AppendMode.NarrowedFileAcceptsItsDeclaredSchemaAndRangeChecksValues]=]  PROPERTIES WORKING_DIRECTORY /root/repo/_warn_build/tests SKIP_REGULAR_EXPRESSION [==[\[  SKIPPED \]]==])
+set(  columnar_tests_TESTS ColumnarRoundTrip.MultiRowGroupAndCsvEscaping ColumnarRoundTrip.SingleRowGroup_Int64BoundariesAndWeirdStrings ColumnarRoundTrip.CRLFAndNoFinalNewline ColumnarRoundTrip.EmptyDataFileProducesZeroRowGroups ColumnarRoundTrip.SkipsAllEmptyLinesInData ColumnarRoundTrip.VeryLongStrings ColumnarRoundTrip.StringChunkWithManyValuesLoadsInBulk ParallelCsv.MatchesSequentialBatchesAcrossQuotedNewlines ParallelCsv.ReportsSameErrorLineAsSequential SchemaErrors.DuplicateColumnNameThrows SchemaErrors.UnknownTypeThrows CsvBatchReaderErrors.InvalidInt64Throws CsvBatchReaderErrors.WrongFieldCountThrows CsvBatchReader.Int64FastPathMatchesCheckedParse ColumnarErrors.ReaderRejectsBadMagic ColumnarErrors.ReaderRejectsBadVersion ColumnarErrors.ReaderRejectsZeroFooterOffset ColumnarErrors.ReaderRejectsChunkOverlapsFooter StringColumnTests.AppendAndSliceKeepOffsetsContiguous MappedReader.ViewsMatchStreamReader MappedReader.UnalignedChunksFromUnpaddedFilesAreCopied ColumnarProjection.ReadsOnlyRequestedColumnsInRequestedOrder ChunkStatsTests.MinMaxAndDistinctEstimate ChunkStatsTests.CandidateBatchesSkipBatchesOutsideRange ChunkStatsTests.VersionOneFilesAreNeverPruned SecondaryIndexes.FindRowsInUnsortedFilesAndDetectStaleIndexes BloomFilters.NoFalseNegativesAndFewFalsePositives BloomFilters.ReaderProbesRuleOutBatchesBeforeReadingThem SortedFiles.LookupAndRangeMatchScanAndWriterRejectsUnsortedRows Int64Encoding.EveryEncodingRoundTripsEdgeValues Int64Encoding.ChoosesCompactEncodingsForTypicalShapes Int64Encoding.EncodedFilesShrinkAndReadBackInBothModes StringDictionaryEncoding.RoundTripsAndFallsBackOnHighCardinality StringDictionaryEncoding.ReaderExposesCodesAndMaterializesValues Codecs.LzRoundTripsEdgeInputsAndRejectsCorruption Codecs.CompressedFilesReadBackInBothModes SpscQueueTests.DeliversInOrderAndCloseUnblocksBothSides PipelinedIngest.WritesSameFileAsSequentialWriter PipelinedIngest.ParseErrorStopsAllStagesAndIsRethrown ParallelEncoding.WideBatchesMatchSingleThreadedWriter CsvExport.MatchesCsvWriterBytesForAnyThreadCount CsvWriterBatch.MatchesWriteNextBytes CsvWriterBatch.MatchesWriteNextAcrossFlushesAndTypes ExecFilter.ParsesPushesNotDownAndReportsErrors ExecFilter.Int64KernelMatchesScalarForEveryOperator ExecQuery.StreamsMatchingRowsAndPrunesBatches ExecAggregate.MatchesReferenceAcrossThreadsAndRadixPartitioning ExecAggregate.QueryOrdersColumnsAsSelectedAndFormatsAverages ExecAggregate.SumOverflowDoesNotDependOnThreads ExecJoin.InnerAndLeftJoinsMatchNestedLoopInAnyMode ExecJoin.RepartitionsBuildPartitionsOverTheBudget SpillDir.CreatesAFreshDirectoryAndRemovesOnlyItsOwn ExecSort.MatchesStableSortInMemoryAndAcrossSpilledMergePasses NarrowTypes.ParseFilterAndExportEveryIntegerType NarrowTypes.NarrowedSchemaFromStatsAndRewriteKeepsValues NullableColumns.ValidityIsStoredOnlyForMixedChunksAndRoundTrips NullableColumns.FiltersAggregatesJoinsAndSortsSkipOrGroupNulls AppendMode.AddsBatchesUnderTheFileOrderAndKeepsOldFooterUntilFinish AppendMode.NarrowedFileAcceptsItsDeclaredSchemaAndRangeChecksValues)
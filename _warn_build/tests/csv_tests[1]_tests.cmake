@@ -0,0 +1,27 @@
+add_test([=[CSVReaderTests.ReadsSimpleLine]=]  /root/repo/_warn_build/tests/csv_tests [==[--gtest_filter=CSVReaderTests.ReadsSimpleLine]==] --gtest_also_run_disabled_tests)
+set_tests_properties([=[CSVReaderTests.ReadsSimpleLine]=]  PROPERTIES WORKING_DIRECTORY /root/repo/_warn_build/tests SKIP_REGULAR_EXPRESSION [==[\[  SKIPPED \]]==])
+add_test([=[CSVReaderTests.ReadsQuotedAndEscapedQuotes]=]  /root/repo/_warn_build/tests/csv_tests [==[--gtest_filter=CSVReaderTests.ReadsQuotedAndEscapedQuotes]==] --gtest_also_run_disabled_tests)
+set_tests_properties([=[CSVReaderTests.ReadsQuotedAndEscapedQuotes]=]  PROPERTIES WORKING_DIRECTORY /root/repo/_warn_build/tests SKIP_REGULAR_EXPRESSION [==[\[  SKIPPED \]]==])
+add_test([=[CSVReaderTests.ReadsDelimiterInsideQuotes]=]  /root/repo/_warn_build/tests/csv_tests [==[--gtest_filter=CSVReaderTests.ReadsDelimiterInsideQuotes]==] --gtest_also_run_disabled_tests)
+set_tests_properties([=[CSVReaderTests.ReadsDelimiterInsideQuotes]=]  PROPERTIES WORKING_DIRECTORY /root/repo/_warn_build/tests SKIP_REGULAR_EXPRESSION [==[\[  SKIPPED \]]==])
+add_test([=[CSVReaderTests.ReadsNewlineInsideQuotes]=]  /root/repo/_warn_build/tests/csv_tests [==[--gtest_filter=CSVReaderTests.ReadsNewlineInsideQuotes]==] --gtest_also_run_disabled_tests)
+set_tests_properties([=[CSVReaderTests.ReadsNewlineInsideQuotes]=]  PROPERTIES WORKING_DIRECTORY /root/repo/_warn_build/tests SKIP_REGULAR_EXPRESSION [==[\[  SKIPPED \]]==])
+add_test([=[CSVReaderTests.BlockBoundariesDoNotChangeTokens]=]  /root/repo/_warn_build/tests/csv_tests [==[--gtest_filter=CSVReaderTests.BlockBoundariesDoNotChangeTokens]==] --gtest_also_run_disabled_tests)
+set_tests_properties([=[CSVReaderTests.BlockBoundariesDoNotChangeTokens]=]  PROPERTIES WORKING_DIRECTORY /root/repo/_warn_build/tests SKIP_REGULAR_EXPRESSION [==[\[  SKIPPED \]]==])
+add_test([=[CSVReaderTests.LongFieldsSpanManyScanBlocks]=]  /root/repo/_warn_build/tests/csv_tests [==[--gtest_filter=CSVReaderTests.LongFieldsSpanManyScanBlocks]==] --gtest_also_run_disabled_tests)
+set_tests_properties([=[CSVReaderTests.LongFieldsSpanManyScanBlocks]=]  PROPERTIES WORKING_DIRECTORY /root/repo/_warn_build/tests SKIP_REGULAR_EXPRESSION [==[\[  SKIPPED \]]==])
+add_test([=[CSVReaderTests.UnterminatedQuoteThrows]=]  /root/repo/_warn_build/tests/csv_tests [==[--gtest_filter=CSVReaderTests.UnterminatedQuoteThrows]==] --gtest_also_run_disabled_tests)
+set_tests_properties([=[CSVReaderTests.UnterminatedQuoteThrows]=]  PROPERTIES WORKING_DIRECTORY /root/repo/_warn_build/tests SKIP_REGULAR_EXPRESSION [==[\[  SKIPPED \]]==])
+add_test([=[CSVReaderTests.RowViewUnescapesOnlyQuotedFields]=]  /root/repo/_warn_build/tests/csv_tests [==[--gtest_filter=CSVReaderTests.RowViewUnescapesOnlyQuotedFields]==] --gtest_also_run_disabled_tests)
+set_tests_properties([=[CSVReaderTests.RowViewUnescapesOnlyQuotedFields]=]  PROPERTIES WORKING_DIRECTORY /root/repo/_warn_build/tests SKIP_REGULAR_EXPRESSION [==[\[  SKIPPED \]]==])
+add_test([=[CSVReaderTests.RowViewGrowsBufferForRowsLongerThanBlock]=]  /root/repo/_warn_build/tests/csv_tests [==[--gtest_filter=CSVReaderTests.RowViewGrowsBufferForRowsLongerThanBlock]==] --gtest_also_run_disabled_tests)
+set_tests_properties([=[CSVReaderTests.RowViewGrowsBufferForRowsLongerThanBlock]=]  PROPERTIES WORKING_DIRECTORY /root/repo/_warn_build/tests SKIP_REGULAR_EXPRESSION [==[\[  SKIPPED \]]==])
+add_test([=[CSVReaderTests.RowViewFlagsBlankRows]=]  /root/repo/_warn_build/tests/csv_tests [==[--gtest_filter=CSVReaderTests.RowViewFlagsBlankRows]==] --gtest_also_run_disabled_tests)
+set_tests_properties([=[CSVReaderTests.RowViewFlagsBlankRows]=]  PROPERTIES WORKING_DIRECTORY /root/repo/_warn_build/tests SKIP_REGULAR_EXPRESSION [==[\[  SKIPPED \]]==])
+add_test([=[CSVWriterTests.WritesSimpleLine]=]  /root/repo/_warn_build/tests/csv_tests [==[--gtest_filter=CSVWriterTests.WritesSimpleLine]==] --gtest_also_run_disabled_tests)
+set_tests_properties([=[CSVWriterTests.WritesSimpleLine]=]  PROPERTIES WORKING_DIRECTORY /root/repo/_warn_build/tests SKIP_REGULAR_EXPRESSION [==[\[  SKIPPED \]]==])
+add_test([=[CSVWriterTests.QuotesAndEscapesWhenNeeded]=]  /root/repo/_warn_build/tests/csv_tests [==[--gtest_filter=CSVWriterTests.QuotesAndEscapesWhenNeeded]==] --gtest_also_run_disabled_tests)
+set_tests_properties([=[CSVWriterTests.QuotesAndEscapesWhenNeeded]=]  PROPERTIES WORKING_DIRECTORY /root/repo/_warn_build/tests SKIP_REGULAR_EXPRESSION [==[\[  SKIPPED \]]==])
+add_test([=[CSVRoundTripTests.WriterThenReader]=]  /root/repo/_warn_build/tests/csv_tests [==[--gtest_filter=CSVRoundTripTests.WriterThenReader]==] --gtest_also_run_disabled_tests)
+set_tests_properties([=[CSVRoundTripTests.WriterThenReader]=]  PROPERTIES WORKING_DIRECTORY /root/repo/_warn_build/tests SKIP_REGULAR_EXPRESSION [==[\[  SKIPPED \]]==])
+set(  csv_tests_TESTS CSVReaderTests.ReadsSimpleLine CSVReaderTests.ReadsQuotedAndEscapedQuotes CSVReaderTests.ReadsDelimiterInsideQuotes CSVReaderTests.ReadsNewlineInsideQuotes CSVReaderTests.BlockBoundariesDoNotChangeTokens CSVReaderTests.LongFieldsSpanManyScanBlocks CSVReaderTests.UnterminatedQuoteThrows CSVReaderTests.RowViewUnescapesOnlyQuotedFields CSVReaderTests.RowViewGrowsBufferForRowsLongerThanBlock CSVReaderTests.RowViewFlagsBlankRows CSVWriterTests.WritesSimpleLine CSVWriterTests.QuotesAndEscapesWhenNeeded CSVRoundTripTests.WriterThenReader)
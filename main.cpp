@@ -1,59 +1,191 @@
+#include <algorithm>
+#include <cctype>
+#include <charconv>
 #include <cstdlib>
 #include <filesystem>
 #include <fstream>
 #include <iostream>
 #include <stdexcept>
 #include <string>
+#include <string_view>
+#include <system_error>
+#include <unordered_map>
+#include <vector>
 
 #include "batch.h"
-#include "csvwriter.h"
 #include "schema.h"
+#include "utils/utils.h"
 #include "engine/columnar/columnar_reader.h"
 #include "engine/columnar/columnar_writer.h"
+#include "engine/columnar/csv_export.h"
+#include "engine/columnar/ingest.h"
+#include "engine/columnar/secondary_index.h"
+#include "engine/exec/join.h"
+#include "engine/exec/query.h"
+#include "engine/exec/sort.h"
 
 void PrintUsage(const char *prog) {
 	std::cerr
 			<< "Usage:\n"
-			<< "  " << prog << " to-columnar <schema.csv> <data.csv> <out.columnar>\n"
-			<< "  " << prog << " to-csv <in.columnar> <out_schema.csv> <out_data.csv>\n";
+			<< "  " << prog << " to-columnar [--threads N] [--codec none|lz|zstd|lz4] [--sort-by a,b:desc] [--bloom a,b]\n"
+			<< "      [--narrow | --append] <schema.csv> <data.csv> <out.columnar>\n"
+			<< "  " << prog << " to-csv [--threads N] [--columns a,b,c] <in.columnar> <out_schema.csv> <out_data.csv>\n"
+			<< "  " << prog << " query [--where EXPR] [--select a,sum(b),...] [--group-by a] [--threads N] <in.columnar>\n"
+			<< "  " << prog << " join [--type inner|left] --on KEY | --left-key A --right-key B [--left-columns a,b]\n"
+			<< "      [--right-columns c,d] [--threads N] [--memory-mb N] [--codec C] <left.columnar> <right.columnar> <out.columnar>\n"
+			<< "  " << prog << " index [--out PATH] <in.columnar> <column>   (default PATH: <in.columnar>.<column>.idx)\n"
+			<< "  " << prog << " sort --by a,b:desc [--threads N] [--memory-mb N] [--codec C] <in.columnar> <out.columnar>\n";
+}
+
+
+struct CliArgs {
+	std::vector<std::string> positional;
+	std::unordered_map<std::string, std::string> options;
+
+	bool Has(const std::string &name) const { return options.contains(name); }
+
+	std::string Get(const std::string &name, const std::string &def = "") const {
+		const auto it = options.find(name);
+		return it == options.end() ? def : it->second;
+	}
+
+	// A decimal integer in [0, max]; signs, spaces and anything after the digits are rejected.
+	std::size_t GetSize(const std::string &name, std::size_t def, std::size_t max) const {
+		const auto it = options.find(name);
+		if (it == options.end()) return def;
+		const std::string &s = it->second;
+		std::size_t v = 0;
+		const auto [ptr, ec] = std::from_chars(s.data(), s.data() + s.size(), v);
+		if (s.empty() || !std::isdigit(static_cast<unsigned char>(s.front())) || ec != std::errc{} ||
+		    ptr != s.data() + s.size()) {
+			throw std::runtime_error("option " + name + " expects a non-negative integer, got '" + s + "'");
+		}
+		if (v > max) throw std::runtime_error("option " + name + " must be at most " + std::to_string(max) + ", got " + s);
+		return v;
+	}
+};
+
+std::vector<std::string> SplitList(const std::string &list) {
+	std::vector<std::string> items;
+	std::size_t begin = 0;
+	while (begin <= list.size()) {
+		const std::size_t end = std::min(list.find(',', begin), list.size());
+		const std::string_view item = utils::Trim(std::string_view(list).substr(begin, end - begin));
+		if (!item.empty()) items.emplace_back(item);
+		begin = end + 1;
+	}
+	return items;
+}
+
+// Upper limits for --threads and --memory-mb (1 TiB).
+constexpr std::size_t kMaxThreads = 1024;
+constexpr std::size_t kMaxMemoryMb = std::size_t{1} << 20;
+
+// Options that take no value; they are stored as "1".
+constexpr std::string_view kFlags[] = {"--narrow", "--append"};
+
+// Splits argv[first..] into positional arguments, flags and "--name value" / "--name=value"
+// options.
+CliArgs ParseArgs(int argc, char **argv, int first) {
+	CliArgs args;
+	for (int i = first; i < argc; ++i) {
+		std::string a = argv[i];
+		if (!a.starts_with("--")) {
+			args.positional.push_back(std::move(a));
+			continue;
+		}
+		const auto eq = a.find('=');
+		if (std::ranges::find(kFlags, a) != std::end(kFlags)) {
+			args.options[a] = "1";
+		} else if (eq != std::string::npos) {
+			args.options[a.substr(0, eq)] = a.substr(eq + 1);
+		} else if (i + 1 < argc) {
+			args.options[a] = argv[++i];
+		} else {
+			throw std::runtime_error("option " + a + " expects a value");
+		}
+	}
+	return args;
 }
 
 
 int ToColumnar(const std::filesystem::path &schema_path,
                const std::filesystem::path &data_path,
-               const std::filesystem::path &out_path) {
+               const std::filesystem::path &out_path,
+               std::size_t threads,
+               columnar::WriterOptions options,
+               const std::vector<std::string> &sort_by,
+               const std::vector<std::string> &bloom,
+               bool narrow) {
 	std::ifstream schema_in(schema_path);
 	if (!schema_in.is_open()) {
 		throw std::runtime_error("failed to open schema.csv: " + schema_path.string());
 	}
 	Schema schema = LoadSchemaCsv(schema_in);
+	for (const auto &item: sort_by) {
+		const auto [column, descending] = utils::ParseSortKey(item);
+		const auto it = std::ranges::find(schema, column, &ColumnSchema::name);
+		if (it == schema.end()) throw std::runtime_error("unknown column '" + std::string(column) + "' in --sort-by");
+		options.sort_by.push_back({static_cast<std::uint32_t>(it - schema.begin()), descending});
+	}
+	for (const auto &name: bloom) {
+		const auto it = std::ranges::find(schema, name, &ColumnSchema::name);
+		if (it == schema.end()) throw std::runtime_error("unknown column '" + name + "' in --bloom");
+		options.bloom_columns.push_back(static_cast<std::size_t>(it - schema.begin()));
+	}
 
-	std::ifstream data_in(data_path);
-	if (!data_in.is_open()) {
+	if (!std::ifstream(data_path).is_open()) {
 		throw std::runtime_error("failed to open data.csv: " + data_path.string());
 	}
+	// An appended file keeps its column types, so there is nothing to narrow.
+	if (narrow && options.append) throw std::runtime_error("--narrow cannot be combined with --append");
 
-	CsvBatchReader batch_reader(data_in, schema);
-	columnar::ColumnarWriter writer(out_path, schema);
-
-	std::size_t total_rows = 0;
-	std::size_t groups = 0;
-	while (true) {
-		auto batch_opt = batch_reader.ReadNext();
-		if (!batch_opt.has_value()) break;
-		writer.WriteBatch(*batch_opt);
-		total_rows += batch_opt->RowCount();
-		++groups;
+	// Narrowing needs the values' ranges, so the file is written with the declared types
+	// first and rewritten from its chunk stats if any column fits a smaller type.
+	const std::filesystem::path wide_path = narrow ? std::filesystem::path(out_path.string() + ".wide.tmp") : out_path;
+	// Removes the wide file however this returns; a no-op once it has been renamed.
+	struct RemoveOnExit {
+		std::filesystem::path path;
+		~RemoveOnExit() {
+			std::error_code ec;
+			if (!path.empty()) std::filesystem::remove(path, ec);
+		}
+	} const wide_cleanup{narrow ? wide_path : std::filesystem::path()};
+	{
+		columnar::ColumnarWriter writer(wide_path, schema, options);
+		columnar::IngestOptions ingest;
+		ingest.threads = threads;
+		columnar::IngestCsv(data_path, writer, ingest);
+		writer.Finish();
+	}
+	if (narrow) {
+		const Schema narrowed = columnar::NarrowedSchema(columnar::ColumnarReader(wide_path));
+		const bool changed = !std::ranges::equal(narrowed, schema, {}, &ColumnSchema::type, &ColumnSchema::type);
+		if (changed) {
+			columnar::RewriteColumnar(wide_path, out_path, narrowed, options);
+		} else {
+			std::filesystem::rename(wide_path, out_path);
+		}
 	}
-	writer.Finish();
 	return 0;
 }
 
 int ToCsv(const std::filesystem::path &in_path,
           const std::filesystem::path &out_schema_path,
-          const std::filesystem::path &out_data_path) {
-	columnar::ColumnarReader reader(in_path);
-	const Schema &schema = reader.GetSchema();
+          const std::filesystem::path &out_data_path,
+          const std::vector<std::string> &columns,
+          std::size_t threads) {
+	std::vector<std::size_t> projection;
+	Schema schema;
+	{
+		columnar::ColumnarReader reader(in_path);
+		if (columns.empty()) {
+			projection = reader.AllColumns();
+		} else {
+			for (const auto &name: columns) projection.push_back(reader.ColumnIndex(name));
+		}
+		schema = reader.ProjectSchema(projection);
+	}
 
 	{
 		std::ofstream schema_out(out_schema_path);
@@ -63,40 +195,17 @@ int ToCsv(const std::filesystem::path &in_path,
 		SaveSchemaCsv(schema_out, schema);
 	}
 
-	std::ofstream data_out(out_data_path);
+	std::ofstream data_out(out_data_path, std::ios::binary);
 	if (!data_out.is_open()) {
 		throw std::runtime_error("failed to open output data.csv: " + out_data_path.string());
 	}
-	CSVWriter csv_writer(data_out);
-
-	for (std::size_t rg = 0; rg < reader.NumBatches(); ++rg) {
-		Batch batch = reader.ReadBatch(rg);
-		const std::size_t rows = batch.RowCount();
-		const std::size_t cols = batch.ColCount();
-
-		for (std::size_t r = 0; r < rows; ++r) {
-			Row out_row;
-			out_row.resize(cols);
-			for (std::size_t c = 0; c < cols; ++c) {
-				const auto &cs = schema[c];
-				const auto &col = batch.GetColumn(c);
-				switch (cs.type) {
-					case DataType::Int64: {
-						const auto &vec = std::get<std::vector<std::int64_t> >(col);
-						out_row[c] = std::to_string(vec[r]);
-						break;
-					}
-					case DataType::String: {
-						const auto &vec = std::get<std::vector<std::string> >(col);
-						out_row[c] = vec[r];
-						break;
-					}
-				}
-			}
-			if (!csv_writer.WriteNext(out_row)) {
-				throw std::runtime_error("failed to write data.csv");
-			}
-		}
+
+	columnar::CsvExportOptions options;
+	options.threads = threads;
+	columnar::ExportCsv(in_path, projection, data_out, options);
+	data_out.flush();
+	if (!data_out) {
+		throw std::runtime_error("failed to write data.csv");
 	}
 	return 0;
 }
@@ -110,16 +219,72 @@ int main(int argc, char **argv) {
 		}
 
 		const std::string mode = argv[1];
-		if (argc != 5) {
+		const CliArgs args = ParseArgs(argc, argv, 2);
+		const auto &pos = args.positional;
+		if (mode == "query" && pos.size() == 1) {
+			exec::QueryOptions options;
+			options.where = args.Get("--where");
+			options.select = SplitList(args.Get("--select"));
+			options.group_by = SplitList(args.Get("--group-by"));
+			options.threads = args.GetSize("--threads", 1, kMaxThreads);
+			exec::RunQuery(pos[0], options, std::cout);
+			std::cout.flush();
+			if (!std::cout) {
+				throw std::runtime_error("failed to write query output");
+			}
+			return 0;
+		}
+		if (mode == "index" && pos.size() == 2) {
+			const std::size_t column = columnar::ColumnarReader(pos[0]).ColumnIndex(pos[1]);
+			const std::string out = args.Get("--out", columnar::SecondaryIndexPath(pos[0], pos[1]).string());
+			columnar::BuildSecondaryIndex(pos[0], column, out);
+			return 0;
+		}
+		if (mode == "sort" && pos.size() == 2) {
+			exec::SortOptions options;
+			for (const auto &key: SplitList(args.Get("--by"))) options.keys.push_back(exec::ParseSortKey(key));
+			if (options.keys.empty()) throw std::runtime_error("sort needs --by");
+			options.threads = args.GetSize("--threads", 1, kMaxThreads);
+			options.memory_budget = args.GetSize("--memory-mb", options.memory_budget >> 20, kMaxMemoryMb) << 20;
+			options.writer.codec = columnar::ParseCodec(args.Get("--codec", "none"));
+			exec::ExternalSort(pos[0], pos[1], options);
+			return 0;
+		}
+		if (pos.size() != 3) {
 			PrintUsage(argv[0]);
 			return 1;
 		}
 		if (mode == "to-columnar") {
-			return ToColumnar(argv[2], argv[3], argv[4]);
+			columnar::WriterOptions options;
+			options.codec = columnar::ParseCodec(args.Get("--codec", "none"));
+			options.encode_threads = args.GetSize("--threads", 1, kMaxThreads);
+			options.append = args.Has("--append");
+			return ToColumnar(pos[0], pos[1], pos[2], args.GetSize("--threads", 1, kMaxThreads), options,
+			                  SplitList(args.Get("--sort-by")), SplitList(args.Get("--bloom")), args.Has("--narrow"));
+		}
+
+		if (mode == "join") {
+			exec::JoinOptions options;
+			const std::string type = args.Get("--type", "inner");
+			if (type == "left") options.type = exec::JoinType::Left;
+			else if (type != "inner") throw std::runtime_error("option --type expects inner or left, got '" + type + "'");
+			options.left_key = args.Get("--left-key", args.Get("--on"));
+			options.right_key = args.Get("--right-key", args.Get("--on"));
+			if (options.left_key.empty() || options.right_key.empty()) {
+				throw std::runtime_error("join needs --on or both --left-key and --right-key");
+			}
+			options.left_columns = SplitList(args.Get("--left-columns"));
+			options.right_columns = SplitList(args.Get("--right-columns"));
+			options.threads = args.GetSize("--threads", 1, kMaxThreads);
+			options.memory_budget = args.GetSize("--memory-mb", options.memory_budget >> 20, kMaxMemoryMb) << 20;
+			options.writer.codec = columnar::ParseCodec(args.Get("--codec", "none"));
+			exec::HashJoin(pos[0], pos[1], pos[2], options);
+			return 0;
 		}
 
 		if (mode == "to-csv") {
-			return ToCsv(argv[2], argv[3], argv[4]);
+			return ToCsv(pos[0], pos[1], pos[2], SplitList(args.Get("--columns")),
+			             args.GetSize("--threads", 1, kMaxThreads));
 		}
 
 		PrintUsage(argv[0]);
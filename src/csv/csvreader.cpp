@@ -1,60 +1,173 @@
 #include "csvreader.h"
 
+#include <bit>
+#include <cstring>
 #include <istream>
 #include <stdexcept>
 
-CSVReader::CSVReader(std::istream &input, char delimiter)
-	: in_(input), delim_(delimiter) {
+#include "csvscan.h"
+
+namespace {
+	bool IsBlankField(std::string_view f) {
+		for (const char c: f) {
+			if (c != ' ' && c != '\t' && c != '\n' && c != '\r' && c != '\f' && c != '\v') return false;
+		}
+		return true;
+	}
+}
+
+CSVReader::CSVReader(std::istream &input, char delimiter, std::size_t block_size)
+	: in_(input), delim_(delimiter), capacity_(block_size == 0 ? kDefaultBlockSize : block_size) {
+	// The tail padding lets StructuralMask always load a full block; bits past len_ are masked off.
+	buf_.resize(capacity_ + csv::kScanBlock);
+}
+
+// Moves the unfinished row to the front of the buffer and appends the next block after it,
+// doubling the buffer when the row alone fills it.
+bool CSVReader::Refill() {
+	if (row_begin_ > 0) {
+		std::memmove(buf_.data(), buf_.data() + row_begin_, len_ - row_begin_);
+		len_ -= row_begin_;
+		pos_ -= row_begin_;
+		row_begin_ = 0;
+	}
+	if (len_ == capacity_) {
+		capacity_ *= 2;
+		buf_.resize(capacity_ + csv::kScanBlock);
+	}
+
+	in_.read(buf_.data() + len_, static_cast<std::streamsize>(capacity_ - len_));
+	const auto got = static_cast<std::size_t>(in_.gcount());
+	len_ += got;
+	mask_base_ = kNoMask;
+	return got > 0;
+}
+
+int CSVReader::Peek() {
+	if (pos_ == len_ && !Refill()) return EOF;
+	return static_cast<unsigned char>(buf_[pos_]);
+}
+
+std::size_t CSVReader::NextStructural() {
+	std::size_t base = pos_ & ~(csv::kScanBlock - 1);
+	std::uint64_t skip = ~std::uint64_t{0} << (pos_ - base);
+
+	while (base < len_) {
+		if (base != mask_base_) {
+			mask_ = csv::StructuralMask(buf_.data() + base, delim_);
+			const std::size_t valid = len_ - base;
+			if (valid < csv::kScanBlock) {
+				mask_ &= (std::uint64_t{1} << valid) - 1;
+			}
+			mask_base_ = base;
+		}
+
+		const std::uint64_t m = mask_ & skip;
+		if (m != 0) {
+			return base + static_cast<std::size_t>(std::countr_zero(m));
+		}
+		base += csv::kScanBlock;
+		skip = ~std::uint64_t{0};
+	}
+	return len_;
 }
 
-std::optional<std::vector<std::string> > CSVReader::ReadNext() {
-	std::vector<std::string> fields;
-	std::string field;
+std::string_view CSVReader::FinishField(const FieldSpan &span) {
+	char *first = buf_.data() + row_begin_ + span.begin;
+	char *last = buf_.data() + row_begin_ + span.end;
+	if (span.quotes == 0) {
+		return {first, last};
+	}
+	if (span.quotes == 2 && first[0] == '"' && last[-1] == '"') {
+		return {first + 1, last - 1};
+	}
+
+	char *out = first;
+	bool inQuotes = false;
+	for (char *p = first; p < last; ++p) {
+		if (*p != '"') {
+			*out++ = *p;
+		} else if (inQuotes && p + 1 < last && p[1] == '"') {
+			*out++ = '"';
+			++p;
+		} else {
+			inQuotes = !inQuotes;
+		}
+	}
+	return {first, out};
+}
+
+bool CSVReader::ReadNext(RowView &row) {
+	row.fields.clear();
+	spans_.clear();
+	row_begin_ = pos_;
+
+	std::size_t field_begin = 0;
+	std::size_t quotes = 0;
 	bool inQuotes = false;
 	bool started = false;
 
-	while (true) {
-		int ci = in_.get();
+	const auto end_field = [&](std::size_t end) {
+		spans_.push_back(FieldSpan{field_begin, end - row_begin_, quotes});
+		field_begin = end + 1 - row_begin_;
+		quotes = 0;
+	};
 
-		if (ci == EOF) {
-			if (!started) return std::nullopt;
+	while (true) {
+		if (pos_ == len_ && !Refill()) {
+			if (!started) return false;
 			if (inQuotes) {
 				throw std::runtime_error("csv syntax error");
 			}
-			fields.push_back(field);
-			return fields;
+			end_field(pos_);
+			break;
 		}
 
-		char c = static_cast<char>(ci);
 		started = true;
 
+		pos_ = NextStructural();
+		if (pos_ == len_) continue;
+
+		const char c = buf_[pos_++];
+
 		if (inQuotes) {
 			if (c == '"') {
-				if (in_.peek() == '"') {
-					in_.get();
-					field.push_back('"');
+				++quotes;
+				if (Peek() == '"') {
+					++pos_;
+					++quotes;
 				} else {
 					inQuotes = false;
 				}
-			} else {
-				field.push_back(c);
 			}
 		} else {
 			if (c == '"') {
 				inQuotes = true;
+				++quotes;
 			} else if (c == delim_) {
-				fields.push_back(field);
-				field.clear();
+				end_field(pos_ - 1);
 			} else if (c == '\r') {
-				if (in_.peek() == '\n') in_.get();
-				fields.push_back(field);
-				return fields;
-			} else if (c == '\n') {
-				fields.push_back(field);
-				return fields;
+				end_field(pos_ - 1);
+				if (Peek() == '\n') ++pos_;
+				break;
 			} else {
-				field.push_back(c);
+				end_field(pos_ - 1);
+				break;
 			}
 		}
 	}
+
+	// Blank detection stops at the first field with content, which is the first field of
+	// almost every real row.
+	row.blank = true;
+	for (const auto &span: spans_) {
+		row.fields.push_back(FinishField(span));
+		if (row.blank && !IsBlankField(row.fields.back())) row.blank = false;
+	}
+	return true;
+}
+
+std::optional<Row> CSVReader::ReadNext() {
+	if (!ReadNext(scratch_)) return std::nullopt;
+	return Row(scratch_.fields.begin(), scratch_.fields.end());
 }
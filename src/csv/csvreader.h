@@ -1,19 +1,67 @@
 #pragma once
 
+#include <cstddef>
+#include <cstdint>
 #include <iosfwd>
 #include <optional>
 #include <string>
+#include <string_view>
 #include <vector>
 
 using Row = std::vector<std::string>;
 
+// Fields of the row last read by CSVReader::ReadNext(RowView&). The views point into
+// the reader's buffer and stay valid until the next ReadNext call on the same reader.
+// Reuse one RowView across calls so the field array is not reallocated per row.
+struct RowView {
+	std::vector<std::string_view> fields;
+	// Set by the tokenizer when every field is empty or whitespace-only.
+	bool blank = false;
+
+	std::size_t size() const { return fields.size(); }
+	std::string_view operator[](std::size_t i) const { return fields[i]; }
+};
+
 class CSVReader {
 public:
-	explicit CSVReader(std::istream& input, char delimiter = ',');
+	static constexpr std::size_t kDefaultBlockSize = std::size_t{1} << 20;
+
+	// Input is pulled in blocks of block_size bytes, so the stream is read ahead
+	// of the last row returned by ReadNext(). The buffer grows if one row does not fit.
+	explicit CSVReader(std::istream& input, char delimiter = ',', std::size_t block_size = kDefaultBlockSize);
+
+	// Returns false at end of input. Fields are unescaped in place, and only when
+	// they contain quotes, so no per-row allocation happens once the buffers are warm.
+	bool ReadNext(RowView& row);
 
 	std::optional<Row> ReadNext();
 
 private:
+	static constexpr std::size_t kNoMask = static_cast<std::size_t>(-1);
+
+	// Field bounds relative to row_begin_, so they survive buffer compaction.
+	struct FieldSpan {
+		std::size_t begin;
+		std::size_t end;
+		std::size_t quotes;
+	};
+
 	std::istream& in_;
 	char delim_;
+	std::size_t capacity_;
+	std::vector<char> buf_;
+	std::size_t pos_ = 0;
+	std::size_t len_ = 0;
+	std::size_t row_begin_ = 0;
+
+	std::size_t mask_base_ = kNoMask;
+	std::uint64_t mask_ = 0;
+
+	std::vector<FieldSpan> spans_;
+	RowView scratch_;
+
+	bool Refill();
+	int Peek();
+	std::size_t NextStructural();
+	std::string_view FinishField(const FieldSpan& span);
 };
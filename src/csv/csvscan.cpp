@@ -0,0 +1,86 @@
+#include "csvscan.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define CSV_SCAN_X86 1
+#include <immintrin.h>
+#endif
+
+
+namespace {
+	std::uint64_t StructuralMaskScalar(const char *p, char delimiter) {
+		std::uint64_t mask = 0;
+		for (std::size_t i = 0; i < csv::kScanBlock; ++i) {
+			const char c = p[i];
+			if (c == '"' || c == delimiter || c == '\n' || c == '\r') {
+				mask |= std::uint64_t{1} << i;
+			}
+		}
+		return mask;
+	}
+
+#ifdef CSV_SCAN_X86
+	std::uint64_t StructuralMaskSse2(const char *p, char delimiter) {
+		const __m128i quote = _mm_set1_epi8('"');
+		const __m128i delim = _mm_set1_epi8(delimiter);
+		const __m128i lf = _mm_set1_epi8('\n');
+		const __m128i cr = _mm_set1_epi8('\r');
+
+		std::uint64_t mask = 0;
+		for (std::size_t i = 0; i < csv::kScanBlock; i += 16) {
+			const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p + i));
+			const __m128i hit = _mm_or_si128(
+				_mm_or_si128(_mm_cmpeq_epi8(v, quote), _mm_cmpeq_epi8(v, delim)),
+				_mm_or_si128(_mm_cmpeq_epi8(v, lf), _mm_cmpeq_epi8(v, cr)));
+			mask |= static_cast<std::uint64_t>(static_cast<std::uint16_t>(_mm_movemask_epi8(hit))) << i;
+		}
+		return mask;
+	}
+
+	__attribute__((target("avx2")))
+	std::uint32_t StructuralMaskAvx2Half(const char *p, char delimiter) {
+		const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p));
+		const __m256i hit = _mm256_or_si256(
+			_mm256_or_si256(_mm256_cmpeq_epi8(v, _mm256_set1_epi8('"')), _mm256_cmpeq_epi8(v, _mm256_set1_epi8(delimiter))),
+			_mm256_or_si256(_mm256_cmpeq_epi8(v, _mm256_set1_epi8('\n')), _mm256_cmpeq_epi8(v, _mm256_set1_epi8('\r'))));
+		return static_cast<std::uint32_t>(_mm256_movemask_epi8(hit));
+	}
+
+	__attribute__((target("avx2")))
+	std::uint64_t StructuralMaskAvx2(const char *p, char delimiter) {
+		return static_cast<std::uint64_t>(StructuralMaskAvx2Half(p, delimiter)) |
+		       (static_cast<std::uint64_t>(StructuralMaskAvx2Half(p + 32, delimiter)) << 32);
+	}
+#endif
+
+	using MaskFn = std::uint64_t (*)(const char *, char);
+
+	struct Kernel {
+		MaskFn fn;
+		const char *name;
+	};
+
+	Kernel SelectKernel() {
+#ifdef CSV_SCAN_X86
+		__builtin_cpu_init();
+		if (__builtin_cpu_supports("avx2")) return {StructuralMaskAvx2, "avx2"};
+		if (__builtin_cpu_supports("sse2")) return {StructuralMaskSse2, "sse2"};
+#endif
+		return {StructuralMaskScalar, "scalar"};
+	}
+
+	const Kernel &ActiveKernel() {
+		static const Kernel kernel = SelectKernel();
+		return kernel;
+	}
+}
+
+
+namespace csv {
+	std::uint64_t StructuralMask(const char *p, char delimiter) {
+		return ActiveKernel().fn(p, delimiter);
+	}
+
+	const char *StructuralMaskKernel() {
+		return ActiveKernel().name;
+	}
+}
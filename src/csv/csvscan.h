@@ -0,0 +1,16 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace csv {
+	inline constexpr std::size_t kScanBlock = 64;
+
+	// Structural index of one 64-byte block: bit i is set when p[i] is '"', '\r', '\n'
+	// or the delimiter. p must point to at least kScanBlock readable bytes.
+	// Dispatches at runtime to AVX2 / SSE2 kernels, with a scalar fallback.
+	std::uint64_t StructuralMask(const char *p, char delimiter);
+
+	// Name of the kernel selected on this CPU ("avx2", "sse2" or "scalar").
+	const char *StructuralMaskKernel();
+}
@@ -1,16 +1,26 @@
 #include "csvwriter.h"
 
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
 #include <ostream>
 
+#include "csvscan.h"
+
 CSVWriter::CSVWriter(std::ostream &output, char delimiter)
 	: out_(output), delim_(delimiter) {
 }
 
 
-bool CSVWriter::NeedsQuoting(const std::string &s, char delimiter) {
-	for (char c: s) {
-		if (c == '"' || c == delimiter || c == '\n' || c == '\r') {
-			return true;
+bool CSVWriter::NeedsQuoting(std::string_view s, char delimiter) {
+	char tail[csv::kScanBlock];
+	for (std::size_t base = 0; base < s.size(); base += csv::kScanBlock) {
+		const std::size_t len = std::min(csv::kScanBlock, s.size() - base);
+		if (len == csv::kScanBlock) {
+			if (csv::StructuralMask(s.data() + base, delimiter) != 0) return true;
+		} else {
+			std::memcpy(tail, s.data() + base, len);
+			if ((csv::StructuralMask(tail, delimiter) & ((std::uint64_t{1} << len) - 1)) != 0) return true;
 		}
 	}
 	return false;
@@ -47,3 +57,23 @@ bool CSVWriter::WriteNext(const std::vector<std::string> &fields) {
 	out_ << lineEnding_;
 	return static_cast<bool>(out_);
 }
+
+void CSVWriter::AppendQuoted(std::string_view s, std::string &out) {
+	out.push_back('"');
+	std::size_t begin = 0;
+	for (std::size_t q = s.find('"'); q != std::string_view::npos; q = s.find('"', q + 1)) {
+		out.append(s.substr(begin, q + 1 - begin));
+		out.push_back('"');
+		begin = q + 1;
+	}
+	out.append(s.substr(begin));
+	out.push_back('"');
+}
+
+bool CSVWriter::FlushBuffer() {
+	if (!buf_.empty()) {
+		out_.write(buf_.data(), static_cast<std::streamsize>(buf_.size()));
+		buf_.clear();
+	}
+	return static_cast<bool>(out_);
+}
@@ -2,20 +2,36 @@
 
 #include <iosfwd>
 #include <string>
+#include <string_view>
 #include <vector>
 
+class Batch;
+
 class CSVWriter {
 public:
 	explicit CSVWriter(std::ostream &output, char delimiter = ',');
 
 	bool WriteNext(const std::vector<std::string> &fields);
 
-private:
-	static bool NeedsQuoting(const std::string &s, char delimiter);
+	// Writes every row of `batch`, byte-identical to WriteNext on the same values, through
+	// an internal buffer that goes out in large writes; nothing is left buffered on return.
+	// Defined in the batch library (csv_batch_writer.cpp), which owns Batch.
+	bool WriteBatch(const Batch &batch);
+
+	// Whether `s` holds a character the tokenizer treats as structural (csv::StructuralMask):
+	// a quote, CR, LF or the delimiter. Every writer quotes exactly these fields.
+	static bool NeedsQuoting(std::string_view s, char delimiter);
 
+	// Appends `s` to `out` as a quoted field with doubled quotes.
+	static void AppendQuoted(std::string_view s, std::string &out);
+
+private:
 	static std::string EscapeField(const std::string &s);
 
+	bool FlushBuffer();
+
 	std::ostream &out_;
 	char delim_;
 	std::string lineEnding_ = "\n";
+	std::string buf_;
 };
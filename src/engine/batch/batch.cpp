@@ -1,31 +1,36 @@
 #include "batch.h"
 
+#include <algorithm>
 #include <stdexcept>
 #include <string>
 #include <string_view>
+#include <type_traits>
+
+
+namespace {
+	[[noreturn]] void BadValue(std::string_view field, std::size_t line_no, const std::string &name, DataType type) {
+		field = utils::Trim(field);
+		throw std::runtime_error(
+			"CSV parse error at line " + std::to_string(line_no) + ": column '" + name + "' expects " + ToString(type) +
+			", got " + (field.empty() ? "empty value" : "'" + std::string(field) + "'"));
+	}
+}
 
 
 Batch::Batch(Schema schema)
 	: schema_(std::move(schema)) {
 	columns_.reserve(schema_.size());
 	for (const auto &col: schema_) {
-		switch (col.type) {
-			case DataType::Int64:
-				columns_.emplace_back(std::vector<int64_t>{});
-				break;
-			case DataType::String:
-				columns_.emplace_back(std::vector<std::string>{});
-				break;
-			default:
-				throw std::runtime_error("Batch: unsupported DataType in schema");
-		}
+		columns_.push_back(utils::MakeColumn(col.type));
 	}
+	validity_.resize(schema_.size());
 }
 
 void Batch::Clear() {
 	for (auto &c: columns_) {
 		std::visit([](auto &vec) { vec.clear(); }, c);
 	}
+	for (auto &v: validity_) v.clear();
 	row_count_ = 0;
 }
 
@@ -35,47 +40,121 @@ void Batch::Reserve(std::size_t rows) {
 	}
 }
 
-void Batch::AppendRow(const Row &row, std::size_t line_no) {
-	if (row.size() != schema_.size()) {
-		throw std::runtime_error("CSV parse error");
+void Batch::AppendRow(const RowView &row, std::size_t line_no) {
+	BatchAppender(*this).AppendRow(row, line_no);
+}
+
+void Batch::AppendRows(const Batch &src, std::size_t begin, std::size_t count) {
+	if (src.ColCount() != columns_.size() || begin + count > src.RowCount()) {
+		throw std::runtime_error("Batch: AppendRows out of range");
 	}
 
-	for (std::size_t i = 0; i < row.size(); ++i) {
-		const auto &col_schema = schema_[i];
-		const std::string &field = row[i];
+	for (std::size_t i = 0; i < columns_.size(); ++i) {
+		std::visit([&](auto &dst) {
+			using Vec = std::decay_t<decltype(dst)>;
+			const auto &from = std::get<Vec>(src.columns_[i]);
+			if constexpr (std::is_same_v<Vec, StringColumn>) {
+				dst.Append(from, begin, count);
+			} else {
+				dst.insert(dst.end(), from.begin() + begin, from.begin() + begin + count);
+			}
+		}, columns_[i]);
+
+		const Validity &from = src.validity_[i];
+		Validity &to = validity_[i];
+		if (from.empty() && to.empty()) continue;
+		if (to.empty()) to = utils::AllSet(row_count_);
+		utils::AppendBits(to, row_count_, from.empty() ? nullptr : from.data(), begin, count);
+	}
+
+	row_count_ += count;
+}
+
+void Batch::SetNull(std::size_t col, std::size_t row) {
+	if (row >= row_count_) throw std::runtime_error("Batch: SetNull out of range");
+	Validity &v = validity_[col];
+	if (v.empty()) v = utils::AllSet(row_count_);
+	utils::ClearBit(v.data(), row);
+}
 
-		switch (col_schema.type) {
+
+BatchAppender::BatchAppender(Batch &batch)
+	: batch_(batch) {
+	const Schema &schema = batch_.GetSchema();
+	sinks_.resize(schema.size());
+	for (std::size_t i = 0; i < schema.size(); ++i) {
+		auto &column = batch_.GetColumn(i);
+		sinks_[i].name = &schema[i].name;
+		sinks_[i].type = schema[i].type;
+		sinks_[i].column = std::visit([](auto &vec) -> void * { return &vec; }, column);
+		if (schema[i].nullable) sinks_[i].validity = &batch_.GetValidity(i);
+	}
+}
+
+void BatchAppender::AppendRow(const RowView &row, std::size_t line_no) {
+	if (row.size() != sinks_.size()) {
+		throw std::runtime_error("CSV parse error");
+	}
+
+	const std::size_t row_no = batch_.RowCount();
+	for (std::size_t i = 0; i < sinks_.size(); ++i) {
+		const Sink &sink = sinks_[i];
+		if (sink.validity != nullptr) {
+			// Whitespace-only integer fields are null too, rather than unparseable.
+			const bool null = sink.type == DataType::String ? row[i].empty() : utils::Trim(row[i]).empty();
+			// The bitmap is materialized at the first null; until then every row is valid.
+			if (null || !sink.validity->empty()) {
+				if (sink.validity->empty()) *sink.validity = utils::AllSet(row_no);
+				utils::AppendBit(*sink.validity, row_no, !null);
+			}
+			if (null) {
+				AppendNull(sink);
+				continue;
+			}
+		}
+		switch (sink.type) {
 			case DataType::Int64: {
-				auto &vec = std::get<std::vector<int64_t> >(columns_[i]);
-				vec.push_back(utils::ParseInt64(field, line_no, col_schema.name));
+				int64_t v = 0;
+				if (!utils::TryParseInt64Digits(row[i], v)) {
+					v = utils::ParseInt64Slow(row[i], line_no, *sink.name);
+				}
+				static_cast<std::vector<int64_t> *>(sink.column)->push_back(v);
 				break;
 			}
-			case DataType::String: {
-				auto &vec = std::get<std::vector<std::string> >(columns_[i]);
-				vec.push_back(field);
+			case DataType::String:
+				static_cast<StringColumn *>(sink.column)->push_back(row[i]);
 				break;
+			default: {
+				int64_t v = 0;
+				if (!utils::ParseIntegerValue(sink.type, row[i], v)) BadValue(row[i], line_no, *sink.name, sink.type);
+				utils::VisitIntegerType(sink.type, [&](auto t) {
+					static_cast<std::vector<decltype(t)> *>(sink.column)->push_back(static_cast<decltype(t)>(v));
+				});
 			}
-			default:
-				throw std::runtime_error("unsupported DataType in schema");
 		}
 	}
 
-	++row_count_;
+	batch_.SetRowCount(row_no + 1);
 }
 
-
-CsvBatchReader::CsvBatchReader(std::istream &in, const Schema &schema, std::size_t batch_rows, char delimiter)
-	: reader_(in, delimiter), schema_(schema), batch_rows_(batch_rows) {
-	if (schema_.empty()) {
-		throw std::runtime_error("CsvBatchReader: schema is empty");
+void BatchAppender::AppendNull(const Sink &sink) {
+	if (sink.type == DataType::String) {
+		static_cast<StringColumn *>(sink.column)->push_back(std::string_view());
+		return;
 	}
+	utils::VisitIntegerType(sink.type, [&](auto t) {
+		static_cast<std::vector<decltype(t)> *>(sink.column)->push_back(0);
+	});
 }
 
-bool CsvBatchReader::IsAllEmpty(const Row &row) {
-	for (const auto &f: row) {
-		if (!utils::Trim(f).empty()) return false;
+
+CsvBatchReader::CsvBatchReader(std::istream &in, const Schema &schema, std::size_t batch_rows, char delimiter,
+                               std::size_t first_line)
+	: reader_(in, delimiter), schema_(schema), batch_rows_(batch_rows), line_no_(first_line) {
+	if (schema_.empty()) {
+		throw std::runtime_error("CsvBatchReader: schema is empty");
 	}
-	return true;
+	keep_blank_ = std::ranges::all_of(schema_, &ColumnSchema::nullable);
 }
 
 std::optional<Batch> CsvBatchReader::ReadNext() {
@@ -85,22 +164,21 @@ std::optional<Batch> CsvBatchReader::ReadNext() {
 
 	Batch batch(schema_);
 	batch.Reserve(batch_rows_);
+	BatchAppender appender(batch);
 
 	while (batch.RowCount() < batch_rows_) {
-		auto row_opt = reader_.ReadNext();
-		if (!row_opt.has_value()) {
+		if (!reader_.ReadNext(row_)) {
 			eof_ = true;
 			break;
 		}
 
 		++line_no_;
-		Row &row = *row_opt;
 
-		if (IsAllEmpty(row)) {
+		if (row_.blank && !(keep_blank_ && row_.size() == schema_.size())) {
 			continue;
 		}
 
-		batch.AppendRow(row, line_no_);
+		appender.AppendRow(row_, line_no_);
 	}
 
 	if (batch.RowCount() == 0 && eof_) {
@@ -10,12 +10,16 @@
 
 #include "csvreader.h"
 #include "schema.h"
+#include "utils/bitmap.h"
 #include "utils/utils.h"
 
 
 class Batch {
 public:
 	using Column = DataVector;
+	// Set bit = the row is not null; see utils/bitmap.h. Either empty, when the column has
+	// no nulls, or BitmapWords(RowCount()) words. The values of null rows are unspecified.
+	using Validity = std::vector<std::uint64_t>;
 
 	explicit Batch(Schema schema);
 
@@ -23,7 +27,10 @@ public:
 
 	void Reserve(std::size_t rows);
 
-	void AppendRow(const Row &row, std::size_t line_no);
+	void AppendRow(const RowView &row, std::size_t line_no);
+
+	// Appends rows [begin, begin + count) of a batch with the same schema.
+	void AppendRows(const Batch &src, std::size_t begin, std::size_t count);
 
 	std::size_t RowCount() const { return row_count_; }
 	std::size_t ColCount() const { return columns_.size(); }
@@ -36,19 +43,61 @@ public:
 
 	void SetRowCount(std::size_t n) { row_count_ = n; }
 
+	const Validity &GetValidity(std::size_t i) const { return validity_[i]; }
+	Validity &GetValidity(std::size_t i) { return validity_[i]; }
+
+	bool IsNull(std::size_t col, std::size_t row) const {
+		return !validity_[col].empty() && !utils::GetBit(validity_[col].data(), row);
+	}
+	std::size_t NullCount(std::size_t col) const {
+		return validity_[col].empty() ? 0 : row_count_ - utils::CountSet(validity_[col]);
+	}
+	// Marks a row below RowCount() null, creating the column's bitmap if it has none.
+	void SetNull(std::size_t col, std::size_t row);
+
 private:
 	Schema schema_;
 	std::vector<Column> columns_;
+	std::vector<Validity> validity_;
 	std::size_t row_count_ = 0;
 };
 
 
+// Appends CSV rows to a batch through column pointers resolved once up front, so each
+// field goes straight into its typed column without a per-field variant dispatch.
+// The batch must outlive the appender and keep its column count.
+class BatchAppender {
+public:
+	explicit BatchAppender(Batch &batch);
+
+	void AppendRow(const RowView &row, std::size_t line_no);
+
+private:
+	struct Sink {
+		DataType type = DataType::Int64;
+		// The column's storage for `type`.
+		void *column = nullptr;
+		// Nullable columns only: empty fields are nulls.
+		Batch::Validity *validity = nullptr;
+		const std::string *name = nullptr;
+	};
+
+	Batch &batch_;
+	std::vector<Sink> sinks_;
+
+	static void AppendNull(const Sink &sink);
+};
+
+
 class CsvBatchReader {
 public:
+	// first_line offsets the line numbers reported in parse errors, for readers that
+	// start in the middle of a file.
 	CsvBatchReader(std::istream &in,
 	               const Schema &schema,
 	               std::size_t batch_rows = (1 << 16),
-	               char delimiter = ',');
+	               char delimiter = ',',
+	               std::size_t first_line = 0);
 
 	std::optional<Batch> ReadNext();
 
@@ -57,10 +106,12 @@ public:
 
 private:
 	CSVReader reader_;
+	RowView row_;
 	const Schema &schema_;
 	std::size_t batch_rows_;
 	std::size_t line_no_ = 0;
 	bool eof_ = false;
-
-	static bool IsAllEmpty(const Row &row);
+	// Blank rows are skipped, except full-width ones when every column is nullable: those
+	// are rows of nulls.
+	bool keep_blank_ = false;
 };
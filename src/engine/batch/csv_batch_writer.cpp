@@ -0,0 +1,98 @@
+#include "csvwriter.h"
+
+#include <algorithm>
+#include <bit>
+#include <charconv>
+#include <cstring>
+#include <ostream>
+#include <vector>
+
+#include "batch.h"
+#include "csvscan.h"
+
+
+namespace {
+	constexpr std::size_t kFlushBytes = std::size_t{1} << 20;
+
+	// Marks the values of `col` that contain a quote, CR, LF or the delimiter. The whole data
+	// buffer is scanned in 64-byte blocks, so the per-value cost is only paid for the hits.
+	std::vector<bool> QuotedValues(const StringColumn &col, char delimiter) {
+		std::vector<bool> quoted(col.size(), false);
+		const std::string &data = col.Data();
+		const auto &offsets = col.Offsets();
+
+		std::size_t row = 0;
+		char tail[csv::kScanBlock];
+		for (std::size_t base = 0; base < data.size(); base += csv::kScanBlock) {
+			const std::size_t len = std::min(csv::kScanBlock, data.size() - base);
+			std::uint64_t mask;
+			if (len == csv::kScanBlock) {
+				mask = csv::StructuralMask(data.data() + base, delimiter);
+			} else {
+				std::memcpy(tail, data.data() + base, len);
+				mask = csv::StructuralMask(tail, delimiter) & ((std::uint64_t{1} << len) - 1);
+			}
+			while (mask != 0) {
+				const std::size_t pos = base + static_cast<std::size_t>(std::countr_zero(mask));
+				mask &= mask - 1;
+				while (offsets[row + 1] <= pos) ++row;
+				quoted[row] = true;
+			}
+		}
+		return quoted;
+	}
+}
+
+
+bool CSVWriter::WriteBatch(const Batch &batch) {
+	if (!out_) return false;
+
+	struct Source {
+		const std::int64_t *ints = nullptr;
+		// Integer types other than Int64, widened.
+		DataType type = DataType::Int64;
+		std::vector<std::int64_t> wide;
+		const StringColumn *strings = nullptr;
+		std::vector<bool> quoted;
+		// Validity bitmap; null when the column has no nulls.
+		const std::uint64_t *valid = nullptr;
+	};
+	std::vector<Source> sources(batch.ColCount());
+	for (std::size_t c = 0; c < sources.size(); ++c) {
+		const auto &col = batch.GetColumn(c);
+		sources[c].type = batch.GetSchema()[c].type;
+		if (!batch.GetValidity(c).empty()) sources[c].valid = batch.GetValidity(c).data();
+		if (const auto *strings = std::get_if<StringColumn>(&col)) {
+			sources[c].strings = strings;
+			sources[c].quoted = QuotedValues(*strings, delim_);
+		} else {
+			sources[c].ints = utils::WidenInts(col, sources[c].wide).data();
+		}
+	}
+
+	buf_.reserve(kFlushBytes + kFlushBytes / 4);
+	for (std::size_t r = 0; r < batch.RowCount(); ++r) {
+		for (std::size_t c = 0; c < sources.size(); ++c) {
+			if (c != 0) buf_.push_back(delim_);
+
+			const Source &src = sources[c];
+			if (src.valid && !utils::GetBit(src.valid, r)) {
+				// Nulls are empty fields.
+			} else if (src.ints && src.type == DataType::Int64) {
+				char num[24];
+				const auto res = std::to_chars(num, num + sizeof(num), src.ints[r]);
+				buf_.append(num, res.ptr);
+			} else if (src.ints) {
+				utils::AppendIntegerValue(buf_, src.type, src.ints[r]);
+			} else if (src.quoted[r]) {
+				AppendQuoted((*src.strings)[r], buf_);
+			} else {
+				buf_.append((*src.strings)[r]);
+			}
+		}
+		buf_.append(lineEnding_);
+
+		if (buf_.size() >= kFlushBytes && !FlushBuffer()) return false;
+	}
+	return FlushBuffer();
+}
@@ -0,0 +1,209 @@
+#include "parallel_csv.h"
+
+#include <algorithm>
+#include <bit>
+#include <fstream>
+#include <span>
+#include <spanstream>
+#include <stdexcept>
+#include <string>
+
+#include "csvscan.h"
+#include "utils/utils.h"
+
+
+namespace {
+	constexpr std::uint64_t kNoNewline = static_cast<std::uint64_t>(-1);
+	constexpr std::size_t kScanBuffer = std::size_t{1} << 20;
+
+	struct RangeScan {
+		bool odd_quotes = false;
+		// First '\n' reached after an even / odd number of quotes in the range.
+		std::uint64_t newline_even = kNoNewline;
+		std::uint64_t newline_odd = kNoNewline;
+	};
+
+	RangeScan ScanRange(const std::filesystem::path &path, std::uint64_t begin, std::uint64_t end) {
+		std::ifstream in(path, std::ios::binary);
+		if (!in.is_open()) {
+			throw std::runtime_error("failed to open data.csv: " + path.string());
+		}
+		utils::Seek(in, begin);
+
+		RangeScan scan;
+		std::vector<char> buf(kScanBuffer + csv::kScanBlock);
+		std::uint64_t pos = begin;
+		while (pos < end) {
+			const auto want = static_cast<std::size_t>(std::min<std::uint64_t>(kScanBuffer, end - pos));
+			in.read(buf.data(), static_cast<std::streamsize>(want));
+			if (static_cast<std::size_t>(in.gcount()) != want) {
+				throw std::runtime_error("failed to read data.csv");
+			}
+
+			for (std::size_t base = 0; base < want; base += csv::kScanBlock) {
+				// Passing '"' as the delimiter limits the mask to quotes, CR and LF.
+				std::uint64_t mask = csv::StructuralMask(buf.data() + base, '"');
+				if (want - base < csv::kScanBlock) {
+					mask &= (std::uint64_t{1} << (want - base)) - 1;
+				}
+				while (mask != 0) {
+					const std::size_t i = base + static_cast<std::size_t>(std::countr_zero(mask));
+					mask &= mask - 1;
+					if (buf[i] == '"') {
+						scan.odd_quotes = !scan.odd_quotes;
+					} else if (buf[i] == '\n') {
+						auto &slot = scan.odd_quotes ? scan.newline_odd : scan.newline_even;
+						if (slot == kNoNewline) slot = pos + i;
+					}
+				}
+			}
+			pos += want;
+		}
+		return scan;
+	}
+}
+
+
+ParallelCsvBatchReader::ParallelCsvBatchReader(const std::filesystem::path &path,
+                                               const Schema &schema,
+                                               std::size_t threads,
+                                               std::size_t batch_rows,
+                                               char delimiter,
+                                               std::size_t segment_bytes)
+	: path_(path), schema_(schema), batch_rows_(batch_rows), delim_(delimiter),
+	  pool_(std::make_unique<utils::ThreadPool>(threads)) {
+	if (schema_.empty()) {
+		throw std::runtime_error("ParallelCsvBatchReader: schema is empty");
+	}
+	if (batch_rows_ == 0) {
+		throw std::runtime_error("ParallelCsvBatchReader: batch_rows must be positive");
+	}
+
+	std::error_code ec;
+	const std::uint64_t file_size = std::filesystem::file_size(path_, ec);
+	if (ec) {
+		throw std::runtime_error("failed to open data.csv: " + path_.string());
+	}
+	FindSegmentBounds(file_size, segment_bytes);
+	Schedule();
+}
+
+void ParallelCsvBatchReader::FindSegmentBounds(std::uint64_t file_size, std::size_t segment_bytes) {
+	if (segment_bytes == 0) {
+		segment_bytes = std::clamp<std::uint64_t>(file_size / (pool_->Size() * 4),
+		                                          std::uint64_t{1} << 20, std::uint64_t{32} << 20);
+	}
+
+	const std::uint64_t nranges = std::max<std::uint64_t>(1, (file_size + segment_bytes - 1) / segment_bytes);
+	std::vector<std::future<RangeScan> > scans;
+	scans.reserve(nranges);
+	for (std::uint64_t k = 0; k < nranges; ++k) {
+		const std::uint64_t begin = k * segment_bytes;
+		const std::uint64_t end = std::min<std::uint64_t>(file_size, begin + segment_bytes);
+		scans.push_back(pool_->Submit([this, begin, end] { return ScanRange(path_, begin, end); }));
+	}
+
+	bounds_.assign(1, 0);
+	bool in_quotes = false;
+	for (std::uint64_t k = 0; k < nranges; ++k) {
+		const RangeScan scan = scans[k].get();
+		if (k > 0) {
+			// A newline outside quotes always ends a row, so the segment boundary goes right after it.
+			const std::uint64_t nl = in_quotes ? scan.newline_odd : scan.newline_even;
+			if (nl != kNoNewline && nl + 1 < file_size && nl + 1 > bounds_.back()) {
+				bounds_.push_back(nl + 1);
+			}
+		}
+		in_quotes = in_quotes != scan.odd_quotes;
+	}
+	bounds_.push_back(file_size);
+}
+
+ParallelCsvBatchReader::Segment ParallelCsvBatchReader::ParseSegment(std::size_t idx, std::size_t first_line) const {
+	Segment seg;
+	try {
+		const std::uint64_t begin = bounds_[idx];
+		std::string bytes(static_cast<std::size_t>(bounds_[idx + 1] - begin), '\0');
+
+		std::ifstream in(path_, std::ios::binary);
+		if (!in.is_open()) {
+			throw std::runtime_error("failed to open data.csv: " + path_.string());
+		}
+		utils::Seek(in, begin);
+		in.read(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+		if (static_cast<std::size_t>(in.gcount()) != bytes.size()) {
+			throw std::runtime_error("failed to read data.csv");
+		}
+
+		std::ispanstream stream(std::span<char>(bytes.data(), bytes.size()));
+		CsvBatchReader reader(stream, schema_, batch_rows_, delim_, first_line);
+		while (auto batch = reader.ReadNext()) {
+			seg.batches.push_back(std::move(*batch));
+		}
+		seg.lines = reader.CurrentLine() - first_line;
+	} catch (...) {
+		seg.error = std::current_exception();
+	}
+	return seg;
+}
+
+void ParallelCsvBatchReader::Schedule() {
+	const std::size_t window = 2 * pool_->Size();
+	while (inflight_.size() < window && next_segment_ < NumSegments()) {
+		const std::size_t idx = next_segment_++;
+		inflight_.push_back(pool_->Submit([this, idx] { return ParseSegment(idx, 0); }));
+	}
+}
+
+bool ParallelCsvBatchReader::NextSegment() {
+	Schedule();
+	if (inflight_.empty()) return false;
+
+	current_index_ = next_segment_ - inflight_.size();
+	current_ = inflight_.front().get();
+	inflight_.pop_front();
+	batch_pos_ = 0;
+	row_pos_ = 0;
+
+	if (current_.error) {
+		// Workers do not know how many lines precede their segment; parse it again here so
+		// the error carries the same line number as the single-threaded reader would report.
+		Segment again = ParseSegment(current_index_, lines_before_);
+		std::rethrow_exception(again.error ? again.error : current_.error);
+	}
+	lines_before_ += current_.lines;
+
+	Schedule();
+	return true;
+}
+
+std::optional<Batch> ParallelCsvBatchReader::ReadNext() {
+	std::optional<Batch> out;
+	while (true) {
+		while (batch_pos_ < current_.batches.size()) {
+			Batch &src = current_.batches[batch_pos_];
+			const std::size_t avail = src.RowCount() - row_pos_;
+
+			if (!out.has_value() && row_pos_ == 0 && avail == batch_rows_) {
+				out = std::move(src);
+				++batch_pos_;
+				return out;
+			}
+			if (!out.has_value()) {
+				out.emplace(schema_);
+				out->Reserve(batch_rows_);
+			}
+
+			const std::size_t take = std::min(avail, batch_rows_ - out->RowCount());
+			out->AppendRows(src, row_pos_, take);
+			row_pos_ += take;
+			if (row_pos_ == src.RowCount()) {
+				++batch_pos_;
+				row_pos_ = 0;
+			}
+			if (out->RowCount() == batch_rows_) return out;
+		}
+		if (!NextSegment()) break;
+	}
+	return out;
+}
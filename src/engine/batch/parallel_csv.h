@@ -0,0 +1,68 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <filesystem>
+#include <future>
+#include <memory>
+#include <optional>
+#include <vector>
+
+#include "batch.h"
+#include "schema.h"
+#include "utils/thread_pool.h"
+
+
+// Parses a CSV file on several threads and yields the same batches, in the same order,
+// as CsvBatchReader over the whole file.
+//
+// The file is cut into byte segments at row boundaries: every segment's quote parity and
+// first newline under either starting quote state are found in parallel, then a prefix XOR
+// of the parities tells which newline is outside quotes. Each segment is parsed into batches
+// on a worker and the rows are re-chunked into batch_rows-sized batches in file order.
+class ParallelCsvBatchReader {
+public:
+	// segment_bytes == 0 picks a size from the file size and thread count.
+	ParallelCsvBatchReader(const std::filesystem::path &path,
+	                       const Schema &schema,
+	                       std::size_t threads,
+	                       std::size_t batch_rows = (1 << 16),
+	                       char delimiter = ',',
+	                       std::size_t segment_bytes = 0);
+
+	std::optional<Batch> ReadNext();
+
+	std::size_t NumSegments() const { return bounds_.size() - 1; }
+	std::size_t BatchRows() const { return batch_rows_; }
+
+private:
+	struct Segment {
+		std::vector<Batch> batches;
+		std::size_t lines = 0;
+		std::exception_ptr error;
+	};
+
+	std::filesystem::path path_;
+	const Schema &schema_;
+	std::size_t batch_rows_;
+	char delim_;
+	std::vector<std::uint64_t> bounds_;
+
+	std::deque<std::future<Segment> > inflight_;
+	std::size_t next_segment_ = 0;
+	std::size_t lines_before_ = 0;
+
+	Segment current_;
+	std::size_t current_index_ = 0;
+	std::size_t batch_pos_ = 0;
+	std::size_t row_pos_ = 0;
+
+	// Declared last so the workers are joined before the state they read is destroyed.
+	std::unique_ptr<utils::ThreadPool> pool_;
+
+	void FindSegmentBounds(std::uint64_t file_size, std::size_t segment_bytes);
+	Segment ParseSegment(std::size_t idx, std::size_t first_line) const;
+	void Schedule();
+	bool NextSegment();
+};
@@ -0,0 +1,71 @@
+#include "batch_view.h"
+
+#include <cstring>
+#include <stdexcept>
+#include <type_traits>
+
+#include "batch.h"
+
+
+namespace columnar {
+	StringColumn StringChunkView::ToColumn() const {
+		StringColumn col;
+		auto &offsets = col.MutableOffsets();
+		offsets.resize(lens_.size() + 1);
+		for (std::size_t i = 0; i < lens_.size(); ++i) {
+			offsets[i + 1] = offsets[i] + lens_[i];
+		}
+		if (offsets.back() != data_.size()) {
+			throw std::runtime_error("columnar: corrupted string chunk");
+		}
+		col.MutableData().assign(data_);
+		return col;
+	}
+
+	char *BatchView::Allocate(std::size_t bytes) {
+		const std::size_t words = (bytes + sizeof(std::uint64_t) - 1) / sizeof(std::uint64_t);
+		owned_.push_back(std::make_unique_for_overwrite<std::uint64_t[]>(words == 0 ? 1 : words));
+		return reinterpret_cast<char *>(owned_.back().get());
+	}
+
+	std::string_view BatchView::Aligned(std::string_view bytes, std::size_t alignment) {
+		if (reinterpret_cast<std::uintptr_t>(bytes.data()) % alignment == 0) {
+			return bytes;
+		}
+		char *copy = Allocate(bytes.size());
+		if (!bytes.empty()) std::memcpy(copy, bytes.data(), bytes.size());
+		return {copy, bytes.size()};
+	}
+
+	Batch BatchView::ToBatch() const {
+		Batch batch(schema_);
+		for (std::size_t col = 0; col < columns_.size(); ++col) {
+			std::visit([&](const auto &view) {
+				using View = std::decay_t<decltype(view)>;
+				if constexpr (std::is_same_v<View, StringChunkView>) {
+					std::get<StringColumn>(batch.GetColumn(col)) = view.ToColumn();
+				} else {
+					using T = std::remove_const_t<typename View::element_type>;
+					std::get<std::vector<T> >(batch.GetColumn(col)).assign(view.begin(), view.end());
+				}
+			}, columns_[col]);
+			batch.GetValidity(col).assign(validity_[col].begin(), validity_[col].end());
+		}
+		batch.SetRowCount(rows_);
+		return batch;
+	}
+
+	std::span<const std::int64_t> WidenInts(const BatchView::ColumnView &column, std::vector<std::int64_t> &scratch) {
+		return std::visit([&](const auto &values) -> std::span<const std::int64_t> {
+			using View = std::decay_t<decltype(values)>;
+			if constexpr (std::is_same_v<View, StringChunkView>) {
+				throw std::runtime_error("columnar: not an integer column");
+			} else if constexpr (std::is_same_v<View, std::span<const std::int64_t> >) {
+				return values;
+			} else {
+				scratch.assign(values.begin(), values.end());
+				return scratch;
+			}
+		}, column);
+	}
+}
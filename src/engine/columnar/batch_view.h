@@ -0,0 +1,117 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <memory>
+#include <span>
+#include <utility>
+#include <string_view>
+#include <variant>
+#include <vector>
+
+#include "schema.h"
+#include "utils/utils.h"
+
+class Batch;
+
+namespace columnar {
+
+	// Read-only string chunk in its on-disk shape: a uint32 length per value followed by
+	// the concatenated bytes. Values are reached by walking the lengths in order.
+	class StringChunkView {
+	public:
+		class const_iterator {
+		public:
+			using iterator_category = std::forward_iterator_tag;
+			using value_type = std::string_view;
+			using difference_type = std::ptrdiff_t;
+			using pointer = void;
+			using reference = std::string_view;
+
+			const_iterator() = default;
+			const_iterator(const std::uint32_t *len, const char *data) : len_(len), data_(data) {}
+
+			std::string_view operator*() const { return {data_, *len_}; }
+			const_iterator &operator++() { data_ += *len_++; return *this; }
+			const_iterator operator++(int) { auto t = *this; ++*this; return t; }
+			friend bool operator==(const const_iterator &a, const const_iterator &b) { return a.len_ == b.len_; }
+
+		private:
+			const std::uint32_t *len_ = nullptr;
+			const char *data_ = nullptr;
+		};
+
+		StringChunkView() = default;
+		StringChunkView(std::span<const std::uint32_t> lens, std::string_view data) : lens_(lens), data_(data) {}
+
+		std::size_t size() const { return lens_.size(); }
+		std::span<const std::uint32_t> Lengths() const { return lens_; }
+		std::string_view Data() const { return data_; }
+
+		const_iterator begin() const { return {lens_.data(), data_.data()}; }
+		const_iterator end() const { return {lens_.data() + lens_.size(), nullptr}; }
+
+		StringColumn ToColumn() const;
+
+	private:
+		std::span<const std::uint32_t> lens_;
+		std::string_view data_;
+	};
+
+	// Batch whose columns point into the reader's storage: straight into the file mapping
+	// for ReadMode::Mapped, or into buffers owned by the view otherwise. Views stay valid
+	// while the ColumnarReader that produced them is alive. Move-only, since the column
+	// spans may point into the view's own buffers.
+	class BatchView {
+	public:
+		// Alternatives in the order of DataVector's.
+		using ColumnView = std::variant<std::span<const std::int64_t>, StringChunkView, std::span<const std::int32_t>,
+		                                std::span<const std::int16_t>, std::span<const std::int8_t> >;
+
+		BatchView(Schema schema, std::size_t rows) : schema_(std::move(schema)), rows_(rows) {}
+
+		BatchView(BatchView &&) = default;
+		BatchView &operator=(BatchView &&) = default;
+		BatchView(const BatchView &) = delete;
+		BatchView &operator=(const BatchView &) = delete;
+
+		std::size_t RowCount() const { return rows_; }
+		std::size_t ColCount() const { return columns_.size(); }
+		const Schema &GetSchema() const { return schema_; }
+
+		const ColumnView &GetColumn(std::size_t i) const { return columns_[i]; }
+		std::span<const std::int64_t> Int64Column(std::size_t i) const {
+			return std::get<std::span<const std::int64_t> >(columns_[i]);
+		}
+		const StringChunkView &StringColumnView(std::size_t i) const { return std::get<StringChunkView>(columns_[i]); }
+		// Batch::Validity of column i as a view: empty when the column has no nulls.
+		std::span<const std::uint64_t> Validity(std::size_t i) const { return validity_[i]; }
+
+		// Copies the viewed values into an owning Batch.
+		Batch ToBatch() const;
+
+		void AddColumn(ColumnView column, std::span<const std::uint64_t> validity = {}) {
+			columns_.push_back(column);
+			validity_.push_back(validity);
+		}
+
+		// 8-byte aligned scratch storage owned by the view.
+		char *Allocate(std::size_t bytes);
+
+		// Returns `bytes` itself when its start is a multiple of `alignment`, otherwise an
+		// aligned copy owned by the view (files written before chunks were padded).
+		std::string_view Aligned(std::string_view bytes, std::size_t alignment);
+
+	private:
+		Schema schema_;
+		std::size_t rows_;
+		std::vector<ColumnView> columns_;
+		std::vector<std::span<const std::uint64_t> > validity_;
+		std::vector<std::unique_ptr<std::uint64_t[]> > owned_;
+	};
+
+	// utils::WidenInts for a viewed column.
+	std::span<const std::int64_t> WidenInts(const BatchView::ColumnView &column, std::vector<std::int64_t> &scratch);
+
+}
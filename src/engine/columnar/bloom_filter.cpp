@@ -0,0 +1,178 @@
+#include "bloom_filter.h"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include <vector>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define COLUMNAR_BLOOM_X86 1
+#include <immintrin.h>
+#endif
+
+
+namespace {
+	constexpr std::size_t kWords = columnar::kBloomBlockBytes / sizeof(std::uint32_t);
+	constexpr std::uint32_t kSalt[kWords] = {
+		0x47b6137bU, 0x44974d91U, 0x8824ad5bU, 0xa2b7289dU,
+		0x705495c7U, 0x2df1424bU, 0x9efc4947U, 0x5c6bfb31U,
+	};
+
+	std::uint64_t Mix64(std::uint64_t x) {
+		x ^= x >> 33;
+		x *= 0xff51afd7ed558ccdULL;
+		x ^= x >> 33;
+		x *= 0xc4ceb9fe1a85ec53ULL;
+		x ^= x >> 33;
+		return x;
+	}
+
+	std::uint64_t Mum(std::uint64_t a, std::uint64_t b) {
+		const unsigned __int128 r = static_cast<unsigned __int128>(a) * b;
+		return static_cast<std::uint64_t>(r) ^ static_cast<std::uint64_t>(r >> 64);
+	}
+
+	// Block picked by the upper 32 bits of the hash, scaled to the block count without a division.
+	std::size_t BlockIndex(std::uint64_t hash, std::size_t blocks) {
+		return static_cast<std::size_t>(((hash >> 32) * blocks) >> 32);
+	}
+
+	void InsertScalar(std::uint32_t *words, std::size_t blocks, std::span<const std::uint64_t> hashes) {
+		for (const auto hash: hashes) {
+			std::uint32_t *block = words + BlockIndex(hash, blocks) * kWords;
+			const auto key = static_cast<std::uint32_t>(hash);
+			for (std::size_t i = 0; i < kWords; ++i) block[i] |= std::uint32_t{1} << ((key * kSalt[i]) >> 27);
+		}
+	}
+
+	void HashScalar(std::span<const std::int64_t> values, std::uint64_t *out) {
+		for (std::size_t i = 0; i < values.size(); ++i) out[i] = Mix64(static_cast<std::uint64_t>(values[i]));
+	}
+
+#ifdef COLUMNAR_BLOOM_X86
+	// Low 64 bits of a * b per lane; AVX2 only multiplies 32-bit halves.
+	__attribute__((target("avx2")))
+	__m256i MulLo64(__m256i a, __m256i b) {
+		const __m256i cross = _mm256_add_epi64(_mm256_mul_epu32(_mm256_srli_epi64(a, 32), b),
+		                                       _mm256_mul_epu32(a, _mm256_srli_epi64(b, 32)));
+		return _mm256_add_epi64(_mm256_mul_epu32(a, b), _mm256_slli_epi64(cross, 32));
+	}
+
+	// Mix64 of four values at a time.
+	__attribute__((target("avx2")))
+	void HashAvx2(std::span<const std::int64_t> values, std::uint64_t *out) {
+		const __m256i c1 = _mm256_set1_epi64x(static_cast<long long>(0xff51afd7ed558ccdULL));
+		const __m256i c2 = _mm256_set1_epi64x(static_cast<long long>(0xc4ceb9fe1a85ec53ULL));
+		std::size_t i = 0;
+		for (; i + 4 <= values.size(); i += 4) {
+			__m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(values.data() + i));
+			x = _mm256_xor_si256(x, _mm256_srli_epi64(x, 33));
+			x = MulLo64(x, c1);
+			x = _mm256_xor_si256(x, _mm256_srli_epi64(x, 33));
+			x = MulLo64(x, c2);
+			x = _mm256_xor_si256(x, _mm256_srli_epi64(x, 33));
+			_mm256_storeu_si256(reinterpret_cast<__m256i *>(out + i), x);
+		}
+		HashScalar(values.subspan(i), out + i);
+	}
+
+	// The eight salted multiplies, shifts and bit sets of a block run as one lane each.
+	__attribute__((target("avx2")))
+	void InsertAvx2(std::uint32_t *words, std::size_t blocks, std::span<const std::uint64_t> hashes) {
+		const __m256i salt = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(kSalt));
+		const __m256i one = _mm256_set1_epi32(1);
+		for (const auto hash: hashes) {
+			auto *block = reinterpret_cast<__m256i *>(words + BlockIndex(hash, blocks) * kWords);
+			const __m256i key = _mm256_set1_epi32(static_cast<int>(static_cast<std::uint32_t>(hash)));
+			const __m256i mask = _mm256_sllv_epi32(one, _mm256_srli_epi32(_mm256_mullo_epi32(key, salt), 27));
+			_mm256_storeu_si256(block, _mm256_or_si256(_mm256_loadu_si256(block), mask));
+		}
+	}
+#endif
+
+	using HashFn = void (*)(std::span<const std::int64_t>, std::uint64_t *);
+	using InsertFn = void (*)(std::uint32_t *, std::size_t, std::span<const std::uint64_t>);
+
+	struct Kernel {
+		HashFn hash;
+		InsertFn insert;
+		const char *name;
+	};
+
+	const Kernel &ActiveKernel() {
+		static const Kernel kernel = [] {
+#ifdef COLUMNAR_BLOOM_X86
+			__builtin_cpu_init();
+			if (__builtin_cpu_supports("avx2")) return Kernel{HashAvx2, InsertAvx2, "avx2"};
+#endif
+			return Kernel{HashScalar, InsertScalar, "scalar"};
+		}();
+		return kernel;
+	}
+
+	std::string Build(std::span<const std::uint64_t> hashes, std::size_t distinct) {
+		const std::size_t bits = std::max<std::size_t>(distinct, 1) * columnar::kBloomBitsPerValue;
+		const std::size_t blocks = (bits + columnar::kBloomBlockBytes * 8 - 1) / (columnar::kBloomBlockBytes * 8);
+		std::vector<std::uint32_t> words(blocks * kWords);
+		ActiveKernel().insert(words.data(), blocks, hashes);
+		return {reinterpret_cast<const char *>(words.data()), words.size() * sizeof(std::uint32_t)};
+	}
+}
+
+
+namespace columnar {
+	std::uint64_t BloomHash(std::int64_t value) {
+		return Mix64(static_cast<std::uint64_t>(value));
+	}
+
+	std::uint64_t BloomHash(std::string_view value) {
+		constexpr std::uint64_t k0 = 0xa0761d6478bd642fULL;
+		constexpr std::uint64_t k1 = 0xe7037ed1a0b428dbULL;
+		constexpr std::uint64_t k2 = 0x8ebc6af09c88c6e3ULL;
+		const char *p = value.data();
+		const std::size_t n = value.size();
+		std::uint64_t h = k0 ^ n;
+		std::size_t i = 0;
+		for (; i + 8 <= n; i += 8) {
+			std::uint64_t word;
+			std::memcpy(&word, p + i, sizeof(word));
+			h = Mum(word ^ k1, h ^ k2);
+		}
+		if (i < n) {
+			std::uint64_t tail = 0;
+			std::memcpy(&tail, p + i, n - i);
+			h = Mum(tail ^ k1, h ^ k2 ^ (n - i));
+		}
+		return Mix64(h);
+	}
+
+	std::string BuildBloomFilter(std::span<const std::int64_t> values, std::size_t distinct) {
+		std::vector<std::uint64_t> hashes(values.size());
+		ActiveKernel().hash(values, hashes.data());
+		return Build(hashes, distinct);
+	}
+
+	std::string BuildBloomFilter(const StringColumn &values, std::size_t distinct) {
+		std::vector<std::uint64_t> hashes(values.size());
+		for (std::size_t i = 0; i < values.size(); ++i) hashes[i] = BloomHash(values[i]);
+		return Build(hashes, distinct);
+	}
+
+	bool BloomMayContain(std::string_view filter, std::uint64_t hash) {
+		if (filter.empty() || filter.size() % kBloomBlockBytes != 0) {
+			throw std::runtime_error("columnar: corrupted Bloom filter");
+		}
+		std::uint32_t block[kWords];
+		std::memcpy(block, filter.data() + BlockIndex(hash, filter.size() / kBloomBlockBytes) * kBloomBlockBytes,
+		            sizeof(block));
+		const auto key = static_cast<std::uint32_t>(hash);
+		for (std::size_t i = 0; i < kWords; ++i) {
+			if ((block[i] & (std::uint32_t{1} << ((key * kSalt[i]) >> 27))) == 0) return false;
+		}
+		return true;
+	}
+
+	const char *BloomKernel() {
+		return ActiveKernel().name;
+	}
+}
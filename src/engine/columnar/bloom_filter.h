@@ -0,0 +1,34 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <string_view>
+
+#include "utils/utils.h"
+
+namespace columnar {
+
+	// Hashes of column values as inserted into Bloom filters. They are part of the file
+	// format, so unlike std::hash they never change between builds.
+	std::uint64_t BloomHash(std::int64_t value);
+	std::uint64_t BloomHash(std::string_view value);
+
+	// Split-block Bloom filter in the Parquet layout: 32-byte blocks of eight 32-bit words.
+	// A value sets one bit in each word of the single block its hash selects, so inserting
+	// and probing touch one cache line. Sized at kBloomBitsPerValue bits per distinct value,
+	// about 1% false positives.
+	static constexpr std::size_t kBloomBlockBytes = 32;
+	static constexpr std::size_t kBloomBitsPerValue = 10;
+
+	std::string BuildBloomFilter(std::span<const std::int64_t> values, std::size_t distinct);
+	std::string BuildBloomFilter(const StringColumn &values, std::size_t distinct);
+
+	// False only when no value with this hash was inserted into `filter`.
+	bool BloomMayContain(std::string_view filter, std::uint64_t hash);
+
+	// Name of the hash and insert kernels picked for this CPU ("avx2" or "scalar").
+	const char *BloomKernel();
+
+}
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+namespace columnar {
+
+	// Bounds-checked cursor over an in-memory byte range (a loaded footer, a mapped file).
+	class ByteReader {
+	public:
+		ByteReader(const char *data, std::size_t size) : p_(data), end_(data + size) {}
+		explicit ByteReader(std::string_view bytes) : ByteReader(bytes.data(), bytes.size()) {}
+
+		template<class T>
+		T Read() {
+			static_assert(std::is_trivially_copyable_v<T>);
+			T v{};
+			ReadBytes(&v, sizeof(T));
+			return v;
+		}
+
+		void ReadBytes(void *out, std::size_t size) {
+			if (Remaining() < size) throw std::runtime_error("failed to read from file");
+			if (size > 0) std::memcpy(out, p_, size);
+			p_ += size;
+		}
+
+		std::string_view ReadView(std::size_t size) {
+			if (Remaining() < size) throw std::runtime_error("failed to read from file");
+			std::string_view v(p_, size);
+			p_ += size;
+			return v;
+		}
+
+		std::string ReadString() {
+			const auto len = Read<std::uint32_t>();
+			return std::string(ReadView(len));
+		}
+
+		std::size_t Remaining() const { return static_cast<std::size_t>(end_ - p_); }
+		const char *Position() const { return p_; }
+
+	private:
+		const char *p_;
+		const char *end_;
+	};
+
+	// Appends raw values to a byte buffer (a footer, a batch header); the counterpart of ByteReader.
+	class ByteWriter {
+	public:
+		explicit ByteWriter(std::string &out) : out_(out) {}
+
+		template<class T>
+		void Write(const T &v) {
+			static_assert(std::is_trivially_copyable_v<T>);
+			WriteBytes(&v, sizeof(T));
+		}
+
+		void WriteBytes(const void *data, std::size_t size) {
+			out_.append(static_cast<const char *>(data), size);
+		}
+
+		void WriteString(std::string_view s) {
+			if (s.size() > UINT32_MAX) throw std::runtime_error("columnar: string too long");
+			Write(static_cast<std::uint32_t>(s.size()));
+			WriteBytes(s.data(), s.size());
+		}
+
+		std::size_t Size() const { return out_.size(); }
+
+	private:
+		std::string &out_;
+	};
+
+}
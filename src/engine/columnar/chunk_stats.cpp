@@ -0,0 +1,156 @@
+#include "chunk_stats.h"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cmath>
+#include <functional>
+#include <stdexcept>
+
+namespace {
+	std::uint64_t Mix64(std::uint64_t x) {
+		x ^= x >> 33;
+		x *= 0xff51afd7ed558ccdULL;
+		x ^= x >> 33;
+		x *= 0xc4ceb9fe1a85ec53ULL;
+		x ^= x >> 33;
+		return x;
+	}
+
+	// HyperLogLog with 256 one-byte registers, about 6.5% standard error.
+	class DistinctSketch {
+	public:
+		void Add(std::uint64_t hash) {
+			const std::size_t idx = hash >> (64 - kBits);
+			const std::uint64_t rest = hash << kBits;
+			const auto rank = static_cast<std::uint8_t>(rest == 0 ? 64 - kBits + 1 : std::countl_zero(rest) + 1);
+			registers_[idx] = std::max(registers_[idx], rank);
+		}
+
+		std::uint32_t Estimate(std::size_t rows) const {
+			constexpr double m = kRegisters;
+			double sum = 0;
+			std::size_t zeros = 0;
+			for (const auto r: registers_) {
+				sum += std::ldexp(1.0, -r);
+				zeros += r == 0;
+			}
+			double estimate = 0.7213 / (1 + 1.079 / m) * m * m / sum;
+			if (estimate <= 2.5 * m && zeros != 0) {
+				estimate = m * std::log(m / static_cast<double>(zeros));
+			}
+			const auto rounded = static_cast<std::uint64_t>(std::llround(estimate));
+			return static_cast<std::uint32_t>(std::clamp<std::uint64_t>(rounded, rows == 0 ? 0 : 1, rows));
+		}
+
+	private:
+		static constexpr int kBits = 8;
+		static constexpr std::size_t kRegisters = std::size_t{1} << kBits;
+		std::array<std::uint8_t, kRegisters> registers_{};
+	};
+
+	std::string_view Prefix(std::string_view s) {
+		return s.substr(0, std::min(s.size(), columnar::kStatsPrefixLength));
+	}
+
+	// Prefixes shorter than the limit are exact values.
+	bool IsExact(const std::string &prefix) {
+		return prefix.size() < columnar::kStatsPrefixLength;
+	}
+
+	bool MayMatchInt(const columnar::ChunkStats &s, columnar::CompareOp op, std::int64_t v) {
+		using columnar::CompareOp;
+		switch (op) {
+			case CompareOp::Eq: return s.min_int <= v && v <= s.max_int;
+			case CompareOp::Ne: return !(s.min_int == v && s.max_int == v);
+			case CompareOp::Lt: return s.min_int < v;
+			case CompareOp::Le: return s.min_int <= v;
+			case CompareOp::Gt: return s.max_int > v;
+			case CompareOp::Ge: return s.max_int >= v;
+		}
+		return true;
+	}
+
+	// Every value x in the chunk satisfies min_str <= x and Prefix(x) <= max_str.
+	bool MayMatchString(const columnar::ChunkStats &s, columnar::CompareOp op, std::string_view v) {
+		using columnar::CompareOp;
+		const std::string_view min = s.min_str;
+		const std::string_view max = s.max_str;
+		switch (op) {
+			case CompareOp::Eq: return min <= v && Prefix(v) <= max;
+			case CompareOp::Ne: return !(IsExact(s.min_str) && IsExact(s.max_str) && min == v && max == v);
+			case CompareOp::Lt: return min < v;
+			case CompareOp::Le: return min <= v;
+			case CompareOp::Gt: return IsExact(s.max_str) ? max > v : Prefix(v) <= max;
+			case CompareOp::Ge: return Prefix(v) <= max;
+		}
+		return true;
+	}
+
+	template<class T>
+	columnar::ChunkStats ComputeIntStats(std::span<const T> values) {
+		columnar::ChunkStats stats;
+		stats.present = true;
+		if (values.empty()) return stats;
+
+		const auto [min, max] = std::minmax_element(values.begin(), values.end());
+		stats.min_int = *min;
+		stats.max_int = *max;
+
+		// Hashed as int64, so the estimate does not depend on the column's width.
+		DistinctSketch sketch;
+		for (const std::int64_t v: values) sketch.Add(Mix64(static_cast<std::uint64_t>(v)));
+		stats.distinct = sketch.Estimate(values.size());
+		return stats;
+	}
+}
+
+
+namespace columnar {
+	ChunkStats ComputeStats(std::span<const std::int64_t> values) {
+		return ComputeIntStats(values);
+	}
+
+	ChunkStats ComputeStats(std::span<const std::int32_t> values) {
+		return ComputeIntStats(values);
+	}
+
+	ChunkStats ComputeStats(std::span<const std::int16_t> values) {
+		return ComputeIntStats(values);
+	}
+
+	ChunkStats ComputeStats(std::span<const std::int8_t> values) {
+		return ComputeIntStats(values);
+	}
+
+	ChunkStats ComputeStats(const StringColumn &values) {
+		ChunkStats stats;
+		stats.present = true;
+		if (values.empty()) return stats;
+
+		std::string_view min = values[0];
+		std::string_view max = values[0];
+		DistinctSketch sketch;
+		const std::hash<std::string_view> hasher;
+		for (const std::string_view v: values) {
+			if (v < min) min = v;
+			if (v > max) max = v;
+			sketch.Add(Mix64(hasher(v)));
+		}
+		stats.min_str = Prefix(min);
+		stats.max_str = Prefix(max);
+		stats.distinct = sketch.Estimate(values.size());
+		return stats;
+	}
+
+	bool MayMatch(const ChunkStats &stats, DataType type, const Predicate &pred) {
+		if (type == DataType::String) {
+			const auto *v = std::get_if<std::string>(&pred.value);
+			if (v == nullptr) throw std::runtime_error("columnar: predicate on string column needs a string value");
+			return !stats.present || (!stats.all_null && MayMatchString(stats, pred.op, *v));
+		}
+		const auto *v = std::get_if<std::int64_t>(&pred.value);
+		if (v == nullptr) throw std::runtime_error("columnar: predicate on " + ToString(type) + " column needs an integer value");
+		return !stats.present || (!stats.all_null && MayMatchInt(stats, pred.op, *v));
+	}
+}
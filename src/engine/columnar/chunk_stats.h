@@ -0,0 +1,63 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <string_view>
+#include <variant>
+#include <vector>
+
+#include "schema.h"
+#include "utils/utils.h"
+
+namespace columnar {
+
+	// String min/max are stored truncated to this many bytes.
+	static constexpr std::size_t kStatsPrefixLength = 32;
+
+	// Per-chunk summary recorded in the footer (format version 2+). Files written before
+	// version 2 load with `present == false`, which never prunes anything.
+	struct ChunkStats {
+		bool present = false;
+		// Integer columns, whatever their width.
+		std::int64_t min_int = 0;
+		std::int64_t max_int = 0;
+		// String columns: prefixes of the smallest and largest value. A prefix shorter than
+		// kStatsPrefixLength is the whole value.
+		std::string min_str;
+		std::string max_str;
+		// Approximate number of distinct values (HyperLogLog estimate, clamped to the row count).
+		std::uint32_t distinct = 0;
+		// Every row is null, so no predicate matches; the fields above are unset. Stats of
+		// other chunks cover their non-null values only.
+		bool all_null = false;
+	};
+
+	ChunkStats ComputeStats(std::span<const std::int64_t> values);
+	ChunkStats ComputeStats(std::span<const std::int32_t> values);
+	ChunkStats ComputeStats(std::span<const std::int16_t> values);
+	ChunkStats ComputeStats(std::span<const std::int8_t> values);
+	ChunkStats ComputeStats(const StringColumn &values);
+
+	enum class CompareOp : std::uint8_t {
+		Eq,
+		Ne,
+		Lt,
+		Le,
+		Gt,
+		Ge,
+	};
+
+	// `column <op> value`; the value alternative must match the column type.
+	struct Predicate {
+		std::size_t column = 0;
+		CompareOp op = CompareOp::Eq;
+		std::variant<std::int64_t, std::string> value;
+	};
+
+	// False only when no row of a chunk with these stats can satisfy `pred`. Null rows
+	// satisfy no predicate.
+	bool MayMatch(const ChunkStats &stats, DataType type, const Predicate &pred);
+
+}
@@ -0,0 +1,264 @@
+#include "codec.h"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#ifdef COLUMNAR_HAVE_ZSTD
+#include <zstd.h>
+#endif
+#ifdef COLUMNAR_HAVE_LZ4
+#include <lz4.h>
+#endif
+
+
+namespace {
+	constexpr std::size_t kMinMatch = 4;
+	constexpr std::size_t kMaxOffset = 65535;
+	constexpr int kHashBits = 14;
+
+	[[noreturn]] void Corrupted() {
+		throw std::runtime_error("columnar: corrupted compressed chunk");
+	}
+
+	std::uint32_t Load32(const char *p) {
+		std::uint32_t v;
+		std::memcpy(&v, p, sizeof(v));
+		return v;
+	}
+
+	std::uint32_t Hash(std::uint32_t seq) {
+		return (seq * 2654435761U) >> (32 - kHashBits);
+	}
+
+	void PutLength(std::string &out, std::size_t len) {
+		for (; len >= 255; len -= 255) out.push_back(static_cast<char>(255));
+		out.push_back(static_cast<char>(len));
+	}
+
+	// token: literal length (high nibble) and match length - kMinMatch (low nibble), each
+	// continued in 255-run bytes when the nibble is 15; then the literals; then, except in
+	// the last sequence, a little-endian u16 match offset.
+	void PutSequence(std::string &out, const char *literals, std::size_t lit, std::size_t offset, std::size_t match) {
+		const std::size_t m = match - kMinMatch;
+		out.push_back(static_cast<char>((std::min<std::size_t>(lit, 15) << 4) | std::min<std::size_t>(m, 15)));
+		if (lit >= 15) PutLength(out, lit - 15);
+		out.append(literals, lit);
+		out.push_back(static_cast<char>(offset & 0xff));
+		out.push_back(static_cast<char>(offset >> 8));
+		if (m >= 15) PutLength(out, m - 15);
+	}
+
+	void PutLastLiterals(std::string &out, const char *literals, std::size_t lit) {
+		out.push_back(static_cast<char>(std::min<std::size_t>(lit, 15) << 4));
+		if (lit >= 15) PutLength(out, lit - 15);
+		out.append(literals, lit);
+	}
+
+	void LzCompress(std::string_view src, std::string &out) {
+		thread_local std::vector<std::uint32_t> table;
+		table.assign(std::size_t{1} << kHashBits, UINT32_MAX);
+
+		const char *s = src.data();
+		const std::size_t n = src.size();
+		std::size_t anchor = 0;
+		std::size_t i = 0;
+		while (i + kMinMatch <= n) {
+			const std::uint32_t seq = Load32(s + i);
+			const std::uint32_t h = Hash(seq);
+			const std::size_t cand = table[h];
+			table[h] = static_cast<std::uint32_t>(i);
+
+			if (cand == UINT32_MAX || i - cand > kMaxOffset || Load32(s + cand) != seq) {
+				// Step faster through data that keeps failing to match.
+				i += 1 + ((i - anchor) >> 6);
+				continue;
+			}
+
+			std::size_t len = kMinMatch;
+			while (i + len < n && s[cand + len] == s[i + len]) ++len;
+			PutSequence(out, s + anchor, i - anchor, i - cand, len);
+			i += len;
+			anchor = i;
+			if (i >= 2 && i + kMinMatch <= n) table[Hash(Load32(s + i - 2))] = static_cast<std::uint32_t>(i - 2);
+		}
+		PutLastLiterals(out, s + anchor, n - anchor);
+	}
+
+	std::size_t ReadLength(const char *&p, const char *end) {
+		std::size_t len = 0;
+		unsigned char b;
+		do {
+			if (p == end) Corrupted();
+			b = static_cast<unsigned char>(*p++);
+			len += b;
+		} while (b == 255);
+		return len;
+	}
+
+	void LzDecompress(std::string_view src, std::span<char> dst) {
+		const char *p = src.data();
+		const char *end = p + src.size();
+		char *out = dst.data();
+		const std::size_t cap = dst.size();
+		std::size_t o = 0;
+
+		while (true) {
+			if (p == end) Corrupted();
+			const auto token = static_cast<unsigned char>(*p++);
+
+			std::size_t lit = token >> 4;
+			if (lit == 15) lit += ReadLength(p, end);
+			if (lit > static_cast<std::size_t>(end - p) || lit > cap - o) Corrupted();
+			std::memcpy(out + o, p, lit);
+			p += lit;
+			o += lit;
+			if (p == end) break;
+
+			if (end - p < 2) Corrupted();
+			const std::size_t offset = static_cast<unsigned char>(p[0]) | (static_cast<std::size_t>(static_cast<unsigned char>(p[1])) << 8);
+			p += 2;
+			std::size_t match = (token & 15) + kMinMatch;
+			if ((token & 15) == 15) match += ReadLength(p, end);
+			if (offset == 0 || offset > o || match > cap - o) Corrupted();
+
+			const char *from = out + o - offset;
+			if (offset >= match) {
+				std::memcpy(out + o, from, match);
+			} else {
+				for (std::size_t k = 0; k < match; ++k) out[o + k] = from[k];
+			}
+			o += match;
+		}
+		if (o != cap) Corrupted();
+	}
+
+	[[noreturn]] void Unavailable(columnar::Codec codec) {
+		throw std::runtime_error(std::string("columnar: codec '") + columnar::CodecName(codec) +
+		                         "' is not available in this build");
+	}
+}
+
+
+namespace columnar {
+	const char *CodecName(Codec codec) {
+		switch (codec) {
+			case Codec::None: return "none";
+			case Codec::Lz: return "lz";
+			case Codec::Zstd: return "zstd";
+			case Codec::Lz4: return "lz4";
+		}
+		return "unknown";
+	}
+
+	Codec ToCodec(std::uint8_t raw) {
+		if (raw > static_cast<std::uint8_t>(Codec::Lz4)) {
+			throw std::runtime_error("columnar: unknown codec: " + std::to_string(raw));
+		}
+		return static_cast<Codec>(raw);
+	}
+
+	Codec ParseCodec(std::string_view name) {
+		for (const Codec c: {Codec::None, Codec::Lz, Codec::Zstd, Codec::Lz4}) {
+			if (name != CodecName(c)) continue;
+			if (!CodecAvailable(c)) Unavailable(c);
+			return c;
+		}
+		throw std::runtime_error("columnar: unknown codec: '" + std::string(name) + "'");
+	}
+
+	bool CodecAvailable(Codec codec) {
+		switch (codec) {
+			case Codec::None:
+			case Codec::Lz:
+				return true;
+			case Codec::Zstd:
+#ifdef COLUMNAR_HAVE_ZSTD
+				return true;
+#else
+				return false;
+#endif
+			case Codec::Lz4:
+#ifdef COLUMNAR_HAVE_LZ4
+				return true;
+#else
+				return false;
+#endif
+		}
+		return false;
+	}
+
+	void Compress(Codec codec, std::string_view src, std::string &out) {
+		switch (codec) {
+			case Codec::None:
+				out.append(src);
+				return;
+			case Codec::Lz:
+				LzCompress(src, out);
+				return;
+			case Codec::Zstd: {
+#ifdef COLUMNAR_HAVE_ZSTD
+				const std::size_t base = out.size();
+				out.resize(base + ZSTD_compressBound(src.size()));
+				const std::size_t n = ZSTD_compress(out.data() + base, out.size() - base, src.data(), src.size(), 3);
+				if (ZSTD_isError(n)) throw std::runtime_error("columnar: zstd compression failed");
+				out.resize(base + n);
+				return;
+#else
+				Unavailable(codec);
+#endif
+			}
+			case Codec::Lz4: {
+#ifdef COLUMNAR_HAVE_LZ4
+				if (src.size() > static_cast<std::size_t>(LZ4_MAX_INPUT_SIZE)) {
+					throw std::runtime_error("columnar: chunk too large for lz4");
+				}
+				const std::size_t base = out.size();
+				out.resize(base + static_cast<std::size_t>(LZ4_compressBound(static_cast<int>(src.size()))));
+				const int n = LZ4_compress_default(src.data(), out.data() + base, static_cast<int>(src.size()),
+				                                   static_cast<int>(out.size() - base));
+				if (n <= 0) throw std::runtime_error("columnar: lz4 compression failed");
+				out.resize(base + static_cast<std::size_t>(n));
+				return;
+#else
+				Unavailable(codec);
+#endif
+			}
+		}
+		throw std::runtime_error("columnar: unsupported codec");
+	}
+
+	void Decompress(Codec codec, std::string_view src, std::span<char> dst) {
+		switch (codec) {
+			case Codec::None:
+				if (src.size() != dst.size()) Corrupted();
+				if (!src.empty()) std::memcpy(dst.data(), src.data(), src.size());
+				return;
+			case Codec::Lz:
+				LzDecompress(src, dst);
+				return;
+			case Codec::Zstd: {
+#ifdef COLUMNAR_HAVE_ZSTD
+				const std::size_t n = ZSTD_decompress(dst.data(), dst.size(), src.data(), src.size());
+				if (ZSTD_isError(n) || n != dst.size()) Corrupted();
+				return;
+#else
+				Unavailable(codec);
+#endif
+			}
+			case Codec::Lz4: {
+#ifdef COLUMNAR_HAVE_LZ4
+				const int n = LZ4_decompress_safe(src.data(), dst.data(), static_cast<int>(src.size()),
+				                                  static_cast<int>(dst.size()));
+				if (n < 0 || static_cast<std::size_t>(n) != dst.size()) Corrupted();
+				return;
+#else
+				Unavailable(codec);
+#endif
+			}
+		}
+		throw std::runtime_error("columnar: unsupported codec");
+	}
+}
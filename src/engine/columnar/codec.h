@@ -0,0 +1,34 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <string_view>
+
+namespace columnar {
+
+	// Block compression applied to a whole (already encoded) chunk. Stored per chunk in the
+	// footer from format version 4.
+	enum class Codec : std::uint8_t {
+		None = 0,
+		// Built-in LZ77 byte codec (LZ4-style sequences, 64 KiB window).
+		Lz = 1,
+		// System libzstd / liblz4, when the build found them.
+		Zstd = 2,
+		Lz4 = 3,
+	};
+
+	const char *CodecName(Codec codec);
+	Codec ToCodec(std::uint8_t raw);
+	// "none", "lz", "zstd" or "lz4"; throws for unknown names and codecs missing from this build.
+	Codec ParseCodec(std::string_view name);
+	bool CodecAvailable(Codec codec);
+
+	// Appends `src` compressed with `codec` to `out`.
+	void Compress(Codec codec, std::string_view src, std::string &out);
+
+	// Decompresses into exactly dst.size() bytes. Throws on corrupted input.
+	void Decompress(Codec codec, std::string_view src, std::span<char> dst);
+
+}
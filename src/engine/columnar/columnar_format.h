@@ -1,20 +1,62 @@
 #pragma once
 
+#include <cstddef>
 #include <cstdint>
+#include <string>
+#include <variant>
 #include <vector>
 
+#include "chunk_stats.h"
+#include "codec.h"
+#include "encoding.h"
+
 namespace columnar {
 
-	static constexpr std::uint32_t kColumnarVersion = 1;
+	// Version 2 adds per-chunk ChunkStats to the footer, version 3 a per-chunk Encoding,
+	// version 4 a per-chunk Codec and uncompressed size, version 5 the sort order with
+	// per-batch first/last keys, version 6 per-chunk Bloom filters, version 7 nullable
+	// columns with per-chunk null counts and validity bitmaps. Readers still accept version 1.
+	static constexpr std::uint32_t kColumnarVersion = 7;
+	static constexpr std::uint32_t kMinColumnarVersion = 1;
+
+	// Chunk offsets are padded to this boundary so mapped readers can view them as arrays.
+	static constexpr std::size_t kChunkAlignment = 8;
 
 	struct ChunkMeta {
 		std::uint64_t offset = 0;
+		// Bytes stored in the file, after compression.
 		std::uint64_t size = 0;
+		Encoding encoding = Encoding::Plain;
+		Codec codec = Codec::None;
+		// Size of the encoded chunk before compression; equals `size` for Codec::None.
+		std::uint64_t uncompressed_size = 0;
+		ChunkStats stats;
+		// Split-block Bloom filter of the chunk's values, stored after the batch's chunks;
+		// size 0 when the column has none.
+		std::uint64_t bloom_offset = 0;
+		std::uint64_t bloom_size = 0;
+		// Null rows. Only chunks with some but not all rows null store a validity bitmap
+		// (BitmapWords(row_count) words, after the chunks); an all-null chunk stores no data.
+		std::uint32_t null_count = 0;
+		std::uint64_t validity_offset = 0;
+		std::uint64_t validity_size = 0;
+	};
+
+	// One value of an integer or string column.
+	using KeyValue = std::variant<std::int64_t, std::string>;
+
+	struct SortColumn {
+		std::uint32_t column = 0;
+		bool descending = false;
 	};
 
 	struct BatchMeta {
 		std::uint32_t row_count = 0;
 		std::vector<ChunkMeta> columns;
+		// Sort column values of the first and last row, one per file sort column; empty for
+		// files without a sort order and for empty batches.
+		std::vector<KeyValue> first_key;
+		std::vector<KeyValue> last_key;
 	};
 
 }
@@ -1,155 +1,752 @@
 #include "columnar_reader.h"
 
+#include <algorithm>
+#include <cstring>
+#include <ranges>
 #include <stdexcept>
 #include <string>
+#include <type_traits>
 
 #include "batch.h"
+#include "bloom_filter.h"
+#include "secondary_index.h"
+#include "byte_io.h"
 #include "columnar_format.h"
 #include "utils/utils.h"
 
 
-template<class T>
-T ReadObj(std::ifstream &in) {
-	T v{};
-	in.read(reinterpret_cast<char *>(&v), sizeof(T));
-	if (!in) {
-		throw std::runtime_error("failed to read from file");
-	}
-	return v;
-}
-
 void ReadBytes(std::ifstream &in, void *data, std::size_t size) {
 	in.read(static_cast<char *>(data), static_cast<std::streamsize>(size));
 	if (!in) throw std::runtime_error("failed to read from file");
 }
 
-std::string ReadString(std::ifstream &in) {
-	const auto len = ReadObj<std::uint32_t>(in);
-	std::string s;
-	s.resize(len);
-	if (len > 0) ReadBytes(in, s.data(), len);
-	return s;
-}
-
 DataType ToDataType(std::uint8_t raw) {
-	if (raw == static_cast<std::uint8_t>(DataType::Int64)) return DataType::Int64;
-	if (raw == static_cast<std::uint8_t>(DataType::String)) return DataType::String;
+	if (raw <= static_cast<std::uint8_t>(DataType::Timestamp)) return static_cast<DataType>(raw);
 	throw std::runtime_error("unknown DataType");
 }
 
 
 namespace columnar {
-	ColumnarReader::ColumnarReader(const std::filesystem::path &path)
-		: in_(path, std::ios::binary) {
-		if (!in_.is_open()) {
-			throw std::runtime_error("columnar: failed to open file for reading: " + path.string());
+	// header: magic(4) + version(4) + footer_offset(8)
+	constexpr std::size_t kHeaderSize = 4 + 4 + 8;
+
+	ColumnarReader::ColumnarReader(const std::filesystem::path &path, ReadMode mode)
+		: mode_(mode) {
+		if (mode_ == ReadMode::Mapped) {
+			map_ = std::make_unique<MappedFile>(path);
+		} else {
+			in_.open(path, std::ios::binary);
+			if (!in_.is_open()) {
+				throw std::runtime_error("columnar: failed to open file for reading: " + path.string());
+			}
 		}
 		ReadHeader();
 		ReadFooter();
 	}
 
 	void ColumnarReader::ReadHeader() {
+		if (map_) {
+			ParseHeader({map_->Data(), map_->Size()});
+			return;
+		}
+		char header[kHeaderSize];
+		ReadBytes(in_, header, sizeof(header));
+		ParseHeader({header, sizeof(header)});
+	}
+
+	void ColumnarReader::ParseHeader(std::string_view bytes) {
+		ByteReader r(bytes);
 		char magic[4];
-		ReadBytes(in_, magic, sizeof(magic));
+		r.ReadBytes(magic, sizeof(magic));
 		if (!(magic[0] == 'C' && magic[1] == 'D' && magic[2] == 'B' && magic[3] == '1')) {
 			throw std::runtime_error("columnar: bad format file");
 		}
 
-		const auto version = ReadObj<std::uint32_t>(in_);
-		if (version != kColumnarVersion) {
-			throw std::runtime_error("unsupported version: " + std::to_string(version));
+		version_ = r.Read<std::uint32_t>();
+		if (version_ < kMinColumnarVersion || version_ > kColumnarVersion) {
+			throw std::runtime_error("unsupported version: " + std::to_string(version_));
 		}
 
-		footer_offset_ = ReadObj<std::uint64_t>(in_);
+		footer_offset_ = r.Read<std::uint64_t>();
 		if (footer_offset_ == 0) {
 			throw std::runtime_error("bad footer offset");
 		}
 	}
 
 	void ColumnarReader::ReadFooter() {
+		if (map_) {
+			file_size_ = map_->Size();
+			if (footer_offset_ > map_->Size()) throw std::runtime_error("bad footer offset");
+			ParseFooter({map_->Data() + footer_offset_, map_->Size() - footer_offset_});
+			return;
+		}
+
+		in_.clear();
+		in_.seekg(0, std::ios::end);
+		file_size_ = static_cast<std::uint64_t>(in_.tellg());
+		if (footer_offset_ > file_size_) throw std::runtime_error("bad footer offset");
+
+		std::string footer(static_cast<std::size_t>(file_size_ - footer_offset_), '\0');
 		utils::Seek(in_, footer_offset_);
+		ReadBytes(in_, footer.data(), footer.size());
+		ParseFooter(footer);
+	}
 
-		const auto ncols = ReadObj<std::uint32_t>(in_);
+	void ColumnarReader::ParseFooter(std::string_view bytes) {
+		ByteReader r(bytes);
+		const auto ncols = r.Read<std::uint32_t>();
 
 		schema_.clear();
 		schema_.reserve(ncols);
 		for (std::uint32_t i = 0; i < ncols; ++i) {
-			std::string name = ReadString(in_);
-			schema_.push_back(ColumnSchema{std::move(name), ToDataType(ReadObj<std::uint8_t>(in_))});
+			std::string name = r.ReadString();
+			const DataType type = ToDataType(r.Read<std::uint8_t>());
+			const bool nullable = version_ >= 7 && r.Read<std::uint8_t>() != 0;
+			schema_.push_back(ColumnSchema{std::move(name), type, nullable});
 		}
 
-		const auto nrg = ReadObj<std::uint32_t>(in_);
+		const auto nrg = r.Read<std::uint32_t>();
 		batches_.clear();
 		batches_.reserve(nrg);
 		for (std::uint32_t rg = 0; rg < nrg; ++rg) {
 			BatchMeta meta;
-			meta.row_count = ReadObj<std::uint32_t>(in_);
+			meta.row_count = r.Read<std::uint32_t>();
 			meta.columns.resize(ncols);
 			for (std::uint32_t c = 0; c < ncols; ++c) {
-				meta.columns[c].offset = ReadObj<std::uint64_t>(in_);
-				meta.columns[c].size = ReadObj<std::uint64_t>(in_);
+				meta.columns[c].offset = r.Read<std::uint64_t>();
+				meta.columns[c].size = r.Read<std::uint64_t>();
+				if (version_ >= 3) {
+					const Encoding enc = ToEncoding(r.Read<std::uint8_t>());
+					const bool string_encoding = enc == Encoding::Plain || enc == Encoding::Dictionary;
+					const bool int_encoding = enc != Encoding::Dictionary;
+					if (!(schema_[c].type == DataType::String ? string_encoding : int_encoding)) {
+						throw std::runtime_error("invalid meta data in .columnar file");
+					}
+					meta.columns[c].encoding = enc;
+				}
+				meta.columns[c].uncompressed_size = meta.columns[c].size;
+				if (version_ >= 4) {
+					meta.columns[c].codec = ToCodec(r.Read<std::uint8_t>());
+					meta.columns[c].uncompressed_size = r.Read<std::uint64_t>();
+					if (meta.columns[c].codec == Codec::None && meta.columns[c].uncompressed_size != meta.columns[c].size) {
+						throw std::runtime_error("invalid meta data in .columnar file");
+					}
+				}
+				if (version_ >= 2) {
+					meta.columns[c].stats = ParseStats(r, schema_[c].type);
+				}
+				if (version_ >= 6) {
+					meta.columns[c].bloom_offset = r.Read<std::uint64_t>();
+					meta.columns[c].bloom_size = r.Read<std::uint64_t>();
+				}
+				if (version_ >= 7) {
+					ChunkMeta &ch = meta.columns[c];
+					ch.null_count = r.Read<std::uint32_t>();
+					ch.validity_offset = r.Read<std::uint64_t>();
+					ch.validity_size = r.Read<std::uint64_t>();
+					const bool bitmap = ch.null_count > 0 && ch.null_count < meta.row_count;
+					if (ch.null_count > meta.row_count || (ch.null_count > 0 && !schema_[c].nullable) ||
+					    ch.validity_size != (bitmap ? utils::BitmapWords(meta.row_count) * sizeof(std::uint64_t) : 0) ||
+					    ch.validity_offset % kChunkAlignment != 0) {
+						throw std::runtime_error("invalid meta data in .columnar file");
+					}
+					ch.stats.all_null = meta.row_count > 0 && ch.null_count == meta.row_count;
+				}
 			}
 			batches_.push_back(std::move(meta));
 		}
 
+		sort_by_.clear();
+		keyed_batches_.clear();
+		if (version_ >= 5) {
+			const auto nsort = r.Read<std::uint32_t>();
+			for (std::uint32_t k = 0; k < nsort; ++k) {
+				SortColumn key;
+				key.column = r.Read<std::uint32_t>();
+				key.descending = r.Read<std::uint8_t>() != 0;
+				if (key.column >= ncols) throw std::runtime_error("invalid meta data in .columnar file");
+				sort_by_.push_back(key);
+			}
+			for (std::size_t idx = 0; idx < batches_.size() && !sort_by_.empty(); ++idx) {
+				BatchMeta &meta = batches_[idx];
+				if (meta.row_count == 0) continue;
+				for (const auto &key: sort_by_) {
+					meta.first_key.push_back(ParseKey(r, schema_[key.column].type));
+					meta.last_key.push_back(ParseKey(r, schema_[key.column].type));
+				}
+				keyed_batches_.push_back(idx);
+			}
+		}
+
 		for (const auto &rg: batches_) {
 			for (const auto &ch: rg.columns) {
-				if (ch.offset + ch.size > footer_offset_) {
+				if (ch.offset + ch.size > footer_offset_ || ch.bloom_offset + ch.bloom_size > footer_offset_ ||
+				    ch.validity_offset + ch.validity_size > footer_offset_) {
 					throw std::runtime_error("invalid meta data in .columnar file");
 				}
 			}
 		}
 	}
 
-	Batch ColumnarReader::ReadBatch(std::size_t idx) {
-		const BatchMeta &rg = batches_[idx];
-		const std::size_t ncols = schema_.size();
-		const std::size_t nrows = rg.row_count;
+	ChunkStats ColumnarReader::ParseStats(ByteReader &r, DataType type) {
+		ChunkStats stats;
+		stats.present = true;
+		if (type == DataType::String) {
+			stats.min_str = r.ReadString();
+			stats.max_str = r.ReadString();
+		} else {
+			stats.min_int = r.Read<std::int64_t>();
+			stats.max_int = r.Read<std::int64_t>();
+		}
+		stats.distinct = r.Read<std::uint32_t>();
+		return stats;
+	}
 
-		Batch batch(schema_);
-		batch.Reserve(nrows);
+	KeyValue ColumnarReader::ParseKey(ByteReader &r, DataType type) {
+		if (type == DataType::String) return r.ReadString();
+		return r.Read<std::int64_t>();
+	}
+
+	std::vector<std::size_t> ColumnarReader::CandidateBatches(std::span<const Predicate> conjunction) const {
+		for (const auto &pred: conjunction) {
+			if (pred.column >= schema_.size()) {
+				throw std::runtime_error("columnar: column index out of range: " + std::to_string(pred.column));
+			}
+		}
 
-		for (std::size_t col = 0; col < ncols; ++col) {
-			const auto &cs = schema_[col];
-			const auto &ch = rg.columns[col];
-			utils::Seek(in_, ch.offset);
+		std::vector<std::size_t> out;
+		for (std::size_t idx = 0; idx < batches_.size(); ++idx) {
+			const BatchMeta &rg = batches_[idx];
+			if (rg.row_count == 0) continue;
+			const bool may_match = std::all_of(conjunction.begin(), conjunction.end(), [&](const Predicate &pred) {
+				return MayMatch(rg.columns[pred.column].stats, schema_[pred.column].type, pred);
+			});
+			if (may_match) out.push_back(idx);
+		}
+		return out;
+	}
+
+	std::pair<std::uint64_t, std::uint64_t> ColumnarReader::BatchExtent(std::size_t idx) const {
+		std::uint64_t begin = footer_offset_;
+		std::uint64_t end = 0;
+		for (const auto &ch: batches_[idx].columns) {
+			begin = std::min(begin, ch.offset);
+			end = std::max({end, ch.offset + ch.size, ch.validity_offset + ch.validity_size});
+		}
+		return {begin, std::max(begin, end)};
+	}
 
-			switch (cs.type) {
-				case DataType::Int64: {
-					auto &vec = std::get<std::vector<std::int64_t> >(batch.GetColumn(col));
-					vec.resize(nrows);
-					if (nrows > 0) ReadBytes(in_, vec.data(), nrows * sizeof(std::int64_t));
+	// Short forward steps (consecutive batches, or one reader of several splitting a scan)
+	// switch the mapping to sequential read-ahead and prefetch the next batch; any other jump
+	// switches it to random access so the kernel stops reading ahead.
+	void ColumnarReader::AdviseAccess(std::size_t idx) {
+		// Re-reading the current batch (other columns of it) says nothing about the pattern.
+		if (!map_ || idx == last_batch_) return;
+
+		if (last_batch_ != kNoBatch) {
+			const bool forward = idx > last_batch_ && idx - last_batch_ <= kSequentialStride;
+			const Access access = forward ? Access::Sequential : Access::Random;
+			if (access != access_) {
+				map_->Advise(0, footer_offset_,
+				             access == Access::Sequential ? MappedFile::Advice::Sequential : MappedFile::Advice::Random);
+				access_ = access;
+			}
+		}
+		last_batch_ = idx;
+
+		if (access_ != Access::Random && idx + 1 < batches_.size()) {
+			const auto [begin, end] = BatchExtent(idx + 1);
+			map_->Advise(begin, end - begin, MappedFile::Advice::WillNeed);
+		}
+	}
+
+	void ColumnarReader::ReadAt(std::uint64_t offset, void *dst, std::size_t size) {
+		if (size == 0) return;
+		if (map_) {
+			if (offset + size > map_->Size()) throw std::runtime_error("failed to read from file");
+			std::memcpy(dst, map_->Data() + offset, size);
+			return;
+		}
+		utils::Seek(in_, offset);
+		ReadBytes(in_, dst, size);
+	}
+
+	std::string_view ColumnarReader::StoredBytes(const ChunkMeta &ch, std::string &buf) {
+		if (map_) {
+			if (ch.offset + ch.size > map_->Size()) throw std::runtime_error("failed to read from file");
+			return {map_->Data() + ch.offset, static_cast<std::size_t>(ch.size)};
+		}
+		buf.resize(static_cast<std::size_t>(ch.size));
+		ReadAt(ch.offset, buf.data(), buf.size());
+		return buf;
+	}
+
+	std::string_view ColumnarReader::ChunkBytes(const ChunkMeta &ch, BatchView &view) {
+		if (map_ && ch.codec == Codec::None) {
+			return StoredBytes(ch, scratch_);
+		}
+		const auto size = static_cast<std::size_t>(ch.uncompressed_size);
+		char *buf = view.Allocate(size);
+		if (ch.codec == Codec::None) {
+			ReadAt(ch.offset, buf, size);
+		} else {
+			Decompress(ch.codec, StoredBytes(ch, compressed_), std::span(buf, size));
+		}
+		return {buf, size};
+	}
+
+	std::string_view ColumnarReader::ChunkBytes(const ChunkMeta &ch) {
+		if (ch.codec == Codec::None) {
+			return StoredBytes(ch, scratch_);
+		}
+		scratch_.resize(static_cast<std::size_t>(ch.uncompressed_size));
+		Decompress(ch.codec, StoredBytes(ch, compressed_), scratch_);
+		return scratch_;
+	}
+
+	void ColumnarReader::ReadValidity(const ChunkMeta &ch, std::size_t nrows, std::uint64_t *out) {
+		const std::size_t words = utils::BitmapWords(nrows);
+		if (ch.null_count == nrows) {
+			std::fill_n(out, words, 0);
+		} else if (ch.null_count == 0) {
+			const auto all = utils::AllSet(nrows);
+			std::copy(all.begin(), all.end(), out);
+		} else {
+			ReadAt(ch.validity_offset, out, words * sizeof(std::uint64_t));
+		}
+	}
+
+	std::span<const std::uint64_t> ColumnarReader::ValidityView(const ChunkMeta &ch, std::size_t nrows, BatchView &view) {
+		if (ch.null_count == 0) return {};
+		const std::size_t words = utils::BitmapWords(nrows);
+		if (map_ && ch.null_count < nrows) {
+			if (ch.validity_offset + words * sizeof(std::uint64_t) > map_->Size()) {
+				throw std::runtime_error("failed to read from file");
+			}
+			const auto bytes = view.Aligned({map_->Data() + ch.validity_offset, words * sizeof(std::uint64_t)},
+			                                alignof(std::uint64_t));
+			return {reinterpret_cast<const std::uint64_t *>(bytes.data()), words};
+		}
+		auto *bits = reinterpret_cast<std::uint64_t *>(view.Allocate(words * sizeof(std::uint64_t)));
+		ReadValidity(ch, nrows, bits);
+		return {bits, words};
+	}
+
+	void ColumnarReader::AppendChunk(const ChunkMeta &ch, DataType type, std::size_t nrows, DataVector &out) {
+		// All-null chunks store no data; their rows read as 0 / "".
+		if (ch.null_count != 0 && ch.null_count == nrows) {
+			std::visit([&](auto &vec) {
+				if constexpr (std::is_same_v<std::decay_t<decltype(vec)>, StringColumn>) {
+					auto &offsets = vec.MutableOffsets();
+					offsets.resize(offsets.size() + nrows, offsets.back());
+				} else {
+					vec.resize(vec.size() + nrows);
+				}
+			}, out);
+			return;
+		}
+
+		// Uncompressed chunks are read straight into the column; compressed ones are inflated
+		// into scratch_ first and copied from there.
+		std::string_view inflated;
+		if (ch.codec != Codec::None) inflated = ChunkBytes(ch);
+		const auto read = [&](std::uint64_t pos, void *dst, std::size_t size) {
+			if (ch.codec == Codec::None) {
+				ReadAt(ch.offset + pos, dst, size);
+			} else if (size > 0) {
+				if (pos + size > inflated.size()) throw std::runtime_error("failed to read from file");
+				std::memcpy(dst, inflated.data() + pos, size);
+			}
+		};
+		const auto bytes = [&] { return ch.codec == Codec::None ? ChunkBytes(ch) : inflated; };
+
+		if (type != DataType::String) {
+			std::visit([&](auto &vec) {
+				using Vec = std::decay_t<decltype(vec)>;
+				if constexpr (!std::is_same_v<Vec, StringColumn>) {
+					using T = typename Vec::value_type;
+					const std::size_t base = vec.size();
+					vec.resize(base + nrows);
+					if (ch.encoding == Encoding::Plain) {
+						if (nrows * sizeof(T) > ch.uncompressed_size) {
+							throw std::runtime_error("columnar: corrupted " + ToString(type) + " chunk");
+						}
+						read(0, vec.data() + base, nrows * sizeof(T));
+					} else if constexpr (std::is_same_v<T, std::int64_t>) {
+						DecodeInt64(ch.encoding, bytes(), std::span(vec.data() + base, nrows));
+					} else {
+						wide_.resize(nrows);
+						DecodeInt64(ch.encoding, bytes(), wide_);
+						std::copy(wide_.begin(), wide_.end(), vec.begin() + base);
+					}
+				}
+			}, out);
+			return;
+		}
+
+		switch (type) {
+			case DataType::String: {
+				auto &vec = std::get<StringColumn>(out);
+				if (ch.encoding == Encoding::Dictionary) {
+					DecodeStringDictionary(bytes(), nrows, dict_);
+					std::size_t total = 0;
+					for (const auto code: dict_.codes) total += dict_.values.Length(code);
+					vec.reserve(vec.size() + nrows, vec.DataSize() + total);
+					for (const auto code: dict_.codes) vec.push_back(dict_.values[code]);
 					break;
 				}
-				case DataType::String: {
-					auto &vec = std::get<std::vector<std::string> >(batch.GetColumn(col));
-					vec.resize(nrows);
 
-					std::vector<std::uint32_t> lens(nrows);
-					if (nrows > 0) ReadBytes(in_, lens.data(), nrows * sizeof(std::uint32_t));
+				const std::size_t lens_size = nrows * sizeof(std::uint32_t);
+				if (lens_size > ch.uncompressed_size) {
+					throw std::runtime_error("columnar: corrupted string chunk");
+				}
+				auto &offsets = vec.MutableOffsets();
+				const std::size_t base = offsets.size() - 1;
+				offsets.resize(base + nrows + 1);
 
-					std::uint64_t total = 0;
-					for (auto l: lens) total += l;
+				// The uint32 lens land in the front half of the new offsets slots and are widened
+				// back to front in place, so no temporary lens buffer is needed.
+				auto *raw = reinterpret_cast<char *>(offsets.data() + base + 1);
+				read(0, raw, lens_size);
+				for (std::size_t i = nrows; i-- > 0;) {
+					std::uint32_t len;
+					std::memcpy(&len, raw + i * sizeof(std::uint32_t), sizeof(len));
+					offsets[base + 1 + i] = len;
+				}
+				for (std::size_t i = base + 1; i <= base + nrows; ++i) {
+					offsets[i] += offsets[i - 1];
+				}
 
-					std::string blob;
-					blob.resize(static_cast<std::size_t>(total));
-					if (total > 0) ReadBytes(in_, blob.data(), static_cast<std::size_t>(total));
+				const std::uint64_t total = offsets[base + nrows] - offsets[base];
+				if (lens_size + total > ch.uncompressed_size) {
+					throw std::runtime_error("columnar: corrupted string chunk");
+				}
 
-					std::size_t pos = 0;
-					for (std::size_t i = 0; i < nrows; ++i) {
-						const std::size_t l = lens[i];
-						if (pos + l > blob.size()) throw std::runtime_error("columnar: corrupted string chunk");
-						vec[i] = blob.substr(pos, l);
-						pos += l;
+				auto &data = vec.MutableData();
+				const std::size_t data_base = data.size();
+				data.resize(data_base + static_cast<std::size_t>(total));
+				read(lens_size, data.data() + data_base, static_cast<std::size_t>(total));
+				break;
+			}
+			default:
+				throw std::runtime_error("columnar: unsupported DataType");
+		}
+	}
+
+	std::size_t ColumnarReader::ColumnIndex(std::string_view name) const {
+		for (std::size_t i = 0; i < schema_.size(); ++i) {
+			if (schema_[i].name == name) return i;
+		}
+		throw std::runtime_error("columnar: no such column: '" + std::string(name) + "'");
+	}
+
+	std::vector<std::size_t> ColumnarReader::AllColumns() const {
+		std::vector<std::size_t> cols(schema_.size());
+		for (std::size_t i = 0; i < cols.size(); ++i) cols[i] = i;
+		return cols;
+	}
+
+	Schema ColumnarReader::ProjectSchema(std::span<const std::size_t> cols) const {
+		Schema projected;
+		projected.reserve(cols.size());
+		for (const std::size_t c: cols) {
+			if (c >= schema_.size()) {
+				throw std::runtime_error("columnar: column index out of range: " + std::to_string(c));
+			}
+			projected.push_back(schema_[c]);
+		}
+		return projected;
+	}
+
+	BatchView ColumnarReader::ReadBatchView(std::size_t idx) {
+		const auto all = AllColumns();
+		return ReadBatchView(idx, all);
+	}
+
+	BatchView ColumnarReader::ReadBatchView(std::size_t idx, std::span<const std::size_t> cols) {
+		const BatchMeta &rg = batches_[idx];
+		const std::size_t nrows = rg.row_count;
+		AdviseAccess(idx);
+
+		BatchView view(ProjectSchema(cols), nrows);
+		for (const std::size_t col: cols) {
+			const ChunkMeta &ch = rg.columns[col];
+			const auto valid = ValidityView(ch, nrows, view);
+			if (ch.null_count != 0 && ch.null_count == nrows) {
+				// All-null chunks store no data; their rows read as 0 / "".
+				char *zeros = view.Allocate(nrows * sizeof(std::int64_t));
+				std::memset(zeros, 0, nrows * sizeof(std::int64_t));
+				if (schema_[col].type == DataType::String) {
+					view.AddColumn(StringChunkView({reinterpret_cast<const std::uint32_t *>(zeros), nrows}, {}), valid);
+				} else {
+					utils::VisitIntegerType(schema_[col].type, [&](auto t) {
+						view.AddColumn(std::span(reinterpret_cast<const decltype(t) *>(zeros), nrows), valid);
+					});
+				}
+				continue;
+			}
+			if (utils::IsInteger(schema_[col].type)) {
+				utils::VisitIntegerType(schema_[col].type, [&](auto t) {
+					using T = decltype(t);
+					if (ch.encoding == Encoding::Plain) {
+						const std::string_view bytes = ChunkBytes(ch, view);
+						if (bytes.size() < nrows * sizeof(T)) {
+							throw std::runtime_error("columnar: corrupted " + ToString(schema_[col].type) + " chunk");
+						}
+						const auto aligned = view.Aligned(bytes.substr(0, nrows * sizeof(T)), alignof(T));
+						view.AddColumn(std::span(reinterpret_cast<const T *>(aligned.data()), nrows), valid);
+						return;
 					}
-					break;
+					auto *values = reinterpret_cast<T *>(view.Allocate(nrows * sizeof(T)));
+					if constexpr (std::is_same_v<T, std::int64_t>) {
+						DecodeInt64(ch.encoding, ChunkBytes(ch), std::span(values, nrows));
+					} else {
+						wide_.resize(nrows);
+						DecodeInt64(ch.encoding, ChunkBytes(ch), wide_);
+						std::copy(wide_.begin(), wide_.end(), values);
+					}
+					view.AddColumn(std::span<const T>(values, nrows), valid);
+				});
+				continue;
+			}
+			if (ch.encoding == Encoding::Dictionary) {
+				DecodeStringDictionary(ChunkBytes(ch), nrows, dict_);
+				auto *lens = reinterpret_cast<std::uint32_t *>(view.Allocate(nrows * sizeof(std::uint32_t)));
+				std::size_t total = 0;
+				for (std::size_t i = 0; i < nrows; ++i) {
+					lens[i] = static_cast<std::uint32_t>(dict_.values.Length(dict_.codes[i]));
+					total += lens[i];
+				}
+				char *data = view.Allocate(total);
+				char *p = data;
+				for (const auto code: dict_.codes) {
+					const std::string_view v = dict_.values[code];
+					std::memcpy(p, v.data(), v.size());
+					p += v.size();
 				}
-				default:
-					throw std::runtime_error("columnar: unsupported DataType");
+				view.AddColumn(StringChunkView(std::span<const std::uint32_t>(lens, nrows), std::string_view(data, total)), valid);
+				continue;
+			}
+			const std::string_view bytes = ChunkBytes(ch, view);
+			const std::size_t lens_size = nrows * sizeof(std::uint32_t);
+			if (bytes.size() < lens_size) {
+				throw std::runtime_error("columnar: corrupted string chunk");
+			}
+			const auto lens = view.Aligned(bytes.substr(0, lens_size), alignof(std::uint32_t));
+			std::span<const std::uint32_t> len_span(reinterpret_cast<const std::uint32_t *>(lens.data()), nrows);
+
+			std::uint64_t total = 0;
+			for (const auto l: len_span) total += l;
+			if (lens_size + total > bytes.size()) {
+				throw std::runtime_error("columnar: corrupted string chunk");
 			}
+			view.AddColumn(StringChunkView(len_span, bytes.substr(lens_size, static_cast<std::size_t>(total))), valid);
 		}
+		return view;
+	}
+
+	Batch ColumnarReader::ReadBatch(std::size_t idx) {
+		const auto all = AllColumns();
+		return ReadBatch(idx, all);
+	}
+
+	Batch ColumnarReader::ReadBatch(std::size_t idx, std::span<const std::size_t> cols) {
+		const BatchMeta &rg = batches_[idx];
+		const std::size_t nrows = rg.row_count;
+		AdviseAccess(idx);
 
+		Batch batch(ProjectSchema(cols));
+		batch.Reserve(nrows);
+		for (std::size_t i = 0; i < cols.size(); ++i) {
+			const ChunkMeta &ch = rg.columns[cols[i]];
+			AppendChunk(ch, schema_[cols[i]].type, nrows, batch.GetColumn(i));
+			if (ch.null_count > 0) {
+				batch.GetValidity(i).resize(utils::BitmapWords(nrows));
+				ReadValidity(ch, nrows, batch.GetValidity(i).data());
+			}
+		}
 		batch.SetRowCount(nrows);
 		return batch;
 	}
+
+	std::optional<StringDictionary> ColumnarReader::ReadDictionary(std::size_t idx, std::size_t col) {
+		if (col >= schema_.size()) {
+			throw std::runtime_error("columnar: column index out of range: " + std::to_string(col));
+		}
+		const ChunkMeta &ch = batches_[idx].columns[col];
+		if (ch.encoding != Encoding::Dictionary) return std::nullopt;
+
+		AdviseAccess(idx);
+		StringDictionary dict;
+		DecodeStringDictionary(ChunkBytes(ch), batches_[idx].row_count, dict);
+		return dict;
+	}
+
+	bool ColumnarReader::MayContain(std::size_t idx, std::size_t col, const KeyValue &value) {
+		if (col >= schema_.size()) {
+			throw std::runtime_error("columnar: column index out of range: " + std::to_string(col));
+		}
+		if (std::holds_alternative<std::string>(value) != (schema_[col].type == DataType::String)) {
+			throw std::runtime_error("columnar: lookup value does not match the type of column '" + schema_[col].name + "'");
+		}
+		const ChunkMeta &ch = batches_[idx].columns[col];
+		if (ch.bloom_size == 0) return true;
+
+		std::string_view filter;
+		std::string buf;
+		if (map_) {
+			filter = {map_->Data() + ch.bloom_offset, static_cast<std::size_t>(ch.bloom_size)};
+		} else {
+			buf.resize(static_cast<std::size_t>(ch.bloom_size));
+			ReadAt(ch.bloom_offset, buf.data(), buf.size());
+			filter = buf;
+		}
+		const std::uint64_t hash = std::visit([](const auto &v) {
+			if constexpr (std::is_same_v<std::decay_t<decltype(v)>, std::string>) return BloomHash(std::string_view(v));
+			else return BloomHash(v);
+		}, value);
+		return BloomMayContain(filter, hash);
+	}
+
+	std::vector<std::uint64_t> ColumnarReader::ReadValidity(std::size_t idx, std::size_t col) {
+		if (col >= schema_.size()) {
+			throw std::runtime_error("columnar: column index out of range: " + std::to_string(col));
+		}
+		const ChunkMeta &ch = batches_[idx].columns[col];
+		std::vector<std::uint64_t> bits;
+		if (ch.null_count == 0) return bits;
+		bits.resize(utils::BitmapWords(batches_[idx].row_count));
+		ReadValidity(ch, batches_[idx].row_count, bits.data());
+		return bits;
+	}
+
+	DataVector ColumnarReader::ReadColumn(std::size_t col, std::vector<std::uint64_t> *validity) {
+		if (col >= schema_.size()) {
+			throw std::runtime_error("columnar: column index out of range: " + std::to_string(col));
+		}
+
+		std::uint64_t rows = 0;
+		std::uint64_t bytes = 0;
+		for (const auto &rg: batches_) {
+			rows += rg.row_count;
+			bytes += rg.columns[col].uncompressed_size;
+		}
+
+		DataVector out = utils::MakeColumn(schema_[col].type);
+		if (auto *strings = std::get_if<StringColumn>(&out)) {
+			strings->reserve(static_cast<std::size_t>(rows), static_cast<std::size_t>(bytes - std::min(bytes, rows * 4)));
+		} else {
+			std::visit([&](auto &vec) { vec.reserve(static_cast<std::size_t>(rows)); }, out);
+		}
+
+		if (validity) validity->clear();
+		std::vector<std::uint64_t> bits;
+		std::size_t done = 0;
+		for (std::size_t idx = 0; idx < batches_.size(); ++idx) {
+			AdviseAccess(idx);
+			const ChunkMeta &ch = batches_[idx].columns[col];
+			const std::size_t nrows = batches_[idx].row_count;
+			AppendChunk(ch, schema_[col].type, nrows, out);
+			if (validity && (ch.null_count > 0 || !validity->empty())) {
+				if (validity->empty()) *validity = utils::AllSet(done);
+				bits.resize(utils::BitmapWords(nrows));
+				ReadValidity(ch, nrows, bits.data());
+				utils::AppendBits(*validity, done, bits.data(), 0, nrows);
+			}
+			done += nrows;
+		}
+		return out;
+	}
+
+	Batch ColumnarReader::Range(const KeyValue &lo, const KeyValue &hi, std::span<const std::size_t> cols) {
+		if (sort_by_.empty()) throw std::runtime_error("columnar: file has no sort order");
+		const SortColumn lead = sort_by_.front();
+		const bool is_string = schema_[lead.column].type == DataType::String;
+		if (std::holds_alternative<std::string>(lo) != is_string || std::holds_alternative<std::string>(hi) != is_string) {
+			throw std::runtime_error("columnar: range bounds do not match the type of column '" +
+			                         schema_[lead.column].name + "'");
+		}
+
+		Batch out(ProjectSchema(cols));
+		if (hi < lo) return out;
+
+		// In file order, the rows in range run from the first one not before `start` to the
+		// last one not after `end`.
+		const KeyValue &start = lead.descending ? hi : lo;
+		const KeyValue &end = lead.descending ? lo : hi;
+		const auto before = [&](const KeyValue &a, const KeyValue &b) { return lead.descending ? b < a : a < b; };
+
+		auto it = std::ranges::partition_point(keyed_batches_, [&](std::size_t idx) {
+			return before(batches_[idx].last_key[0], start);
+		});
+		for (; it != keyed_batches_.end() && !before(end, batches_[*it].first_key[0]); ++it) {
+			const BatchMeta &meta = batches_[*it];
+			std::size_t first = 0;
+			std::size_t last = meta.row_count;
+			if (before(meta.first_key[0], start) || before(end, meta.last_key[0])) {
+				const std::size_t key_col[] = {lead.column};
+				const Batch keys = ReadBatch(*it, key_col);
+				const DataVector &column = keys.GetColumn(0);
+				// Row value against `key` in file order.
+				const auto compare = [&](std::size_t row, const KeyValue &key) {
+					const int c = std::visit([&](const auto &values) {
+						if constexpr (std::is_same_v<std::decay_t<decltype(values)>, StringColumn>) {
+							const int r = values[row].compare(std::get<std::string>(key));
+							return (r > 0) - (r < 0);
+						} else {
+							const std::int64_t v = values[row];
+							const std::int64_t k = std::get<std::int64_t>(key);
+							return (v > k) - (v < k);
+						}
+					}, column);
+					return lead.descending ? -c : c;
+				};
+				const auto rows = std::views::iota(std::size_t{0}, std::size_t{meta.row_count});
+				first = *std::ranges::partition_point(rows, [&](std::size_t row) { return compare(row, start) < 0; });
+				last = *std::ranges::partition_point(rows, [&](std::size_t row) { return compare(row, end) <= 0; });
+			}
+			if (first < last) out.AppendRows(ReadBatch(*it, cols), first, last - first);
+		}
+		return out;
+	}
+
+	Batch ColumnarReader::Range(const KeyValue &lo, const KeyValue &hi) {
+		const auto all = AllColumns();
+		return Range(lo, hi, all);
+	}
+
+	Batch ColumnarReader::Lookup(const KeyValue &key, std::span<const std::size_t> cols) {
+		return Range(key, key, cols);
+	}
+
+	Batch ColumnarReader::Lookup(const KeyValue &key) {
+		return Range(key, key);
+	}
+
+	Batch ColumnarReader::Lookup(const SecondaryIndex &index, const KeyValue &key, std::span<const std::size_t> cols) {
+		if (!index.Matches(*this)) {
+			throw std::runtime_error("columnar: index on column '" + index.GetColumnSchema().name +
+			                         "' is stale; rebuild it");
+		}
+		const std::vector<RowLocation> rows = index.Find(key);
+		return ReadRows(rows, cols);
+	}
+
+	Batch ColumnarReader::ReadRows(std::span<const RowLocation> rows, std::span<const std::size_t> cols) {
+		Batch out(ProjectSchema(cols));
+		std::optional<Batch> batch;
+		std::size_t loaded = kNoBatch;
+		for (std::size_t i = 0; i < rows.size(); ++i) {
+			const RowLocation loc = rows[i];
+			if (loc.batch >= batches_.size() || loc.row >= batches_[loc.batch].row_count) {
+				throw std::runtime_error("columnar: row location out of range");
+			}
+			if (loc.batch != loaded) {
+				batch = ReadBatch(loc.batch, cols);
+				loaded = loc.batch;
+			}
+			out.AppendRows(*batch, loc.row, 1);
+		}
+		return out;
+	}
 }
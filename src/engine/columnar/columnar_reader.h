@@ -4,33 +4,154 @@
 #include <cstdint>
 #include <filesystem>
 #include <fstream>
+#include <memory>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <utility>
 #include <vector>
 
 #include "schema.h"
+#include "batch_view.h"
+#include "chunk_stats.h"
 #include "columnar_format.h"
+#include "mapped_file.h"
 
 class Batch;
 
 namespace columnar {
 
+	class ByteReader;
+	class SecondaryIndex;
+	struct RowLocation;
+
+	enum class ReadMode : std::uint8_t {
+		// std::ifstream; every ReadBatch seeks and reads into fresh buffers.
+		Stream = 0,
+		// The file is mapped once; ReadBatchView returns views straight into the mapping.
+		Mapped = 1,
+	};
+
 	class ColumnarReader {
 	public:
-		explicit ColumnarReader(const std::filesystem::path& path);
+		explicit ColumnarReader(const std::filesystem::path& path, ReadMode mode = ReadMode::Stream);
 
 		const Schema& GetSchema() const { return schema_; }
 		std::size_t NumBatches() const { return batches_.size(); }
 		const BatchMeta& GetBatchMeta(std::size_t idx) const { return batches_[idx]; }
+		ReadMode Mode() const { return mode_; }
+		std::uint32_t Version() const { return version_; }
+		std::uint64_t FileSize() const { return file_size_; }
+		std::uint64_t FooterOffset() const { return footer_offset_; }
+
+		// Throws if no column has this name.
+		std::size_t ColumnIndex(std::string_view name) const;
+		std::vector<std::size_t> AllColumns() const;
+		Schema ProjectSchema(std::span<const std::size_t> cols) const;
 
 		Batch ReadBatch(std::size_t idx);
+		// Reads only the chunks of `cols`; the result's schema is those columns, in that order.
+		Batch ReadBatch(std::size_t idx, std::span<const std::size_t> cols);
+
+		// Zero-copy in Mapped mode for plain chunks (except chunks of old files that are not
+		// 8-byte aligned); encoded chunks are decoded into buffers owned by the view, as are
+		// all chunks in Stream mode.
+		BatchView ReadBatchView(std::size_t idx);
+		BatchView ReadBatchView(std::size_t idx, std::span<const std::size_t> cols);
+
+		// Dictionary and codes of a Dictionary-encoded string chunk, without materializing
+		// the strings; nullopt for chunks with any other encoding.
+		std::optional<StringDictionary> ReadDictionary(std::size_t idx, std::size_t col);
+
+		// Indices of the batches whose chunk stats allow a row satisfying every predicate;
+		// the others are skipped without any data I/O. Files without stats (version 1)
+		// return every non-empty batch.
+		std::vector<std::size_t> CandidateBatches(std::span<const Predicate> conjunction) const;
+
+		// False only when the Bloom filter of chunk (idx, col) shows no row equals `value`;
+		// true for chunks without a filter. Reads the filter, never the chunk.
+		bool MayContain(std::size_t idx, std::size_t col, const KeyValue& value);
+
+		// Batch::Validity of chunk (idx, col); empty when it has no nulls.
+		std::vector<std::uint64_t> ReadValidity(std::size_t idx, std::size_t col);
+
+		// One column across all batches, in a single contiguous buffer. `validity`, if given,
+		// receives the column's Batch::Validity over all those rows.
+		DataVector ReadColumn(std::size_t col, std::vector<std::uint64_t>* validity = nullptr);
+
+		// Declared sort order (format version 5+); empty when the file has none.
+		const std::vector<SortColumn>& SortOrder() const { return sort_by_; }
+
+		// Rows whose leading sort column lies in [lo, hi], in file order, with the columns
+		// `cols`. The batches that can hold them are found by binary search over the footer's
+		// first/last keys, and rows within the boundary batches by binary search over their
+		// key chunk. Throws if the file has no sort order or the bounds do not match the
+		// column type.
+		Batch Range(const KeyValue& lo, const KeyValue& hi, std::span<const std::size_t> cols);
+		Batch Range(const KeyValue& lo, const KeyValue& hi);
+		// Range(key, key).
+		Batch Lookup(const KeyValue& key, std::span<const std::size_t> cols);
+		Batch Lookup(const KeyValue& key);
+
+		// Rows equal to `key` in the index's column, found through a secondary index of this
+		// file; the file need not be sorted. Throws if the index is stale.
+		Batch Lookup(const SecondaryIndex& index, const KeyValue& key, std::span<const std::size_t> cols);
+
+		// The rows at `rows`, in that order, with the columns `cols`. Each batch involved is
+		// read once.
+		Batch ReadRows(std::span<const RowLocation> rows, std::span<const std::size_t> cols);
 
 	private:
+		enum class Access : std::uint8_t {
+			Unknown,
+			Sequential,
+			Random,
+		};
+
+		static constexpr std::size_t kNoBatch = static_cast<std::size_t>(-1);
+		static constexpr std::size_t kSequentialStride = 16;
+
+		ReadMode mode_;
+		std::uint32_t version_ = 0;
 		std::ifstream in_;
+		std::unique_ptr<MappedFile> map_;
 		Schema schema_;
 		std::vector<BatchMeta> batches_;
+		std::vector<SortColumn> sort_by_;
+		// Non-empty batches, the ones with first/last keys, when the file has a sort order.
+		std::vector<std::size_t> keyed_batches_;
 		std::uint64_t footer_offset_ = 0;
+		std::uint64_t file_size_ = 0;
+		std::string scratch_;
+		std::string compressed_;
+		StringDictionary dict_;
+		// Decoded values of an encoded chunk narrower than int64.
+		std::vector<std::int64_t> wide_;
+
+		std::size_t last_batch_ = kNoBatch;
+		Access access_ = Access::Unknown;
 
 		void ReadHeader();
 		void ReadFooter();
+		void ParseHeader(std::string_view bytes);
+		void ParseFooter(std::string_view bytes);
+		static ChunkStats ParseStats(ByteReader& r, DataType type);
+		static KeyValue ParseKey(ByteReader& r, DataType type);
+
+		std::pair<std::uint64_t, std::uint64_t> BatchExtent(std::size_t idx) const;
+		void AdviseAccess(std::size_t idx);
+		void ReadAt(std::uint64_t offset, void* dst, std::size_t size);
+		// Stored (possibly compressed) chunk bytes: in the mapping, or read into `buf`.
+		std::string_view StoredBytes(const ChunkMeta& ch, std::string& buf);
+		// Uncompressed chunk bytes: in the mapping, or in view-owned storage / scratch_.
+		std::string_view ChunkBytes(const ChunkMeta& ch, BatchView& view);
+		std::string_view ChunkBytes(const ChunkMeta& ch);
+		void AppendChunk(const ChunkMeta& ch, DataType type, std::size_t nrows, DataVector& out);
+		// Writes the chunk's validity bitmap, all set or all clear when it stores none, to `out`.
+		void ReadValidity(const ChunkMeta& ch, std::size_t nrows, std::uint64_t* out);
+		// The chunk's validity for a view: in the mapping when stored, else view-owned.
+		std::span<const std::uint64_t> ValidityView(const ChunkMeta& ch, std::size_t nrows, BatchView& view);
 	};
 
 }
@@ -1,158 +1,545 @@
 #include "columnar_writer.h"
 
+#include <fcntl.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <bit>
+#include <cerrno>
+#include <climits>
+#include <cstring>
+#include <future>
 #include <limits>
+#include <optional>
+#include <span>
 #include <stdexcept>
+#include <string_view>
+#include <type_traits>
 
 #include "batch.h"
+#include "bloom_filter.h"
+#include "byte_io.h"
+#include "columnar_reader.h"
 #include "utils/utils.h"
 
-template<class T>
-void WriteObj(std::ofstream &out, const T &v) {
-	out.write(reinterpret_cast<const char *>(&v), sizeof(T));
-	if (!out) {
-		throw std::runtime_error("failed to write to file");
+namespace {
+	// header: magic(4) + version(4) + footer_offset(8)
+	constexpr std::uint64_t kVersionPosInHeader = 4;
+
+	constexpr char kZeros[columnar::kChunkAlignment] = {};
+
+	// Writes all of `iov` at `offset`, resuming after short writes.
+	void PWriteAll(int fd, std::vector<iovec> &iov, std::uint64_t offset) {
+		std::size_t first = 0;
+		while (first < iov.size()) {
+			if (iov[first].iov_len == 0) {
+				++first;
+				continue;
+			}
+			const int count = static_cast<int>(std::min<std::size_t>(iov.size() - first, IOV_MAX));
+			const ssize_t n = ::pwritev(fd, iov.data() + first, count, static_cast<off_t>(offset));
+			if (n < 0 && errno == EINTR) continue;
+			if (n <= 0) throw std::runtime_error("failed to write to file");
+
+			offset += static_cast<std::uint64_t>(n);
+			auto left = static_cast<std::size_t>(n);
+			while (left > 0) {
+				if (left >= iov[first].iov_len) {
+					left -= iov[first].iov_len;
+					++first;
+				} else {
+					iov[first].iov_base = static_cast<char *>(iov[first].iov_base) + left;
+					iov[first].iov_len -= left;
+					left = 0;
+				}
+			}
+		}
 	}
-}
 
-void WriteBytes(std::ofstream &out, const void *data, std::size_t size) {
-	out.write(reinterpret_cast<const char *>(data), static_cast<std::streamsize>(size));
-	if (!out) {
-		throw std::runtime_error("failed to write to file");
+	void PWriteAll(int fd, std::string_view bytes, std::uint64_t offset) {
+		std::vector<iovec> iov{{const_cast<char *>(bytes.data()), bytes.size()}};
+		PWriteAll(fd, iov, offset);
 	}
-}
 
-std::uint64_t Position(std::ofstream &out) {
-	return out.tellp();
-}
+	template<class T>
+	void EncodeInts(const std::vector<T> &values, columnar::ChunkMeta &meta, std::string &out) {
+		using namespace columnar;
+		meta.stats = ComputeStats(std::span<const T>(values));
+		if constexpr (std::is_same_v<T, std::int64_t>) {
+			meta.encoding = ChooseInt64Encoding(values, meta.stats);
+			EncodeInt64(values, meta.encoding, meta.stats, out);
+		} else {
+			// Narrower values go through the Int64 encoders but are stored plain at their own
+			// width unless an encoding beats that.
+			const std::vector<std::int64_t> wide(values.begin(), values.end());
+			const std::size_t base = out.size();
+			meta.encoding = ChooseInt64Encoding(wide, meta.stats);
+			if (meta.encoding != Encoding::Plain) {
+				EncodeInt64(wide, meta.encoding, meta.stats, out);
+				if (out.size() - base < values.size() * sizeof(T)) return;
+				out.resize(base);
+				meta.encoding = Encoding::Plain;
+			}
+			out.append(reinterpret_cast<const char *>(values.data()), values.size() * sizeof(T));
+		}
+	}
+
+	// Computes the chunk stats, picks an encoding and appends the encoded chunk to `out`.
+	void EncodeChunk(const DataVector &column, DataType type, columnar::ChunkMeta &meta, std::string &out) {
+		using namespace columnar;
+		if (column.index() != utils::MakeColumn(type).index()) {
+			throw std::runtime_error("columnar: column does not match its DataType");
+		}
+		if (type != DataType::String) {
+			std::visit([&](const auto &values) {
+				if constexpr (!std::is_same_v<std::decay_t<decltype(values)>, StringColumn>) EncodeInts(values, meta, out);
+			}, column);
+			return;
+		}
+
+		const auto &vec = std::get<StringColumn>(column);
+		meta.stats = ComputeStats(vec);
+		if (EncodeStringDictionary(vec, meta.stats, out)) {
+			meta.encoding = Encoding::Dictionary;
+			return;
+		}
+
+		meta.encoding = Encoding::Plain;
+		const std::size_t base = out.size();
+		out.resize(base + vec.size() * sizeof(std::uint32_t));
+		char *lens = out.data() + base;
+		for (std::size_t i = 0; i < vec.size(); ++i) {
+			const std::size_t len = vec.Length(i);
+			if (len > std::numeric_limits<std::uint32_t>::max()) {
+				throw std::runtime_error("columnar: string value too long");
+			}
+			const auto len32 = static_cast<std::uint32_t>(len);
+			std::memcpy(lens + i * sizeof(len32), &len32, sizeof(len32));
+		}
+		out.append(vec.Data());
+	}
+
+	// EncodeChunk plus compression with `codec`; incompressible chunks are stored as they are.
+	void BuildChunk(const DataVector &column, DataType type, columnar::Codec codec, columnar::ChunkMeta &meta,
+	                std::string &chunk) {
+		EncodeChunk(column, type, meta, chunk);
+		meta.uncompressed_size = chunk.size();
+
+		if (codec != columnar::Codec::None && !chunk.empty()) {
+			std::string compressed;
+			columnar::Compress(codec, chunk, compressed);
+			if (compressed.size() < chunk.size()) {
+				meta.codec = codec;
+				chunk.swap(compressed);
+			}
+		}
+		meta.size = chunk.size();
+	}
+
+	// Copy of `column` whose null rows hold its first non-null value, which leaves the stats,
+	// the encoding choice and the Bloom filter as they would be for the non-null values alone.
+	DataVector FillNulls(const DataVector &column, const Batch::Validity &valid) {
+		std::size_t first = 0;
+		while (!utils::GetBit(valid.data(), first)) ++first;
+		DataVector out = column;
+		std::visit([&](auto &values) {
+			using Vec = std::decay_t<decltype(values)>;
+			if constexpr (std::is_same_v<Vec, StringColumn>) {
+				const std::string_view fill = values[first];
+				StringColumn filled;
+				for (std::size_t i = 0; i < values.size(); ++i) {
+					filled.push_back(utils::GetBit(valid.data(), i) ? values[i] : fill);
+				}
+				values = std::move(filled);
+			} else {
+				const auto fill = values[first];
+				for (std::size_t w = 0; w < valid.size(); ++w) {
+					for (std::uint64_t nulls = ~valid[w]; nulls != 0; nulls &= nulls - 1) {
+						const std::size_t i = w * 64 + static_cast<std::size_t>(std::countr_zero(nulls));
+						if (i >= values.size()) break;
+						values[i] = fill;
+					}
+				}
+			}
+		}, out);
+		return out;
+	}
+
+	columnar::KeyValue ValueAt(const DataVector &column, std::size_t row) {
+		return std::visit([row](const auto &values) -> columnar::KeyValue {
+			if constexpr (std::is_same_v<std::decay_t<decltype(values)>, StringColumn>) return std::string(values[row]);
+			else return std::int64_t{values[row]};
+		}, column);
+	}
+
+	int CompareRows(const DataVector &column, std::size_t a, std::size_t b) {
+		return std::visit([a, b](const auto &values) {
+			if constexpr (std::is_same_v<std::decay_t<decltype(values)>, StringColumn>) {
+				const int c = values[a].compare(values[b]);
+				return (c > 0) - (c < 0);
+			} else {
+				return (values[a] > values[b]) - (values[a] < values[b]);
+			}
+		}, column);
+	}
+
+	void CheckSorted(const Batch &batch, std::span<const columnar::SortColumn> order) {
+		for (std::size_t row = 1; row < batch.RowCount(); ++row) {
+			for (const auto &key: order) {
+				const int c = CompareRows(batch.GetColumn(key.column), row - 1, row);
+				if (c == 0) continue;
+				if ((c > 0) != key.descending) {
+					throw std::runtime_error("columnar: rows are not in the declared sort order");
+				}
+				break;
+			}
+		}
+	}
 
-void WriteString(std::ofstream &out, const std::string &s) {
-	const auto len = static_cast<std::uint32_t>(s.size());
-	WriteObj(out, len);
-	WriteBytes(out, s.data(), s.size());
+	// True if key `a` sorts after key `b` in `order`.
+	bool KeyAfter(const std::vector<columnar::KeyValue> &a, const std::vector<columnar::KeyValue> &b,
+	              std::span<const columnar::SortColumn> order) {
+		for (std::size_t k = 0; k < order.size(); ++k) {
+			if (a[k] == b[k]) continue;
+			return (a[k] > b[k]) != order[k].descending;
+		}
+		return false;
+	}
+
+	void WriteKey(columnar::ByteWriter &w, const columnar::KeyValue &key) {
+		if (const auto *v = std::get_if<std::int64_t>(&key)) w.Write(*v);
+		else w.WriteString(std::get<std::string>(key));
+	}
+
+	void WriteStats(columnar::ByteWriter &w, const columnar::ChunkStats &stats, DataType type) {
+		if (type == DataType::String) {
+			w.WriteString(stats.min_str);
+			w.WriteString(stats.max_str);
+		} else {
+			w.Write(stats.min_int);
+			w.Write(stats.max_int);
+		}
+		w.Write(stats.distinct);
+	}
 }
 
 
 namespace columnar {
-	ColumnarWriter::ColumnarWriter(const std::filesystem::path &path, const Schema &schema)
-		: out_(path, std::ios::binary | std::ios::trunc)
-		  , schema_(schema) {
-		if (!out_.is_open()) {
-			throw std::runtime_error("failed to open file for writing: " + path.string());
-		}
+	ColumnarWriter::ColumnarWriter(const std::filesystem::path &path, const Schema &schema, WriterOptions options)
+		: schema_(schema)
+		  , options_(options) {
 		if (schema_.empty()) {
 			throw std::runtime_error("columnar: invalid schema");
 		}
-		WriteHeader();
+		if (!CodecAvailable(options_.codec)) {
+			throw std::runtime_error(std::string("columnar: codec '") + CodecName(options_.codec) + "' is not available in this build");
+		}
+		if (options_.append) {
+			OpenForAppend(path);
+		} else {
+			fd_ = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0666);
+			if (fd_ < 0) {
+				throw std::runtime_error("failed to open file for writing: " + path.string());
+			}
+			WriteHeader();
+		}
+		for (const auto &key: options_.sort_by) {
+			if (key.column >= schema_.size()) throw std::runtime_error("columnar: sort column out of range");
+		}
+		bloom_.assign(schema_.size(), false);
+		for (const auto col: options_.bloom_columns) {
+			if (col >= schema_.size()) throw std::runtime_error("columnar: Bloom filter column out of range");
+			bloom_[col] = true;
+		}
+		if (options_.encode_threads > 1 && schema_.size() > 1) {
+			pool_ = std::make_unique<utils::ThreadPool>(std::min(options_.encode_threads, schema_.size()));
+		}
 	}
 
 	ColumnarWriter::~ColumnarWriter() {
-		if (!finalized_) {
+		// An append that is never finished is dropped: the file is cut back to its old end.
+		if (!finalized_ && options_.append) {
+			[[maybe_unused]] const int rc = ::ftruncate(fd_, static_cast<off_t>(append_from_));
+		} else if (!finalized_) {
 			Finish();
 		}
+		::close(fd_);
 	}
 
 	void ColumnarWriter::WriteHeader() {
+		std::string header;
+		ByteWriter w(header);
 		const char magic[4] = {'C', 'D', 'B', '1'};
-		WriteBytes(out_, magic, sizeof(magic));
-		WriteObj(out_, kColumnarVersion);
-		WriteObj(out_, static_cast<std::uint64_t>(0));
+		w.WriteBytes(magic, sizeof(magic));
+		w.Write(kColumnarVersion);
+		w.Write(static_cast<std::uint64_t>(0));
+		PWriteAll(fd_, header, 0);
+		end_ = header.size();
 	}
 
-	void ColumnarWriter::WriteBatch(const Batch &batch) {
-		if (finalized_) {
-			throw std::runtime_error("columnar: cannot write row group after Finalize()");
+	void ColumnarWriter::OpenForAppend(const std::filesystem::path &path) {
+		ColumnarReader reader(path);
+		// Version 1 footers have no chunk stats, which a current footer cannot leave out.
+		if (reader.Version() < 2) throw std::runtime_error("columnar: cannot append to a version 1 file");
+		// A declared integer type may be wider than the stored one, as after narrowing; the
+		// writer then takes the stored type, so values outside its range are rejected when
+		// the batches are built.
+		const auto plain_int = [](DataType t) {
+			return t == DataType::Int8 || t == DataType::Int16 || t == DataType::Int32 || t == DataType::Int64;
+		};
+		const auto fits = [&](const ColumnSchema &stored, const ColumnSchema &declared) {
+			if (stored.name != declared.name || stored.nullable != declared.nullable) return false;
+			return stored.type == declared.type ||
+			       (plain_int(stored.type) && plain_int(declared.type) &&
+			        utils::ValueWidth(stored.type) <= utils::ValueWidth(declared.type));
+		};
+		if (!std::ranges::equal(reader.GetSchema(), schema_, fits)) {
+			throw std::runtime_error("columnar: schema does not match the file appended to");
+		}
+		schema_ = reader.GetSchema();
+		const auto same_key = [](const SortColumn &a, const SortColumn &b) {
+			return a.column == b.column && a.descending == b.descending;
+		};
+		if (options_.sort_by.empty()) options_.sort_by = reader.SortOrder();
+		if (!std::ranges::equal(reader.SortOrder(), options_.sort_by, same_key)) {
+			throw std::runtime_error("columnar: sort order does not match the file appended to");
 		}
 
-		const std::size_t ncols = schema_.size();
-		const std::size_t nrows = batch.RowCount();
-
-		BatchMeta rg;
-		rg.row_count = nrows;
-		rg.columns.resize(ncols);
+		for (std::size_t idx = 0; idx < reader.NumBatches(); ++idx) {
+			const BatchMeta &meta = reader.GetBatchMeta(idx);
+			for (std::size_t col = 0; col < meta.columns.size(); ++col) {
+				if (meta.columns[col].bloom_size != 0 && std::ranges::find(options_.bloom_columns, col) == options_.bloom_columns.end()) {
+					options_.bloom_columns.push_back(col);
+				}
+			}
+			if (!meta.last_key.empty()) last_key_ = meta.last_key;
+			batches_.push_back(meta);
+		}
 
-		WriteObj(out_, rg.row_count);
+		fd_ = ::open(path.c_str(), O_WRONLY | O_CLOEXEC);
+		if (fd_ < 0) {
+			throw std::runtime_error("failed to open file for writing: " + path.string());
+		}
+		// Past the old footer (and whatever a torn earlier append left after it), so that
+		// footer stays readable until the header is switched over.
+		append_from_ = reader.FileSize();
+		end_ = append_from_;
+	}
 
-		for (std::size_t col = 0; col < ncols; ++col) {
-			const std::uint64_t chunk_begin = Position(out_);
+	EncodedBatch ColumnarWriter::EncodeBatch(const Batch &batch) const {
+		const std::size_t ncols = schema_.size();
+		if (batch.RowCount() > std::numeric_limits<std::uint32_t>::max()) {
+			throw std::runtime_error("columnar: batch has too many rows");
+		}
 
-			const auto &col_schema = schema_[col];
-			const auto &column = batch.GetColumn(col);
+		EncodedBatch encoded;
+		encoded.meta.row_count = static_cast<std::uint32_t>(batch.RowCount());
+		encoded.meta.columns.resize(ncols);
+		encoded.chunks.resize(ncols);
+		encoded.validity.resize(ncols);
+		encoded.blooms.resize(ncols);
 
-			switch (col_schema.type) {
-				case DataType::Int64: {
-					const auto &vec = std::get<std::vector<std::int64_t> >(column);
-					if (!vec.empty()) {
-						WriteBytes(out_, vec.data(), vec.size() * sizeof(std::int64_t));
-					}
-					break;
+		if (!options_.sort_by.empty() && batch.RowCount() > 0) {
+			for (const auto &key: options_.sort_by) {
+				if (batch.NullCount(key.column) > 0) {
+					throw std::runtime_error("columnar: sort column '" + schema_[key.column].name + "' has nulls");
 				}
-				case DataType::String: {
-					const auto &vec = std::get<std::vector<std::string> >(column);
+			}
+			CheckSorted(batch, options_.sort_by);
+			for (const auto &key: options_.sort_by) {
+				encoded.meta.first_key.push_back(ValueAt(batch.GetColumn(key.column), 0));
+				encoded.meta.last_key.push_back(ValueAt(batch.GetColumn(key.column), batch.RowCount() - 1));
+			}
+		}
 
-					for (const auto &s: vec) {
-						WriteObj(out_, static_cast<std::uint32_t>(s.size()));
-					}
+		const auto build = [&](std::size_t col) {
+			ChunkMeta &meta = encoded.meta.columns[col];
+			const std::size_t nulls = batch.NullCount(col);
+			if (nulls > 0 && !schema_[col].nullable) {
+				throw std::runtime_error("columnar: column '" + schema_[col].name + "' is not nullable but has nulls");
+			}
+			meta.null_count = static_cast<std::uint32_t>(nulls);
+			if (nulls > 0 && nulls == batch.RowCount()) {
+				meta.stats.present = true;
+				meta.stats.all_null = true;
+				return;
+			}
 
-					for (const auto &s: vec) {
-						if (!s.empty()) {
-							WriteBytes(out_, s.data(), s.size());
-						}
-					}
-					break;
+			std::optional<DataVector> filled;
+			if (nulls > 0) {
+				const Batch::Validity &valid = batch.GetValidity(col);
+				filled = FillNulls(batch.GetColumn(col), valid);
+				encoded.validity[col].assign(reinterpret_cast<const char *>(valid.data()),
+				                             valid.size() * sizeof(std::uint64_t));
+			}
+			const DataVector &values = filled ? *filled : batch.GetColumn(col);
+			BuildChunk(values, schema_[col].type, options_.codec, meta, encoded.chunks[col]);
+			if (bloom_[col] && batch.RowCount() > 0) {
+				if (const auto *strings = std::get_if<StringColumn>(&values)) {
+					encoded.blooms[col] = BuildBloomFilter(*strings, meta.stats.distinct);
+				} else {
+					// Probes hash every integer as int64, so narrower columns are widened first.
+					std::vector<std::int64_t> wide;
+					encoded.blooms[col] = BuildBloomFilter(utils::WidenInts(values, wide), meta.stats.distinct);
 				}
-				default:
-					throw std::runtime_error("columnar: unsupported DataType in schema");
 			}
+		};
+
+		if (!pool_) {
+			for (std::size_t col = 0; col < ncols; ++col) build(col);
+			return encoded;
+		}
+
+		std::vector<std::future<void> > done;
+		done.reserve(ncols);
+		for (std::size_t col = 0; col < ncols; ++col) {
+			done.push_back(pool_->Submit([&build, col] { build(col); }));
+		}
+		// Every task references this frame, so wait for all of them before rethrowing.
+		for (auto &f: done) f.wait();
+		for (auto &f: done) f.get();
+		return encoded;
+	}
+
+	void ColumnarWriter::WriteEncoded(EncodedBatch &&batch) {
+		if (finalized_) {
+			throw std::runtime_error("columnar: cannot write row group after Finalize()");
+		}
+		if (batch.chunks.size() != schema_.size() || batch.meta.columns.size() != schema_.size() ||
+		    batch.validity.size() != schema_.size() || batch.blooms.size() != schema_.size()) {
+			throw std::runtime_error("columnar: encoded batch does not match the schema");
+		}
+		if (batch.meta.first_key.size() != (batch.meta.row_count > 0 ? options_.sort_by.size() : 0)) {
+			throw std::runtime_error("columnar: encoded batch does not match the sort order");
+		}
+		if (!batch.meta.first_key.empty()) {
+			if (!last_key_.empty() && KeyAfter(last_key_, batch.meta.first_key, options_.sort_by)) {
+				throw std::runtime_error("columnar: rows are not in the declared sort order");
+			}
+			last_key_ = batch.meta.last_key;
+		}
 
-			const std::uint64_t chunk_end = Position(out_);
-			rg.columns[col].offset = chunk_begin;
-			rg.columns[col].size = chunk_end - chunk_begin;
+		// Chunk offsets follow from the buffer sizes, so the whole batch (row count, padding,
+		// chunks) goes out as one positional gather write.
+		std::vector<iovec> iov;
+		iov.reserve(6 * batch.chunks.size() + 1);
+		std::uint64_t pos = end_;
+		iov.push_back({&batch.meta.row_count, sizeof(batch.meta.row_count)});
+		pos += sizeof(batch.meta.row_count);
+		for (std::size_t col = 0; col < batch.chunks.size(); ++col) {
+			const std::size_t pad = (kChunkAlignment - pos % kChunkAlignment) % kChunkAlignment;
+			if (pad != 0) iov.push_back({const_cast<char *>(kZeros), pad});
+			pos += pad;
+
+			std::string &chunk = batch.chunks[col];
+			batch.meta.columns[col].offset = pos;
+			iov.push_back({chunk.data(), chunk.size()});
+			pos += chunk.size();
 		}
+		for (std::size_t col = 0; col < batch.validity.size(); ++col) {
+			std::string &valid = batch.validity[col];
+			if (valid.empty()) continue;
+			const std::size_t pad = (kChunkAlignment - pos % kChunkAlignment) % kChunkAlignment;
+			if (pad != 0) iov.push_back({const_cast<char *>(kZeros), pad});
+			pos += pad;
 
-		batches_.push_back(std::move(rg));
+			batch.meta.columns[col].validity_offset = pos;
+			batch.meta.columns[col].validity_size = valid.size();
+			iov.push_back({valid.data(), valid.size()});
+			pos += valid.size();
+		}
+		for (std::size_t col = 0; col < batch.blooms.size(); ++col) {
+			std::string &bloom = batch.blooms[col];
+			if (bloom.empty()) continue;
+			const std::size_t pad = (kChunkAlignment - pos % kChunkAlignment) % kChunkAlignment;
+			if (pad != 0) iov.push_back({const_cast<char *>(kZeros), pad});
+			pos += pad;
+
+			batch.meta.columns[col].bloom_offset = pos;
+			batch.meta.columns[col].bloom_size = bloom.size();
+			iov.push_back({bloom.data(), bloom.size()});
+			pos += bloom.size();
+		}
+		PWriteAll(fd_, iov, end_);
+		end_ = pos;
+		batches_.push_back(std::move(batch.meta));
 	}
 
-	void ColumnarWriter::PatchFooterOffset(std::uint64_t footer_offset) {
-		// header: magic(4) + version(4) + footer_offset(8)
-		constexpr std::uint64_t footer_pos_in_header = 4 + 4;
-		const std::uint64_t cur = Position(out_);
-		utils::Seek(out_, footer_pos_in_header);
-		WriteObj(out_, footer_offset);
-		utils::Seek(out_, cur);
+	void ColumnarWriter::WriteBatch(const Batch &batch) {
+		WriteEncoded(EncodeBatch(batch));
 	}
 
-	void ColumnarWriter::WriteFooter(std::uint64_t footer_offset) {
-		WriteObj(out_, static_cast<std::uint32_t>(schema_.size()));
+	// Version and footer offset in one write, which cannot be torn across a sector.
+	void ColumnarWriter::PatchHeader(std::uint64_t footer_offset) {
+		std::string patch;
+		ByteWriter w(patch);
+		w.Write(kColumnarVersion);
+		w.Write(footer_offset);
+		PWriteAll(fd_, patch, kVersionPosInHeader);
+	}
+
+	void ColumnarWriter::Sync() {
+		if (::fdatasync(fd_) != 0) throw std::runtime_error("failed to sync file");
+	}
+
+	void ColumnarWriter::WriteFooter() {
+		std::string footer;
+		ByteWriter w(footer);
+		w.Write(static_cast<std::uint32_t>(schema_.size()));
 		for (const auto &col: schema_) {
-			WriteString(out_, col.name);
-			const auto type = static_cast<std::uint8_t>(col.type);
-			WriteObj(out_, type);
+			w.WriteString(col.name);
+			w.Write(static_cast<std::uint8_t>(col.type));
+			w.Write(static_cast<std::uint8_t>(col.nullable));
+		}
+
+		w.Write(static_cast<std::uint32_t>(batches_.size()));
+		for (const auto &rg: batches_) {
+			w.Write(rg.row_count);
+			for (std::size_t col = 0; col < rg.columns.size(); ++col) {
+				const auto &ch = rg.columns[col];
+				w.Write(ch.offset);
+				w.Write(ch.size);
+				w.Write(static_cast<std::uint8_t>(ch.encoding));
+				w.Write(static_cast<std::uint8_t>(ch.codec));
+				w.Write(ch.uncompressed_size);
+				WriteStats(w, ch.stats, schema_[col].type);
+				w.Write(ch.bloom_offset);
+				w.Write(ch.bloom_size);
+				w.Write(ch.null_count);
+				w.Write(ch.validity_offset);
+				w.Write(ch.validity_size);
+			}
 		}
 
-		const auto nrg = static_cast<std::uint32_t>(batches_.size());
-		WriteObj(out_, nrg);
+		w.Write(static_cast<std::uint32_t>(options_.sort_by.size()));
+		for (const auto &key: options_.sort_by) {
+			w.Write(key.column);
+			w.Write(static_cast<std::uint8_t>(key.descending));
+		}
 		for (const auto &rg: batches_) {
-			WriteObj(out_, rg.row_count);
-			for (const auto &ch: rg.columns) {
-				WriteObj(out_, ch.offset);
-				WriteObj(out_, ch.size);
+			for (std::size_t k = 0; k < rg.first_key.size(); ++k) {
+				WriteKey(w, rg.first_key[k]);
+				WriteKey(w, rg.last_key[k]);
 			}
 		}
+		PWriteAll(fd_, footer, end_);
 	}
 
 	void ColumnarWriter::Finish() {
 		if (finalized_) return;
 		finalized_ = true;
 
-		out_.flush();
-
-		const std::uint64_t footer_offset = Position(out_);
-		WriteFooter(footer_offset);
-
-		out_.flush();
-
-		PatchFooterOffset(footer_offset);
-
-		out_.flush();
+		const std::uint64_t footer_offset = end_;
+		WriteFooter();
+		if (!options_.append) {
+			PatchHeader(footer_offset);
+			return;
+		}
+		// The new batches and footer must be on disk before the header points at them; until
+		// then a crash leaves the old footer in charge.
+		Sync();
+		PatchHeader(footer_offset);
+		Sync();
 	}
 }
@@ -1,40 +1,93 @@
 #pragma once
 
+#include <cstddef>
 #include <cstdint>
 #include <filesystem>
-#include <fstream>
+#include <memory>
 #include <string>
 #include <vector>
 
 #include "schema.h"
 #include "columnar_format.h"
+#include "utils/thread_pool.h"
 
 class Batch;
 
 namespace columnar {
 
+	struct WriterOptions {
+		// Applied per chunk; chunks that do not shrink are stored uncompressed.
+		Codec codec = Codec::None;
+		// Worker threads encoding the columns of one batch in parallel.
+		std::size_t encode_threads = 1;
+		// Declared sort order, recorded in the footer with each batch's first and last key so
+		// readers can binary-search it. Every row is checked against it; writing a row out of
+		// order, or a null in a sort column, throws.
+		std::vector<SortColumn> sort_by;
+		// Columns that get a Bloom filter per chunk, so readers can rule out batches for
+		// equality lookups without reading them.
+		std::vector<std::size_t> bloom_columns;
+		// Add batches to the existing file at the path instead of replacing it. The schema
+		// must match the file's, except that an integer column may be declared wider than it
+		// is stored (a narrowed file); GetSchema then has the stored types, which batches must
+		// use. An empty sort_by takes the file's sort order, and columns with Bloom filters
+		// keep getting them. New batches and a new footer go after the old footer, which
+		// stays valid until Finish points the header at the new one.
+		bool append = false;
+	};
+
+	// A batch whose chunks are encoded (and compressed) in memory but not yet placed in the
+	// file; meta.columns[i].offset (and validity_offset, bloom_offset) is assigned by
+	// WriteEncoded.
+	struct EncodedBatch {
+		BatchMeta meta;
+		std::vector<std::string> chunks;
+		// Validity bitmap per column; empty for chunks with no nulls or only nulls.
+		std::vector<std::string> validity;
+		// Serialized Bloom filter per column; empty for columns without one.
+		std::vector<std::string> blooms;
+	};
+
 	class ColumnarWriter {
 	public:
-		ColumnarWriter(const std::filesystem::path& path, const Schema& schema);
+		ColumnarWriter(const std::filesystem::path& path, const Schema& schema, WriterOptions options = {});
 		~ColumnarWriter();
 
 		ColumnarWriter(const ColumnarWriter&) = delete;
 		ColumnarWriter& operator=(const ColumnarWriter&) = delete;
 
 		void WriteBatch(const Batch& batch);
+
+		// WriteBatch split in two: EncodeBatch does all the CPU work and only reads the
+		// writer's schema and options, so it may run on other threads concurrently with
+		// WriteEncoded, which appends the chunks to the file in call order.
+		EncodedBatch EncodeBatch(const Batch& batch) const;
+		void WriteEncoded(EncodedBatch&& batch);
+
 		void Finish();
 
 		const Schema& GetSchema() const { return schema_; }
 
 	private:
-		std::ofstream out_;
+		int fd_ = -1;
+		// End of the data written so far; batches and the footer are placed here with pwritev.
+		std::uint64_t end_ = 0;
+		// Appending: the file's size when it was opened. Everything before it is left as is.
+		std::uint64_t append_from_ = 0;
 		Schema schema_;
+		WriterOptions options_;
+		std::vector<bool> bloom_;
+		std::unique_ptr<utils::ThreadPool> pool_;
 		std::vector<BatchMeta> batches_;
+		// Last key of the last non-empty batch, to check the order across batches.
+		std::vector<KeyValue> last_key_;
 		bool finalized_ = false;
 
 		void WriteHeader();
-		void WriteFooter(std::uint64_t footer_offset);
-		void PatchFooterOffset(std::uint64_t footer_offset);
+		void OpenForAppend(const std::filesystem::path& path);
+		void WriteFooter();
+		void PatchHeader(std::uint64_t footer_offset);
+		void Sync();
 	};
 
 }
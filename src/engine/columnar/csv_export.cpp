@@ -0,0 +1,219 @@
+#include "csv_export.h"
+
+#include <algorithm>
+#include <atomic>
+#include <charconv>
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <ostream>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include "csvwriter.h"
+#include "utils/bitmap.h"
+
+namespace {
+	void AppendField(std::string &out, std::string_view s, bool quote) {
+		if (quote) CSVWriter::AppendQuoted(s, out);
+		else out.append(s);
+	}
+
+	// Cursor over one projected column of a batch.
+	struct ColumnCursor {
+		enum class Kind { Int64, Integer, String, Dictionary } kind = Kind::Int64;
+		const std::int64_t *ints = nullptr;
+		// Kind::Integer: any other integer type, widened into `wide`.
+		DataType type = DataType::Int64;
+		std::vector<std::int64_t> wide;
+		const std::uint32_t *lens = nullptr;
+		const char *data = nullptr;
+		// Every plain value is checked for quoting only when the chunk contains a special character.
+		bool check_quotes = false;
+		// Dictionary values, already quoted/escaped, and the row codes.
+		StringColumn formatted;
+		std::vector<std::uint32_t> codes;
+		// Validity bitmap, null when the chunk has no nulls; dictionary chunks own theirs.
+		const std::uint64_t *valid = nullptr;
+		std::vector<std::uint64_t> owned_valid;
+	};
+}
+
+
+namespace columnar {
+	void FormatCsvBatch(ColumnarReader &reader, std::size_t idx, std::span<const std::size_t> cols, char delimiter,
+	                    std::string &out) {
+		const BatchMeta &meta = reader.GetBatchMeta(idx);
+		const Schema &schema = reader.GetSchema();
+		const std::size_t rows = meta.row_count;
+
+		// Dictionary chunks are formatted from the dictionary; everything else comes from a view.
+		std::vector<ColumnCursor> cursors(cols.size());
+		std::vector<std::size_t> view_cols;
+		std::vector<std::size_t> view_slot;
+		for (std::size_t i = 0; i < cols.size(); ++i) {
+			if (cols[i] >= schema.size()) {
+				throw std::runtime_error("columnar: column index out of range: " + std::to_string(cols[i]));
+			}
+			auto dict = meta.columns[cols[i]].encoding == Encoding::Dictionary ? reader.ReadDictionary(idx, cols[i]) : std::nullopt;
+			if (!dict) {
+				view_cols.push_back(cols[i]);
+				view_slot.push_back(i);
+				continue;
+			}
+			auto &cur = cursors[i];
+			cur.kind = ColumnCursor::Kind::Dictionary;
+			std::string field;
+			for (const std::string_view v: dict->values) {
+				field.clear();
+				AppendField(field, v, CSVWriter::NeedsQuoting(v, delimiter));
+				cur.formatted.push_back(field);
+			}
+			cur.codes = std::move(dict->codes);
+			cur.owned_valid = reader.ReadValidity(idx, cols[i]);
+			if (!cur.owned_valid.empty()) cur.valid = cur.owned_valid.data();
+		}
+
+		const BatchView view = reader.ReadBatchView(idx, view_cols);
+		for (std::size_t k = 0; k < view_cols.size(); ++k) {
+			auto &cur = cursors[view_slot[k]];
+			cur.type = schema[view_cols[k]].type;
+			if (!view.Validity(k).empty()) cur.valid = view.Validity(k).data();
+			if (utils::IsInteger(cur.type)) {
+				cur.kind = cur.type == DataType::Int64 ? ColumnCursor::Kind::Int64 : ColumnCursor::Kind::Integer;
+				cur.ints = WidenInts(view.GetColumn(k), cur.wide).data();
+			} else {
+				const StringChunkView &sv = view.StringColumnView(k);
+				cur.kind = ColumnCursor::Kind::String;
+				cur.lens = sv.Lengths().data();
+				cur.data = sv.Data().data();
+				cur.check_quotes = CSVWriter::NeedsQuoting(sv.Data(), delimiter);
+			}
+		}
+
+		for (std::size_t r = 0; r < rows; ++r) {
+			for (std::size_t i = 0; i < cursors.size(); ++i) {
+				if (i != 0) out.push_back(delimiter);
+				auto &cur = cursors[i];
+				// Nulls are empty fields; string cursors still step past the slot's value.
+				if (cur.valid && !utils::GetBit(cur.valid, r)) {
+					if (cur.kind == ColumnCursor::Kind::String) cur.data += *cur.lens++;
+					continue;
+				}
+				switch (cur.kind) {
+					case ColumnCursor::Kind::Int64: {
+						char buf[24];
+						const auto res = std::to_chars(buf, buf + sizeof(buf), cur.ints[r]);
+						out.append(buf, res.ptr);
+						break;
+					}
+					case ColumnCursor::Kind::Integer:
+						utils::AppendIntegerValue(out, cur.type, cur.ints[r]);
+						break;
+					case ColumnCursor::Kind::String: {
+						const std::string_view v(cur.data, *cur.lens);
+						AppendField(out, v, cur.check_quotes && CSVWriter::NeedsQuoting(v, delimiter));
+						cur.data += *cur.lens++;
+						break;
+					}
+					case ColumnCursor::Kind::Dictionary:
+						out.append(cur.formatted[cur.codes[r]]);
+						break;
+				}
+			}
+			out.push_back('\n');
+		}
+	}
+
+	void ExportCsv(const std::filesystem::path &in_path, std::span<const std::size_t> cols, std::ostream &out,
+	               const CsvExportOptions &options) {
+		const std::size_t threads = std::max<std::size_t>(1, options.threads);
+		const std::size_t window = options.window != 0 ? options.window : 2 * threads;
+
+		ColumnarReader first(in_path, ReadMode::Mapped);
+		const std::size_t nbatches = first.NumBatches();
+		if (nbatches == 0) return;
+
+		// slots[i % window] holds batch i between formatting and writing.
+		struct Slot {
+			std::string bytes;
+			bool ready = false;
+		};
+		std::vector<Slot> slots(window);
+		std::mutex mu;
+		std::condition_variable cv;
+		std::size_t written = 0;
+		std::atomic<std::size_t> next{0};
+		bool abort = false;
+		std::exception_ptr error;
+
+		const auto worker = [&](ColumnarReader &reader) {
+			std::string buf;
+			try {
+				while (true) {
+					const std::size_t idx = next.fetch_add(1);
+					if (idx >= nbatches) return;
+					{
+						std::unique_lock lock(mu);
+						cv.wait(lock, [&] { return abort || idx < written + window; });
+						if (abort) return;
+						buf.swap(slots[idx % window].bytes);
+					}
+					buf.clear();
+					FormatCsvBatch(reader, idx, cols, options.delimiter, buf);
+					{
+						std::lock_guard lock(mu);
+						slots[idx % window].bytes.swap(buf);
+						slots[idx % window].ready = true;
+					}
+					cv.notify_all();
+				}
+			} catch (...) {
+				std::lock_guard lock(mu);
+				if (!error) error = std::current_exception();
+				abort = true;
+				cv.notify_all();
+			}
+		};
+
+		std::vector<std::jthread> workers;
+		workers.reserve(threads);
+		workers.emplace_back(worker, std::ref(first));
+		std::vector<std::unique_ptr<ColumnarReader> > readers;
+		for (std::size_t t = 1; t < threads; ++t) {
+			readers.push_back(std::make_unique<ColumnarReader>(in_path, ReadMode::Mapped));
+			workers.emplace_back(worker, std::ref(*readers.back()));
+		}
+
+		std::string pending;
+		for (std::size_t idx = 0; idx < nbatches; ++idx) {
+			{
+				std::unique_lock lock(mu);
+				cv.wait(lock, [&] { return abort || slots[idx % window].ready; });
+				if (abort) break;
+				pending.swap(slots[idx % window].bytes);
+				slots[idx % window].ready = false;
+			}
+			out.write(pending.data(), static_cast<std::streamsize>(pending.size()));
+			{
+				std::lock_guard lock(mu);
+				// Hand the written buffer back for reuse by the worker that takes this slot next.
+				slots[idx % window].bytes.swap(pending);
+				written = idx + 1;
+				if (!out) {
+					abort = true;
+					if (!error) error = std::make_exception_ptr(std::runtime_error("failed to write data.csv"));
+				}
+			}
+			cv.notify_all();
+			if (!out) break;
+		}
+
+		for (auto &w: workers) w.join();
+		if (error) std::rethrow_exception(error);
+	}
+}
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <cstddef>
+#include <filesystem>
+#include <iosfwd>
+#include <span>
+#include <string>
+
+#include "columnar_reader.h"
+
+namespace columnar {
+
+	struct CsvExportOptions {
+		// Threads formatting batches; the calling thread does the writing.
+		std::size_t threads = 1;
+		char delimiter = ',';
+		// Formatted batches allowed to wait for the writer; 0 means 2 * threads.
+		std::size_t window = 0;
+	};
+
+	// Appends the rows of batch `idx`, restricted to `cols`, to `out` as CSV: the same bytes
+	// CSVWriter produces, quoted by CSVWriter::NeedsQuoting. Integers go through
+	// std::to_chars; dictionary chunks are quoted once per dictionary value, and plain string
+	// chunks that contain no character needing quotes skip the per-field check.
+	void FormatCsvBatch(ColumnarReader& reader, std::size_t idx, std::span<const std::size_t> cols, char delimiter,
+	                    std::string& out);
+
+	// Writes every batch of the file as CSV rows to `out`, in batch order. Batches are
+	// formatted on worker threads (each with its own mapped reader) into buffers that are
+	// recycled once written, so memory stays bounded by the window.
+	void ExportCsv(const std::filesystem::path& in_path, std::span<const std::size_t> cols, std::ostream& out,
+	               const CsvExportOptions& options = {});
+
+}
@@ -0,0 +1,444 @@
+#include "encoding.h"
+
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <numeric>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "byte_io.h"
+
+#if defined(__GNUC__) && defined(__x86_64__)
+#define COLUMNAR_ENCODING_X86 1
+#include <immintrin.h>
+#endif
+
+
+namespace {
+	constexpr std::size_t kForHeader = 16;
+	constexpr std::size_t kDeltaHeader = 24;
+
+	int BitWidth(std::uint64_t range) {
+		return static_cast<int>(std::bit_width(range));
+	}
+
+	std::uint64_t WidthMask(int width) {
+		return width == 64 ? ~std::uint64_t{0} : (std::uint64_t{1} << width) - 1;
+	}
+
+	// Packed values are followed by one zero word, so an unpacker may always load the word
+	// after the one holding a value's first bit.
+	std::size_t PackedBytes(std::size_t n, int width) {
+		return ((n * static_cast<std::size_t>(width) + 63) / 64 + 1) * sizeof(std::uint64_t);
+	}
+
+	template<class T>
+	void Put(std::string &out, const T &v) {
+		out.append(reinterpret_cast<const char *>(&v), sizeof(T));
+	}
+
+	void PutWidth(std::string &out, int width) {
+		const char header[8] = {static_cast<char>(width)};
+		out.append(header, sizeof(header));
+	}
+
+	int ReadWidth(columnar::ByteReader &r) {
+		char header[8];
+		r.ReadBytes(header, sizeof(header));
+		const int width = static_cast<unsigned char>(header[0]);
+		if (width > 64) throw std::runtime_error("columnar: corrupted int64 chunk");
+		return width;
+	}
+
+	// Packs value(i) for i in [0, n), each already masked to `width` bits, little-endian.
+	template<class F>
+	void PackBits(std::size_t n, int width, F value, std::string &out) {
+		const std::size_t base = out.size();
+		out.resize(base + PackedBytes(n, width));
+		if (width == 0) return;
+
+		char *dst = out.data() + base;
+		std::uint64_t word = 0;
+		int used = 0;
+		for (std::size_t i = 0; i < n; ++i) {
+			const std::uint64_t v = value(i);
+			word |= v << used;
+			used += width;
+			if (used >= 64) {
+				std::memcpy(dst, &word, 8);
+				dst += 8;
+				used -= 64;
+				word = used == 0 ? 0 : v >> (width - used);
+			}
+		}
+		if (used > 0) std::memcpy(dst, &word, 8);
+	}
+
+	// out[i] = base + packed value i (wrapping), for i in [begin, end).
+	void UnpackScalar(const char *words, std::size_t begin, std::size_t end, int width, std::uint64_t base,
+	                  std::int64_t *out) {
+		const std::uint64_t mask = WidthMask(width);
+		for (std::size_t i = begin; i < end; ++i) {
+			const std::size_t bit = i * static_cast<std::size_t>(width);
+			const char *p = words + (bit >> 6) * 8;
+			const int shift = static_cast<int>(bit & 63);
+			std::uint64_t lo, hi;
+			std::memcpy(&lo, p, 8);
+			std::memcpy(&hi, p + 8, 8);
+			std::uint64_t v = lo >> shift;
+			if (shift != 0) v |= hi << (64 - shift);
+			out[i] = static_cast<std::int64_t>(base + (v & mask));
+		}
+	}
+
+	void UnpackCodesScalar(const char *words, std::size_t begin, std::size_t end, int width, std::uint32_t *out) {
+		const std::uint64_t mask = WidthMask(width);
+		for (std::size_t i = begin; i < end; ++i) {
+			const std::size_t bit = i * static_cast<std::size_t>(width);
+			std::uint64_t lo;
+			std::memcpy(&lo, words + (bit >> 6) * 8, 8);
+			const int shift = static_cast<int>(bit & 63);
+			std::uint64_t v = lo >> shift;
+			if (shift + width > 64) {
+				std::uint64_t hi;
+				std::memcpy(&hi, words + (bit >> 6) * 8 + 8, 8);
+				v |= hi << (64 - shift);
+			}
+			out[i] = static_cast<std::uint32_t>(v & mask);
+		}
+	}
+
+	void UnpackCodesScalarAll(const char *words, std::size_t n, int width, std::uint32_t *out) {
+		UnpackCodesScalar(words, 0, n, width, out);
+	}
+
+	void UnpackScalarAll(const char *words, std::size_t n, int width, std::uint64_t base, std::int64_t *out) {
+		UnpackScalar(words, 0, n, width, base, out);
+	}
+
+#ifdef COLUMNAR_ENCODING_X86
+	// Four lanes per step: gather the two words under each value and funnel-shift them.
+	// AVX2 variable shifts by 64 yield zero, which covers values starting on a word boundary.
+	__attribute__((target("avx2")))
+	inline __m256i UnpackLanes(const long long *w, __m256i bits, __m256i mask) {
+		const __m256i idx = _mm256_srli_epi64(bits, 6);
+		const __m256i shift = _mm256_and_si256(bits, _mm256_set1_epi64x(63));
+		const __m256i lo = _mm256_i64gather_epi64(w, idx, 8);
+		const __m256i hi = _mm256_i64gather_epi64(w, _mm256_add_epi64(idx, _mm256_set1_epi64x(1)), 8);
+		const __m256i v = _mm256_or_si256(_mm256_srlv_epi64(lo, shift),
+		                                  _mm256_sllv_epi64(hi, _mm256_sub_epi64(_mm256_set1_epi64x(64), shift)));
+		return _mm256_and_si256(v, mask);
+	}
+
+	__attribute__((target("avx2")))
+	void UnpackAvx2(const char *words, std::size_t n, int width, std::uint64_t base, std::int64_t *out) {
+		const auto *w = reinterpret_cast<const long long *>(words);
+		const __m256i mask = _mm256_set1_epi64x(static_cast<long long>(WidthMask(width)));
+		const __m256i vbase = _mm256_set1_epi64x(static_cast<long long>(base));
+		const __m256i step = _mm256_set1_epi64x(4LL * width);
+		__m256i bits = _mm256_setr_epi64x(0, width, 2LL * width, 3LL * width);
+
+		std::size_t i = 0;
+		for (; i + 4 <= n; i += 4) {
+			const __m256i v = _mm256_add_epi64(UnpackLanes(w, bits, mask), vbase);
+			_mm256_storeu_si256(reinterpret_cast<__m256i *>(out + i), v);
+			bits = _mm256_add_epi64(bits, step);
+		}
+		UnpackScalar(words, i, n, width, base, out);
+	}
+
+	__attribute__((target("avx2")))
+	void UnpackCodesAvx2(const char *words, std::size_t n, int width, std::uint32_t *out) {
+		const auto *w = reinterpret_cast<const long long *>(words);
+		const __m256i mask = _mm256_set1_epi64x(static_cast<long long>(WidthMask(width)));
+		const __m256i step = _mm256_set1_epi64x(4LL * width);
+		const __m256i low_halves = _mm256_setr_epi32(0, 2, 4, 6, 0, 0, 0, 0);
+		__m256i bits = _mm256_setr_epi64x(0, width, 2LL * width, 3LL * width);
+
+		std::size_t i = 0;
+		for (; i + 4 <= n; i += 4) {
+			const __m256i v = _mm256_permutevar8x32_epi32(UnpackLanes(w, bits, mask), low_halves);
+			_mm_storeu_si128(reinterpret_cast<__m128i *>(out + i), _mm256_castsi256_si128(v));
+			bits = _mm256_add_epi64(bits, step);
+		}
+		UnpackCodesScalar(words, i, n, width, out);
+	}
+#endif
+
+	using UnpackFn = void (*)(const char *, std::size_t, int, std::uint64_t, std::int64_t *);
+	using UnpackCodesFn = void (*)(const char *, std::size_t, int, std::uint32_t *);
+
+	struct Kernel {
+		UnpackFn fn;
+		UnpackCodesFn codes;
+		const char *name;
+	};
+
+	Kernel SelectKernel() {
+#ifdef COLUMNAR_ENCODING_X86
+		__builtin_cpu_init();
+		if (__builtin_cpu_supports("avx2")) return {UnpackAvx2, UnpackCodesAvx2, "avx2"};
+#endif
+		return {UnpackScalarAll, UnpackCodesScalarAll, "scalar"};
+	}
+
+	const Kernel &ActiveKernel() {
+		static const Kernel kernel = SelectKernel();
+		return kernel;
+	}
+
+	void Unpack(columnar::ByteReader &r, std::size_t n, int width, std::uint64_t base, std::int64_t *out) {
+		const std::string_view words = r.ReadView(PackedBytes(n, width));
+		if (width == 0) {
+			std::fill(out, out + n, static_cast<std::int64_t>(base));
+			return;
+		}
+		ActiveKernel().fn(words.data(), n, width, base, out);
+	}
+
+	struct Int64Shape {
+		int for_width = 0;
+		int delta_width = 0;
+		std::uint64_t delta_min = 0;
+		std::size_t runs = 0;
+	};
+
+	// All deltas and ranges are taken in wrapping uint64 arithmetic, so any int64 input packs.
+	Int64Shape Analyze(std::span<const std::int64_t> values, const columnar::ChunkStats &stats) {
+		Int64Shape shape;
+		shape.for_width = BitWidth(static_cast<std::uint64_t>(stats.max_int) - static_cast<std::uint64_t>(stats.min_int));
+		if (values.empty()) return shape;
+
+		std::int64_t dmin = 0, dmax = 0;
+		shape.runs = 1;
+		for (std::size_t i = 1; i < values.size(); ++i) {
+			const auto d = static_cast<std::int64_t>(static_cast<std::uint64_t>(values[i]) - static_cast<std::uint64_t>(values[i - 1]));
+			if (i == 1) dmin = dmax = d;
+			dmin = std::min(dmin, d);
+			dmax = std::max(dmax, d);
+			shape.runs += d != 0;
+		}
+		shape.delta_min = static_cast<std::uint64_t>(dmin);
+		shape.delta_width = BitWidth(static_cast<std::uint64_t>(dmax) - static_cast<std::uint64_t>(dmin));
+		return shape;
+	}
+
+	std::uint64_t Delta(std::span<const std::int64_t> values, std::size_t i) {
+		return static_cast<std::uint64_t>(values[i + 1]) - static_cast<std::uint64_t>(values[i]);
+	}
+}
+
+
+namespace columnar {
+	const char *EncodingName(Encoding encoding) {
+		switch (encoding) {
+			case Encoding::Plain: return "plain";
+			case Encoding::FrameOfReference: return "for";
+			case Encoding::Delta: return "delta";
+			case Encoding::RunLength: return "rle";
+			case Encoding::Dictionary: return "dict";
+		}
+		return "unknown";
+	}
+
+	Encoding ToEncoding(std::uint8_t raw) {
+		if (raw > static_cast<std::uint8_t>(Encoding::Dictionary)) {
+			throw std::runtime_error("columnar: unknown encoding: " + std::to_string(raw));
+		}
+		return static_cast<Encoding>(raw);
+	}
+
+	Encoding ChooseInt64Encoding(std::span<const std::int64_t> values, const ChunkStats &stats) {
+		const std::size_t n = values.size();
+		if (n == 0) return Encoding::Plain;
+
+		const Int64Shape shape = Analyze(values, stats);
+		const std::size_t sizes[] = {
+			n * sizeof(std::int64_t),
+			kForHeader + PackedBytes(n, shape.for_width),
+			kDeltaHeader + PackedBytes(n - 1, shape.delta_width),
+			sizeof(std::uint64_t) + shape.runs * (sizeof(std::int64_t) + sizeof(std::uint32_t)),
+		};
+		const auto best = std::min_element(std::begin(sizes), std::end(sizes));
+		return static_cast<Encoding>(best - std::begin(sizes));
+	}
+
+	void EncodeInt64(std::span<const std::int64_t> values, Encoding encoding, const ChunkStats &stats, std::string &out) {
+		const std::size_t n = values.size();
+		switch (encoding) {
+			case Encoding::Plain:
+				out.append(reinterpret_cast<const char *>(values.data()), n * sizeof(std::int64_t));
+				return;
+			case Encoding::FrameOfReference: {
+				const auto base = static_cast<std::uint64_t>(stats.min_int);
+				const int width = BitWidth(static_cast<std::uint64_t>(stats.max_int) - base);
+				Put(out, base);
+				PutWidth(out, width);
+				PackBits(n, width, [&](std::size_t i) { return static_cast<std::uint64_t>(values[i]) - base; }, out);
+				return;
+			}
+			case Encoding::Delta: {
+				if (n == 0) throw std::runtime_error("columnar: delta encoding needs at least one value");
+				const Int64Shape shape = Analyze(values, stats);
+				Put(out, values[0]);
+				Put(out, shape.delta_min);
+				PutWidth(out, shape.delta_width);
+				PackBits(n - 1, shape.delta_width, [&](std::size_t i) { return Delta(values, i) - shape.delta_min; }, out);
+				return;
+			}
+			case Encoding::RunLength: {
+				std::vector<std::int64_t> run_values;
+				std::vector<std::uint32_t> run_lengths;
+				for (std::size_t i = 0; i < n; ++i) {
+					if (i == 0 || values[i] != run_values.back() || run_lengths.back() == UINT32_MAX) {
+						run_values.push_back(values[i]);
+						run_lengths.push_back(0);
+					}
+					++run_lengths.back();
+				}
+				Put(out, static_cast<std::uint64_t>(run_values.size()));
+				out.append(reinterpret_cast<const char *>(run_values.data()), run_values.size() * sizeof(std::int64_t));
+				out.append(reinterpret_cast<const char *>(run_lengths.data()), run_lengths.size() * sizeof(std::uint32_t));
+				return;
+			}
+			case Encoding::Dictionary:
+				throw std::runtime_error("columnar: dictionary encoding is for string chunks");
+		}
+		throw std::runtime_error("columnar: unsupported int64 encoding");
+	}
+
+	void DecodeInt64(Encoding encoding, std::string_view bytes, std::span<std::int64_t> out) {
+		const std::size_t n = out.size();
+		ByteReader r(bytes);
+		switch (encoding) {
+			case Encoding::Plain:
+				r.ReadBytes(out.data(), n * sizeof(std::int64_t));
+				return;
+			case Encoding::FrameOfReference: {
+				const auto base = r.Read<std::uint64_t>();
+				const int width = ReadWidth(r);
+				Unpack(r, n, width, base, out.data());
+				return;
+			}
+			case Encoding::Delta: {
+				if (n == 0) return;
+				const auto first = r.Read<std::int64_t>();
+				const auto base = r.Read<std::uint64_t>();
+				const int width = ReadWidth(r);
+				// Unpack deltas into out[1..n), then prefix-sum them onto the first value.
+				Unpack(r, n - 1, width, base, out.data() + 1);
+				auto acc = static_cast<std::uint64_t>(first);
+				out[0] = first;
+				for (std::size_t i = 1; i < n; ++i) {
+					acc += static_cast<std::uint64_t>(out[i]);
+					out[i] = static_cast<std::int64_t>(acc);
+				}
+				return;
+			}
+			case Encoding::RunLength: {
+				const auto runs = r.Read<std::uint64_t>();
+				if (runs > n) throw std::runtime_error("columnar: corrupted int64 chunk");
+				const std::string_view values = r.ReadView(runs * sizeof(std::int64_t));
+				const std::string_view lengths = r.ReadView(runs * sizeof(std::uint32_t));
+				std::size_t pos = 0;
+				for (std::size_t k = 0; k < runs; ++k) {
+					std::int64_t v;
+					std::uint32_t len;
+					std::memcpy(&v, values.data() + k * sizeof(v), sizeof(v));
+					std::memcpy(&len, lengths.data() + k * sizeof(len), sizeof(len));
+					if (len > n - pos) throw std::runtime_error("columnar: corrupted int64 chunk");
+					std::fill_n(out.data() + pos, len, v);
+					pos += len;
+				}
+				if (pos != n) throw std::runtime_error("columnar: corrupted int64 chunk");
+				return;
+			}
+			case Encoding::Dictionary:
+				throw std::runtime_error("columnar: dictionary encoding is for string chunks");
+		}
+		throw std::runtime_error("columnar: unsupported int64 encoding");
+	}
+
+	std::optional<std::uint32_t> StringDictionary::Find(std::string_view value) const {
+		const auto it = std::lower_bound(values.begin(), values.end(), value);
+		if (it == values.end() || *it != value) return std::nullopt;
+		return static_cast<std::uint32_t>(it - values.begin());
+	}
+
+	bool EncodeStringDictionary(const StringColumn &values, const ChunkStats &stats, std::string &out) {
+		const std::size_t n = values.size();
+		const std::size_t limit = std::min(n / 2, kMaxDictionarySize);
+		if (n == 0 || stats.distinct > limit) return false;
+
+		std::unordered_map<std::string_view, std::uint32_t> index;
+		index.reserve(stats.distinct * 2);
+		std::vector<std::string_view> dict;
+		std::vector<std::uint32_t> codes(n);
+		for (std::size_t i = 0; i < n; ++i) {
+			const auto [it, inserted] = index.try_emplace(values[i], static_cast<std::uint32_t>(dict.size()));
+			if (inserted) {
+				dict.push_back(values[i]);
+				if (dict.size() > limit) return false;
+			}
+			codes[i] = it->second;
+		}
+
+		const std::size_t d = dict.size();
+		const int width = BitWidth(d - 1);
+		std::size_t dict_bytes = 0;
+		for (const auto v: dict) dict_bytes += v.size();
+		const std::size_t encoded = kForHeader + PackedBytes(n, width) + d * sizeof(std::uint32_t) + dict_bytes;
+		if (encoded >= n * sizeof(std::uint32_t) + values.DataSize()) return false;
+
+		// Sort the dictionary and renumber the codes by rank.
+		std::vector<std::uint32_t> order(d);
+		std::iota(order.begin(), order.end(), 0);
+		std::sort(order.begin(), order.end(), [&](std::uint32_t a, std::uint32_t b) { return dict[a] < dict[b]; });
+		std::vector<std::uint32_t> rank(d);
+		for (std::size_t k = 0; k < d; ++k) rank[order[k]] = static_cast<std::uint32_t>(k);
+
+		out.reserve(out.size() + encoded);
+		Put(out, static_cast<std::uint64_t>(d));
+		PutWidth(out, width);
+		PackBits(n, width, [&](std::size_t i) { return static_cast<std::uint64_t>(rank[codes[i]]); }, out);
+		for (const auto k: order) Put(out, static_cast<std::uint32_t>(dict[k].size()));
+		for (const auto k: order) out.append(dict[k]);
+		return true;
+	}
+
+	void DecodeStringDictionary(std::string_view bytes, std::size_t n, StringDictionary &out) {
+		ByteReader r(bytes);
+		const auto d = r.Read<std::uint64_t>();
+		const int width = ReadWidth(r);
+		if (d > kMaxDictionarySize || (n > 0 && d == 0)) throw std::runtime_error("columnar: corrupted string chunk");
+
+		const std::string_view words = r.ReadView(PackedBytes(n, width));
+		out.codes.resize(n);
+		if (width == 0) {
+			std::fill(out.codes.begin(), out.codes.end(), 0);
+		} else {
+			ActiveKernel().codes(words.data(), n, width, out.codes.data());
+		}
+		std::uint32_t max_code = 0;
+		for (const auto c: out.codes) max_code = std::max(max_code, c);
+		if (n > 0 && max_code >= d) throw std::runtime_error("columnar: corrupted string chunk");
+
+		const std::string_view lens = r.ReadView(d * sizeof(std::uint32_t));
+		out.values.clear();
+		auto &offsets = out.values.MutableOffsets();
+		offsets.resize(d + 1);
+		for (std::size_t k = 0; k < d; ++k) {
+			std::uint32_t len;
+			std::memcpy(&len, lens.data() + k * sizeof(len), sizeof(len));
+			offsets[k + 1] = offsets[k] + len;
+		}
+		out.values.MutableData().assign(r.ReadView(static_cast<std::size_t>(offsets[d])));
+	}
+
+	const char *Int64DecodeKernel() {
+		return ActiveKernel().name;
+	}
+}
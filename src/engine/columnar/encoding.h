@@ -0,0 +1,68 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "chunk_stats.h"
+
+namespace columnar {
+
+	// Per-chunk encoding id, stored in the footer from format version 3.
+	enum class Encoding : std::uint8_t {
+		// Raw values.
+		Plain = 0,
+		// base(i64), width(u8) + 7 pad bytes, then value - base bit-packed.
+		FrameOfReference = 1,
+		// first(i64), base(i64), width(u8) + 7 pad bytes, then the n-1 deltas - base bit-packed.
+		Delta = 2,
+		// nruns(u64), values(i64 x nruns), run lengths(u32 x nruns).
+		RunLength = 3,
+		// String chunks: dictionary size(u64), code width(u8) + 7 pad bytes, the codes
+		// bit-packed, then the dictionary as value lengths(u32 x size) and value bytes.
+		Dictionary = 4,
+	};
+
+	// Chunks with more distinct values than this, or more than half their row count, stay plain.
+	static constexpr std::size_t kMaxDictionarySize = std::size_t{1} << 16;
+
+	const char *EncodingName(Encoding encoding);
+	Encoding ToEncoding(std::uint8_t raw);
+
+	// Picks the smallest of the Int64 encodings for these values; `stats` are the chunk's
+	// stats (min/max). Plain wins ties.
+	Encoding ChooseInt64Encoding(std::span<const std::int64_t> values, const ChunkStats &stats);
+
+	// Appends `values` encoded with `encoding` to `out`.
+	void EncodeInt64(std::span<const std::int64_t> values, Encoding encoding, const ChunkStats &stats, std::string &out);
+
+	// Decodes exactly out.size() values. Throws on a corrupted chunk.
+	// Bit-unpacking dispatches at runtime to an AVX2 kernel, with a scalar fallback.
+	void DecodeInt64(Encoding encoding, std::string_view bytes, std::span<std::int64_t> out);
+
+	// Sorted distinct values of a dictionary-encoded chunk plus one code per row. Since the
+	// dictionary is sorted, codes compare the same way as the strings they stand for.
+	struct StringDictionary {
+		StringColumn values;
+		std::vector<std::uint32_t> codes;
+
+		// Code of `value`, if it occurs in the chunk.
+		std::optional<std::uint32_t> Find(std::string_view value) const;
+	};
+
+	// Appends the Dictionary encoding of `values` to `out` and returns true, or returns false
+	// without touching `out` when the cardinality is too high for it to pay off. `stats`
+	// are the chunk's stats; their distinct estimate rules out hopeless chunks up front.
+	bool EncodeStringDictionary(const StringColumn &values, const ChunkStats &stats, std::string &out);
+
+	// Decodes a Dictionary chunk of `n` rows. Throws on a corrupted chunk.
+	void DecodeStringDictionary(std::string_view bytes, std::size_t n, StringDictionary &out);
+
+	// Name of the unpack kernel selected on this CPU ("avx2" or "scalar").
+	const char *Int64DecodeKernel();
+
+}
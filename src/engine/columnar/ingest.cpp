@@ -0,0 +1,160 @@
+#include "ingest.h"
+
+#include <algorithm>
+#include <exception>
+#include <fstream>
+#include <limits>
+#include <optional>
+#include <stdexcept>
+#include <thread>
+#include <type_traits>
+
+#include "batch.h"
+#include "parallel_csv.h"
+#include "utils/spsc_queue.h"
+
+
+namespace columnar {
+	void IngestCsv(const std::filesystem::path &data_path, ColumnarWriter &writer, const IngestOptions &options) {
+		const Schema &schema = writer.GetSchema();
+
+		std::ifstream data_in;
+		if (options.threads <= 1) {
+			data_in.open(data_path);
+			if (!data_in.is_open()) {
+				throw std::runtime_error("failed to open data.csv: " + data_path.string());
+			}
+		}
+
+		utils::SpscQueue<Batch> parsed(options.queue_depth);
+		utils::SpscQueue<EncodedBatch> encoded(options.queue_depth);
+		std::exception_ptr parse_error;
+		std::exception_ptr encode_error;
+		std::exception_ptr write_error;
+
+		std::jthread parser([&] {
+			try {
+				const auto run = [&](auto &reader) {
+					while (auto batch = reader.ReadNext()) {
+						if (!parsed.Push(std::move(*batch))) return;
+					}
+				};
+				if (options.threads > 1) {
+					ParallelCsvBatchReader reader(data_path, schema, options.threads, options.batch_rows, options.delimiter);
+					run(reader);
+				} else {
+					CsvBatchReader reader(data_in, schema, options.batch_rows, options.delimiter);
+					run(reader);
+				}
+			} catch (...) {
+				parse_error = std::current_exception();
+			}
+			parsed.Close();
+		});
+
+		std::jthread encoder([&] {
+			try {
+				while (auto batch = parsed.Pop()) {
+					if (!encoded.Push(writer.EncodeBatch(*batch))) break;
+				}
+			} catch (...) {
+				encode_error = std::current_exception();
+			}
+			// Also stops the parser when encoding ended early.
+			parsed.Close();
+			encoded.Close();
+		});
+
+		try {
+			while (auto batch = encoded.Pop()) {
+				writer.WriteEncoded(std::move(*batch));
+			}
+		} catch (...) {
+			write_error = std::current_exception();
+		}
+		encoded.Close();
+
+		encoder.join();
+		parser.join();
+		for (const auto &error: {parse_error, encode_error, write_error}) {
+			if (error) std::rethrow_exception(error);
+		}
+	}
+
+	Schema NarrowedSchema(const ColumnarReader &reader) {
+		Schema schema = reader.GetSchema();
+		for (std::size_t col = 0; col < schema.size(); ++col) {
+			if (schema[col].type != DataType::Int64) continue;
+			std::int64_t min = std::numeric_limits<std::int64_t>::max();
+			std::int64_t max = std::numeric_limits<std::int64_t>::min();
+			bool known = true;
+			bool seen = false;
+			for (std::size_t idx = 0; idx < reader.NumBatches() && known; ++idx) {
+				const BatchMeta &meta = reader.GetBatchMeta(idx);
+				if (meta.row_count == 0) continue;
+				const ChunkStats &stats = meta.columns[col].stats;
+				if (stats.all_null) continue;
+				known = stats.present;
+				seen = true;
+				min = std::min(min, stats.min_int);
+				max = std::max(max, stats.max_int);
+			}
+			// Without any value there is no range to go by.
+			if (!known || !seen) continue;
+			for (const DataType type: {DataType::Int8, DataType::Int16, DataType::Int32}) {
+				const auto [lo, hi] = utils::ValueRange(type);
+				if (min >= lo && max <= hi) {
+					schema[col].type = type;
+					break;
+				}
+			}
+		}
+		return schema;
+	}
+
+	void RewriteColumnar(const std::filesystem::path &in, const std::filesystem::path &out, const Schema &schema,
+	                     const WriterOptions &options) {
+		ColumnarReader reader(in, ReadMode::Mapped);
+		const Schema &from = reader.GetSchema();
+		if (schema.size() != from.size()) throw std::runtime_error("columnar: rewrite schema does not match the file");
+		for (std::size_t col = 0; col < schema.size(); ++col) {
+			const bool same = schema[col].type == from[col].type;
+			if (schema[col].name != from[col].name ||
+			    (!same && !(utils::IsInteger(schema[col].type) && utils::IsInteger(from[col].type)))) {
+				throw std::runtime_error("columnar: rewrite schema does not match the file");
+			}
+		}
+
+		ColumnarWriter writer(out, schema, options);
+		std::vector<std::int64_t> wide;
+		for (std::size_t idx = 0; idx < reader.NumBatches(); ++idx) {
+			Batch batch = reader.ReadBatch(idx);
+			Batch converted(schema);
+			for (std::size_t col = 0; col < schema.size(); ++col) {
+				if (schema[col].type == from[col].type) {
+					converted.GetColumn(col) = std::move(batch.GetColumn(col));
+					continue;
+				}
+				const auto values = utils::WidenInts(batch.GetColumn(col), wide);
+				const auto [lo, hi] = utils::ValueRange(schema[col].type);
+				std::visit([&](auto &dst) {
+					using Vec = std::decay_t<decltype(dst)>;
+					if constexpr (!std::is_same_v<Vec, StringColumn>) {
+						dst.reserve(values.size());
+						for (const auto v: values) {
+							if (v < lo || v > hi) {
+								throw std::runtime_error("columnar: value " + std::to_string(v) + " of column '" +
+								                         schema[col].name + "' does not fit " + ToString(schema[col].type));
+							}
+							dst.push_back(static_cast<typename Vec::value_type>(v));
+						}
+					}
+				}, converted.GetColumn(col));
+			}
+			converted.SetRowCount(batch.RowCount());
+			for (std::size_t col = 0; col < schema.size(); ++col) converted.GetValidity(col) = std::move(batch.GetValidity(col));
+			writer.WriteBatch(converted);
+		}
+		writer.Finish();
+	}
+}
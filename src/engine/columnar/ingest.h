@@ -0,0 +1,37 @@
+#pragma once
+
+#include <cstddef>
+#include <filesystem>
+
+#include "columnar_reader.h"
+#include "columnar_writer.h"
+
+namespace columnar {
+
+	struct IngestOptions {
+		// Parser threads; more than one switches to ParallelCsvBatchReader.
+		std::size_t threads = 1;
+		std::size_t batch_rows = 65536;
+		char delimiter = ',';
+		// Batches buffered between consecutive stages.
+		std::size_t queue_depth = 4;
+	};
+
+	// Appends the rows of a CSV file to `writer` (using its schema) as three concurrent stages:
+	// parse (CSV -> Batch), encode (Batch -> EncodedBatch) and write, on the calling thread.
+	// The stages are joined by bounded SPSC queues, so a slow stage holds back the others
+	// instead of letting batches pile up. Does not call writer.Finish(). The first error
+	// of any stage is rethrown after all stages have stopped.
+	void IngestCsv(const std::filesystem::path& data_path, ColumnarWriter& writer, const IngestOptions& options = {});
+
+	// The file's schema with every Int64 column replaced by the narrowest of Int8, Int16 and
+	// Int32 that holds all of its values, judged from the footer's chunk stats alone. Files
+	// without stats (version 1) and columns without any non-null value keep their types.
+	Schema NarrowedSchema(const ColumnarReader& reader);
+
+	// Copies the columnar file `in` to `out` with `schema`, which must name the same columns
+	// and may only change integer columns to integer types that hold their values.
+	void RewriteColumnar(const std::filesystem::path& in, const std::filesystem::path& out, const Schema& schema,
+	                     const WriterOptions& options = {});
+
+}
@@ -0,0 +1,61 @@
+#include "mapped_file.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+
+
+namespace columnar {
+	MappedFile::MappedFile(const std::filesystem::path &path) {
+		const int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+		if (fd < 0) {
+			throw std::runtime_error("columnar: failed to open file for reading: " + path.string());
+		}
+
+		struct stat st{};
+		if (::fstat(fd, &st) != 0) {
+			::close(fd);
+			throw std::runtime_error("columnar: failed to stat file: " + path.string());
+		}
+		size_ = static_cast<std::size_t>(st.st_size);
+
+		if (size_ > 0) {
+			void *p = ::mmap(nullptr, size_, PROT_READ, MAP_SHARED, fd, 0);
+			if (p == MAP_FAILED) {
+				::close(fd);
+				throw std::runtime_error("columnar: failed to map file: " + path.string());
+			}
+			data_ = static_cast<const char *>(p);
+		}
+		// The mapping keeps the file referenced, the descriptor is not needed any more.
+		::close(fd);
+	}
+
+	MappedFile::~MappedFile() {
+		if (data_ != nullptr) {
+			::munmap(const_cast<char *>(data_), size_);
+		}
+	}
+
+	void MappedFile::Advise(std::uint64_t offset, std::uint64_t length, Advice advice) const {
+		if (data_ == nullptr || offset >= size_ || length == 0) return;
+
+		static const std::uint64_t page = static_cast<std::uint64_t>(::sysconf(_SC_PAGESIZE));
+		const std::uint64_t begin = offset & ~(page - 1);
+		const std::uint64_t end = std::min<std::uint64_t>(size_, offset + length);
+
+		int native = MADV_NORMAL;
+		switch (advice) {
+			case Advice::Normal: native = MADV_NORMAL; break;
+			case Advice::Sequential: native = MADV_SEQUENTIAL; break;
+			case Advice::Random: native = MADV_RANDOM; break;
+			case Advice::WillNeed: native = MADV_WILLNEED; break;
+		}
+		(void) ::madvise(const_cast<char *>(data_) + begin, static_cast<std::size_t>(end - begin), native);
+	}
+}
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+
+namespace columnar {
+
+	// Read-only shared mapping of a whole file.
+	class MappedFile {
+	public:
+		enum class Advice : std::uint8_t {
+			Normal,
+			Sequential,
+			Random,
+			WillNeed,
+		};
+
+		explicit MappedFile(const std::filesystem::path& path);
+		~MappedFile();
+
+		MappedFile(const MappedFile&) = delete;
+		MappedFile& operator=(const MappedFile&) = delete;
+
+		const char* Data() const { return data_; }
+		std::size_t Size() const { return size_; }
+
+		// Page-cache hint for [offset, offset + length); the range is widened to page bounds.
+		// Hints are best effort and failures are ignored.
+		void Advise(std::uint64_t offset, std::uint64_t length, Advice advice) const;
+
+	private:
+		const char* data_ = nullptr;
+		std::size_t size_ = 0;
+	};
+
+}
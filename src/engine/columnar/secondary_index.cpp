@@ -0,0 +1,224 @@
+#include "secondary_index.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <numeric>
+#include <stdexcept>
+#include <string_view>
+
+#include "batch.h"
+#include "byte_io.h"
+#include "columnar_reader.h"
+
+namespace {
+	constexpr char kIndexMagic[4] = {'C', 'D', 'X', '1'};
+	constexpr std::uint32_t kIndexVersion = 1;
+
+	std::uint64_t PackLocation(std::size_t batch, std::size_t row) {
+		return static_cast<std::uint64_t>(batch) << 32 | row;
+	}
+
+	template<class T>
+	T Load(const char *p, std::size_t i) {
+		T v;
+		std::memcpy(&v, p + i * sizeof(T), sizeof(T));
+		return v;
+	}
+
+	void PadTo8(std::string &out) {
+		out.resize((out.size() + 7) / 8 * 8, '\0');
+	}
+}
+
+
+namespace columnar {
+	std::filesystem::path SecondaryIndexPath(const std::filesystem::path &data, std::string_view column) {
+		std::filesystem::path path = data;
+		path += "." + std::string(column) + ".idx";
+		return path;
+	}
+
+	void BuildSecondaryIndex(const std::filesystem::path &data, std::size_t column, const std::filesystem::path &index) {
+		ColumnarReader reader(data, ReadMode::Mapped);
+		const ColumnSchema schema = reader.ProjectSchema(std::span(&column, 1)).front();
+		const std::size_t cols[] = {column};
+
+		std::string out;
+		ByteWriter w(out);
+		w.WriteBytes(kIndexMagic, sizeof(kIndexMagic));
+		w.Write(kIndexVersion);
+		w.Write(reader.FileSize());
+		w.Write(reader.FooterOffset());
+		w.Write(static_cast<std::uint32_t>(column));
+		w.Write(static_cast<std::uint8_t>(schema.type));
+		w.WriteString(schema.name);
+
+		std::vector<std::uint64_t> locations;
+		if (schema.type != DataType::String) {
+			// Keys of every integer type are stored as int64.
+			std::vector<std::pair<std::int64_t, std::uint64_t> > entries;
+			std::vector<std::int64_t> wide;
+			for (std::size_t idx = 0; idx < reader.NumBatches(); ++idx) {
+				const BatchView view = reader.ReadBatchView(idx, cols);
+				const auto values = WidenInts(view.GetColumn(0), wide);
+				const auto valid = view.Validity(0);
+				for (std::size_t row = 0; row < values.size(); ++row) {
+					if (valid.empty() || utils::GetBit(valid.data(), row)) entries.emplace_back(values[row], PackLocation(idx, row));
+				}
+			}
+			std::ranges::sort(entries);
+			w.Write(static_cast<std::uint64_t>(entries.size()));
+			PadTo8(out);
+			for (const auto &e: entries) w.Write(e.second);
+			for (const auto &e: entries) w.Write(e.first);
+		} else {
+			StringColumn values;
+			for (std::size_t idx = 0; idx < reader.NumBatches(); ++idx) {
+				const Batch batch = reader.ReadBatch(idx, cols);
+				const auto &strings = std::get<StringColumn>(batch.GetColumn(0));
+				if (batch.NullCount(0) == 0) {
+					values.Append(strings, 0, strings.size());
+					for (std::size_t row = 0; row < strings.size(); ++row) locations.push_back(PackLocation(idx, row));
+					continue;
+				}
+				for (std::size_t row = 0; row < strings.size(); ++row) {
+					if (batch.IsNull(0, row)) continue;
+					values.push_back(strings[row]);
+					locations.push_back(PackLocation(idx, row));
+				}
+			}
+			// Rows were collected in location order, so a stable sort keeps ties by location.
+			std::vector<std::size_t> order(values.size());
+			std::iota(order.begin(), order.end(), std::size_t{0});
+			std::ranges::stable_sort(order, [&](std::size_t a, std::size_t b) { return values[a] < values[b]; });
+
+			w.Write(static_cast<std::uint64_t>(order.size()));
+			PadTo8(out);
+			for (const auto i: order) w.Write(locations[i]);
+			std::uint64_t offset = 0;
+			w.Write(offset);
+			for (const auto i: order) {
+				offset += values.Length(i);
+				w.Write(offset);
+			}
+			for (const auto i: order) w.WriteBytes(values[i].data(), values[i].size());
+		}
+
+		std::filesystem::path tmp = index;
+		tmp += ".tmp";
+		{
+			std::ofstream file(tmp, std::ios::binary | std::ios::trunc);
+			if (!file.is_open()) throw std::runtime_error("failed to open file for writing: " + tmp.string());
+			file.write(out.data(), static_cast<std::streamsize>(out.size()));
+			if (!file.flush()) throw std::runtime_error("failed to write index: " + tmp.string());
+		}
+		std::filesystem::rename(tmp, index);
+	}
+
+	SecondaryIndex::SecondaryIndex(const std::filesystem::path &path)
+		: map_(std::make_unique<MappedFile>(path)) {
+		ByteReader r(map_->Data(), map_->Size());
+		char magic[sizeof(kIndexMagic)];
+		r.ReadBytes(magic, sizeof(magic));
+		if (std::memcmp(magic, kIndexMagic, sizeof(magic)) != 0 || r.Read<std::uint32_t>() != kIndexVersion) {
+			throw std::runtime_error("columnar: not a column index file: " + path.string());
+		}
+		data_size_ = r.Read<std::uint64_t>();
+		data_footer_offset_ = r.Read<std::uint64_t>();
+		column_ = r.Read<std::uint32_t>();
+		const auto type = r.Read<std::uint8_t>();
+		if (type > static_cast<std::uint8_t>(DataType::Timestamp)) {
+			throw std::runtime_error("columnar: corrupted column index: " + path.string());
+		}
+		schema_.type = static_cast<DataType>(type);
+		schema_.name = r.ReadString();
+		count_ = static_cast<std::size_t>(r.Read<std::uint64_t>());
+
+		const std::size_t header = (map_->Size() - r.Remaining() + 7) / 8 * 8;
+		if (header > map_->Size() || count_ > (map_->Size() - header) / (sizeof(std::uint64_t) * 2) ||
+		    map_->Size() - header < count_ * sizeof(std::uint64_t) * 2 + (schema_.type == DataType::String ? 8 : 0)) {
+			throw std::runtime_error("columnar: corrupted column index: " + path.string());
+		}
+		locations_ = map_->Data() + header;
+		keys_ = locations_ + count_ * sizeof(std::uint64_t);
+		if (schema_.type == DataType::String) {
+			// Offsets start at 0, never decrease and end at the size of the string bytes.
+			strings_ = keys_ + (count_ + 1) * sizeof(std::uint64_t);
+			const auto string_bytes = static_cast<std::uint64_t>(map_->Data() + map_->Size() - strings_);
+			std::uint64_t prev = 0;
+			for (std::size_t i = 0; i <= count_; ++i) {
+				const auto offset = Load<std::uint64_t>(keys_, i);
+				if (offset < prev || (i == 0 && offset != 0)) {
+					throw std::runtime_error("columnar: corrupted column index: " + path.string());
+				}
+				prev = offset;
+			}
+			if (prev != string_bytes) throw std::runtime_error("columnar: corrupted column index: " + path.string());
+		}
+		for (std::size_t i = 0; i < count_; ++i) {
+			batch_end_ = std::max<std::size_t>(batch_end_, (Load<std::uint64_t>(locations_, i) >> 32) + 1);
+		}
+
+		for (std::size_t i = 0; i < count_; i += kIndexLeafEntries) root_.push_back(KeyAt(i));
+	}
+
+	bool SecondaryIndex::Matches(const ColumnarReader &reader) const {
+		if (reader.FileSize() != data_size_ || reader.FooterOffset() != data_footer_offset_ ||
+		    column_ >= reader.GetSchema().size() || reader.GetSchema()[column_].name != schema_.name ||
+		    reader.GetSchema()[column_].type != schema_.type) {
+			return false;
+		}
+		// A location past the file's batches means the index does not describe this file.
+		return count_ == 0 || batch_end_ <= reader.NumBatches();
+	}
+
+	KeyValue SecondaryIndex::KeyAt(std::size_t i) const {
+		if (schema_.type != DataType::String) return Load<std::int64_t>(keys_, i);
+		const auto begin = Load<std::uint64_t>(keys_, i);
+		return std::string(strings_ + begin, Load<std::uint64_t>(keys_, i + 1) - begin);
+	}
+
+	int SecondaryIndex::Compare(std::size_t i, const KeyValue &key) const {
+		if (schema_.type != DataType::String) {
+			const auto v = Load<std::int64_t>(keys_, i);
+			const auto k = std::get<std::int64_t>(key);
+			return (v > k) - (v < k);
+		}
+		const auto begin = Load<std::uint64_t>(keys_, i);
+		const std::string_view v(strings_ + begin, Load<std::uint64_t>(keys_, i + 1) - begin);
+		const int c = v.compare(std::get<std::string>(key));
+		return (c > 0) - (c < 0);
+	}
+
+	std::size_t SecondaryIndex::Bound(const KeyValue &key, bool upper) const {
+		// Root: the last leaf whose first key is below the bound holds its start.
+		const auto leaf = std::ranges::partition_point(root_, [&](const KeyValue &first) {
+			return upper ? !(key < first) : first < key;
+		}) - root_.begin();
+		std::size_t lo = leaf == 0 ? 0 : (leaf - 1) * kIndexLeafEntries;
+		std::size_t hi = std::min(count_, static_cast<std::size_t>(leaf) * kIndexLeafEntries);
+		while (lo < hi) {
+			const std::size_t mid = lo + (hi - lo) / 2;
+			const int c = Compare(mid, key);
+			if (upper ? c <= 0 : c < 0) lo = mid + 1;
+			else hi = mid;
+		}
+		return lo;
+	}
+
+	std::vector<RowLocation> SecondaryIndex::Find(const KeyValue &lo, const KeyValue &hi) const {
+		if (std::holds_alternative<std::string>(lo) != (schema_.type == DataType::String) ||
+		    std::holds_alternative<std::string>(hi) != (schema_.type == DataType::String)) {
+			throw std::runtime_error("columnar: lookup value does not match the type of column '" + schema_.name + "'");
+		}
+		std::vector<RowLocation> rows;
+		if (hi < lo) return rows;
+		const std::size_t end = Bound(hi, true);
+		for (std::size_t i = Bound(lo, false); i < end; ++i) {
+			const auto packed = Load<std::uint64_t>(locations_, i);
+			rows.push_back({static_cast<std::uint32_t>(packed >> 32), static_cast<std::uint32_t>(packed)});
+		}
+		return rows;
+	}
+}
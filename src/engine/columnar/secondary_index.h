@@ -0,0 +1,79 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "columnar_format.h"
+#include "mapped_file.h"
+#include "schema.h"
+
+namespace columnar {
+
+	class ColumnarReader;
+
+	struct RowLocation {
+		std::uint32_t batch = 0;
+		std::uint32_t row = 0;
+
+		friend bool operator==(const RowLocation&, const RowLocation&) = default;
+	};
+
+	// Default index path for `column` of `data`: "<data>.<column>.idx".
+	std::filesystem::path SecondaryIndexPath(const std::filesystem::path& data, std::string_view column);
+
+	// Writes a secondary index over `column` of the columnar file at `data`: every non-null value
+	// with its row location, sorted by value and then location. The index records the data
+	// file's size and footer offset, so it goes stale once the file is rewritten or appended
+	// to. It is written to a temporary file and renamed into place.
+	void BuildSecondaryIndex(const std::filesystem::path& data, std::size_t column, const std::filesystem::path& index);
+
+	// A mapped index file. Keys and locations are flat arrays cut into leaves of
+	// kIndexLeafEntries; the first key of every leaf is kept in memory as the root level of a
+	// two-level B+tree, so a lookup binary-searches the root and then touches one leaf.
+	class SecondaryIndex {
+	public:
+		static constexpr std::size_t kIndexLeafEntries = 256;
+
+		explicit SecondaryIndex(const std::filesystem::path& path);
+
+		std::size_t Column() const { return column_; }
+		const ColumnSchema& GetColumnSchema() const { return schema_; }
+		std::size_t Size() const { return count_; }
+
+		// True if the index was built from the file `reader` has open, as it is now, and all
+		// its locations fall within that file's batches.
+		bool Matches(const ColumnarReader& reader) const;
+
+		// Rows whose value lies in [lo, hi], ordered by value and then location.
+		std::vector<RowLocation> Find(const KeyValue& lo, const KeyValue& hi) const;
+		std::vector<RowLocation> Find(const KeyValue& key) const { return Find(key, key); }
+
+	private:
+		std::unique_ptr<MappedFile> map_;
+		std::uint64_t data_size_ = 0;
+		std::uint64_t data_footer_offset_ = 0;
+		std::size_t column_ = 0;
+		ColumnSchema schema_;
+		std::size_t count_ = 0;
+		// Mapped arrays: count_ locations, then count_ int64 keys or count_ + 1 string offsets
+		// into the string bytes.
+		const char* locations_ = nullptr;
+		const char* keys_ = nullptr;
+		const char* strings_ = nullptr;
+		// One past the highest batch any location points at.
+		std::size_t batch_end_ = 0;
+		std::vector<KeyValue> root_;
+
+		KeyValue KeyAt(std::size_t i) const;
+		// Three-way comparison of entry i's key with `key`.
+		int Compare(std::size_t i, const KeyValue& key) const;
+		// First entry whose key is not less than `key`, or with `upper` greater than it.
+		std::size_t Bound(const KeyValue& key, bool upper) const;
+	};
+
+}
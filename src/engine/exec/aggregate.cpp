@@ -0,0 +1,651 @@
+#include "aggregate.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cctype>
+#include <charconv>
+#include <functional>
+#include <future>
+#include <limits>
+#include <memory>
+#include <numeric>
+#include <span>
+#include <stdexcept>
+#include <type_traits>
+#include <variant>
+
+#include "columnar_reader.h"
+#include "filter.h"
+#include "utils/thread_pool.h"
+#include "utils/utils.h"
+
+namespace {
+	using exec::AggFunc;
+	using exec::AggregateSpec;
+
+	// A worker's table is split into 1 << kRadixBits partitions by the top hash bits once it
+	// holds more than kRadixThreshold groups. Rows are then bucketed by partition before
+	// probing, so each probe loop runs against a table a fraction of the size, and the final
+	// merge runs one partition per thread.
+	constexpr int kRadixBits = 6;
+	constexpr std::size_t kRadixPartitions = std::size_t{1} << kRadixBits;
+	constexpr std::size_t kRadixThreshold = std::size_t{1} << 15;
+
+	constexpr std::uint64_t kHashSeed = 0x9e3779b97f4a7c15ULL;
+	// Hashed in place of the value of a null key.
+	constexpr std::uint64_t kNullKeyHash = 0x5bd1e9955bd1e995ULL;
+
+	std::uint64_t Mix64(std::uint64_t x) {
+		x ^= x >> 33;
+		x *= 0xff51afd7ed558ccdULL;
+		x ^= x >> 33;
+		x *= 0xc4ceb9fe1a85ec53ULL;
+		x ^= x >> 33;
+		return x;
+	}
+
+	std::size_t PartitionOf(std::uint64_t hash) {
+		return static_cast<std::size_t>(hash >> (64 - kRadixBits));
+	}
+
+	// Key column of a batch or of a group table: int64 values, or Arrow-style offsets + bytes.
+	struct KeyRef {
+		const std::int64_t *ints = nullptr;
+		const StringColumn::Offset *offsets = nullptr;
+		const char *data = nullptr;
+		// Validity bitmap; null when there are no nulls.
+		const std::uint64_t *valid = nullptr;
+
+		std::string_view Str(std::size_t r) const {
+			return {data + offsets[r], static_cast<std::size_t>(offsets[r + 1] - offsets[r])};
+		}
+		bool Null(std::size_t r) const { return valid && !utils::GetBit(valid, r); }
+	};
+
+	// Hashes the keys of `rows` column by column into out[0, rows.size()).
+	void HashKeys(std::span<const KeyRef> keys, std::span<const std::uint32_t> rows, std::uint64_t *out) {
+		std::fill_n(out, rows.size(), kHashSeed);
+		const std::hash<std::string_view> hasher;
+		for (const KeyRef &k: keys) {
+			if (k.ints) {
+				for (std::size_t i = 0; i < rows.size(); ++i) {
+					const auto v = k.Null(rows[i]) ? kNullKeyHash : static_cast<std::uint64_t>(k.ints[rows[i]]);
+					out[i] = Mix64(out[i] * kHashSeed ^ v);
+				}
+			} else {
+				for (std::size_t i = 0; i < rows.size(); ++i) {
+					const auto v = k.Null(rows[i]) ? kNullKeyHash : hasher(k.Str(rows[i]));
+					out[i] = Mix64(out[i] * kHashSeed ^ v);
+				}
+			}
+		}
+	}
+
+	[[noreturn]] void SumOverflow() {
+		throw std::runtime_error("exec: int64 overflow in sum");
+	}
+
+	// Sums are kept in 128 bits, which no int64 input can overflow, and checked against
+	// int64 once all partials are merged: whether a SUM overflows does not depend on how
+	// the rows were split between threads.
+	struct AggState {
+		__int128 value = 0;
+		std::int64_t count = 0;
+	};
+
+	std::int64_t SumResult(const AggState &s) {
+		if (s.value < std::numeric_limits<std::int64_t>::min() || s.value > std::numeric_limits<std::int64_t>::max()) {
+			SumOverflow();
+		}
+		return static_cast<std::int64_t>(s.value);
+	}
+
+	// Open-addressing (linear probing) table from group keys to aggregate states. Each slot is
+	// one word: the upper 32 hash bits as a tag and the group index + 1 (0 = empty), so probes
+	// only touch the key columns on a tag match. Keys and states are stored per group, in
+	// insertion order.
+	class GroupTable {
+	public:
+		GroupTable(const Schema &key_schema, std::span<const AggregateSpec> aggs) : aggs_(aggs) {
+			for (const auto &col: key_schema) {
+				// Integer keys of any width are held as int64.
+				if (col.type == DataType::String) keys_.emplace_back(StringColumn{});
+				else keys_.emplace_back(std::vector<std::int64_t>{});
+				nullable_.push_back(col.nullable);
+				valid_.emplace_back();
+			}
+			for (const auto &a: aggs_) {
+				AggState init;
+				if (a.func == AggFunc::Min) init.value = std::numeric_limits<std::int64_t>::max();
+				if (a.func == AggFunc::Max) init.value = std::numeric_limits<std::int64_t>::min();
+				init_.push_back(init);
+			}
+		}
+
+		std::size_t Size() const { return hashes_.size(); }
+		std::uint64_t Hash(std::uint32_t g) const { return hashes_[g]; }
+		const AggState *States(std::uint32_t g) const { return states_.data() + g * aggs_.size(); }
+		const DataVector &Keys(std::size_t col) const { return keys_[col]; }
+		bool KeyNull(std::size_t col, std::uint32_t g) const {
+			return nullable_[col] && !utils::GetBit(valid_[col].data(), g);
+		}
+
+		std::vector<KeyRef> KeyRefs() const {
+			std::vector<KeyRef> refs;
+			for (std::size_t c = 0; c < keys_.size(); ++c) {
+				const std::uint64_t *valid = nullable_[c] ? valid_[c].data() : nullptr;
+				if (const auto *ints = std::get_if<std::vector<std::int64_t> >(&keys_[c])) {
+					refs.push_back({ints->data(), nullptr, nullptr, valid});
+				} else {
+					const auto &s = std::get<StringColumn>(keys_[c]);
+					refs.push_back({nullptr, s.Offsets().data(), s.Data().data(), valid});
+				}
+			}
+			return refs;
+		}
+
+		// Group of row `r` of `keys`, created with initial states if missing.
+		std::uint32_t FindOrInsert(std::uint64_t hash, std::span<const KeyRef> keys, std::size_t r) {
+			if (2 * (hashes_.size() + 1) > slots_.size()) Grow();
+			const std::uint64_t tag = hash >> 32;
+			for (std::size_t i = hash & mask_;; i = (i + 1) & mask_) {
+				const std::uint64_t slot = slots_[i];
+				if (slot == 0) {
+					const std::uint32_t g = Insert(hash, keys, r);
+					slots_[i] = (tag << 32) | (static_cast<std::uint64_t>(g) + 1);
+					return g;
+				}
+				const auto g = static_cast<std::uint32_t>((slot & 0xffffffffu) - 1);
+				if ((slot >> 32) == tag && KeyEquals(g, keys, r)) return g;
+			}
+		}
+
+		// Folds row values into the states of their groups; gids[i] is the group of rows[i].
+		// valid[a], when set, is the validity bitmap of aggregate a's input: null rows are
+		// folded in as the operation's identity without branching, and not counted.
+		void Update(std::span<const std::uint32_t> gids, std::span<const std::uint32_t> rows,
+		            std::span<const std::int64_t *const> values, std::span<const std::uint64_t *const> valid) {
+			const std::size_t n = aggs_.size();
+			for (std::size_t a = 0; a < n; ++a) {
+				AggState *st = states_.data() + a;
+				const std::int64_t *v = values[a];
+				const std::uint64_t *ok = valid[a];
+				if (ok == nullptr) {
+					Fold(aggs_[a].func, st, n, gids, rows, v, [](std::uint32_t) { return true; });
+				} else {
+					Fold(aggs_[a].func, st, n, gids, rows, v, [ok](std::uint32_t r) { return utils::GetBit(ok, r); });
+				}
+			}
+		}
+
+		// Adds group `g` of `src` (whose keys are `src_keys`) into this table.
+		void MergeGroup(const GroupTable &src, std::span<const KeyRef> src_keys, std::uint32_t g) {
+			const std::uint32_t dst = FindOrInsert(src.Hash(g), src_keys, g);
+			const std::size_t n = aggs_.size();
+			AggState *to = states_.data() + dst * n;
+			const AggState *from = src.States(g);
+			for (std::size_t a = 0; a < n; ++a) {
+				switch (aggs_[a].func) {
+					case AggFunc::Count:
+						break;
+					case AggFunc::Sum:
+					case AggFunc::Avg:
+						to[a].value += from[a].value;
+						break;
+					case AggFunc::Min:
+						to[a].value = std::min(to[a].value, from[a].value);
+						break;
+					case AggFunc::Max:
+						to[a].value = std::max(to[a].value, from[a].value);
+						break;
+				}
+				to[a].count += from[a].count;
+			}
+		}
+
+		void MergeFrom(const GroupTable &src) {
+			const auto refs = src.KeyRefs();
+			for (std::uint32_t g = 0; g < src.Size(); ++g) MergeGroup(src, refs, g);
+		}
+
+	private:
+		template<class Present>
+		static void Fold(AggFunc func, AggState *st, std::size_t n, std::span<const std::uint32_t> gids,
+		                 std::span<const std::uint32_t> rows, const std::int64_t *v, Present present) {
+			switch (func) {
+				case AggFunc::Count:
+					for (std::size_t i = 0; i < gids.size(); ++i) st[gids[i] * n].count += present(rows[i]);
+					break;
+				case AggFunc::Sum:
+				case AggFunc::Avg:
+					for (std::size_t i = 0; i < gids.size(); ++i) {
+						AggState &s = st[gids[i] * n];
+						const bool p = present(rows[i]);
+						s.value += v[rows[i]] & -std::int64_t{p};
+						s.count += p;
+					}
+					break;
+				case AggFunc::Min:
+					for (std::size_t i = 0; i < gids.size(); ++i) {
+						AggState &s = st[gids[i] * n];
+						const bool p = present(rows[i]);
+						s.value = std::min<__int128>(s.value, p ? v[rows[i]] : std::numeric_limits<std::int64_t>::max());
+						s.count += p;
+					}
+					break;
+				case AggFunc::Max:
+					for (std::size_t i = 0; i < gids.size(); ++i) {
+						AggState &s = st[gids[i] * n];
+						const bool p = present(rows[i]);
+						s.value = std::max<__int128>(s.value, p ? v[rows[i]] : std::numeric_limits<std::int64_t>::min());
+						s.count += p;
+					}
+					break;
+			}
+		}
+
+		std::span<const AggregateSpec> aggs_;
+		std::vector<AggState> init_;
+		std::vector<std::uint64_t> slots_;
+		std::size_t mask_ = 0;
+		std::vector<std::uint64_t> hashes_;
+		std::vector<DataVector> keys_;
+		// Per key column: nullable, and if so the validity of each group's key.
+		std::vector<bool> nullable_;
+		std::vector<std::vector<std::uint64_t> > valid_;
+		std::vector<AggState> states_;
+
+		bool KeyEquals(std::uint32_t g, std::span<const KeyRef> keys, std::size_t r) const {
+			for (std::size_t c = 0; c < keys_.size(); ++c) {
+				const bool null = keys[c].Null(r);
+				if (null != KeyNull(c, g)) return false;
+				if (null) continue;
+				if (keys[c].ints) {
+					if (std::get<std::vector<std::int64_t> >(keys_[c])[g] != keys[c].ints[r]) return false;
+				} else if (std::get<StringColumn>(keys_[c])[g] != keys[c].Str(r)) {
+					return false;
+				}
+			}
+			return true;
+		}
+
+		std::uint32_t Insert(std::uint64_t hash, std::span<const KeyRef> keys, std::size_t r) {
+			if (hashes_.size() >= std::numeric_limits<std::uint32_t>::max() - 1) {
+				throw std::runtime_error("exec: too many groups");
+			}
+			const auto g = static_cast<std::uint32_t>(hashes_.size());
+			hashes_.push_back(hash);
+			for (std::size_t c = 0; c < keys_.size(); ++c) {
+				const bool null = keys[c].Null(r);
+				if (nullable_[c]) utils::AppendBit(valid_[c], g, !null);
+				if (keys[c].ints) std::get<std::vector<std::int64_t> >(keys_[c]).push_back(null ? 0 : keys[c].ints[r]);
+				else std::get<StringColumn>(keys_[c]).push_back(null ? std::string_view() : keys[c].Str(r));
+			}
+			states_.insert(states_.end(), init_.begin(), init_.end());
+			return g;
+		}
+
+		void Grow() {
+			const std::size_t capacity = std::max<std::size_t>(16, slots_.size() * 2);
+			slots_.assign(capacity, 0);
+			mask_ = capacity - 1;
+			for (std::size_t g = 0; g < hashes_.size(); ++g) {
+				std::size_t i = hashes_[g] & mask_;
+				while (slots_[i] != 0) i = (i + 1) & mask_;
+				slots_[i] = ((hashes_[g] >> 32) << 32) | (g + 1);
+			}
+		}
+	};
+
+	// One worker's partial aggregate: a single table, or kRadixPartitions of them once the
+	// group count passes kRadixThreshold.
+	class PartialAggregate {
+	public:
+		PartialAggregate(const Schema &key_schema, std::span<const AggregateSpec> aggs)
+			: key_schema_(key_schema), aggs_(aggs) {
+			parts_.emplace_back(key_schema_, aggs_);
+		}
+
+		bool Partitioned() const { return parts_.size() > 1; }
+		std::vector<GroupTable> &Parts() { return parts_; }
+
+		void Consume(std::span<const KeyRef> keys, std::span<const std::uint32_t> rows,
+		             std::span<const std::int64_t *const> values, std::span<const std::uint64_t *const> valid) {
+			hashes_.resize(rows.size());
+			HashKeys(keys, rows, hashes_.data());
+			gids_.resize(rows.size());
+
+			if (!Partitioned()) {
+				GroupTable &t = parts_.front();
+				for (std::size_t i = 0; i < rows.size(); ++i) gids_[i] = t.FindOrInsert(hashes_[i], keys, rows[i]);
+				t.Update(gids_, rows, values, valid);
+				if (t.Size() > kRadixThreshold) Partition();
+				return;
+			}
+
+			// Counting sort of the rows by partition, then one probe pass per partition.
+			std::array<std::size_t, kRadixPartitions + 1> start{};
+			for (const auto h: hashes_) ++start[PartitionOf(h) + 1];
+			std::partial_sum(start.begin(), start.end(), start.begin());
+			auto next = start;
+			sorted_rows_.resize(rows.size());
+			sorted_hashes_.resize(rows.size());
+			for (std::size_t i = 0; i < rows.size(); ++i) {
+				const std::size_t pos = next[PartitionOf(hashes_[i])]++;
+				sorted_rows_[pos] = rows[i];
+				sorted_hashes_[pos] = hashes_[i];
+			}
+			for (std::size_t p = 0; p < kRadixPartitions; ++p) {
+				GroupTable &t = parts_[p];
+				for (std::size_t i = start[p]; i < start[p + 1]; ++i) {
+					gids_[i] = t.FindOrInsert(sorted_hashes_[i], keys, sorted_rows_[i]);
+				}
+				const std::size_t len = start[p + 1] - start[p];
+				t.Update(std::span(gids_).subspan(start[p], len), std::span(sorted_rows_).subspan(start[p], len), values,
+				         valid);
+			}
+		}
+
+		void Partition() {
+			if (Partitioned()) return;
+			const GroupTable whole = std::move(parts_.front());
+			parts_.clear();
+			for (std::size_t p = 0; p < kRadixPartitions; ++p) parts_.emplace_back(key_schema_, aggs_);
+			const auto refs = whole.KeyRefs();
+			for (std::uint32_t g = 0; g < whole.Size(); ++g) {
+				parts_[PartitionOf(whole.Hash(g))].MergeGroup(whole, refs, g);
+			}
+		}
+
+	private:
+		const Schema &key_schema_;
+		std::span<const AggregateSpec> aggs_;
+		std::vector<GroupTable> parts_;
+		std::vector<std::uint64_t> hashes_;
+		std::vector<std::uint32_t> gids_;
+		std::vector<std::uint32_t> sorted_rows_;
+		std::vector<std::uint64_t> sorted_hashes_;
+	};
+
+	std::string FormatAverage(const AggState &s) {
+		char buf[32];
+		const double avg = s.count == 0 ? 0.0 : static_cast<double>(SumResult(s)) / static_cast<double>(s.count);
+		const auto res = std::to_chars(buf, buf + sizeof(buf), avg);
+		return std::string(buf, res.ptr);
+	}
+
+	const char *FuncName(AggFunc f) {
+		switch (f) {
+			case AggFunc::Count: return "count";
+			case AggFunc::Sum: return "sum";
+			case AggFunc::Min: return "min";
+			case AggFunc::Max: return "max";
+			case AggFunc::Avg: return "avg";
+		}
+		return "?";
+	}
+}
+
+
+namespace exec {
+	std::optional<AggregateSpec> ParseAggregate(std::string_view text, const Schema &schema) {
+		text = utils::Trim(text);
+		const auto open = text.find('(');
+		if (open == std::string_view::npos || !text.ends_with(')')) return std::nullopt;
+
+		std::string func(utils::Trim(text.substr(0, open)));
+		std::ranges::transform(func, func.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+		const std::string_view arg = utils::Trim(text.substr(open + 1, text.size() - open - 2));
+
+		AggregateSpec spec;
+		if (func == "count") spec.func = AggFunc::Count;
+		else if (func == "sum") spec.func = AggFunc::Sum;
+		else if (func == "min") spec.func = AggFunc::Min;
+		else if (func == "max") spec.func = AggFunc::Max;
+		else if (func == "avg") spec.func = AggFunc::Avg;
+		else throw std::runtime_error("exec: unknown aggregate function '" + func + "'");
+
+		if (arg == "*") {
+			if (spec.func != AggFunc::Count) throw std::runtime_error("exec: only count accepts '*'");
+			return spec;
+		}
+		const auto it = std::ranges::find(schema, arg, &ColumnSchema::name);
+		if (it == schema.end()) throw std::runtime_error("exec: unknown column '" + std::string(arg) + "' in " + std::string(text));
+		if (spec.func != AggFunc::Count && !utils::IsInteger(it->type)) {
+			throw std::runtime_error("exec: " + func + " needs an integer column, '" + it->name + "' is " + ToString(it->type));
+		}
+		spec.column = static_cast<std::size_t>(it - schema.begin());
+		return spec;
+	}
+
+	std::string AggregateName(const AggregateSpec &spec, const Schema &schema) {
+		return std::string(FuncName(spec.func)) + "(" + (spec.column ? schema[*spec.column].name : "*") + ")";
+	}
+
+	Batch Aggregate(const std::filesystem::path &path, const AggregateOptions &options, AggregateStats *stats) {
+		columnar::ColumnarReader first(path, columnar::ReadMode::Mapped);
+		const Schema &schema = first.GetSchema();
+		const Schema key_schema = first.ProjectSchema(options.group_by);
+		const std::span<const AggregateSpec> aggs = options.aggregates;
+		for (const auto &a: aggs) {
+			if (a.column && *a.column >= schema.size()) throw std::runtime_error("exec: aggregate column out of range");
+			if (a.func != AggFunc::Count && (!a.column || !utils::IsInteger(schema[*a.column].type))) {
+				throw std::runtime_error("exec: " + std::string(FuncName(a.func)) + " needs an integer column");
+			}
+		}
+
+		// Every column a batch is read with: keys, aggregate inputs and filter columns.
+		std::vector<std::size_t> cols(options.group_by.begin(), options.group_by.end());
+		for (const auto &a: aggs) {
+			if (a.column && (a.func != AggFunc::Count || schema[*a.column].nullable)) cols.push_back(*a.column);
+		}
+		if (options.where) {
+			const auto where_cols = ReferencedColumns(*options.where);
+			cols.insert(cols.end(), where_cols.begin(), where_cols.end());
+		}
+		std::ranges::sort(cols);
+		cols.erase(std::unique(cols.begin(), cols.end()), cols.end());
+		const auto pos = [&](std::size_t col) { return static_cast<std::size_t>(std::ranges::find(cols, col) - cols.begin()); };
+		const std::optional<Expr> local = options.where ? std::optional(RemapColumns(*options.where, cols)) : std::nullopt;
+
+		const std::size_t nbatches = first.NumBatches();
+		const std::size_t threads = std::clamp<std::size_t>(options.threads, 1, std::max<std::size_t>(1, nbatches));
+		std::vector<std::unique_ptr<PartialAggregate> > partials;
+		for (std::size_t t = 0; t < threads; ++t) partials.push_back(std::make_unique<PartialAggregate>(key_schema, aggs));
+
+		std::atomic<std::size_t> next{0};
+		std::atomic<bool> abort{false};
+		std::atomic<std::size_t> batches_scanned{0};
+		std::atomic<std::size_t> rows_scanned{0};
+		const auto worker = [&](std::size_t t) {
+			try {
+				std::unique_ptr<columnar::ColumnarReader> own;
+				if (t != 0) own = std::make_unique<columnar::ColumnarReader>(path, columnar::ReadMode::Mapped);
+				columnar::ColumnarReader &reader = t == 0 ? first : *own;
+				PartialAggregate &partial = *partials[t];
+
+				SelectionVector rows;
+				std::vector<std::vector<StringColumn::Offset> > offsets(options.group_by.size());
+				std::vector<KeyRef> keys(options.group_by.size());
+				std::vector<const std::int64_t *> values(aggs.size());
+				std::vector<const std::uint64_t *> valid(aggs.size());
+				// Narrower integer columns widened to int64.
+				std::vector<std::vector<std::int64_t> > wide_keys(keys.size());
+				std::vector<std::vector<std::int64_t> > wide_values(aggs.size());
+				while (!abort) {
+					const std::size_t idx = next.fetch_add(1);
+					if (idx >= nbatches) return;
+					const columnar::BatchMeta &meta = reader.GetBatchMeta(idx);
+					if (meta.row_count == 0) continue;
+					if (options.where && !MayMatch(*options.where, meta, schema)) continue;
+					if (options.where && !MayMatchBlooms(*options.where, reader, idx)) continue;
+					++batches_scanned;
+					rows_scanned += meta.row_count;
+
+					const columnar::BatchView view = reader.ReadBatchView(idx, cols);
+					if (local) {
+						rows = ToSelection(Evaluate(*local, view));
+					} else {
+						rows.resize(meta.row_count);
+						std::iota(rows.begin(), rows.end(), 0u);
+					}
+					if (rows.empty()) continue;
+
+					for (std::size_t k = 0; k < keys.size(); ++k) {
+						const std::size_t p = pos(options.group_by[k]);
+						const std::uint64_t *key_valid = view.Validity(p).empty() ? nullptr : view.Validity(p).data();
+						if (utils::IsInteger(key_schema[k].type)) {
+							keys[k] = {columnar::WidenInts(view.GetColumn(p), wide_keys[k]).data(), nullptr, nullptr, key_valid};
+							continue;
+						}
+						const auto &sv = view.StringColumnView(p);
+						auto &off = offsets[k];
+						off.resize(sv.size() + 1);
+						off[0] = 0;
+						for (std::size_t i = 0; i < sv.size(); ++i) off[i + 1] = off[i] + sv.Lengths()[i];
+						keys[k] = {nullptr, off.data(), sv.Data().data(), key_valid};
+					}
+					for (std::size_t a = 0; a < aggs.size(); ++a) {
+						values[a] = nullptr;
+						valid[a] = nullptr;
+						if (!aggs[a].column || (aggs[a].func == AggFunc::Count && !schema[*aggs[a].column].nullable)) continue;
+						const std::size_t p = pos(*aggs[a].column);
+						if (!view.Validity(p).empty()) valid[a] = view.Validity(p).data();
+						if (aggs[a].func != AggFunc::Count) values[a] = columnar::WidenInts(view.GetColumn(p), wide_values[a]).data();
+					}
+					partial.Consume(keys, rows, values, valid);
+				}
+			} catch (...) {
+				abort = true;
+				throw;
+			}
+		};
+
+		utils::ThreadPool pool(threads);
+		{
+			std::vector<std::future<void> > done;
+			for (std::size_t t = 0; t < threads; ++t) done.push_back(pool.Submit([&worker, t] { worker(t); }));
+			for (auto &f: done) f.wait();
+			for (auto &f: done) f.get();
+		}
+		if (stats) {
+			stats->batches_scanned = batches_scanned;
+			stats->rows_scanned = rows_scanned;
+		}
+
+		// Merge into the first partial; partition-wise in parallel once any worker partitioned.
+		PartialAggregate &result = *partials.front();
+		const bool partitioned = std::ranges::any_of(partials, [](const auto &p) { return p->Partitioned(); });
+		if (partitioned) {
+			for (auto &p: partials) p->Partition();
+			std::vector<std::future<void> > done;
+			for (std::size_t part = 0; part < kRadixPartitions; ++part) {
+				done.push_back(pool.Submit([&, part] {
+					for (std::size_t t = 1; t < partials.size(); ++t) {
+						result.Parts()[part].MergeFrom(partials[t]->Parts()[part]);
+					}
+				}));
+			}
+			for (auto &f: done) f.wait();
+			for (auto &f: done) f.get();
+		} else {
+			for (std::size_t t = 1; t < partials.size(); ++t) {
+				result.Parts().front().MergeFrom(partials[t]->Parts().front());
+			}
+		}
+
+		// Order the groups by key.
+		std::vector<std::pair<std::uint32_t, std::uint32_t> > order;
+		for (std::size_t p = 0; p < result.Parts().size(); ++p) {
+			for (std::uint32_t g = 0; g < result.Parts()[p].Size(); ++g) order.emplace_back(static_cast<std::uint32_t>(p), g);
+		}
+		// Without GROUP BY there is exactly one group, even when no row matched.
+		if (options.group_by.empty() && order.empty()) {
+			order.emplace_back(0, result.Parts().front().FindOrInsert(kHashSeed, {}, 0));
+		}
+		const auto &parts = result.Parts();
+		std::ranges::sort(order, [&](const auto &a, const auto &b) {
+			for (std::size_t k = 0; k < key_schema.size(); ++k) {
+				// Null keys first.
+				const bool na = parts[a.first].KeyNull(k, a.second);
+				const bool nb = parts[b.first].KeyNull(k, b.second);
+				if (na != nb) return na;
+				if (na) continue;
+				const DataVector &ka = parts[a.first].Keys(k);
+				const DataVector &kb = parts[b.first].Keys(k);
+				if (const auto *ia = std::get_if<std::vector<std::int64_t> >(&ka)) {
+					const auto x = (*ia)[a.second];
+					const auto y = std::get<std::vector<std::int64_t> >(kb)[b.second];
+					if (x != y) return x < y;
+				} else {
+					const auto x = std::get<StringColumn>(ka)[a.second];
+					const auto y = std::get<StringColumn>(kb)[b.second];
+					if (x != y) return x < y;
+				}
+			}
+			return false;
+		});
+
+		// min/max keep their column's type, so dates stay dates. Aggregates other than count
+		// are null for groups without a non-null value, which only occur for a nullable
+		// column or the single group of an aggregate without GROUP BY.
+		Schema out_schema = key_schema;
+		for (const auto &a: aggs) {
+			DataType type = DataType::Int64;
+			if (a.func == AggFunc::Avg) type = DataType::String;
+			if (a.func == AggFunc::Min || a.func == AggFunc::Max) type = schema[*a.column].type;
+			const bool nullable = a.func != AggFunc::Count && (schema[*a.column].nullable || options.group_by.empty());
+			out_schema.push_back({AggregateName(a, schema), type, nullable});
+		}
+		Batch out(out_schema);
+		out.Reserve(order.size());
+		for (const auto &[p, g]: order) {
+			for (std::size_t k = 0; k < key_schema.size(); ++k) {
+				std::visit([&](auto &dst) {
+					using Col = std::decay_t<decltype(dst)>;
+					if constexpr (std::is_same_v<Col, StringColumn>) {
+						dst.push_back(std::get<StringColumn>(parts[p].Keys(k))[g]);
+					} else {
+						const std::int64_t v = std::get<std::vector<std::int64_t> >(parts[p].Keys(k))[g];
+						dst.push_back(static_cast<typename Col::value_type>(v));
+					}
+				}, out.GetColumn(k));
+			}
+			const AggState *st = parts[p].States(g);
+			for (std::size_t a = 0; a < aggs.size(); ++a) {
+				auto &col = out.GetColumn(key_schema.size() + a);
+				switch (aggs[a].func) {
+					case AggFunc::Count:
+						std::get<std::vector<std::int64_t> >(col).push_back(st[a].count);
+						break;
+					case AggFunc::Avg:
+						std::get<StringColumn>(col).push_back(FormatAverage(st[a]));
+						break;
+					case AggFunc::Sum:
+						std::get<std::vector<std::int64_t> >(col).push_back(SumResult(st[a]));
+						break;
+					default:
+						std::visit([&](auto &dst) {
+							using Col = std::decay_t<decltype(dst)>;
+							if constexpr (!std::is_same_v<Col, StringColumn>) {
+								dst.push_back(static_cast<typename Col::value_type>(st[a].value));
+							}
+						}, col);
+				}
+			}
+		}
+		out.SetRowCount(order.size());
+		for (std::size_t row = 0; row < order.size(); ++row) {
+			const auto [p, g] = order[row];
+			for (std::size_t k = 0; k < key_schema.size(); ++k) {
+				if (parts[p].KeyNull(k, g)) out.SetNull(k, row);
+			}
+			const AggState *st = parts[p].States(g);
+			for (std::size_t a = 0; a < aggs.size(); ++a) {
+				if (out_schema[key_schema.size() + a].nullable && st[a].count == 0) out.SetNull(key_schema.size() + a, row);
+			}
+		}
+		return out;
+	}
+}
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "batch.h"
+#include "expr.h"
+#include "schema.h"
+
+namespace exec {
+
+	enum class AggFunc : std::uint8_t {
+		Count,
+		Sum,
+		Min,
+		Max,
+		Avg,
+	};
+
+	struct AggregateSpec {
+		AggFunc func = AggFunc::Count;
+		// Input column; nullopt for count(*).
+		std::optional<std::size_t> column;
+	};
+
+	// Parses `count(*)`, `count(col)`, `sum(col)`, `min(col)`, `max(col)` or `avg(col)`
+	// (function names are case-insensitive). Returns nullopt when `text` is not a call,
+	// and throws for unknown functions or columns. Everything but count needs an int64 column.
+	std::optional<AggregateSpec> ParseAggregate(std::string_view text, const Schema& schema);
+
+	// Output column name, e.g. "sum(bytes)".
+	std::string AggregateName(const AggregateSpec& spec, const Schema& schema);
+
+	struct AggregateOptions {
+		// Key columns; empty aggregates the whole file into one row.
+		std::vector<std::size_t> group_by;
+		std::vector<AggregateSpec> aggregates;
+		// Rows to include, over file column indices.
+		std::optional<Expr> where;
+		// Workers claiming batches; each keeps its own partial tables, merged at the end.
+		std::size_t threads = 1;
+	};
+
+	struct AggregateStats {
+		// Batches read after pruning, and their rows.
+		std::size_t batches_scanned = 0;
+		std::size_t rows_scanned = 0;
+	};
+
+	// Grouped aggregation over a columnar file. The result has the key columns followed by
+	// one column per aggregate: int64, except avg, which is a decimal string. Rows are
+	// sorted by key. SUM and AVG throw if an int64 sum overflows. Aggregates skip null
+	// values (count(col) counts the others); null keys form one group, sorted first.
+	// Without GROUP BY there is always one row: over no rows, count is 0 and the others null.
+	// Batches that chunk stats or Bloom filters rule out are skipped; `stats`, when given,
+	// counts the rest.
+	Batch Aggregate(const std::filesystem::path& path, const AggregateOptions& options, AggregateStats* stats = nullptr);
+
+}
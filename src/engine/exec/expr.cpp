@@ -0,0 +1,368 @@
+#include "expr.h"
+
+#include <algorithm>
+#include <cctype>
+#include <stdexcept>
+#include <string>
+
+#include "columnar_reader.h"
+#include "utils/utils.h"
+
+namespace {
+	using columnar::CompareOp;
+
+	enum class Tok : std::uint8_t {
+		Ident,
+		Number,
+		String,
+		Op,
+		LParen,
+		RParen,
+		And,
+		Or,
+		Not,
+		End,
+	};
+
+	struct Token {
+		Tok kind = Tok::End;
+		std::string text;
+		CompareOp op = CompareOp::Eq;
+		std::size_t offset = 0;
+	};
+
+	[[noreturn]] void Fail(const std::string &msg, std::size_t offset) {
+		throw std::runtime_error("exec: invalid --where: " + msg + " at offset " + std::to_string(offset));
+	}
+
+	bool IsIdentChar(char c) {
+		return std::isalnum(static_cast<unsigned char>(c)) != 0 || c == '_' || c == '.';
+	}
+
+	bool IsPlainInteger(DataType type) {
+		return type == DataType::Int64 || type == DataType::Int32 || type == DataType::Int16 || type == DataType::Int8;
+	}
+
+	bool EqualsKeyword(std::string_view word, std::string_view keyword) {
+		return std::ranges::equal(word, keyword, [](char a, char b) {
+			return std::toupper(static_cast<unsigned char>(a)) == b;
+		});
+	}
+
+	// Reads a literal delimited by `quote`, where a doubled quote stands for itself.
+	std::string ReadQuoted(std::string_view text, std::size_t &i, char quote) {
+		const std::size_t start = i++;
+		std::string out;
+		while (true) {
+			if (i >= text.size()) Fail("unterminated quote", start);
+			if (text[i] == quote) {
+				if (i + 1 < text.size() && text[i + 1] == quote) {
+					out.push_back(quote);
+					i += 2;
+					continue;
+				}
+				++i;
+				return out;
+			}
+			out.push_back(text[i++]);
+		}
+	}
+
+	std::vector<Token> Tokenize(std::string_view text) {
+		std::vector<Token> tokens;
+		std::size_t i = 0;
+		while (true) {
+			while (i < text.size() && std::isspace(static_cast<unsigned char>(text[i])) != 0) ++i;
+			Token t;
+			t.offset = i;
+			if (i == text.size()) {
+				tokens.push_back(std::move(t));
+				return tokens;
+			}
+
+			const char c = text[i];
+			const char next = i + 1 < text.size() ? text[i + 1] : '\0';
+			const auto op = [&](CompareOp o, std::size_t len) {
+				t.kind = Tok::Op;
+				t.op = o;
+				t.text = std::string(text.substr(i, len));
+				i += len;
+			};
+			if (c == '(' || c == ')') {
+				t.kind = c == '(' ? Tok::LParen : Tok::RParen;
+				++i;
+			} else if (c == '\'') {
+				t.kind = Tok::String;
+				t.text = ReadQuoted(text, i, '\'');
+			} else if (c == '"') {
+				t.kind = Tok::Ident;
+				t.text = ReadQuoted(text, i, '"');
+			} else if (c == '=') {
+				op(CompareOp::Eq, next == '=' ? 2 : 1);
+			} else if (c == '!' && next == '=') {
+				op(CompareOp::Ne, 2);
+			} else if (c == '<') {
+				if (next == '>') op(CompareOp::Ne, 2);
+				else if (next == '=') op(CompareOp::Le, 2);
+				else op(CompareOp::Lt, 1);
+			} else if (c == '>') {
+				if (next == '=') op(CompareOp::Ge, 2);
+				else op(CompareOp::Gt, 1);
+			} else if (c == '!') {
+				t.kind = Tok::Not;
+				++i;
+			} else if ((c == '&' || c == '|') && next == c) {
+				t.kind = c == '&' ? Tok::And : Tok::Or;
+				i += 2;
+			} else if (std::isdigit(static_cast<unsigned char>(c)) != 0 ||
+			           ((c == '-' || c == '+') && std::isdigit(static_cast<unsigned char>(next)) != 0)) {
+				const std::size_t start = i++;
+				while (i < text.size() && std::isdigit(static_cast<unsigned char>(text[i])) != 0) ++i;
+				t.kind = Tok::Number;
+				t.text = std::string(text.substr(start, i - start));
+			} else if (IsIdentChar(c)) {
+				const std::size_t start = i;
+				while (i < text.size() && IsIdentChar(text[i])) ++i;
+				t.text = std::string(text.substr(start, i - start));
+				if (EqualsKeyword(t.text, "AND")) t.kind = Tok::And;
+				else if (EqualsKeyword(t.text, "OR")) t.kind = Tok::Or;
+				else if (EqualsKeyword(t.text, "NOT")) t.kind = Tok::Not;
+				else t.kind = Tok::Ident;
+			} else {
+				Fail(std::string("unexpected character '") + c + "'", i);
+			}
+			tokens.push_back(std::move(t));
+		}
+	}
+
+	CompareOp Mirror(CompareOp op) {
+		switch (op) {
+			case CompareOp::Lt: return CompareOp::Gt;
+			case CompareOp::Le: return CompareOp::Ge;
+			case CompareOp::Gt: return CompareOp::Lt;
+			case CompareOp::Ge: return CompareOp::Le;
+			default: return op;
+		}
+	}
+
+	CompareOp Complement(CompareOp op) {
+		switch (op) {
+			case CompareOp::Eq: return CompareOp::Ne;
+			case CompareOp::Ne: return CompareOp::Eq;
+			case CompareOp::Lt: return CompareOp::Ge;
+			case CompareOp::Le: return CompareOp::Gt;
+			case CompareOp::Gt: return CompareOp::Le;
+			case CompareOp::Ge: return CompareOp::Lt;
+		}
+		return op;
+	}
+
+	// Joins `operands` under `kind`, flattening nested nodes of the same kind.
+	exec::Expr Combine(exec::ExprKind kind, std::vector<exec::Expr> operands) {
+		if (operands.size() == 1) return std::move(operands.front());
+		exec::Expr node;
+		node.kind = kind;
+		for (auto &e: operands) {
+			if (e.kind == kind) {
+				for (auto &c: e.children) node.children.push_back(std::move(c));
+			} else {
+				node.children.push_back(std::move(e));
+			}
+		}
+		return node;
+	}
+
+	class Parser {
+	public:
+		Parser(std::string_view text, const Schema &schema) : tokens_(Tokenize(text)), schema_(schema) {}
+
+		exec::Expr Parse() {
+			exec::Expr e = ParseOr();
+			if (Peek().kind != Tok::End) Fail("unexpected '" + Describe(Peek()) + "'", Peek().offset);
+			return e;
+		}
+
+	private:
+		std::vector<Token> tokens_;
+		std::size_t pos_ = 0;
+		const Schema &schema_;
+
+		const Token &Peek() const { return tokens_[pos_]; }
+		const Token &Next() { return tokens_[pos_ == tokens_.size() - 1 ? pos_ : pos_++]; }
+
+		static std::string Describe(const Token &t) {
+			switch (t.kind) {
+				case Tok::LParen: return "(";
+				case Tok::RParen: return ")";
+				case Tok::And: return "AND";
+				case Tok::Or: return "OR";
+				case Tok::Not: return "NOT";
+				case Tok::End: return "end of input";
+				case Tok::String: return "'" + t.text + "'";
+				default: return t.text;
+			}
+		}
+
+		exec::Expr ParseOr() {
+			std::vector<exec::Expr> operands;
+			operands.push_back(ParseAnd());
+			while (Peek().kind == Tok::Or) {
+				Next();
+				operands.push_back(ParseAnd());
+			}
+			return Combine(exec::ExprKind::Or, std::move(operands));
+		}
+
+		exec::Expr ParseAnd() {
+			std::vector<exec::Expr> operands;
+			operands.push_back(ParseUnary());
+			while (Peek().kind == Tok::And) {
+				Next();
+				operands.push_back(ParseUnary());
+			}
+			return Combine(exec::ExprKind::And, std::move(operands));
+		}
+
+		exec::Expr ParseUnary() {
+			if (Peek().kind == Tok::Not) {
+				Next();
+				return exec::Negate(ParseUnary());
+			}
+			if (Peek().kind == Tok::LParen) {
+				Next();
+				exec::Expr e = ParseOr();
+				if (Peek().kind != Tok::RParen) Fail("expected ')' but got '" + Describe(Peek()) + "'", Peek().offset);
+				Next();
+				return e;
+			}
+			return ParseComparison();
+		}
+
+		exec::Expr ParseComparison() {
+			const Token lhs = Next();
+			const Token op = Next();
+			const Token rhs = Next();
+			if (op.kind != Tok::Op) Fail("expected a comparison operator but got '" + Describe(op) + "'", op.offset);
+
+			exec::Expr e;
+			if (lhs.kind == Tok::Ident) {
+				e.compare.op = op.op;
+				Bind(e.compare, lhs, rhs);
+			} else if (rhs.kind == Tok::Ident) {
+				e.compare.op = Mirror(op.op);
+				Bind(e.compare, rhs, lhs);
+			} else {
+				Fail("comparison needs a column on one side", lhs.offset);
+			}
+			return e;
+		}
+
+		void Bind(columnar::Predicate &pred, const Token &column, const Token &literal) const {
+			const auto it = std::ranges::find(schema_, column.text, &ColumnSchema::name);
+			if (it == schema_.end()) Fail("unknown column '" + column.text + "'", column.offset);
+			pred.column = static_cast<std::size_t>(it - schema_.begin());
+
+			if (literal.kind != Tok::Number && literal.kind != Tok::String) {
+				Fail("expected a literal but got '" + Describe(literal) + "'", literal.offset);
+			}
+			if (it->type == DataType::String) {
+				pred.value = literal.text;
+				return;
+			}
+			// Integer literals bind to every integer type; quoted literals to the types with a
+			// text form (bool, date, timestamp).
+			std::int64_t v = 0;
+			bool ok;
+			if (literal.kind == Tok::Number) {
+				ok = utils::TryParseInt64Digits(
+					literal.text.starts_with('+') ? std::string_view(literal.text).substr(1) : literal.text, v);
+			} else {
+				ok = !IsPlainInteger(it->type) && utils::ParseIntegerValue(it->type, literal.text, v);
+			}
+			if (!ok) {
+				Fail("column '" + column.text + "' is " + ToString(it->type) + " but got '" + Describe(literal) + "'",
+				     literal.offset);
+			}
+			pred.value = v;
+		}
+	};
+
+	void CollectColumns(const exec::Expr &expr, std::vector<std::size_t> &out) {
+		if (expr.kind == exec::ExprKind::Compare) {
+			out.push_back(expr.compare.column);
+			return;
+		}
+		for (const auto &c: expr.children) CollectColumns(c, out);
+	}
+}
+
+
+namespace exec {
+	Expr ParseWhere(std::string_view text, const Schema &schema) {
+		return Parser(text, schema).Parse();
+	}
+
+	Expr Negate(const Expr &expr) {
+		Expr out;
+		switch (expr.kind) {
+			case ExprKind::Compare:
+				out.compare = expr.compare;
+				out.compare.op = Complement(expr.compare.op);
+				return out;
+			case ExprKind::And:
+			case ExprKind::Or:
+				out.kind = expr.kind == ExprKind::And ? ExprKind::Or : ExprKind::And;
+				for (const auto &c: expr.children) out.children.push_back(Negate(c));
+				return out;
+		}
+		return out;
+	}
+
+	std::vector<std::size_t> ReferencedColumns(const Expr &expr) {
+		std::vector<std::size_t> cols;
+		CollectColumns(expr, cols);
+		std::ranges::sort(cols);
+		cols.erase(std::unique(cols.begin(), cols.end()), cols.end());
+		return cols;
+	}
+
+	Expr RemapColumns(const Expr &expr, std::span<const std::size_t> projection) {
+		Expr out = expr;
+		if (expr.kind == ExprKind::Compare) {
+			const auto it = std::ranges::find(projection, expr.compare.column);
+			if (it == projection.end()) {
+				throw std::runtime_error("exec: column " + std::to_string(expr.compare.column) + " is not in the projection");
+			}
+			out.compare.column = static_cast<std::size_t>(it - projection.begin());
+			return out;
+		}
+		for (auto &c: out.children) c = RemapColumns(c, projection);
+		return out;
+	}
+
+	bool MayMatch(const Expr &expr, const columnar::BatchMeta &batch, const Schema &schema) {
+		switch (expr.kind) {
+			case ExprKind::Compare: {
+				const std::size_t col = expr.compare.column;
+				return columnar::MayMatch(batch.columns[col].stats, schema[col].type, expr.compare);
+			}
+			case ExprKind::And:
+				return std::ranges::all_of(expr.children, [&](const Expr &c) { return MayMatch(c, batch, schema); });
+			case ExprKind::Or:
+				return std::ranges::any_of(expr.children, [&](const Expr &c) { return MayMatch(c, batch, schema); });
+		}
+		return true;
+	}
+
+	bool MayMatchBlooms(const Expr &expr, columnar::ColumnarReader &reader, std::size_t idx) {
+		switch (expr.kind) {
+			case ExprKind::Compare:
+				return expr.compare.op != CompareOp::Eq || reader.MayContain(idx, expr.compare.column, expr.compare.value);
+			case ExprKind::And:
+				return std::ranges::all_of(expr.children, [&](const Expr &c) { return MayMatchBlooms(c, reader, idx); });
+			case ExprKind::Or:
+				return std::ranges::any_of(expr.children, [&](const Expr &c) { return MayMatchBlooms(c, reader, idx); });
+		}
+		return true;
+	}
+}
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string_view>
+#include <vector>
+
+#include "chunk_stats.h"
+#include "columnar_format.h"
+#include "schema.h"
+
+namespace columnar {
+	class ColumnarReader;
+}
+
+namespace exec {
+
+	enum class ExprKind : std::uint8_t {
+		Compare,
+		And,
+		Or,
+	};
+
+	// Boolean predicate tree. NOT is pushed into the comparisons while parsing, so the
+	// leaves are plain `column <op> value` tests and every inner node is an AND or an OR.
+	struct Expr {
+		ExprKind kind = ExprKind::Compare;
+		// Compare only; `compare.column` indexes the schema the expression was parsed against.
+		columnar::Predicate compare;
+		// And / Or: two or more operands.
+		std::vector<Expr> children;
+	};
+
+	// Parses a filter such as `age >= 18 AND (city = 'Paris' OR NOT name < 'M')`.
+	// Comparisons are =, ==, !=, <>, <, <=, >, >= between a column and a literal (either
+	// side); string literals are single-quoted with '' as an escaped quote. Keywords are
+	// case-insensitive; &&, || and ! are accepted too. Columns are resolved against
+	// `schema` and literals must match the column type.
+	Expr ParseWhere(std::string_view text, const Schema& schema);
+
+	// Logical negation, with the NOT pushed down to the comparisons.
+	Expr Negate(const Expr& expr);
+
+	// Sorted, distinct columns that the expression reads.
+	std::vector<std::size_t> ReferencedColumns(const Expr& expr);
+
+	// Rewrites column indices into positions within `projection`, which must contain
+	// every referenced column, for evaluating over batches read with that projection.
+	Expr RemapColumns(const Expr& expr, std::span<const std::size_t> projection);
+
+	// False only when the chunk stats of `batch` rule out every row.
+	bool MayMatch(const Expr& expr, const columnar::BatchMeta& batch, const Schema& schema);
+
+	// False only when the Bloom filters of batch `idx` rule out every row; only equality
+	// comparisons on columns with filters can be ruled out. Reads filters, never chunks.
+	bool MayMatchBlooms(const Expr& expr, columnar::ColumnarReader& reader, std::size_t idx);
+
+}
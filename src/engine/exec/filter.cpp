@@ -0,0 +1,353 @@
+#include "filter.h"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+
+#include "batch.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define EXEC_FILTER_X86 1
+#include <immintrin.h>
+#endif
+
+
+namespace {
+	using columnar::CompareOp;
+
+	template<CompareOp Op, class T>
+	bool Test(const T &a, const T &b) {
+		if constexpr (Op == CompareOp::Eq) return a == b;
+		else if constexpr (Op == CompareOp::Ne) return a != b;
+		else if constexpr (Op == CompareOp::Lt) return a < b;
+		else if constexpr (Op == CompareOp::Le) return a <= b;
+		else if constexpr (Op == CompareOp::Gt) return a > b;
+		else return a >= b;
+	}
+
+	// Fills the words of values [begin, n); begin is a multiple of 64.
+	template<CompareOp Op, class T>
+	void CompareScalarFrom(const T *p, std::size_t begin, std::size_t n, T v, std::uint64_t *out) {
+		for (std::size_t w = begin / 64; w * 64 < n; ++w) {
+			const std::size_t end = std::min(n, w * 64 + 64);
+			std::uint64_t bits = 0;
+			for (std::size_t i = w * 64; i < end; ++i) {
+				bits |= static_cast<std::uint64_t>(Test<Op>(p[i], v)) << (i - w * 64);
+			}
+			out[w] = bits;
+		}
+	}
+
+	template<CompareOp Op, class T>
+	void CompareScalar(const T *p, std::size_t n, T v, std::uint64_t *out) {
+		CompareScalarFrom<Op>(p, 0, n, v, out);
+	}
+
+#ifdef EXEC_FILTER_X86
+	template<class T>
+	__attribute__((target("avx2")))
+	__m256i Broadcast(T v) {
+		if constexpr (sizeof(T) == 8) return _mm256_set1_epi64x(v);
+		else if constexpr (sizeof(T) == 4) return _mm256_set1_epi32(v);
+		else if constexpr (sizeof(T) == 2) return _mm256_set1_epi16(v);
+		else return _mm256_set1_epi8(v);
+	}
+
+	template<class T>
+	__attribute__((target("avx2")))
+	__m256i CmpEq(__m256i a, __m256i b) {
+		if constexpr (sizeof(T) == 8) return _mm256_cmpeq_epi64(a, b);
+		else if constexpr (sizeof(T) == 4) return _mm256_cmpeq_epi32(a, b);
+		else if constexpr (sizeof(T) == 2) return _mm256_cmpeq_epi16(a, b);
+		else return _mm256_cmpeq_epi8(a, b);
+	}
+
+	template<class T>
+	__attribute__((target("avx2")))
+	__m256i CmpGt(__m256i a, __m256i b) {
+		if constexpr (sizeof(T) == 8) return _mm256_cmpgt_epi64(a, b);
+		else if constexpr (sizeof(T) == 4) return _mm256_cmpgt_epi32(a, b);
+		else if constexpr (sizeof(T) == 2) return _mm256_cmpgt_epi16(a, b);
+		else return _mm256_cmpgt_epi8(a, b);
+	}
+
+	// Lane mask of `x <op> v`, inverted for Ne/Ge/Le: AVX2 only has == and signed >, so the
+	// other operators swap the operands and the caller inverts the result bits.
+	template<CompareOp Op, class T>
+	__attribute__((target("avx2")))
+	__m256i RawMask(const T *p, __m256i v) {
+		const __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p));
+		if constexpr (Op == CompareOp::Eq || Op == CompareOp::Ne) return CmpEq<T>(x, v);
+		else if constexpr (Op == CompareOp::Lt || Op == CompareOp::Ge) return CmpGt<T>(v, x);
+		else return CmpGt<T>(x, v);
+	}
+
+	// Result bits of the 64 values at `p`.
+	template<CompareOp Op, class T>
+	__attribute__((target("avx2")))
+	std::uint64_t BlockBits(const T *p, __m256i v) {
+		std::uint64_t bits = 0;
+		if constexpr (sizeof(T) == 8) {
+			for (std::size_t k = 0; k < 16; ++k) {
+				const __m256i m = RawMask<Op>(p + k * 4, v);
+				bits |= static_cast<std::uint64_t>(_mm256_movemask_pd(_mm256_castsi256_pd(m))) << (k * 4);
+			}
+		} else if constexpr (sizeof(T) == 4) {
+			for (std::size_t k = 0; k < 8; ++k) {
+				const __m256i m = RawMask<Op>(p + k * 8, v);
+				bits |= static_cast<std::uint64_t>(_mm256_movemask_ps(_mm256_castsi256_ps(m))) << (k * 8);
+			}
+		} else if constexpr (sizeof(T) == 2) {
+			// Packing two 16-lane masks to bytes interleaves their 128-bit halves; the permute
+			// puts them back in row order.
+			for (std::size_t k = 0; k < 2; ++k) {
+				const __m256i packed = _mm256_packs_epi16(RawMask<Op>(p + k * 32, v), RawMask<Op>(p + k * 32 + 16, v));
+				const __m256i m = _mm256_permute4x64_epi64(packed, 0xD8);
+				bits |= static_cast<std::uint64_t>(static_cast<std::uint32_t>(_mm256_movemask_epi8(m))) << (k * 32);
+			}
+		} else {
+			for (std::size_t k = 0; k < 2; ++k) {
+				const __m256i m = RawMask<Op>(p + k * 32, v);
+				bits |= static_cast<std::uint64_t>(static_cast<std::uint32_t>(_mm256_movemask_epi8(m))) << (k * 32);
+			}
+		}
+		if constexpr (Op == CompareOp::Ne || Op == CompareOp::Ge || Op == CompareOp::Le) bits = ~bits;
+		return bits;
+	}
+
+	template<CompareOp Op, class T>
+	__attribute__((target("avx2")))
+	void CompareAvx2(const T *p, std::size_t n, T v, std::uint64_t *out) {
+		const __m256i needle = Broadcast(v);
+		const std::size_t full = n / 64;
+		for (std::size_t w = 0; w < full; ++w) out[w] = BlockBits<Op>(p + w * 64, needle);
+		CompareScalarFrom<Op>(p, full * 64, n, v, out);
+	}
+#endif
+
+	template<class T>
+	using CompareFn = void (*)(const T *, std::size_t, T, std::uint64_t *);
+
+	// Indexed by CompareOp.
+	template<class T>
+	using CompareFns = std::array<CompareFn<T>, 6>;
+
+	struct Kernel {
+		CompareFns<std::int64_t> i64;
+		CompareFns<std::int32_t> i32;
+		CompareFns<std::int16_t> i16;
+		CompareFns<std::int8_t> i8;
+		const char *name;
+
+		template<class T>
+		const CompareFns<T> &Fns() const {
+			if constexpr (std::is_same_v<T, std::int64_t>) return i64;
+			else if constexpr (std::is_same_v<T, std::int32_t>) return i32;
+			else if constexpr (std::is_same_v<T, std::int16_t>) return i16;
+			else return i8;
+		}
+	};
+
+	template<class T>
+	CompareFns<T> ScalarFns() {
+		return {CompareScalar<CompareOp::Eq, T>, CompareScalar<CompareOp::Ne, T>, CompareScalar<CompareOp::Lt, T>,
+		        CompareScalar<CompareOp::Le, T>, CompareScalar<CompareOp::Gt, T>, CompareScalar<CompareOp::Ge, T>};
+	}
+
+#ifdef EXEC_FILTER_X86
+	template<class T>
+	CompareFns<T> Avx2Fns() {
+		return {CompareAvx2<CompareOp::Eq, T>, CompareAvx2<CompareOp::Ne, T>, CompareAvx2<CompareOp::Lt, T>,
+		        CompareAvx2<CompareOp::Le, T>, CompareAvx2<CompareOp::Gt, T>, CompareAvx2<CompareOp::Ge, T>};
+	}
+#endif
+
+	Kernel SelectKernel() {
+#ifdef EXEC_FILTER_X86
+		__builtin_cpu_init();
+		if (__builtin_cpu_supports("avx2")) {
+			return {Avx2Fns<std::int64_t>(), Avx2Fns<std::int32_t>(), Avx2Fns<std::int16_t>(), Avx2Fns<std::int8_t>(), "avx2"};
+		}
+#endif
+		return {ScalarFns<std::int64_t>(), ScalarFns<std::int32_t>(), ScalarFns<std::int16_t>(), ScalarFns<std::int8_t>(),
+		        "scalar"};
+	}
+
+	const Kernel &ActiveKernel() {
+		static const Kernel kernel = SelectKernel();
+		return kernel;
+	}
+
+	// `value` may lie outside T's range, in which case every row gets the same result.
+	template<class T>
+	void CompareInts(std::span<const T> values, CompareOp op, std::int64_t value, std::uint64_t *out) {
+		if (value >= std::numeric_limits<T>::min() && value <= std::numeric_limits<T>::max()) {
+			ActiveKernel().Fns<T>()[static_cast<std::size_t>(op)](values.data(), values.size(), static_cast<T>(value), out);
+			return;
+		}
+		const bool above = value > std::numeric_limits<T>::max();
+		bool all = op == CompareOp::Ne;
+		if (op == CompareOp::Lt || op == CompareOp::Le) all = above;
+		if (op == CompareOp::Gt || op == CompareOp::Ge) all = !above;
+		const std::size_t words = exec::BitmapWords(values.size());
+		std::fill_n(out, words, all ? ~std::uint64_t{0} : 0);
+		if (all && values.size() % 64 != 0) out[words - 1] = (std::uint64_t{1} << (values.size() % 64)) - 1;
+	}
+
+	template<CompareOp Op, class Strings>
+	void CompareStringsAs(const Strings &values, std::string_view v, std::uint64_t *out) {
+		std::size_t i = 0;
+		for (const std::string_view s: values) {
+			out[i / 64] |= static_cast<std::uint64_t>(Test<Op>(s, v)) << (i % 64);
+			++i;
+		}
+	}
+
+	// `out` must be zeroed.
+	template<class Strings>
+	void CompareStrings(const Strings &values, CompareOp op, std::string_view v, std::uint64_t *out) {
+		switch (op) {
+			case CompareOp::Eq: return CompareStringsAs<CompareOp::Eq>(values, v, out);
+			case CompareOp::Ne: return CompareStringsAs<CompareOp::Ne>(values, v, out);
+			case CompareOp::Lt: return CompareStringsAs<CompareOp::Lt>(values, v, out);
+			case CompareOp::Le: return CompareStringsAs<CompareOp::Le>(values, v, out);
+			case CompareOp::Gt: return CompareStringsAs<CompareOp::Gt>(values, v, out);
+			case CompareOp::Ge: return CompareStringsAs<CompareOp::Ge>(values, v, out);
+		}
+	}
+
+	[[noreturn]] void TypeMismatch(std::size_t col) {
+		throw std::runtime_error("exec: predicate value does not match the type of column " + std::to_string(col));
+	}
+
+	struct BatchColumns {
+		const Batch &batch;
+
+		std::size_t Rows() const { return batch.RowCount(); }
+		void CompareInts(std::size_t col, CompareOp op, std::int64_t v, std::uint64_t *out) const {
+			std::visit([&](const auto &values) {
+				using Vec = std::decay_t<decltype(values)>;
+				if constexpr (std::is_same_v<Vec, StringColumn>) TypeMismatch(col);
+				else ::CompareInts(std::span<const typename Vec::value_type>(values), op, v, out);
+			}, batch.GetColumn(col));
+		}
+		const StringColumn &Strings(std::size_t col) const {
+			const auto *v = std::get_if<StringColumn>(&batch.GetColumn(col));
+			if (v == nullptr) TypeMismatch(col);
+			return *v;
+		}
+		std::span<const std::uint64_t> Validity(std::size_t col) const { return batch.GetValidity(col); }
+	};
+
+	struct ViewColumns {
+		const columnar::BatchView &view;
+
+		std::size_t Rows() const { return view.RowCount(); }
+		void CompareInts(std::size_t col, CompareOp op, std::int64_t v, std::uint64_t *out) const {
+			std::visit([&](const auto &values) {
+				if constexpr (std::is_same_v<std::decay_t<decltype(values)>, columnar::StringChunkView>) TypeMismatch(col);
+				else ::CompareInts(values, op, v, out);
+			}, view.GetColumn(col));
+		}
+		const columnar::StringChunkView &Strings(std::size_t col) const {
+			const auto *v = std::get_if<columnar::StringChunkView>(&view.GetColumn(col));
+			if (v == nullptr) TypeMismatch(col);
+			return *v;
+		}
+		std::span<const std::uint64_t> Validity(std::size_t col) const { return view.Validity(col); }
+	};
+
+	template<class Source>
+	exec::Bitmap EvaluateNode(const exec::Expr &expr, const Source &src) {
+		using exec::ExprKind;
+		switch (expr.kind) {
+			case ExprKind::Compare: {
+				const auto &pred = expr.compare;
+				exec::Bitmap out(exec::BitmapWords(src.Rows()));
+				if (const auto *v = std::get_if<std::int64_t>(&pred.value)) {
+					src.CompareInts(pred.column, pred.op, *v, out.data());
+				} else {
+					CompareStrings(src.Strings(pred.column), pred.op, std::get<std::string>(pred.value), out.data());
+				}
+				// Comparisons with null are never true; NOT was pushed down to the comparisons,
+				// so this holds for negated ones too.
+				const auto valid = src.Validity(pred.column);
+				if (!valid.empty()) {
+					for (std::size_t w = 0; w < out.size(); ++w) out[w] &= valid[w];
+				}
+				return out;
+			}
+			case ExprKind::And: {
+				exec::Bitmap acc = EvaluateNode(expr.children.front(), src);
+				for (std::size_t i = 1; i < expr.children.size(); ++i) {
+					if (std::ranges::all_of(acc, [](std::uint64_t w) { return w == 0; })) break;
+					const exec::Bitmap m = EvaluateNode(expr.children[i], src);
+					for (std::size_t w = 0; w < acc.size(); ++w) acc[w] &= m[w];
+				}
+				return acc;
+			}
+			case ExprKind::Or: {
+				exec::Bitmap acc = EvaluateNode(expr.children.front(), src);
+				for (std::size_t i = 1; i < expr.children.size(); ++i) {
+					const exec::Bitmap m = EvaluateNode(expr.children[i], src);
+					for (std::size_t w = 0; w < acc.size(); ++w) acc[w] |= m[w];
+				}
+				return acc;
+			}
+		}
+		throw std::runtime_error("exec: invalid expression");
+	}
+}
+
+
+namespace exec {
+	void CompareInt64(std::span<const std::int64_t> values, columnar::CompareOp op, std::int64_t value,
+	                  std::uint64_t *out) {
+		::CompareInts(values, op, value, out);
+	}
+
+	const char *CompareKernel() {
+		return ActiveKernel().name;
+	}
+
+	void CompareInts(std::span<const std::int32_t> values, columnar::CompareOp op, std::int64_t value, std::uint64_t *out) {
+		::CompareInts(values, op, value, out);
+	}
+
+	void CompareInts(std::span<const std::int16_t> values, columnar::CompareOp op, std::int64_t value, std::uint64_t *out) {
+		::CompareInts(values, op, value, out);
+	}
+
+	void CompareInts(std::span<const std::int8_t> values, columnar::CompareOp op, std::int64_t value, std::uint64_t *out) {
+		::CompareInts(values, op, value, out);
+	}
+
+	Bitmap Evaluate(const Expr &expr, const Batch &batch) {
+		return EvaluateNode(expr, BatchColumns{batch});
+	}
+
+	Bitmap Evaluate(const Expr &expr, const columnar::BatchView &batch) {
+		return EvaluateNode(expr, ViewColumns{batch});
+	}
+
+	std::size_t CountRows(const Bitmap &bitmap) {
+		std::size_t n = 0;
+		for (const auto w: bitmap) n += static_cast<std::size_t>(std::popcount(w));
+		return n;
+	}
+
+	SelectionVector ToSelection(const Bitmap &bitmap) {
+		SelectionVector sel;
+		sel.reserve(CountRows(bitmap));
+		for (std::size_t w = 0; w < bitmap.size(); ++w) {
+			for (std::uint64_t bits = bitmap[w]; bits != 0; bits &= bits - 1) {
+				sel.push_back(static_cast<std::uint32_t>(w * 64 + static_cast<std::size_t>(std::countr_zero(bits))));
+			}
+		}
+		return sel;
+	}
+}
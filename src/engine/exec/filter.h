@@ -0,0 +1,49 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string_view>
+#include <vector>
+
+#include "batch_view.h"
+#include "expr.h"
+#include "utils/bitmap.h"
+
+class Batch;
+
+namespace exec {
+
+	// One bit per row: row i is bit i % 64 of word i / 64. Bits past the row count are zero.
+	using Bitmap = std::vector<std::uint64_t>;
+	// Ascending indices of the selected rows.
+	using SelectionVector = std::vector<std::uint32_t>;
+
+	using utils::BitmapWords;
+
+	// Writes bit i of `out` (BitmapWords(values.size()) words) as `values[i] <op> value`.
+	// Dispatches at runtime to an AVX2 kernel, with a scalar fallback.
+	void CompareInt64(std::span<const std::int64_t> values, columnar::CompareOp op, std::int64_t value,
+	                  std::uint64_t *out);
+
+	// CompareInt64 for narrower integer columns. `value` may lie outside the column type's
+	// range, which gives every row the same result.
+	void CompareInts(std::span<const std::int32_t> values, columnar::CompareOp op, std::int64_t value,
+	                 std::uint64_t *out);
+	void CompareInts(std::span<const std::int16_t> values, columnar::CompareOp op, std::int64_t value,
+	                 std::uint64_t *out);
+	void CompareInts(std::span<const std::int8_t> values, columnar::CompareOp op, std::int64_t value,
+	                 std::uint64_t *out);
+
+	// Name of the integer comparison kernels selected on this CPU ("avx2" or "scalar").
+	const char *CompareKernel();
+
+	// Rows of the batch satisfying `expr`, whose column indices refer to the batch's columns
+	// (see RemapColumns). Null values satisfy no comparison.
+	Bitmap Evaluate(const Expr& expr, const Batch& batch);
+	Bitmap Evaluate(const Expr& expr, const columnar::BatchView& batch);
+
+	std::size_t CountRows(const Bitmap& bitmap);
+	SelectionVector ToSelection(const Bitmap& bitmap);
+
+}
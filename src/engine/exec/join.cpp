@@ -0,0 +1,535 @@
+#include "join.h"
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <numeric>
+#include <optional>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <type_traits>
+
+#include "batch.h"
+#include "columnar_reader.h"
+#include "spill_dir.h"
+
+namespace {
+	constexpr std::uint32_t kNoRow = std::numeric_limits<std::uint32_t>::max();
+	// Spill files one partitioning pass writes per side, all open at once; larger build
+	// sides are partitioned again.
+	constexpr std::size_t kMaxFanout = 64;
+
+	std::uint64_t Mix64(std::uint64_t x) {
+		x ^= x >> 33;
+		x *= 0xff51afd7ed558ccdULL;
+		x ^= x >> 33;
+		x *= 0xc4ceb9fe1a85ec53ULL;
+		x ^= x >> 33;
+		return x;
+	}
+
+	std::uint64_t HashKey(std::int64_t v) { return Mix64(static_cast<std::uint64_t>(v)); }
+	std::uint64_t HashKey(std::string_view v) { return Mix64(std::hash<std::string_view>{}(v)); }
+
+	// One input of a join pass: the columns read from `path` (cols[0] is the key) and, for
+	// each of this side's output columns, its position in `cols`.
+	struct Side {
+		std::filesystem::path path;
+		std::vector<std::size_t> cols;
+		std::vector<std::size_t> out;
+	};
+
+	struct OutputColumn {
+		bool build = false;
+		std::size_t pos = 0;
+	};
+
+	struct Plan {
+		Schema schema;
+		std::vector<OutputColumn> columns;
+		bool left_outer = false;
+		std::size_t threads = 1;
+	};
+
+	// Build-side hash table from key to the chain of build rows with that key. Slots hold a
+	// 32-bit hash tag and the chain head; chains are linked through next_ and, since rows are
+	// inserted backwards, run in build order. Null keys (clear bits of `valid`) match nothing
+	// and are left out.
+	class JoinTable {
+	public:
+		JoinTable(const DataVector &keys, std::span<const std::uint64_t> valid) {
+			strings_ = std::get_if<StringColumn>(&keys);
+			if (!strings_) ints_ = utils::WidenInts(keys, wide_);
+			const std::size_t n = strings_ ? strings_->size() : ints_.size();
+			if (n >= kNoRow) throw std::runtime_error("exec: join build side has too many rows");
+
+			slots_.assign(std::bit_ceil(std::max<std::size_t>(16, 2 * n)), 0);
+			mask_ = slots_.size() - 1;
+			next_.assign(n, kNoRow);
+			for (std::size_t r = n; r-- > 0;) {
+				if (!valid.empty() && !utils::GetBit(valid.data(), r)) continue;
+				if (strings_) Insert((*strings_)[r], static_cast<std::uint32_t>(r));
+				else Insert(ints_[r], static_cast<std::uint32_t>(r));
+			}
+		}
+
+		// First build row with this key, or kNoRow.
+		template<class K>
+		std::uint32_t Find(const K &key) const {
+			const std::uint64_t hash = HashKey(key);
+			for (std::size_t i = hash & mask_;; i = (i + 1) & mask_) {
+				const std::uint64_t slot = slots_[i];
+				if (slot == 0) return kNoRow;
+				const auto row = static_cast<std::uint32_t>((slot & 0xffffffffu) - 1);
+				if ((slot >> 32) == (hash >> 32) && Key<K>(row) == key) return row;
+			}
+		}
+
+		std::uint32_t Next(std::uint32_t row) const { return next_[row]; }
+
+	private:
+		// Integer keys as int64: the key column itself, or its values widened into wide_.
+		std::span<const std::int64_t> ints_;
+		std::vector<std::int64_t> wide_;
+		const StringColumn *strings_ = nullptr;
+		std::vector<std::uint64_t> slots_;
+		std::size_t mask_ = 0;
+		std::vector<std::uint32_t> next_;
+
+		template<class K>
+		K Key(std::uint32_t row) const {
+			if constexpr (std::is_same_v<K, std::int64_t>) return ints_[row];
+			else return (*strings_)[row];
+		}
+
+		template<class K>
+		void Insert(const K &key, std::uint32_t row) {
+			const std::uint64_t hash = HashKey(key);
+			const std::uint64_t tag = (hash >> 32) << 32;
+			for (std::size_t i = hash & mask_;; i = (i + 1) & mask_) {
+				const std::uint64_t slot = slots_[i];
+				if (slot != 0) {
+					const auto head = static_cast<std::uint32_t>((slot & 0xffffffffu) - 1);
+					if ((slot >> 32) != (hash >> 32) || Key<K>(head) != key) continue;
+					next_[row] = head;
+				}
+				slots_[i] = tag | (static_cast<std::uint64_t>(row) + 1);
+				return;
+			}
+		}
+	};
+
+	// Matching (probe row, build row) pairs of one probe batch; build is kNoRow for the
+	// unmatched rows of a left join.
+	struct Matches {
+		std::vector<std::uint32_t> probe;
+		std::vector<std::uint32_t> build;
+		// Probe keys narrower than int64, widened.
+		std::vector<std::int64_t> wide_keys;
+	};
+
+	void ProbeBatch(const JoinTable &table, const columnar::BatchView::ColumnView &keys, std::span<const std::uint64_t> valid,
+	                bool left_outer, Matches &m) {
+		m.probe.clear();
+		m.build.clear();
+		const auto probe = [&](std::uint32_t r, const auto &key) {
+			const bool null = !valid.empty() && !utils::GetBit(valid.data(), r);
+			std::uint32_t b = null ? kNoRow : table.Find(key);
+			if (b == kNoRow && left_outer) {
+				m.probe.push_back(r);
+				m.build.push_back(kNoRow);
+			}
+			for (; b != kNoRow; b = table.Next(b)) {
+				m.probe.push_back(r);
+				m.build.push_back(b);
+			}
+		};
+		if (const auto *strings = std::get_if<columnar::StringChunkView>(&keys)) {
+			std::uint32_t r = 0;
+			for (const std::string_view key: *strings) probe(r++, key);
+		} else {
+			const auto ints = columnar::WidenInts(keys, m.wide_keys);
+			for (std::size_t r = 0; r < ints.size(); ++r) probe(static_cast<std::uint32_t>(r), ints[r]);
+		}
+	}
+
+	void GatherView(const columnar::BatchView::ColumnView &src, std::span<const std::uint32_t> rows, DataVector &dst) {
+		if (!std::holds_alternative<columnar::StringChunkView>(src)) {
+			std::visit([&](auto &out) {
+				using Vec = std::decay_t<decltype(out)>;
+				if constexpr (!std::is_same_v<Vec, StringColumn>) {
+					const auto ints = std::get<std::span<const typename Vec::value_type> >(src);
+					out.reserve(out.size() + rows.size());
+					for (const auto r: rows) out.push_back(ints[r]);
+				}
+			}, dst);
+			return;
+		}
+		const auto &sv = std::get<columnar::StringChunkView>(src);
+		std::vector<std::uint64_t> offsets(sv.size() + 1, 0);
+		for (std::size_t i = 0; i < sv.size(); ++i) offsets[i + 1] = offsets[i] + sv.Lengths()[i];
+		auto &out = std::get<StringColumn>(dst);
+		out.reserve(out.size() + rows.size());
+		for (const auto r: rows) out.push_back(sv.Data().substr(offsets[r], offsets[r + 1] - offsets[r]));
+	}
+
+	void GatherBuild(const DataVector &src, std::span<const std::uint32_t> rows, DataVector &dst) {
+		if (!std::holds_alternative<StringColumn>(src)) {
+			std::visit([&](auto &out) {
+				using Vec = std::decay_t<decltype(out)>;
+				if constexpr (!std::is_same_v<Vec, StringColumn>) {
+					const auto &ints = std::get<Vec>(src);
+					out.reserve(rows.size());
+					for (const auto r: rows) out.push_back(r == kNoRow ? 0 : ints[r]);
+				}
+			}, dst);
+			return;
+		}
+		const auto &strings = std::get<StringColumn>(src);
+		auto &out = std::get<StringColumn>(dst);
+		out.reserve(rows.size());
+		for (const auto r: rows) out.push_back(r == kNoRow ? std::string_view() : strings[r]);
+	}
+
+	// Marks row i of `col` null where rows[i] is kNoRow or a null row of the source column.
+	void GatherValidity(std::span<const std::uint64_t> valid, std::span<const std::uint32_t> rows, Batch &dst,
+	                    std::size_t col) {
+		for (std::size_t i = 0; i < rows.size(); ++i) {
+			if (rows[i] == kNoRow || (!valid.empty() && !utils::GetBit(valid.data(), rows[i]))) dst.SetNull(col, i);
+		}
+	}
+
+	// Joins one build/probe pair (whole files, or one spilled partition of each) and appends
+	// the result to `writer` in probe batch order. Probe batches are joined and encoded on
+	// plan.threads workers; a window of finished batches waits for its turn to be written.
+	void JoinPass(const Side &build, const Side &probe, const Plan &plan, columnar::ColumnarWriter &writer,
+	              exec::JoinStats &stats) {
+		std::vector<DataVector> build_cols;
+		std::vector<Batch::Validity> build_valid(build.cols.size());
+		{
+			columnar::ColumnarReader reader(build.path, columnar::ReadMode::Mapped);
+			for (std::size_t i = 0; i < build.cols.size(); ++i) {
+				build_cols.push_back(reader.ReadColumn(build.cols[i], &build_valid[i]));
+			}
+		}
+		const JoinTable table(build_cols.front(), build_valid.front());
+		stats.build_rows += std::visit([](const auto &v) { return v.size(); }, build_cols.front());
+
+		columnar::ColumnarReader first(probe.path, columnar::ReadMode::Mapped);
+		const std::size_t nbatches = first.NumBatches();
+		if (nbatches == 0) return;
+		const std::size_t threads = std::clamp<std::size_t>(plan.threads, 1, nbatches);
+		const std::size_t window = 2 * threads;
+
+		struct Slot {
+			std::optional<columnar::EncodedBatch> batch;
+			std::size_t rows = 0;
+			bool ready = false;
+		};
+		std::vector<Slot> slots(window);
+		std::mutex mu;
+		std::condition_variable cv;
+		std::size_t written = 0;
+		std::atomic<std::size_t> next{0};
+		bool abort = false;
+		std::exception_ptr error;
+
+		const auto worker = [&](columnar::ColumnarReader &reader) {
+			Matches m;
+			try {
+				while (true) {
+					const std::size_t idx = next.fetch_add(1);
+					if (idx >= nbatches) return;
+					{
+						std::unique_lock lock(mu);
+						cv.wait(lock, [&] { return abort || idx < written + window; });
+						if (abort) return;
+					}
+
+					std::optional<columnar::EncodedBatch> encoded;
+					const columnar::BatchView view = reader.ReadBatchView(idx, probe.cols);
+					ProbeBatch(table, view.GetColumn(0), view.Validity(0), plan.left_outer, m);
+					if (!m.probe.empty()) {
+						Batch out(plan.schema);
+						for (std::size_t c = 0; c < plan.columns.size(); ++c) {
+							const OutputColumn &oc = plan.columns[c];
+							if (oc.build) GatherBuild(build_cols[oc.pos], m.build, out.GetColumn(c));
+							else GatherView(view.GetColumn(oc.pos), m.probe, out.GetColumn(c));
+						}
+						out.SetRowCount(m.probe.size());
+						for (std::size_t c = 0; c < plan.columns.size(); ++c) {
+							if (!plan.schema[c].nullable) continue;
+							const OutputColumn &oc = plan.columns[c];
+							if (oc.build) GatherValidity(build_valid[oc.pos], m.build, out, c);
+							else GatherValidity(view.Validity(oc.pos), m.probe, out, c);
+						}
+						encoded = writer.EncodeBatch(out);
+					}
+					{
+						std::lock_guard lock(mu);
+						Slot &slot = slots[idx % window];
+						slot.batch = std::move(encoded);
+						slot.rows = m.probe.size();
+						slot.ready = true;
+					}
+					cv.notify_all();
+				}
+			} catch (...) {
+				std::lock_guard lock(mu);
+				if (!error) error = std::current_exception();
+				abort = true;
+				cv.notify_all();
+			}
+		};
+
+		std::vector<std::jthread> workers;
+		std::vector<std::unique_ptr<columnar::ColumnarReader> > readers;
+		workers.emplace_back(worker, std::ref(first));
+		for (std::size_t t = 1; t < threads; ++t) {
+			readers.push_back(std::make_unique<columnar::ColumnarReader>(probe.path, columnar::ReadMode::Mapped));
+			workers.emplace_back(worker, std::ref(*readers.back()));
+		}
+
+		for (std::size_t idx = 0; idx < nbatches; ++idx) {
+			Slot slot;
+			{
+				std::unique_lock lock(mu);
+				cv.wait(lock, [&] { return abort || slots[idx % window].ready; });
+				if (abort) break;
+				slot = std::move(slots[idx % window]);
+				slots[idx % window] = Slot{};
+			}
+			try {
+				if (slot.batch) writer.WriteEncoded(std::move(*slot.batch));
+			} catch (...) {
+				std::lock_guard lock(mu);
+				if (!error) error = std::current_exception();
+				abort = true;
+			}
+			{
+				std::lock_guard lock(mu);
+				written = idx + 1;
+			}
+			cv.notify_all();
+			if (abort) break;
+			stats.output_rows += slot.rows;
+			stats.probe_rows += first.GetBatchMeta(idx).row_count;
+		}
+
+		for (auto &w: workers) w.join();
+		if (error) std::rethrow_exception(error);
+	}
+
+	// Rough in-memory size of a build side: decoded columns plus the hash table.
+	std::size_t EstimateBuildBytes(const columnar::ColumnarReader &reader, std::span<const std::size_t> cols) {
+		std::size_t bytes = 0;
+		for (std::size_t idx = 0; idx < reader.NumBatches(); ++idx) {
+			const auto &meta = reader.GetBatchMeta(idx);
+			bytes += std::size_t{meta.row_count} * (2 * sizeof(std::uint64_t) + sizeof(std::uint32_t));
+			for (const auto c: cols) {
+				bytes += std::size_t{meta.row_count} * utils::ValueWidth(reader.GetSchema()[c].type);
+				if (reader.GetSchema()[c].type == DataType::String) bytes += meta.columns[c].uncompressed_size;
+			}
+		}
+		return bytes;
+	}
+
+	// Spill files of one side of a partitioning pass, with their row counts; the path is
+	// empty for a partition without rows.
+	struct Partitions {
+		std::vector<std::filesystem::path> paths;
+		std::vector<std::size_t> rows;
+	};
+
+	// Writes side.cols of every row to one of `parts` columnar files chosen by the key hash
+	// bits below the top `used` ones, so matching keys of both sides land in the same
+	// partition. A partition's file is created with its first row.
+	Partitions PartitionSide(const Side &side, std::size_t parts, int used, const std::filesystem::path &dir,
+	                         const std::string &prefix) {
+		columnar::ColumnarReader reader(side.path, columnar::ReadMode::Mapped);
+		const Schema schema = reader.ProjectSchema(side.cols);
+		const int shift = 64 - std::countr_zero(parts);
+
+		Partitions out{std::vector<std::filesystem::path>(parts), std::vector<std::size_t>(parts, 0)};
+		std::vector<std::unique_ptr<columnar::ColumnarWriter> > writers(parts);
+		std::vector<std::vector<std::uint32_t> > rows(parts);
+		std::vector<std::int64_t> wide_keys;
+		for (std::size_t idx = 0; idx < reader.NumBatches(); ++idx) {
+			const columnar::BatchView view = reader.ReadBatchView(idx, side.cols);
+			for (auto &r: rows) r.clear();
+			const auto route = [&](std::uint32_t r, std::uint64_t hash) { rows[(hash << used) >> shift].push_back(r); };
+			if (const auto *strings = std::get_if<columnar::StringChunkView>(&view.GetColumn(0))) {
+				std::uint32_t r = 0;
+				for (const std::string_view key: *strings) route(r++, HashKey(key));
+			} else {
+				const auto ints = columnar::WidenInts(view.GetColumn(0), wide_keys);
+				for (std::size_t r = 0; r < ints.size(); ++r) route(static_cast<std::uint32_t>(r), HashKey(ints[r]));
+			}
+
+			for (std::size_t p = 0; p < parts; ++p) {
+				if (rows[p].empty()) continue;
+				if (!writers[p]) {
+					out.paths[p] = dir / (prefix + "-" + std::to_string(p) + ".columnar");
+					writers[p] = std::make_unique<columnar::ColumnarWriter>(out.paths[p], schema);
+				}
+				Batch batch(schema);
+				for (std::size_t c = 0; c < schema.size(); ++c) GatherView(view.GetColumn(c), rows[p], batch.GetColumn(c));
+				batch.SetRowCount(rows[p].size());
+				for (std::size_t c = 0; c < schema.size(); ++c) GatherValidity(view.Validity(c), rows[p], batch, c);
+				writers[p]->WriteBatch(batch);
+				out.rows[p] += rows[p].size();
+			}
+		}
+		for (auto &w: writers) {
+			if (w) w->Finish();
+		}
+		return out;
+	}
+
+	// Grace hash join of a build side estimated at `estimate` bytes, over the budget: both
+	// sides are partitioned on the next hash bits after the top `used` ones and joined
+	// partition by partition. A build partition still over the budget is partitioned again,
+	// unless this pass did not split it (a single heavy key) or the hash bits ran out.
+	void JoinPartitioned(const Side &build, const Side &probe, const Plan &plan, std::size_t budget, std::size_t estimate,
+	                     int used, const std::filesystem::path &dir, const std::string &suffix,
+	                     columnar::ColumnarWriter &writer, exec::JoinStats &stats) {
+		const int max_bits = std::min(std::countr_zero(kMaxFanout), 64 - used);
+		const std::size_t parts = std::clamp<std::size_t>(std::bit_ceil(estimate / std::max<std::size_t>(1, budget) + 1), 2,
+		                                                  std::size_t{1} << max_bits);
+		const int bits = std::countr_zero(parts);
+		const Partitions build_parts = PartitionSide(build, parts, used, dir, "build" + suffix);
+		const Partitions probe_parts = PartitionSide(probe, parts, used, dir, "probe" + suffix);
+		const std::size_t build_total = std::accumulate(build_parts.rows.begin(), build_parts.rows.end(), std::size_t{0});
+
+		std::vector<std::size_t> build_cols(build.cols.size());
+		std::iota(build_cols.begin(), build_cols.end(), 0);
+		std::vector<std::size_t> probe_cols(probe.cols.size());
+		std::iota(probe_cols.begin(), probe_cols.end(), 0);
+		for (std::size_t p = 0; p < parts; ++p) {
+			// Nothing to output without probe rows, nor for an inner join without build rows.
+			if (probe_parts.rows[p] == 0 || (build_parts.rows[p] == 0 && !plan.left_outer)) {
+				stats.build_rows += build_parts.rows[p];
+				stats.probe_rows += probe_parts.rows[p];
+				if (!build_parts.paths[p].empty()) std::filesystem::remove(build_parts.paths[p]);
+				if (!probe_parts.paths[p].empty()) std::filesystem::remove(probe_parts.paths[p]);
+				continue;
+			}
+			const std::string part_suffix = suffix + "-" + std::to_string(p);
+			Side sub_build{build_parts.paths[p], build_cols, build.out};
+			if (sub_build.path.empty()) {
+				sub_build.path = dir / ("build" + part_suffix + ".columnar");
+				const columnar::ColumnarReader reader(build.path, columnar::ReadMode::Mapped);
+				columnar::ColumnarWriter(sub_build.path, reader.ProjectSchema(build.cols)).Finish();
+			}
+			const Side sub_probe{probe_parts.paths[p], probe_cols, probe.out};
+
+			const std::size_t sub_estimate =
+				EstimateBuildBytes(columnar::ColumnarReader(sub_build.path, columnar::ReadMode::Mapped), build_cols);
+			if (sub_estimate > budget && build_parts.rows[p] < build_total && used + bits < 64) {
+				JoinPartitioned(sub_build, sub_probe, plan, budget, sub_estimate, used + bits, dir, part_suffix, writer, stats);
+			} else {
+				JoinPass(sub_build, sub_probe, plan, writer, stats);
+				++stats.partitions;
+			}
+			std::filesystem::remove(sub_build.path);
+			std::filesystem::remove(sub_probe.path);
+		}
+	}
+
+	// Key first, then the output columns (each read once).
+	Side MakeSide(const std::filesystem::path &path, std::size_t key, std::span<const std::size_t> outputs) {
+		Side side{path, {key}, {}};
+		for (const auto c: outputs) {
+			const auto it = std::ranges::find(side.cols, c);
+			side.out.push_back(static_cast<std::size_t>(it - side.cols.begin()));
+			if (it == side.cols.end()) side.cols.push_back(c);
+		}
+		return side;
+	}
+
+	std::vector<std::size_t> ResolveColumns(const columnar::ColumnarReader &reader, const std::vector<std::string> &names) {
+		std::vector<std::size_t> cols;
+		for (const auto &name: names) cols.push_back(reader.ColumnIndex(name));
+		return cols;
+	}
+
+	std::size_t TotalRows(const columnar::ColumnarReader &reader) {
+		std::size_t rows = 0;
+		for (std::size_t idx = 0; idx < reader.NumBatches(); ++idx) rows += reader.GetBatchMeta(idx).row_count;
+		return rows;
+	}
+}
+
+
+namespace exec {
+	JoinStats HashJoin(const std::filesystem::path &left, const std::filesystem::path &right,
+	                   const std::filesystem::path &out, const JoinOptions &options) {
+		const columnar::ColumnarReader left_reader(left, columnar::ReadMode::Mapped);
+		const columnar::ColumnarReader right_reader(right, columnar::ReadMode::Mapped);
+		const Schema &left_schema = left_reader.GetSchema();
+		const Schema &right_schema = right_reader.GetSchema();
+
+		const std::size_t left_key = left_reader.ColumnIndex(options.left_key);
+		const std::size_t right_key = right_reader.ColumnIndex(options.right_key);
+		if (left_schema[left_key].type != right_schema[right_key].type) {
+			throw std::runtime_error("exec: join keys '" + options.left_key + "' and '" + options.right_key +
+			                         "' have different types");
+		}
+
+		std::vector<std::size_t> left_out = ResolveColumns(left_reader, options.left_columns);
+		if (options.left_columns.empty()) left_out = left_reader.AllColumns();
+		std::vector<std::size_t> right_out = ResolveColumns(right_reader, options.right_columns);
+		if (options.right_columns.empty()) {
+			for (std::size_t c = 0; c < right_schema.size(); ++c) {
+				if (c != right_key) right_out.push_back(c);
+			}
+		}
+
+		JoinStats stats;
+		stats.build_is_left = options.type == JoinType::Inner && TotalRows(left_reader) < TotalRows(right_reader);
+		const Side left_side = MakeSide(left, left_key, left_out);
+		const Side right_side = MakeSide(right, right_key, right_out);
+		const Side &build = stats.build_is_left ? left_side : right_side;
+		const Side &probe = stats.build_is_left ? right_side : left_side;
+
+		Plan plan;
+		plan.left_outer = options.type == JoinType::Left;
+		plan.threads = options.threads;
+		for (std::size_t i = 0; i < left_out.size(); ++i) {
+			plan.schema.push_back(left_schema[left_out[i]]);
+			plan.columns.push_back({stats.build_is_left, left_side.out[i]});
+		}
+		for (std::size_t i = 0; i < right_out.size(); ++i) {
+			ColumnSchema col = right_schema[right_out[i]];
+			col.nullable = col.nullable || plan.left_outer;
+			if (std::ranges::find(plan.schema, col.name, &ColumnSchema::name) != plan.schema.end()) {
+				col.name = "right." + col.name;
+			}
+			plan.schema.push_back(col);
+			plan.columns.push_back({!stats.build_is_left, right_side.out[i]});
+		}
+
+		columnar::ColumnarWriter writer(out, plan.schema, options.writer);
+		const std::size_t estimate = EstimateBuildBytes(stats.build_is_left ? left_reader : right_reader, build.cols);
+		if (estimate <= options.memory_budget) {
+			JoinPass(build, probe, plan, writer, stats);
+			writer.Finish();
+			return stats;
+		}
+
+		// Grace hash join: partition both sides by key hash so each build partition fits.
+		const SpillDir spill(options.spill_dir, "columnar-join");
+		stats.partitions = 0;
+		JoinPartitioned(build, probe, plan, options.memory_budget, estimate, 0, spill.Path(), "", writer, stats);
+		writer.Finish();
+		return stats;
+	}
+}
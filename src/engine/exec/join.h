@@ -0,0 +1,58 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+#include "columnar_writer.h"
+
+namespace exec {
+
+	enum class JoinType : std::uint8_t {
+		Inner,
+		// Every left row; right columns are nullable and null for unmatched rows.
+		Left,
+	};
+
+	struct JoinOptions {
+		JoinType type = JoinType::Inner;
+		// Equi-join key columns, both int64 or both string. Null keys match nothing.
+		std::string left_key;
+		std::string right_key;
+		// Output columns: the left ones, then the right ones. Empty selects every left column
+		// and every right column except the right key. A right column whose name is already
+		// taken on the left is renamed to "right.<name>".
+		std::vector<std::string> left_columns;
+		std::vector<std::string> right_columns;
+		// Probe workers.
+		std::size_t threads = 1;
+		// Estimated bytes the build side may take in memory; above it both inputs are
+		// hash-partitioned to spill files, again for partitions still over the budget, and
+		// joined one partition at a time.
+		std::size_t memory_budget = std::size_t{256} << 20;
+		// Where spill files go; empty uses the system temp directory.
+		std::filesystem::path spill_dir;
+		columnar::WriterOptions writer;
+	};
+
+	struct JoinStats {
+		std::size_t build_rows = 0;
+		std::size_t probe_rows = 0;
+		std::size_t output_rows = 0;
+		// Partitions joined; 1 when the build side fit in memory.
+		std::size_t partitions = 1;
+		bool build_is_left = false;
+	};
+
+	// Hash join of two columnar files into a new one at `out`. The hash table is built on the
+	// right file, or on the left one for inner joins when it has fewer rows, and the other
+	// file's batches are probed in parallel. Output rows follow probe order (per partition
+	// when spilled), with the matches of one probe row in build order.
+	JoinStats HashJoin(const std::filesystem::path& left,
+	                   const std::filesystem::path& right,
+	                   const std::filesystem::path& out,
+	                   const JoinOptions& options);
+
+}
@@ -0,0 +1,194 @@
+#include "query.h"
+
+#include <algorithm>
+#include <optional>
+#include <ostream>
+#include <stdexcept>
+#include <type_traits>
+
+#include "aggregate.h"
+#include "batch.h"
+#include "columnar_reader.h"
+#include "csvwriter.h"
+#include "filter.h"
+#include "secondary_index.h"
+
+namespace {
+	// Copies the rows in `sel` out of the view.
+	Batch Gather(const columnar::BatchView &view, const exec::SelectionVector &sel) {
+		Batch out(view.GetSchema());
+		for (std::size_t col = 0; col < view.ColCount(); ++col) {
+			if (utils::IsInteger(view.GetSchema()[col].type)) {
+				std::visit([&](auto &dst) {
+					using Vec = std::decay_t<decltype(dst)>;
+					if constexpr (!std::is_same_v<Vec, StringColumn>) {
+						const auto ints = std::get<std::span<const typename Vec::value_type> >(view.GetColumn(col));
+						dst.resize(sel.size());
+						for (std::size_t i = 0; i < sel.size(); ++i) dst[i] = ints[sel[i]];
+					}
+				}, out.GetColumn(col));
+				continue;
+			}
+
+			const auto &src = view.StringColumnView(col);
+			auto &dst = std::get<StringColumn>(out.GetColumn(col));
+			dst.reserve(sel.size());
+			const auto lens = src.Lengths();
+			const char *data = src.Data().data();
+			std::size_t pos = 0;
+			std::size_t row = 0;
+			for (const auto want: sel) {
+				for (; row < want; ++row) pos += lens[row];
+				dst.push_back(std::string_view(data + pos, lens[row]));
+			}
+		}
+		out.SetRowCount(sel.size());
+		for (std::size_t col = 0; col < view.ColCount(); ++col) {
+			const auto valid = view.Validity(col);
+			if (valid.empty()) continue;
+			for (std::size_t i = 0; i < sel.size(); ++i) {
+				if (!utils::GetBit(valid.data(), sel[i])) out.SetNull(col, i);
+			}
+		}
+		return out;
+	}
+
+	// Batches holding rows equal to a top-level equality of `where`, from a secondary index
+	// file on its column (at SecondaryIndexPath) that is current; nullopt when there is none.
+	// A corrupt or truncated index is passed over like a stale one.
+	std::optional<std::vector<bool> > IndexedBatches(const std::filesystem::path &path, const exec::Expr &where,
+	                                                 const columnar::ColumnarReader &reader) {
+		std::vector<const exec::Expr *> conjuncts;
+		if (where.kind == exec::ExprKind::And) {
+			for (const auto &child: where.children) conjuncts.push_back(&child);
+		} else {
+			conjuncts.push_back(&where);
+		}
+		for (const exec::Expr *e: conjuncts) {
+			if (e->kind != exec::ExprKind::Compare || e->compare.op != columnar::CompareOp::Eq) continue;
+			const auto index_path = columnar::SecondaryIndexPath(path, reader.GetSchema()[e->compare.column].name);
+			if (!std::filesystem::exists(index_path)) continue;
+			try {
+				const columnar::SecondaryIndex index(index_path);
+				if (!index.Matches(reader) || index.Column() != e->compare.column) continue;
+
+				std::vector<bool> batches(reader.NumBatches(), false);
+				for (const auto loc: index.Find(e->compare.value)) batches[loc.batch] = true;
+				return batches;
+			} catch (const std::runtime_error &) {
+				continue;
+			}
+		}
+		return std::nullopt;
+	}
+
+	bool IsAggregation(const exec::QueryOptions &options, const Schema &schema) {
+		return !options.group_by.empty() || std::ranges::any_of(options.select, [&](const std::string &item) {
+			return exec::ParseAggregate(item, schema).has_value();
+		});
+	}
+
+	// Aggregation path of RunQuery: runs exec::Aggregate and reorders its columns (keys,
+	// then aggregates) into the select order.
+	Batch RunAggregation(const std::filesystem::path &path, const Schema &schema, const exec::QueryOptions &options,
+	                     const std::optional<exec::Expr> &where, exec::AggregateStats &stats) {
+		exec::AggregateOptions agg;
+		agg.where = where;
+		agg.threads = options.threads;
+		for (const auto &name: options.group_by) {
+			const auto it = std::ranges::find(schema, name, &ColumnSchema::name);
+			if (it == schema.end()) throw std::runtime_error("exec: unknown column '" + name + "' in --group-by");
+			agg.group_by.push_back(static_cast<std::size_t>(it - schema.begin()));
+		}
+
+		// Position of each output column in the Aggregate result: keys first, then aggregates.
+		std::vector<std::size_t> order;
+		const std::size_t nkeys = agg.group_by.size();
+		if (options.select.empty()) {
+			for (std::size_t k = 0; k <= nkeys; ++k) order.push_back(k);
+			agg.aggregates.push_back({exec::AggFunc::Count, std::nullopt});
+		}
+		for (const auto &item: options.select) {
+			if (auto spec = exec::ParseAggregate(item, schema)) {
+				order.push_back(nkeys + agg.aggregates.size());
+				agg.aggregates.push_back(*spec);
+				continue;
+			}
+			const auto it = std::ranges::find(options.group_by, item);
+			if (it == options.group_by.end()) {
+				throw std::runtime_error("exec: column '" + item + "' must be in --group-by or inside an aggregate");
+			}
+			order.push_back(static_cast<std::size_t>(it - options.group_by.begin()));
+		}
+
+		Batch result = exec::Aggregate(path, agg, &stats);
+		Schema out_schema;
+		for (const auto i: order) out_schema.push_back(result.GetSchema()[i]);
+		Batch out(out_schema);
+		for (std::size_t c = 0; c < order.size(); ++c) {
+			out.GetColumn(c) = result.GetColumn(order[c]);
+			out.GetValidity(c) = result.GetValidity(order[c]);
+		}
+		out.SetRowCount(result.RowCount());
+		return out;
+	}
+}
+
+
+namespace exec {
+	QueryStats RunQuery(const std::filesystem::path &path, const QueryOptions &options, std::ostream &out) {
+		columnar::ColumnarReader reader(path, columnar::ReadMode::Mapped);
+		const Schema &schema = reader.GetSchema();
+
+		std::optional<Expr> where;
+		std::vector<std::size_t> where_cols;
+		Expr local;
+		if (!options.where.empty()) {
+			where = ParseWhere(options.where, schema);
+			where_cols = ReferencedColumns(*where);
+			local = RemapColumns(*where, where_cols);
+		}
+
+		QueryStats stats;
+		stats.batches = reader.NumBatches();
+		CSVWriter writer(out, options.delimiter);
+		if (IsAggregation(options, schema)) {
+			exec::AggregateStats agg_stats;
+			const Batch result = RunAggregation(path, schema, options, where, agg_stats);
+			if (!writer.WriteBatch(result)) {
+				throw std::runtime_error("failed to write query output");
+			}
+			stats.rows_matched = result.RowCount();
+			stats.batches_scanned = agg_stats.batches_scanned;
+			stats.rows_scanned = agg_stats.rows_scanned;
+			return stats;
+		}
+
+		std::vector<std::size_t> select;
+		for (const auto &name: options.select) select.push_back(reader.ColumnIndex(name));
+		if (select.empty()) select = reader.AllColumns();
+		const auto indexed = where ? IndexedBatches(path, *where, reader) : std::nullopt;
+		for (std::size_t idx = 0; idx < reader.NumBatches(); ++idx) {
+			const columnar::BatchMeta &meta = reader.GetBatchMeta(idx);
+			if (meta.row_count == 0 || (indexed && !(*indexed)[idx])) continue;
+			if (where && !MayMatch(*where, meta, schema)) continue;
+			if (where && !MayMatchBlooms(*where, reader, idx)) continue;
+			++stats.batches_scanned;
+			stats.rows_scanned += meta.row_count;
+
+			SelectionVector sel;
+			if (where) {
+				sel = ToSelection(Evaluate(local, reader.ReadBatchView(idx, where_cols)));
+				if (sel.empty()) continue;
+			}
+			stats.rows_matched += where ? sel.size() : meta.row_count;
+
+			const columnar::BatchView view = reader.ReadBatchView(idx, select);
+			const Batch batch = !where || sel.size() == meta.row_count ? view.ToBatch() : Gather(view, sel);
+			if (!writer.WriteBatch(batch)) {
+				throw std::runtime_error("failed to write query output");
+			}
+		}
+		return stats;
+	}
+}
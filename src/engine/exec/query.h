@@ -0,0 +1,42 @@
+#pragma once
+
+#include <cstddef>
+#include <filesystem>
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+namespace exec {
+
+	struct QueryOptions {
+		// Filter in ParseWhere syntax; empty matches every row.
+		std::string where;
+		// Output columns, in order; empty selects every column. Items such as `sum(bytes)`
+		// (see ParseAggregate) turn the query into an aggregation, as does a non-empty
+		// group_by; the other items must then be group_by columns. An aggregation with an
+		// empty select outputs the group_by columns and count(*).
+		std::vector<std::string> select;
+		std::vector<std::string> group_by;
+		char delimiter = ',';
+		// Aggregation workers.
+		std::size_t threads = 1;
+	};
+
+	struct QueryStats {
+		std::size_t batches = 0;
+		// Batches left after pruning on secondary indexes, chunk stats and Bloom filters.
+		std::size_t batches_scanned = 0;
+		std::size_t rows_scanned = 0;
+		// Output rows; for an aggregation the groups.
+		std::size_t rows_matched = 0;
+	};
+
+	// Streams the selected columns of the rows matching `options.where` to `out` as CSV, in
+	// file order. Batches whose chunk stats or Bloom filters rule the filter out are not
+	// read, nor, when a current secondary index file (see SecondaryIndexPath) exists for a
+	// column the filter tests for equality, batches the index has no match in. For the
+	// others only the filter columns are read first, and the output columns only when some
+	// row matches. Aggregations write one row per group, sorted by key.
+	QueryStats RunQuery(const std::filesystem::path& path, const QueryOptions& options, std::ostream& out);
+
+}
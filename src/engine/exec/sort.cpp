@@ -0,0 +1,443 @@
+#include "sort.h"
+
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include <future>
+#include <limits>
+#include <memory>
+#include <numeric>
+#include <optional>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+
+#include "batch.h"
+#include "columnar_reader.h"
+#include "spill_dir.h"
+#include "utils/thread_pool.h"
+#include "utils/utils.h"
+
+namespace {
+	// Smallest batches run files are written in, however many runs share the merge budget.
+	constexpr std::size_t kMinRunBatchRows = 1024;
+
+	struct KeyColumn {
+		std::size_t col;
+		bool descending;
+	};
+
+	// Key columns of one batch resolved to typed pointers.
+	class KeyAccess {
+	public:
+		KeyAccess() = default;
+
+		KeyAccess(const Batch &batch, std::span<const KeyColumn> keys) {
+			for (const auto &key: keys) {
+				const auto &column = batch.GetColumn(key.col);
+				const auto &valid = batch.GetValidity(key.col);
+				Key k{nullptr, 0, std::get_if<StringColumn>(&column), valid.empty() ? nullptr : valid.data(), key.descending};
+				std::visit([&](const auto &values) {
+					if constexpr (!std::is_same_v<std::decay_t<decltype(values)>, StringColumn>) {
+						k.ints = values.data();
+						k.width = sizeof(values[0]);
+					}
+				}, column);
+				keys_.push_back(k);
+			}
+		}
+
+		// Three-way comparison of row `a` of this batch with row `b` of `other`. Nulls come
+		// before every value (after, when descending).
+		int Compare(std::size_t a, const KeyAccess &other, std::size_t b) const {
+			for (std::size_t k = 0; k < keys_.size(); ++k) {
+				const Key &key = keys_[k];
+				const bool na = key.Null(a);
+				const bool nb = other.keys_[k].Null(b);
+				int c;
+				if (na || nb) {
+					c = static_cast<int>(nb) - static_cast<int>(na);
+				} else if (key.ints) {
+					const std::int64_t x = key.Int(a);
+					const std::int64_t y = other.keys_[k].Int(b);
+					c = (x > y) - (x < y);
+				} else {
+					const int r = (*key.strings)[a].compare((*other.keys_[k].strings)[b]);
+					c = (r > 0) - (r < 0);
+				}
+				if (c != 0) return key.descending ? -c : c;
+			}
+			return 0;
+		}
+
+	private:
+		struct Key {
+			// Integer keys: the values and their width in bytes.
+			const void *ints;
+			std::size_t width;
+			const StringColumn *strings;
+			// Validity bitmap; null when the batch has no nulls in the column.
+			const std::uint64_t *valid;
+			bool descending;
+
+			bool Null(std::size_t row) const { return valid && !utils::GetBit(valid, row); }
+
+			std::int64_t Int(std::size_t row) const {
+				switch (width) {
+					case 1: return static_cast<const std::int8_t *>(ints)[row];
+					case 2: return static_cast<const std::int16_t *>(ints)[row];
+					case 4: return static_cast<const std::int32_t *>(ints)[row];
+					default: return static_cast<const std::int64_t *>(ints)[row];
+				}
+			}
+		};
+
+		std::vector<Key> keys_;
+	};
+
+	// Rows of `src` in `order`.
+	Batch TakeRows(const Batch &src, std::span<const std::uint32_t> order) {
+		Batch out(src.GetSchema());
+		for (std::size_t col = 0; col < src.ColCount(); ++col) {
+			if (!std::holds_alternative<StringColumn>(src.GetColumn(col))) {
+				std::visit([&](auto &dst) {
+					using Vec = std::decay_t<decltype(dst)>;
+					if constexpr (!std::is_same_v<Vec, StringColumn>) {
+						const auto &ints = std::get<Vec>(src.GetColumn(col));
+						dst.resize(order.size());
+						for (std::size_t i = 0; i < order.size(); ++i) dst[i] = ints[order[i]];
+					}
+				}, out.GetColumn(col));
+				continue;
+			}
+			const auto &strings = std::get<StringColumn>(src.GetColumn(col));
+			auto &dst = std::get<StringColumn>(out.GetColumn(col));
+			std::size_t bytes = 0;
+			for (const auto row: order) bytes += strings[row].size();
+			dst.reserve(order.size(), bytes);
+			for (const auto row: order) dst.push_back(strings[row]);
+		}
+		out.SetRowCount(order.size());
+		for (std::size_t col = 0; col < src.ColCount(); ++col) {
+			const auto &valid = src.GetValidity(col);
+			if (valid.empty()) continue;
+			for (std::size_t i = 0; i < order.size(); ++i) {
+				if (!utils::GetBit(valid.data(), order[i])) out.SetNull(col, i);
+			}
+		}
+		return out;
+	}
+
+	// Row order that stably sorts `batch` by the keys.
+	std::vector<std::uint32_t> SortedOrder(const Batch &batch, std::span<const KeyColumn> keys) {
+		if (batch.RowCount() > std::numeric_limits<std::uint32_t>::max()) {
+			throw std::runtime_error("exec: sort run exceeds 2^32 rows");
+		}
+		std::vector<std::uint32_t> order(batch.RowCount());
+		std::iota(order.begin(), order.end(), 0u);
+		const KeyAccess access(batch, keys);
+		std::ranges::stable_sort(order, [&](std::uint32_t a, std::uint32_t b) {
+			return access.Compare(a, access, b) < 0;
+		});
+		return order;
+	}
+
+	// Bytes the rows of one input batch take in a Batch.
+	std::size_t BatchBytes(const columnar::ColumnarReader &reader, std::size_t idx) {
+		const auto &meta = reader.GetBatchMeta(idx);
+		std::size_t bytes = 0;
+		for (std::size_t c = 0; c < meta.columns.size(); ++c) {
+			bytes += std::size_t{meta.row_count} * utils::ValueWidth(reader.GetSchema()[c].type);
+			if (reader.GetSchema()[c].type == DataType::String) bytes += meta.columns[c].uncompressed_size;
+		}
+		return bytes;
+	}
+
+	// A sorted run read one batch at a time, from memory or from a run file.
+	class RunCursor {
+	public:
+		RunCursor(std::vector<Batch> batches, std::span<const KeyColumn> keys)
+			: keys_(keys), batches_(std::move(batches)) {
+			Load();
+		}
+
+		RunCursor(const std::filesystem::path &path, std::span<const KeyColumn> keys)
+			: keys_(keys),
+			  reader_(std::make_unique<columnar::ColumnarReader>(path, columnar::ReadMode::Mapped)) {
+			Load();
+		}
+
+		bool Done() const { return !current_; }
+		const Batch &Current() const { return *current_; }
+		std::size_t Row() const { return row_; }
+		const KeyAccess &Keys() const { return access_; }
+
+		// Moves to `row` of the current batch, or on to the next batch when it is the row count.
+		void Seek(std::size_t row) {
+			row_ = row;
+			if (row_ == current_->RowCount()) Load();
+		}
+
+	private:
+		void Load() {
+			row_ = 0;
+			current_.reset();
+			for (;;) {
+				if (reader_) {
+					if (next_ == reader_->NumBatches()) break;
+					current_ = reader_->ReadBatch(next_++);
+				} else {
+					if (next_ == batches_.size()) break;
+					current_ = std::move(batches_[next_++]);
+				}
+				if (current_->RowCount() > 0) break;
+			}
+			if (current_ && current_->RowCount() == 0) current_.reset();
+			access_ = current_ ? KeyAccess(*current_, keys_) : KeyAccess();
+		}
+
+		std::span<const KeyColumn> keys_;
+		std::unique_ptr<columnar::ColumnarReader> reader_;
+		std::vector<Batch> batches_;
+		std::size_t next_ = 0;
+		std::optional<Batch> current_;
+		std::size_t row_ = 0;
+		KeyAccess access_;
+	};
+
+	// Tournament tree over the runs' head rows: tree_[0] is the run with the smallest one
+	// and each inner node holds the loser of its match, so replacing the winner's head only
+	// replays the log2(k) matches on its path to the root. Ties go to the earlier run, which
+	// keeps the merge stable.
+	class LoserTree {
+	public:
+		explicit LoserTree(std::vector<RunCursor> &runs)
+			: runs_(runs), tree_(runs.size(), kNone) {
+			for (std::size_t i = runs_.size(); i-- > 0;) Replay(i);
+		}
+
+		std::size_t Winner() const { return tree_[0]; }
+		bool Done() const { return runs_.empty() || runs_[tree_[0]].Done(); }
+
+		// Restores the tree after the head of run `leaf` changed.
+		void Replay(std::size_t leaf) {
+			std::size_t winner = leaf;
+			for (std::size_t node = (leaf + runs_.size()) / 2; node > 0; node /= 2) {
+				if (Beats(tree_[node], winner)) std::swap(tree_[node], winner);
+			}
+			tree_[0] = winner;
+		}
+
+	private:
+		// Placeholder for matches not played yet while building; beats every run.
+		static constexpr std::size_t kNone = std::numeric_limits<std::size_t>::max();
+
+		bool Beats(std::size_t a, std::size_t b) const {
+			if (a == kNone) return true;
+			if (b == kNone) return false;
+			const RunCursor &x = runs_[a];
+			const RunCursor &y = runs_[b];
+			if (x.Done() || y.Done()) return !x.Done() || (y.Done() && a < b);
+			const int c = x.Keys().Compare(x.Row(), y.Keys(), y.Row());
+			return c < 0 || (c == 0 && a < b);
+		}
+
+		std::vector<RunCursor> &runs_;
+		std::vector<std::size_t> tree_;
+	};
+
+	// K-way merge of sorted runs into batches of `batch_rows` passed to `emit`.
+	void Merge(std::vector<RunCursor> &runs, const Schema &schema, std::size_t batch_rows,
+	           const std::function<void(const Batch &)> &emit) {
+		LoserTree tree(runs);
+		Batch out(schema);
+		out.Reserve(batch_rows);
+		while (!tree.Done()) {
+			const std::size_t w = tree.Winner();
+			RunCursor &run = runs[w];
+			const Batch &src = run.Current();
+			const std::size_t begin = run.Row();
+			const std::size_t limit = std::min(src.RowCount(), begin + (batch_rows - out.RowCount()));
+
+			// Take the winner's following rows in one slice for as long as they keep winning.
+			std::size_t end = begin + 1;
+			for (; end < limit; ++end) {
+				run.Seek(end);
+				tree.Replay(w);
+				if (tree.Winner() != w) break;
+			}
+			out.AppendRows(src, begin, end - begin);
+			if (end == limit) {
+				run.Seek(end);
+				tree.Replay(w);
+			}
+
+			if (out.RowCount() == batch_rows) {
+				emit(out);
+				out.Clear();
+			}
+		}
+		if (out.RowCount() > 0) emit(out);
+	}
+
+	void MergeToFile(std::vector<RunCursor> &runs, const Schema &schema, std::size_t batch_rows,
+	                 const std::filesystem::path &path, const columnar::WriterOptions &options) {
+		columnar::ColumnarWriter writer(path, schema, options);
+		Merge(runs, schema, batch_rows, [&](const Batch &batch) { writer.WriteBatch(batch); });
+		writer.Finish();
+	}
+
+	struct BatchRange {
+		std::size_t begin;
+		std::size_t end;
+	};
+
+	// Splits the input batches into contiguous ranges of at most `budget` bytes (one batch
+	// at least), so runs concatenated in range order are the input.
+	std::vector<BatchRange> SplitRuns(const std::vector<std::size_t> &bytes, std::size_t budget) {
+		std::vector<BatchRange> ranges;
+		std::size_t used = 0;
+		for (std::size_t idx = 0; idx < bytes.size(); ++idx) {
+			if (ranges.empty() || (used + bytes[idx] > budget && ranges.back().end > ranges.back().begin)) {
+				ranges.push_back({idx, idx});
+				used = 0;
+			}
+			ranges.back().end = idx + 1;
+			used += bytes[idx];
+		}
+		return ranges;
+	}
+}
+
+
+namespace exec {
+	SortKey ParseSortKey(std::string_view text) {
+		const auto [column, descending] = utils::ParseSortKey(text);
+		return {std::string(column), descending};
+	}
+
+	SortStats ExternalSort(const std::filesystem::path &in, const std::filesystem::path &out,
+	                       const SortOptions &options) {
+		if (options.keys.empty()) throw std::runtime_error("exec: sort needs at least one key");
+		if (options.batch_rows == 0) throw std::runtime_error("exec: sort batch_rows must be positive");
+
+		columnar::ColumnarReader reader(in, columnar::ReadMode::Mapped);
+		const Schema &schema = reader.GetSchema();
+		std::vector<KeyColumn> keys;
+		for (const auto &key: options.keys) keys.push_back({reader.ColumnIndex(key.column), key.descending});
+
+		SortStats stats;
+		std::vector<std::size_t> bytes(reader.NumBatches());
+		std::size_t total_bytes = 0;
+		for (std::size_t idx = 0; idx < bytes.size(); ++idx) {
+			bytes[idx] = BatchBytes(reader, idx);
+			total_bytes += bytes[idx];
+			stats.rows += reader.GetBatchMeta(idx).row_count;
+		}
+		const std::size_t row_bytes = std::max<std::size_t>(1, total_bytes / std::max<std::size_t>(1, stats.rows));
+
+		// Everything fits: sort one range per worker and merge them straight from memory.
+		// Otherwise each worker holds one run of at most its share of the budget at a time.
+		const std::size_t threads = std::max<std::size_t>(1, options.threads);
+		const bool in_memory = total_bytes <= options.memory_budget;
+		const std::size_t run_budget = in_memory
+			                               ? (total_bytes + threads - 1) / threads
+			                               : options.memory_budget / threads;
+		const std::vector<BatchRange> ranges = SplitRuns(bytes, run_budget);
+		stats.runs = ranges.size();
+
+		// Run files are written in batches small enough for every run to have one buffered
+		// while merging, down to kMinRunBatchRows; past that the merge takes several passes.
+		const std::size_t run_batch_rows = std::clamp(
+			options.memory_budget / (std::max<std::size_t>(1, ranges.size()) * row_bytes),
+			std::min(kMinRunBatchRows, options.batch_rows), options.batch_rows);
+		const std::size_t fan_in = std::max<std::size_t>(2, options.memory_budget / (run_batch_rows * row_bytes));
+
+		std::optional<SpillDir> spill;
+		if (!in_memory) spill.emplace(options.spill_dir, "columnar-sort");
+		const auto run_path = [&](std::size_t pass, std::size_t i) {
+			return spill->Path() / ("run-" + std::to_string(pass) + "-" + std::to_string(i) + ".columnar");
+		};
+		columnar::WriterOptions run_writer;
+		run_writer.codec = columnar::Codec::None;
+		run_writer.encode_threads = 1;
+
+		std::vector<std::vector<Batch> > memory_runs(in_memory ? ranges.size() : 0);
+		std::atomic<std::size_t> next{0};
+		const auto worker = [&] {
+			columnar::ColumnarReader local(in, columnar::ReadMode::Mapped);
+			for (std::size_t r = next++; r < ranges.size(); r = next++) {
+				Batch rows(schema);
+				for (std::size_t idx = ranges[r].begin; idx < ranges[r].end; ++idx) {
+					const Batch batch = local.ReadBatch(idx);
+					rows.AppendRows(batch, 0, batch.RowCount());
+				}
+				const std::vector<std::uint32_t> order = SortedOrder(rows, keys);
+				const std::span<const std::uint32_t> all(order);
+
+				if (in_memory) {
+					for (std::size_t i = 0; i < order.size(); i += options.batch_rows) {
+						memory_runs[r].push_back(TakeRows(rows, all.subspan(i, std::min(options.batch_rows, order.size() - i))));
+					}
+					continue;
+				}
+				columnar::ColumnarWriter writer(run_path(0, r), schema, run_writer);
+				for (std::size_t i = 0; i < order.size(); i += run_batch_rows) {
+					writer.WriteBatch(TakeRows(rows, all.subspan(i, std::min(run_batch_rows, order.size() - i))));
+				}
+				writer.Finish();
+			}
+		};
+
+		utils::ThreadPool pool(threads);
+		{
+			std::vector<std::future<void> > done;
+			for (std::size_t t = 0; t < threads; ++t) done.push_back(pool.Submit(worker));
+			for (auto &f: done) f.wait();
+			for (auto &f: done) f.get();
+		}
+
+		std::vector<RunCursor> runs;
+		if (in_memory) {
+			for (auto &batches: memory_runs) runs.emplace_back(std::move(batches), keys);
+		} else {
+			std::vector<std::filesystem::path> files;
+			for (std::size_t r = 0; r < ranges.size(); ++r) files.push_back(run_path(0, r));
+
+			// Merge groups of adjacent runs until one pass can take them all; keeping them
+			// adjacent keeps equal keys in input order.
+			while (files.size() > fan_in) {
+				++stats.merge_passes;
+				std::vector<std::filesystem::path> merged;
+				for (std::size_t i = 0; i < files.size(); i += fan_in) {
+					const std::size_t end = std::min(files.size(), i + fan_in);
+					if (end - i == 1) {
+						merged.push_back(files[i]);
+						continue;
+					}
+					std::vector<RunCursor> group;
+					for (std::size_t f = i; f < end; ++f) group.emplace_back(files[f], keys);
+					merged.push_back(run_path(stats.merge_passes, merged.size()));
+					MergeToFile(group, schema, run_batch_rows, merged.back(), run_writer);
+					group.clear();
+					for (std::size_t f = i; f < end; ++f) std::filesystem::remove(files[f]);
+				}
+				files = std::move(merged);
+			}
+			++stats.merge_passes;
+			for (const auto &file: files) runs.emplace_back(file, keys);
+		}
+
+		// The file format's sort order has no place for nulls, so it records the keys up to the
+		// first nullable one.
+		columnar::WriterOptions writer = options.writer;
+		writer.sort_by.clear();
+		for (const auto &key: keys) {
+			if (schema[key.col].nullable) break;
+			writer.sort_by.push_back({static_cast<std::uint32_t>(key.col), key.descending});
+		}
+		MergeToFile(runs, schema, options.batch_rows, out, writer);
+		return stats;
+	}
+}
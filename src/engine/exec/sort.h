@@ -0,0 +1,54 @@
+#pragma once
+
+#include <cstddef>
+#include <filesystem>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "columnar_writer.h"
+
+namespace exec {
+
+	struct SortKey {
+		std::string column;
+		bool descending = false;
+	};
+
+	// Parses "column", "column:asc" or "column:desc".
+	SortKey ParseSortKey(std::string_view text);
+
+	struct SortOptions {
+		// Compared in order; ints numerically, strings bytewise; nulls first (last when descending).
+		std::vector<SortKey> keys;
+		// Workers sorting runs in parallel.
+		std::size_t threads = 1;
+		// Estimated bytes of rows held in memory at once, split across the workers while
+		// generating runs and across the runs' read buffers while merging.
+		std::size_t memory_budget = std::size_t{256} << 20;
+		// Where run files go; empty uses the system temp directory.
+		std::filesystem::path spill_dir;
+		// Rows per output batch.
+		std::size_t batch_rows = 65536;
+		columnar::WriterOptions writer;
+	};
+
+	struct SortStats {
+		std::size_t rows = 0;
+		// Sorted runs generated from the input; 1 when it was sorted in one piece.
+		std::size_t runs = 0;
+		// Merge passes over spilled runs, including the final one into `out`.
+		std::size_t merge_passes = 0;
+	};
+
+	// Stable external merge sort of a columnar file into a new one at `out`. Contiguous
+	// ranges of input batches are sorted in parallel into runs, which stay in memory when
+	// the whole input fits the budget and are spilled to temporary columnar files otherwise,
+	// then merged with a loser tree. When there are more spilled runs than the budget can
+	// buffer at once, they are merged in several passes. The output records the keys before
+	// the first nullable one as its sort order, so readers can Lookup/Range on the first one.
+	SortStats ExternalSort(const std::filesystem::path& in,
+	                       const std::filesystem::path& out,
+	                       const SortOptions& options);
+
+}
@@ -0,0 +1,27 @@
+#include "spill_dir.h"
+
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+namespace exec {
+	SpillDir::SpillDir(const std::filesystem::path &parent, std::string_view prefix) {
+		const auto base = parent.empty() ? std::filesystem::temp_directory_path() : parent;
+		std::filesystem::create_directories(base);
+		// mkdtemp creates a new directory or fails, so an existing one is never taken over
+		// (and later removed) as ours.
+		std::string name = (base / (std::string(prefix) + "-XXXXXX")).string();
+		if (!::mkdtemp(name.data())) {
+			throw std::runtime_error("exec: failed to create spill directory under " + base.string() + ": " +
+			                         std::strerror(errno));
+		}
+		path_ = name;
+	}
+
+	SpillDir::~SpillDir() {
+		std::error_code ec;
+		std::filesystem::remove_all(path_, ec);
+	}
+}
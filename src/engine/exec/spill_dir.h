@@ -0,0 +1,24 @@
+#pragma once
+
+#include <filesystem>
+#include <string_view>
+
+namespace exec {
+
+	// Private directory for an operator's spill files under `parent` (the system temp
+	// directory if empty), removed with everything in it on destruction.
+	class SpillDir {
+	public:
+		SpillDir(const std::filesystem::path& parent, std::string_view prefix);
+		~SpillDir();
+
+		SpillDir(const SpillDir&) = delete;
+		SpillDir& operator=(const SpillDir&) = delete;
+
+		const std::filesystem::path& Path() const { return path_; }
+
+	private:
+		std::filesystem::path path_;
+	};
+
+}
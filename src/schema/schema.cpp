@@ -7,7 +7,6 @@
 #include <algorithm>
 #include <cctype>
 #include <fstream>
-#include <optional>
 #include <stdexcept>
 #include <string>
 #include <unordered_set>
@@ -29,6 +28,12 @@ DataType ParseColumnType(std::string_view s) {
 
 	if (low == "int64") return DataType::Int64;
 	if (low == "string") return DataType::String;
+	if (low == "int32") return DataType::Int32;
+	if (low == "int16") return DataType::Int16;
+	if (low == "int8") return DataType::Int8;
+	if (low == "bool") return DataType::Bool;
+	if (low == "date") return DataType::Date;
+	if (low == "timestamp") return DataType::Timestamp;
 
 	throw std::runtime_error("unknown column type: '" + std::string(s) + "'");
 }
@@ -37,6 +42,12 @@ std::string ToString(DataType t) {
 	switch (t) {
 		case DataType::Int64: return "int64";
 		case DataType::String: return "string";
+		case DataType::Int32: return "int32";
+		case DataType::Int16: return "int16";
+		case DataType::Int8: return "int8";
+		case DataType::Bool: return "bool";
+		case DataType::Date: return "date";
+		case DataType::Timestamp: return "timestamp";
 	}
 	return "unknown";
 }
@@ -48,15 +59,13 @@ Schema LoadSchemaCsv(std::istream &in, char delimiter) {
 	schema.reserve(64);
 
 	std::unordered_set<std::string> seen_names;
+	RowView row;
 	size_t line = 0;
 
-	while (true) {
-		std::optional<Row> row = reader.ReadNext();
-		if (!row.has_value()) break;
-
+	while (reader.ReadNext(row)) {
 		++line;
 		bool all_empty = true;
-		for (const auto &f: *row) {
+		for (const auto f: row.fields) {
 			if (!utils::Trim(f).empty()) {
 				all_empty = false;
 				break;
@@ -64,18 +73,22 @@ Schema LoadSchemaCsv(std::istream &in, char delimiter) {
 		}
 		if (all_empty) continue;
 
-		if (row->size() != 2) {
+		if (row.size() != 2 && row.size() != 3) {
 			throw std::runtime_error("schema.csv parse error");
 		}
 
-		std::string name = std::string(utils::Trim((*row)[0]));
-		std::string type_str = std::string(utils::Trim((*row)[1]));
+		std::string name = std::string(utils::Trim(row[0]));
+		std::string type_str = std::string(utils::Trim(row[1]));
+		const std::string flag = row.size() == 3 ? ToLowerAscii(utils::Trim(row[2])) : std::string();
 
 		if (name.empty() || !seen_names.insert(name).second) {
 			throw std::runtime_error("schema.csv parse error");
 		}
+		if (!flag.empty() && flag != "nullable") {
+			throw std::runtime_error("schema.csv parse error: unknown column flag '" + flag + "'");
+		}
 
-		schema.push_back(ColumnSchema{std::move(name), ParseColumnType(type_str)});
+		schema.push_back(ColumnSchema{std::move(name), ParseColumnType(type_str), flag == "nullable"});
 	}
 
 	if (schema.empty()) {
@@ -96,7 +109,9 @@ void SaveSchemaCsv(std::ostream &out, const Schema &schema, char delimiter) {
 		if (col.name.empty()) {
 			throw std::runtime_error("cannot write schema: column name is empty");
 		}
-		if (!writer.WriteNext({col.name, ToString(col.type)})) {
+		const bool ok = col.nullable ? writer.WriteNext({col.name, ToString(col.type), "nullable"})
+		                             : writer.WriteNext({col.name, ToString(col.type)});
+		if (!ok) {
 			throw std::runtime_error("failed to write schema row");
 		}
 	}
@@ -11,6 +11,8 @@
 struct ColumnSchema {
 	std::string name;
 	DataType type;
+	// Rows may be null; declared by a third "nullable" field in schema.csv.
+	bool nullable = false;
 };
 
 using Schema = std::vector<ColumnSchema>;
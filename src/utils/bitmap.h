@@ -0,0 +1,61 @@
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+
+// Packed bitmaps: bit i is bit i % 64 of word i / 64, and bits past the end are zero, so
+// whole words can be ANDed, ORed and counted.
+namespace utils {
+	inline std::size_t BitmapWords(std::size_t bits) { return (bits + 63) / 64; }
+
+	inline bool GetBit(const std::uint64_t *words, std::size_t i) {
+		return (words[i / 64] >> (i % 64)) & 1;
+	}
+
+	inline void ClearBit(std::uint64_t *words, std::size_t i) {
+		words[i / 64] &= ~(std::uint64_t{1} << (i % 64));
+	}
+
+	// `bits` set bits.
+	inline std::vector<std::uint64_t> AllSet(std::size_t bits) {
+		std::vector<std::uint64_t> words(BitmapWords(bits), ~std::uint64_t{0});
+		if (bits % 64 != 0) words.back() = (std::uint64_t{1} << (bits % 64)) - 1;
+		return words;
+	}
+
+	inline std::size_t CountSet(const std::vector<std::uint64_t> &words) {
+		std::size_t n = 0;
+		for (const auto w: words) n += static_cast<std::size_t>(std::popcount(w));
+		return n;
+	}
+
+	// Appends bit number `n` to a bitmap holding `n` bits.
+	inline void AppendBit(std::vector<std::uint64_t> &words, std::size_t n, bool value) {
+		if (n % 64 == 0) words.push_back(0);
+		words[n / 64] |= static_cast<std::uint64_t>(value) << (n % 64);
+	}
+
+	// Appends bits [begin, begin + count) of `src` to `dst`, which holds `n` bits, a word
+	// at a time; a null `src` appends set bits.
+	inline void AppendBits(std::vector<std::uint64_t> &dst, std::size_t n, const std::uint64_t *src,
+	                       std::size_t begin, std::size_t count) {
+		dst.resize(BitmapWords(n + count), 0);
+		for (std::size_t i = 0; i < count;) {
+			const std::size_t to = n + i;
+			const std::size_t from = begin + i;
+			const std::size_t take = std::min(64 - to % 64, count - i);
+			std::uint64_t word = ~std::uint64_t{0};
+			if (src != nullptr) {
+				word = src[from / 64] >> (from % 64);
+				if (from % 64 != 0 && from % 64 + take > 64) word |= src[from / 64 + 1] << (64 - from % 64);
+			}
+			const std::uint64_t mask = take == 64 ? ~std::uint64_t{0} : (std::uint64_t{1} << take) - 1;
+			dst[to / 64] |= (word & mask) << (to % 64);
+			i += take;
+		}
+	}
+}
@@ -0,0 +1,163 @@
+#pragma once
+
+#include <charconv>
+#include <cstdint>
+#include <string_view>
+
+
+// Dates are days since 1970-01-01 and timestamps microseconds since 1970-01-01T00:00:00Z,
+// both in the proleptic Gregorian calendar.
+namespace utils {
+	constexpr std::int64_t kMicrosPerSecond = 1000000;
+	constexpr std::int64_t kMicrosPerDay = 86400 * kMicrosPerSecond;
+
+	// Days since the epoch of a civil date (month 1-12, day 1-31).
+	constexpr std::int64_t DaysFromCivil(std::int64_t y, unsigned m, unsigned d) {
+		y -= m <= 2;
+		const std::int64_t era = (y >= 0 ? y : y - 399) / 400;
+		const auto yoe = static_cast<unsigned>(y - era * 400);
+		const unsigned doy = (153 * (m > 2 ? m - 3 : m + 9) + 2) / 5 + d - 1;
+		const unsigned doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+		return era * 146097 + static_cast<std::int64_t>(doe) - 719468;
+	}
+
+	constexpr void CivilFromDays(std::int64_t z, std::int64_t &y, unsigned &m, unsigned &d) {
+		z += 719468;
+		const std::int64_t era = (z >= 0 ? z : z - 146096) / 146097;
+		const auto doe = static_cast<unsigned>(z - era * 146097);
+		const unsigned yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+		const unsigned doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+		const unsigned mp = (5 * doy + 2) / 153;
+		d = doy - (153 * mp + 2) / 5 + 1;
+		m = mp < 10 ? mp + 3 : mp - 9;
+		y = static_cast<std::int64_t>(yoe) + era * 400 + (m <= 2);
+	}
+
+	namespace detail {
+		// Reads exactly `n` digits at s[pos].
+		inline bool Digits(std::string_view s, std::size_t pos, std::size_t n, unsigned &out) {
+			if (pos + n > s.size()) return false;
+			out = 0;
+			for (std::size_t i = pos; i < pos + n; ++i) {
+				const auto d = static_cast<unsigned>(static_cast<unsigned char>(s[i]) - '0');
+				if (d > 9) return false;
+				out = out * 10 + d;
+			}
+			return true;
+		}
+
+		// YYYY-MM-DD at the start of `s`.
+		inline bool DatePrefix(std::string_view s, std::int64_t &days) {
+			unsigned y, m, d;
+			if (!Digits(s, 0, 4, y) || s.size() < 10 || s[4] != '-' || s[7] != '-' ||
+			    !Digits(s, 5, 2, m) || !Digits(s, 8, 2, d)) {
+				return false;
+			}
+			static constexpr unsigned kDays[] = {31, 29, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31};
+			if (m < 1 || m > 12 || d < 1 || d > kDays[m - 1]) return false;
+			if (m == 2 && d == 29 && !(y % 4 == 0 && (y % 100 != 0 || y % 400 == 0))) return false;
+			days = DaysFromCivil(y, m, d);
+			return true;
+		}
+
+		inline char *Pad(char *p, std::int64_t v, int width) {
+			char buf[24];
+			const auto res = std::to_chars(buf, buf + sizeof(buf), v < 0 ? -v : v);
+			if (v < 0) *p++ = '-';
+			for (auto n = res.ptr - buf; n < width; ++n) *p++ = '0';
+			for (const char *q = buf; q != res.ptr; ++q) *p++ = *q;
+			return p;
+		}
+	}
+
+	// "YYYY-MM-DD".
+	inline bool ParseDate(std::string_view s, std::int32_t &out) {
+		std::int64_t days = 0;
+		if (s.size() != 10 || !detail::DatePrefix(s, days)) return false;
+		out = static_cast<std::int32_t>(days);
+		return true;
+	}
+
+	// "YYYY-MM-DD", optionally followed by 'T' or ' ' and "HH:MM[:SS[.fraction]]", then
+	// optionally 'Z' or a "+HH:MM" / "-HH:MM" offset. Digits past microseconds are dropped.
+	inline bool ParseTimestamp(std::string_view s, std::int64_t &out) {
+		std::int64_t days = 0;
+		if (!detail::DatePrefix(s, days)) return false;
+		std::int64_t micros = days * kMicrosPerDay;
+		std::size_t pos = 10;
+		if (pos < s.size() && (s[pos] == 'T' || s[pos] == ' ')) {
+			unsigned h, m, sec = 0;
+			if (!detail::Digits(s, pos + 1, 2, h) || pos + 3 >= s.size() || s[pos + 3] != ':' ||
+			    !detail::Digits(s, pos + 4, 2, m) || h > 23 || m > 59) {
+				return false;
+			}
+			pos += 6;
+			if (pos < s.size() && s[pos] == ':') {
+				if (!detail::Digits(s, pos + 1, 2, sec) || sec > 59) return false;
+				pos += 3;
+			}
+			micros += (static_cast<std::int64_t>(h) * 3600 + m * 60 + sec) * kMicrosPerSecond;
+			if (pos < s.size() && s[pos] == '.') {
+				std::int64_t frac = 0;
+				std::size_t n = 0;
+				for (++pos; pos < s.size() && s[pos] >= '0' && s[pos] <= '9'; ++pos, ++n) {
+					if (n < 6) frac = frac * 10 + (s[pos] - '0');
+				}
+				if (n == 0) return false;
+				for (; n < 6; ++n) frac *= 10;
+				micros += frac;
+			}
+		}
+		if (pos < s.size() && s[pos] == 'Z') {
+			++pos;
+		} else if (pos < s.size() && (s[pos] == '+' || s[pos] == '-')) {
+			unsigned h, m;
+			if (!detail::Digits(s, pos + 1, 2, h) || pos + 3 >= s.size() || s[pos + 3] != ':' ||
+			    !detail::Digits(s, pos + 4, 2, m) || h > 23 || m > 59) {
+				return false;
+			}
+			const std::int64_t offset = (static_cast<std::int64_t>(h) * 3600 + m * 60) * kMicrosPerSecond;
+			micros -= s[pos] == '+' ? offset : -offset;
+			pos += 6;
+		}
+		if (pos != s.size()) return false;
+		out = micros;
+		return true;
+	}
+
+	// Writes the date as "YYYY-MM-DD" and returns the end; needs 16 bytes.
+	inline char *FormatDate(std::int64_t days, char *p) {
+		std::int64_t y;
+		unsigned m, d;
+		CivilFromDays(days, y, m, d);
+		p = detail::Pad(p, y, 4);
+		*p++ = '-';
+		p = detail::Pad(p, m, 2);
+		*p++ = '-';
+		return detail::Pad(p, d, 2);
+	}
+
+	// Writes the timestamp as "YYYY-MM-DDTHH:MM:SS", plus ".ffffff" when it has a fraction,
+	// and returns the end; needs 32 bytes.
+	inline char *FormatTimestamp(std::int64_t micros, char *p) {
+		std::int64_t days = micros / kMicrosPerDay;
+		std::int64_t rest = micros % kMicrosPerDay;
+		if (rest < 0) {
+			--days;
+			rest += kMicrosPerDay;
+		}
+		p = FormatDate(days, p);
+		const std::int64_t secs = rest / kMicrosPerSecond;
+		*p++ = 'T';
+		p = detail::Pad(p, secs / 3600, 2);
+		*p++ = ':';
+		p = detail::Pad(p, secs / 60 % 60, 2);
+		*p++ = ':';
+		p = detail::Pad(p, secs % 60, 2);
+		if (rest % kMicrosPerSecond != 0) {
+			*p++ = '.';
+			p = detail::Pad(p, rest % kMicrosPerSecond, 6);
+		}
+		return p;
+	}
+}
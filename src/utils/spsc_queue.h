@@ -0,0 +1,105 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <optional>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
+
+namespace utils {
+	// Bounded lock-free ring buffer for exactly one producer thread and one consumer thread.
+	// Push blocks while the queue is full and Pop while it is empty, spinning briefly and then
+	// backing off to short sleeps. Close() may be called from either side: the producer calls
+	// it at end of stream (Pop drains what is left, then returns false), the consumer calls it
+	// to abandon the stream (Push then returns false instead of blocking forever).
+	template<class T>
+	class SpscQueue {
+	public:
+		explicit SpscQueue(std::size_t capacity) : slots_(std::max<std::size_t>(1, capacity) + 1) {}
+
+		SpscQueue(const SpscQueue &) = delete;
+		SpscQueue &operator=(const SpscQueue &) = delete;
+
+		std::size_t Capacity() const { return slots_.size() - 1; }
+
+		// Moves from `value` only on success.
+		bool TryPush(T &value) {
+			const std::size_t tail = tail_.load(std::memory_order_relaxed);
+			const std::size_t next = Next(tail);
+			if (next == head_cache_) {
+				head_cache_ = head_.load(std::memory_order_acquire);
+				if (next == head_cache_) return false;
+			}
+			slots_[tail].emplace(std::move(value));
+			tail_.store(next, std::memory_order_release);
+			return true;
+		}
+
+		std::optional<T> TryPop() {
+			const std::size_t head = head_.load(std::memory_order_relaxed);
+			if (head == tail_cache_) {
+				tail_cache_ = tail_.load(std::memory_order_acquire);
+				if (head == tail_cache_) return std::nullopt;
+			}
+			std::optional<T> out = std::move(slots_[head]);
+			slots_[head].reset();
+			head_.store(Next(head), std::memory_order_release);
+			return out;
+		}
+
+		// Returns false, dropping `value`, if the queue was closed.
+		bool Push(T value) {
+			for (std::size_t spins = 0;; ++spins) {
+				if (closed_.load(std::memory_order_acquire)) return false;
+				if (TryPush(value)) return true;
+				Backoff(spins);
+			}
+		}
+
+		// Returns nullopt once the queue is closed and drained.
+		std::optional<T> Pop() {
+			for (std::size_t spins = 0;; ++spins) {
+				if (auto v = TryPop()) return v;
+				if (closed_.load(std::memory_order_acquire)) return TryPop();
+				Backoff(spins);
+			}
+		}
+
+		void Close() { closed_.store(true, std::memory_order_release); }
+		bool Closed() const { return closed_.load(std::memory_order_acquire); }
+
+	private:
+		static constexpr std::size_t kCacheLine = 64;
+
+		std::vector<std::optional<T> > slots_;
+		// Consumer side: head_ and its cached view of tail_.
+		alignas(kCacheLine) std::atomic<std::size_t> head_{0};
+		std::size_t tail_cache_ = 0;
+		// Producer side: tail_ and its cached view of head_.
+		alignas(kCacheLine) std::atomic<std::size_t> tail_{0};
+		std::size_t head_cache_ = 0;
+		alignas(kCacheLine) std::atomic<bool> closed_{false};
+
+		std::size_t Next(std::size_t i) const { return i + 1 == slots_.size() ? 0 : i + 1; }
+
+		static void Backoff(std::size_t spins) {
+			if (spins < 64) {
+#if defined(__x86_64__) || defined(__i386__)
+				_mm_pause();
+#endif
+			} else if (spins < 128) {
+				std::this_thread::yield();
+			} else {
+				std::this_thread::sleep_for(std::chrono::microseconds(50));
+			}
+		}
+	};
+}
@@ -0,0 +1,116 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+
+// Variable-length strings stored Arrow-style: all bytes back to back in one buffer plus
+// an offsets array with size() + 1 entries, so value i is data[offsets[i], offsets[i + 1]).
+// Appending never allocates per value, and a whole column moves with two bulk copies.
+class StringColumn {
+public:
+	using Offset = std::uint64_t;
+
+	class const_iterator {
+	public:
+		using iterator_category = std::random_access_iterator_tag;
+		using value_type = std::string_view;
+		using difference_type = std::ptrdiff_t;
+		using pointer = void;
+		using reference = std::string_view;
+
+		const_iterator() = default;
+		const_iterator(const StringColumn *col, std::size_t i) : col_(col), i_(i) {}
+
+		std::string_view operator*() const { return (*col_)[i_]; }
+		std::string_view operator[](difference_type n) const { return (*col_)[i_ + n]; }
+
+		const_iterator &operator++() { ++i_; return *this; }
+		const_iterator operator++(int) { auto t = *this; ++i_; return t; }
+		const_iterator &operator--() { --i_; return *this; }
+		const_iterator operator--(int) { auto t = *this; --i_; return t; }
+		const_iterator &operator+=(difference_type n) { i_ += n; return *this; }
+		const_iterator &operator-=(difference_type n) { i_ -= n; return *this; }
+		friend const_iterator operator+(const_iterator it, difference_type n) { return it += n; }
+		friend const_iterator operator+(difference_type n, const_iterator it) { return it += n; }
+		friend const_iterator operator-(const_iterator it, difference_type n) { return it -= n; }
+		friend difference_type operator-(const const_iterator &a, const const_iterator &b) {
+			return static_cast<difference_type>(a.i_) - static_cast<difference_type>(b.i_);
+		}
+		friend bool operator==(const const_iterator &a, const const_iterator &b) { return a.i_ == b.i_; }
+		friend auto operator<=>(const const_iterator &a, const const_iterator &b) { return a.i_ <=> b.i_; }
+
+	private:
+		const StringColumn *col_ = nullptr;
+		std::size_t i_ = 0;
+	};
+
+	StringColumn() : offsets_(1, 0) {}
+
+	std::size_t size() const { return offsets_.size() - 1; }
+	bool empty() const { return size() == 0; }
+
+	std::string_view operator[](std::size_t i) const {
+		return {data_.data() + offsets_[i], static_cast<std::size_t>(offsets_[i + 1] - offsets_[i])};
+	}
+
+	const_iterator begin() const { return {this, 0}; }
+	const_iterator end() const { return {this, size()}; }
+
+	void push_back(std::string_view s) {
+		data_.append(s);
+		offsets_.push_back(data_.size());
+	}
+
+	void clear() {
+		offsets_.assign(1, 0);
+		data_.clear();
+	}
+
+	void reserve(std::size_t rows, std::size_t bytes = 0) {
+		offsets_.reserve(rows + 1);
+		if (bytes > 0) data_.reserve(bytes);
+	}
+
+	// Appends values [begin, begin + count) of another column with two bulk copies.
+	void Append(const StringColumn &src, std::size_t begin, std::size_t count) {
+		if (begin + count > src.size()) {
+			throw std::out_of_range("StringColumn::Append out of range");
+		}
+		const Offset first = src.offsets_[begin];
+		const Offset shift = data_.size() - first;
+		data_.append(src.data_, static_cast<std::size_t>(first), static_cast<std::size_t>(src.offsets_[begin + count] - first));
+		// Grow geometrically; an exact reserve would reallocate on every small append.
+		if (offsets_.size() + count > offsets_.capacity()) {
+			offsets_.reserve(std::max(offsets_.size() + count, 2 * offsets_.capacity()));
+		}
+		for (std::size_t i = begin + 1; i <= begin + count; ++i) {
+			offsets_.push_back(src.offsets_[i] + shift);
+		}
+	}
+
+	std::size_t DataSize() const { return data_.size(); }
+	std::size_t Length(std::size_t i) const { return static_cast<std::size_t>(offsets_[i + 1] - offsets_[i]); }
+
+	const std::vector<Offset> &Offsets() const { return offsets_; }
+	const std::string &Data() const { return data_; }
+
+	// Raw buffers for bulk loading. The caller must leave offsets non-empty, starting at 0,
+	// non-decreasing, and ending at data.size().
+	std::vector<Offset> &MutableOffsets() { return offsets_; }
+	std::string &MutableData() { return data_; }
+
+	friend bool operator==(const StringColumn &a, const StringColumn &b) {
+		return a.offsets_ == b.offsets_ && a.data_ == b.data_;
+	}
+
+private:
+	std::vector<Offset> offsets_;
+	std::string data_;
+};
@@ -0,0 +1,81 @@
+#pragma once
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+
+namespace utils {
+	inline std::size_t DefaultThreads() {
+		return std::max<std::size_t>(1, std::thread::hardware_concurrency());
+	}
+
+	// Fixed-size FIFO worker pool. Tasks are started in submission order; results and
+	// exceptions come back through the returned futures. The destructor drains the queue.
+	class ThreadPool {
+	public:
+		explicit ThreadPool(std::size_t threads) {
+			threads = std::max<std::size_t>(1, threads);
+			workers_.reserve(threads);
+			for (std::size_t i = 0; i < threads; ++i) {
+				workers_.emplace_back([this] { WorkerLoop(); });
+			}
+		}
+
+		~ThreadPool() {
+			{
+				std::lock_guard lock(mu_);
+				stop_ = true;
+			}
+			cv_.notify_all();
+			for (auto &w: workers_) w.join();
+		}
+
+		ThreadPool(const ThreadPool &) = delete;
+		ThreadPool &operator=(const ThreadPool &) = delete;
+
+		std::size_t Size() const { return workers_.size(); }
+
+		template<class F>
+		auto Submit(F &&f) -> std::future<std::invoke_result_t<std::decay_t<F> > > {
+			using R = std::invoke_result_t<std::decay_t<F> >;
+			std::packaged_task<R()> task(std::forward<F>(f));
+			auto fut = task.get_future();
+			{
+				std::lock_guard lock(mu_);
+				tasks_.emplace_back(std::move(task));
+			}
+			cv_.notify_one();
+			return fut;
+		}
+
+	private:
+		std::vector<std::thread> workers_;
+		std::deque<std::move_only_function<void()> > tasks_;
+		std::mutex mu_;
+		std::condition_variable cv_;
+		bool stop_ = false;
+
+		void WorkerLoop() {
+			while (true) {
+				std::move_only_function<void()> task;
+				{
+					std::unique_lock lock(mu_);
+					cv_.wait(lock, [this] { return stop_ || !tasks_.empty(); });
+					if (tasks_.empty()) return;
+					task = std::move(tasks_.front());
+					tasks_.pop_front();
+				}
+				task();
+			}
+		}
+	};
+}
@@ -1,16 +1,25 @@
 #pragma once
 
+#include <algorithm>
 #include <charconv>
 #include <cctype>
 #include <cstdint>
+#include <cstring>
 #include <fstream>
+#include <limits>
+#include <span>
 #include <stdexcept>
 #include <system_error>
+#include <type_traits>
+#include <utility>
 #include <variant>
 #include <vector>
 #include <string>
 #include <string_view>
 
+#include "utils/datetime.h"
+#include "utils/string_column.h"
+
 
 namespace utils {
 	template<class IsSpace>
@@ -29,18 +38,132 @@ namespace utils {
 	}
 }
 
+// Every type but String holds integers: Bool is 0/1 in an Int8's storage, Date days since
+// the epoch in an Int32's and Timestamp microseconds since the epoch in an Int64's.
 enum class DataType : uint8_t {
 	Int64 = 0,
 	String = 1,
+	Int32 = 2,
+	Int16 = 3,
+	Int8 = 4,
+	Bool = 5,
+	Date = 6,
+	Timestamp = 7,
 };
 
 using DataObject = std::variant<int64_t, std::string>;
-using DataVector = std::variant<std::vector<int64_t>, std::vector<std::string> >;
+using DataVector = std::variant<std::vector<int64_t>, StringColumn, std::vector<int32_t>, std::vector<int16_t>,
+                                std::vector<int8_t> >;
 
 namespace utils {
-	inline int64_t ParseInt64(std::string_view s,
-	                          std::size_t line_no,
-	                          std::string_view col_name) {
+	inline bool IsInteger(DataType type) { return type != DataType::String; }
+
+	// Calls f(T{}) with the element type T of an integer type's storage.
+	template<class F>
+	decltype(auto) VisitIntegerType(DataType type, F &&f) {
+		switch (type) {
+			case DataType::Int64:
+			case DataType::Timestamp: return f(int64_t{});
+			case DataType::Int32:
+			case DataType::Date: return f(int32_t{});
+			case DataType::Int16: return f(int16_t{});
+			case DataType::Int8:
+			case DataType::Bool: return f(int8_t{});
+			case DataType::String: break;
+		}
+		throw std::runtime_error("not an integer DataType");
+	}
+
+	// Empty storage for a column of `type`.
+	inline DataVector MakeColumn(DataType type) {
+		if (type == DataType::String) return StringColumn{};
+		return VisitIntegerType(type, [](auto v) -> DataVector { return std::vector<decltype(v)>{}; });
+	}
+
+	// Bytes per value in memory and in plain chunks; for strings, the offset per value.
+	inline std::size_t ValueWidth(DataType type) {
+		if (type == DataType::String) return sizeof(StringColumn::Offset);
+		return VisitIntegerType(type, [](auto v) { return sizeof(v); });
+	}
+
+	// Values an integer type accepts.
+	inline std::pair<int64_t, int64_t> ValueRange(DataType type) {
+		if (type == DataType::Bool) return {0, 1};
+		return VisitIntegerType(type, [](auto v) {
+			using T = decltype(v);
+			return std::pair<int64_t, int64_t>(std::numeric_limits<T>::min(), std::numeric_limits<T>::max());
+		});
+	}
+
+	// Integer columns as int64: the vector itself for 8-byte types, otherwise widened into
+	// `scratch`.
+	inline std::span<const int64_t> WidenInts(const DataVector &column, std::vector<int64_t> &scratch) {
+		return std::visit([&](const auto &values) -> std::span<const int64_t> {
+			using Vec = std::decay_t<decltype(values)>;
+			if constexpr (std::is_same_v<Vec, StringColumn>) {
+				throw std::runtime_error("not an integer column");
+			} else if constexpr (std::is_same_v<Vec, std::vector<int64_t> >) {
+				return values;
+			} else {
+				scratch.assign(values.begin(), values.end());
+				return scratch;
+			}
+		}, column);
+	}
+}
+
+namespace utils {
+	// Converts 8 ASCII digits (first digit in the lowest byte) to their value, or returns
+	// false if any byte is not a digit. Three multiplies instead of eight dependent steps.
+	inline bool ParseEightDigits(const char *p, uint64_t &out) {
+		uint64_t chunk = 0;
+		std::memcpy(&chunk, p, sizeof(chunk));
+		if (((chunk & 0xF0F0F0F0F0F0F0F0) |
+		     (((chunk + 0x0606060606060606) & 0xF0F0F0F0F0F0F0F0) >> 4)) != 0x3333333333333333) {
+			return false;
+		}
+		chunk -= 0x3030303030303030;
+		chunk = (chunk * 10) + (chunk >> 8);
+		chunk = (((chunk & 0x000000FF000000FF) * (100 + (1000000ULL << 32))) +
+		         (((chunk >> 16) & 0x000000FF000000FF) * (1 + (10000ULL << 32)))) >> 32;
+		out = chunk;
+		return true;
+	}
+
+	// Plain [-]digits fast path of ParseInt64. Returns false for anything else (whitespace,
+	// signs other than '-', overflow), which the caller hands to the checked path.
+	inline bool TryParseInt64Digits(std::string_view s, int64_t &out) {
+		const char *p = s.data();
+		const char *end = p + s.size();
+		const bool neg = p != end && *p == '-';
+		if (neg) ++p;
+
+		const auto ndigits = static_cast<std::size_t>(end - p);
+		if (ndigits == 0 || ndigits > 19) return false;
+
+		// 19 decimal digits always fit in uint64_t.
+		uint64_t v = 0;
+		for (uint64_t eight = 0; end - p >= 8; p += 8) {
+			if (!ParseEightDigits(p, eight)) return false;
+			v = v * 100000000 + eight;
+		}
+		for (; p != end; ++p) {
+			const auto d = static_cast<unsigned>(static_cast<unsigned char>(*p) - '0');
+			if (d > 9) return false;
+			v = v * 10 + d;
+		}
+
+		constexpr auto kMax = static_cast<uint64_t>(std::numeric_limits<int64_t>::max());
+		if (v > kMax + (neg ? 1 : 0)) return false;
+		out = static_cast<int64_t>(neg ? 0 - v : v);
+		return true;
+	}
+
+	// Checked path of ParseInt64, for fields TryParseInt64Digits already rejected: trims
+	// whitespace and throws on anything that is not an int64.
+	inline int64_t ParseInt64Slow(std::string_view s,
+	                              std::size_t line_no,
+	                              std::string_view col_name) {
 		s = Trim(s, [](unsigned char ch) {
 			return ch == ' ' || ch == '\t' || ch == '\n' || ch == '\r' || ch == '\f' || ch == '\v';
 		});
@@ -62,6 +185,85 @@ namespace utils {
 		}
 		return value;
 	}
+
+	inline int64_t ParseInt64(std::string_view s,
+	                          std::size_t line_no,
+	                          std::string_view col_name) {
+		int64_t fast = 0;
+		if (TryParseInt64Digits(s, fast)) return fast;
+		return ParseInt64Slow(s, line_no, col_name);
+	}
+
+	// A field of an integer type: a decimal within the type's range, 0/1/true/false for Bool,
+	// ISO-8601 text for Date and Timestamp. Surrounding whitespace is ignored. Returns false
+	// when the field does not parse.
+	inline bool ParseIntegerValue(DataType type, std::string_view s, int64_t &out) {
+		s = Trim(s);
+		switch (type) {
+			case DataType::Bool: {
+				const auto is = [&](std::string_view word) {
+					return s.size() == word.size() && std::equal(s.begin(), s.end(), word.begin(), [](char a, char b) {
+						return std::tolower(static_cast<unsigned char>(a)) == b;
+					});
+				};
+				if (s == "1" || is("true")) out = 1;
+				else if (s == "0" || is("false")) out = 0;
+				else return false;
+				return true;
+			}
+			case DataType::Date: {
+				int32_t days = 0;
+				if (!ParseDate(s, days)) return false;
+				out = days;
+				return true;
+			}
+			case DataType::Timestamp:
+				return ParseTimestamp(s, out);
+			default:
+				break;
+		}
+		const auto [ptr, ec] = std::from_chars(s.data(), s.data() + s.size(), out, 10);
+		if (s.empty() || ec != std::errc{} || ptr != s.data() + s.size()) return false;
+		const auto [lo, hi] = ValueRange(type);
+		return out >= lo && out <= hi;
+	}
+
+	// Appends an integer-type value as text: decimal, true/false, or the ISO date/timestamp.
+	inline void AppendIntegerValue(std::string &out, DataType type, int64_t v) {
+		char buf[32];
+		char *end;
+		switch (type) {
+			case DataType::Bool:
+				out.append(v != 0 ? "true" : "false");
+				return;
+			case DataType::Date:
+				end = FormatDate(v, buf);
+				break;
+			case DataType::Timestamp:
+				end = FormatTimestamp(v, buf);
+				break;
+			default:
+				end = std::to_chars(buf, buf + sizeof(buf), v).ptr;
+		}
+		out.append(buf, end);
+	}
+
+	// Parses "column", "column:asc" or "column:desc" into the column name and whether the
+	// order is descending.
+	inline std::pair<std::string_view, bool> ParseSortKey(std::string_view text) {
+		text = Trim(text);
+		bool descending = false;
+		const auto colon = text.rfind(':');
+		if (colon != std::string_view::npos) {
+			std::string dir(Trim(text.substr(colon + 1)));
+			std::ranges::transform(dir, dir.begin(), [](unsigned char ch) { return std::tolower(ch); });
+			if (dir == "desc") descending = true;
+			else if (dir != "asc") throw std::runtime_error("invalid sort key '" + std::string(text) + "'");
+			text = Trim(text.substr(0, colon));
+		}
+		if (text.empty()) throw std::runtime_error("empty sort key");
+		return {text, descending};
+	}
 }
 
 
@@ -75,3 +75,94 @@ TEST(CSVRoundTripTests, WriterThenReader) {
     ASSERT_TRUE(row.has_value());
     EXPECT_EQ((*row), original);
 }
+
+TEST(CSVReaderTests, BlockBoundariesDoNotChangeTokens) {
+    const std::string input =
+        "id,\"a \"\"quoted\"\" value\",x\r\n"
+        "2,\"multi\r\nline, with comma\",\"\"\r\n"
+        "3,plain,\"\"\"\"\n"
+        "\n"
+        "4,\"last\"";
+    const std::vector<std::vector<std::string>> expected{
+        {"id", "a \"quoted\" value", "x"},
+        {"2", "multi\r\nline, with comma", ""},
+        {"3", "plain", "\""},
+        {""},
+        {"4", "last"},
+    };
+
+    for (std::size_t block : {1u, 2u, 3u, 7u, 63u, 64u, 65u, 4096u}) {
+        std::istringstream in(input);
+        CSVReader r(in, ',', block);
+
+        std::vector<std::vector<std::string>> rows;
+        while (auto row = r.ReadNext()) rows.push_back(*row);
+        EXPECT_EQ(rows, expected) << "block size " << block;
+    }
+}
+
+TEST(CSVReaderTests, LongFieldsSpanManyScanBlocks) {
+    const std::string big(1000, 'x');
+    std::istringstream in(big + ";\"" + big + ";" + big + "\"\n");
+    CSVReader r(in, ';', 100);
+
+    auto row = r.ReadNext();
+    ASSERT_TRUE(row.has_value());
+    EXPECT_EQ((*row), (std::vector<std::string>{big, big + ";" + big}));
+    EXPECT_FALSE(r.ReadNext().has_value());
+}
+
+TEST(CSVReaderTests, UnterminatedQuoteThrows) {
+    std::istringstream in("a,\"never closed\n");
+    CSVReader r(in, ',', 4);
+
+    EXPECT_THROW({ (void)r.ReadNext(); }, std::runtime_error);
+}
+
+TEST(CSVReaderTests, RowViewUnescapesOnlyQuotedFields) {
+    std::istringstream in("plain,\"quoted\",\"a\"\"b\",x\"y,z\"w\n,\n");
+    CSVReader r(in);
+    RowView row;
+
+    ASSERT_TRUE(r.ReadNext(row));
+    ASSERT_EQ(row.size(), 4u);
+    EXPECT_EQ(row[0], "plain");
+    EXPECT_EQ(row[1], "quoted");
+    EXPECT_EQ(row[2], "a\"b");
+    EXPECT_EQ(row[3], "xy,zw");
+
+    ASSERT_TRUE(r.ReadNext(row));
+    EXPECT_EQ(row.fields, (std::vector<std::string_view>{"", ""}));
+
+    EXPECT_FALSE(r.ReadNext(row));
+}
+
+TEST(CSVReaderTests, RowViewGrowsBufferForRowsLongerThanBlock) {
+    const std::string big(500, 'q');
+    std::istringstream in("1," + big + "\n\"" + big + "\"\"\",2\n");
+    CSVReader r(in, ',', 16);
+    RowView row;
+
+    ASSERT_TRUE(r.ReadNext(row));
+    EXPECT_EQ(row.fields, (std::vector<std::string_view>{"1", big}));
+
+    ASSERT_TRUE(r.ReadNext(row));
+    EXPECT_EQ(row.fields, (std::vector<std::string_view>{big + "\"", "2"}));
+
+    EXPECT_FALSE(r.ReadNext(row));
+}
+
+TEST(CSVReaderTests, RowViewFlagsBlankRows) {
+    std::istringstream in(" , \t\n\"  \",\n1, \n\"\"\"\",\n");
+    CSVReader r(in);
+    RowView row;
+
+    ASSERT_TRUE(r.ReadNext(row));
+    EXPECT_TRUE(row.blank);
+    ASSERT_TRUE(r.ReadNext(row));
+    EXPECT_TRUE(row.blank);
+    ASSERT_TRUE(r.ReadNext(row));
+    EXPECT_FALSE(row.blank);
+    ASSERT_TRUE(r.ReadNext(row));
+    EXPECT_FALSE(row.blank);
+}
@@ -4,7 +4,14 @@
 #include <cstdint>
 #include <filesystem>
 #include <fstream>
+#include <functional>
+#include <limits>
+#include <algorithm>
+#include <map>
 #include <optional>
+#include <random>
+#include <span>
+#include <sstream>
 #include <string>
 #include <vector>
 #include <chrono>
@@ -13,10 +20,23 @@
 
 #include "schema.h"
 #include "batch.h"
+#include "parallel_csv.h"
 #include "csvwriter.h"
 
 #include "columnar_reader.h"
 #include "columnar_writer.h"
+#include "bloom_filter.h"
+#include "secondary_index.h"
+#include "csv_export.h"
+#include "aggregate.h"
+#include "expr.h"
+#include "filter.h"
+#include "join.h"
+#include "query.h"
+#include "sort.h"
+#include "spill_dir.h"
+#include "ingest.h"
+#include "utils/spsc_queue.h"
 
 namespace fs = std::filesystem;
 
@@ -74,7 +94,7 @@ static FlatTable FlattenBatches(const Schema& schema, const std::vector<Batch>&
                 t.columns.emplace_back(std::vector<std::int64_t>{});
                 break;
             case DataType::String:
-                t.columns.emplace_back(std::vector<std::string>{});
+                t.columns.emplace_back(StringColumn{});
                 break;
             default:
                 throw std::runtime_error("Unsupported DataType in test");
@@ -93,9 +113,9 @@ static FlatTable FlattenBatches(const Schema& schema, const std::vector<Batch>&
                 auto& out = std::get<std::vector<std::int64_t>>(t.columns[c]);
                 out.insert(out.end(), v.begin(), v.end());
             } else {
-                const auto& v = std::get<std::vector<std::string>>(col);
-                auto& out = std::get<std::vector<std::string>>(t.columns[c]);
-                out.insert(out.end(), v.begin(), v.end());
+                const auto& v = std::get<StringColumn>(col);
+                auto& out = std::get<StringColumn>(t.columns[c]);
+                out.Append(v, 0, v.size());
             }
         }
     }
@@ -106,7 +126,7 @@ static FlatTable FlattenBatches(const Schema& schema, const std::vector<Batch>&
         if (cs.type == DataType::Int64) {
             EXPECT_EQ(std::get<std::vector<std::int64_t>>(t.columns[c]).size(), t.rows);
         } else {
-            EXPECT_EQ(std::get<std::vector<std::string>>(t.columns[c]).size(), t.rows);
+            EXPECT_EQ(std::get<StringColumn>(t.columns[c]).size(), t.rows);
         }
     }
 
@@ -164,13 +184,38 @@ static void ExpectTablesEqual(const FlatTable& a, const FlatTable& b) {
                       std::get<std::vector<std::int64_t>>(b.columns[c]))
                 << "Int64 column mismatch at " << c;
         } else {
-            EXPECT_EQ(std::get<std::vector<std::string>>(a.columns[c]),
-                      std::get<std::vector<std::string>>(b.columns[c]))
+            const auto& sa = std::get<StringColumn>(a.columns[c]);
+            const auto& sb = std::get<StringColumn>(b.columns[c]);
+            EXPECT_EQ(std::vector<std::string_view>(sa.begin(), sa.end()),
+                      std::vector<std::string_view>(sb.begin(), sb.end()))
                 << "String column mismatch at " << c;
         }
     }
 }
 
+// Reference formatting: one WriteNext call per row; nulls are empty fields.
+static void WriteRowsWithWriteNext(const Batch& b, CSVWriter& w) {
+    std::vector<std::vector<std::int64_t>> wide(b.ColCount());
+    std::vector<std::span<const std::int64_t>> ints(b.ColCount());
+    for (std::size_t c = 0; c < b.ColCount(); ++c) {
+        if (b.GetSchema()[c].type != DataType::String) ints[c] = utils::WidenInts(b.GetColumn(c), wide[c]);
+    }
+    for (std::size_t r = 0; r < b.RowCount(); ++r) {
+        Row row;
+        row.resize(b.ColCount());
+        for (std::size_t c = 0; c < b.ColCount(); ++c) {
+            const auto& cs = b.GetSchema()[c];
+            if (b.IsNull(c, r)) continue;
+            if (cs.type == DataType::String) {
+                row[c] = std::get<StringColumn>(b.GetColumn(c))[r];
+            } else {
+                utils::AppendIntegerValue(row[c], cs.type, ints[c][r]);
+            }
+        }
+        ASSERT_TRUE(w.WriteNext(row));
+    }
+}
+
 static void ExportColumnarToCsv(const fs::path& col_path,
                                const fs::path& out_schema,
                                const fs::path& out_data) {
@@ -188,21 +233,7 @@ static void ExportColumnarToCsv(const fs::path& col_path,
     CSVWriter w(out);
 
     for (std::size_t rg = 0; rg < reader.NumBatches(); ++rg) {
-        Batch b = reader.ReadBatch(rg);
-        for (std::size_t r = 0; r < b.RowCount(); ++r) {
-            Row row;
-            row.resize(b.ColCount());
-            for (std::size_t c = 0; c < b.ColCount(); ++c) {
-                const auto& cs = schema[c];
-                const auto& col = b.GetColumn(c);
-                if (cs.type == DataType::Int64) {
-                    row[c] = std::to_string(std::get<std::vector<std::int64_t>>(col)[r]);
-                } else {
-                    row[c] = std::get<std::vector<std::string>>(col)[r];
-                }
-            }
-            ASSERT_TRUE(w.WriteNext(row));
-        }
+        WriteRowsWithWriteNext(reader.ReadBatch(rg), w);
     }
 }
 
@@ -431,6 +462,68 @@ TEST(ColumnarRoundTrip, VeryLongStrings) {
     ExpectTablesEqual(expected, got);
 }
 
+TEST(ParallelCsv, MatchesSequentialBatchesAcrossQuotedNewlines) {
+    const std::string schema_csv =
+        "id,int64\n"
+        "text,string\n";
+
+    // Quoted fields with embedded newlines, CRLF and escaped quotes, so many segment cuts
+    // land inside quotes.
+    std::string data_csv;
+    for (int i = 0; i < 500; ++i) {
+        data_csv += std::to_string(i) + ",";
+        switch (i % 4) {
+            case 0: data_csv += "plain" + std::to_string(i) + "\n"; break;
+            case 1: data_csv += "\"multi\nline\n\"\"quoted\"\"\nvalue\"\n"; break;
+            case 2: data_csv += "\"crlf\r\ninside\"\r\n"; break;
+            default: data_csv += "\"\n\n\n\"\n\n"; break;
+        }
+    }
+
+    auto tmp = MakeTempDir();
+    const fs::path schema_path = tmp / "schema.csv";
+    const fs::path data_path   = tmp / "data.csv";
+    WriteFile(schema_path, schema_csv);
+    WriteFile(data_path, data_csv);
+
+    std::ifstream schema_in(schema_path);
+    Schema schema = LoadSchemaCsv(schema_in);
+
+    for (std::size_t segment : {7u, 64u, 333u, 4096u}) {
+        ParallelCsvBatchReader par(data_path, schema, 3, /*batch_rows*/ 37, ',', segment);
+        std::vector<Batch> got;
+        while (auto b = par.ReadNext()) got.push_back(*b);
+        for (std::size_t i = 0; i + 1 < got.size(); ++i) EXPECT_EQ(got[i].RowCount(), 37u);
+
+        std::ifstream data_in(data_path);
+        CsvBatchReader seq(data_in, schema, 37);
+        std::vector<Batch> expected;
+        while (auto b = seq.ReadNext()) expected.push_back(*b);
+
+        ASSERT_EQ(got.size(), expected.size()) << "segment " << segment;
+        ExpectTablesEqual(FlattenBatches(schema, expected), FlattenBatches(schema, got));
+    }
+}
+
+TEST(ParallelCsv, ReportsSameErrorLineAsSequential) {
+    std::string data_csv;
+    for (int i = 0; i < 200; ++i) data_csv += std::to_string(i) + ",\"x\ny\"\n";
+    data_csv += "oops,z\n";
+
+    auto tmp = MakeTempDir();
+    const fs::path data_path = tmp / "data.csv";
+    WriteFile(data_path, data_csv);
+    const Schema schema{{"a", DataType::Int64}, {"b", DataType::String}};
+
+    ParallelCsvBatchReader par(data_path, schema, 4, 1000, ',', 64);
+    try {
+        while (par.ReadNext()) {}
+        FAIL() << "expected parse error";
+    } catch (const std::runtime_error& e) {
+        EXPECT_NE(std::string(e.what()).find("line 201"), std::string::npos) << e.what();
+    }
+}
+
 // ----------------- negative tests (errors) -----------------
 
 TEST(SchemaErrors, DuplicateColumnNameThrows) {
@@ -469,6 +562,34 @@ TEST(CsvBatchReaderErrors, InvalidInt64Throws) {
     EXPECT_THROW({ (void)br.ReadNext(); }, std::runtime_error);
 }
 
+TEST(CsvBatchReader, Int64FastPathMatchesCheckedParse) {
+    const Schema schema{{"i", DataType::Int64}};
+    std::istringstream in(
+        "0\n"
+        "-0\n"
+        "12345678\n"
+        "-123456789012345678\n"
+        "9223372036854775807\n"
+        "-9223372036854775808\n"
+        "  77 \n"
+        "\"-5\"\n"
+        "000000000000000000000042\n");
+    CsvBatchReader br(in, schema, 100);
+
+    auto b = br.ReadNext();
+    ASSERT_TRUE(b.has_value());
+    EXPECT_EQ(std::get<std::vector<std::int64_t>>(b->GetColumn(0)),
+              (std::vector<std::int64_t>{0, 0, 12345678, -123456789012345678LL,
+                                         std::numeric_limits<std::int64_t>::max(),
+                                         std::numeric_limits<std::int64_t>::min(), 77, -5, 42}));
+
+    for (const char* bad : {"9223372036854775808\n", "-9223372036854775809\n", "+1\n", "12a45678\n", "-\n"}) {
+        std::istringstream bad_in(bad);
+        CsvBatchReader bad_br(bad_in, schema, 100);
+        EXPECT_THROW({ (void)bad_br.ReadNext(); }, std::runtime_error) << bad;
+    }
+}
+
 TEST(CsvBatchReaderErrors, WrongFieldCountThrows) {
     const std::string schema_csv = "a,int64\nb,string\n";
     const std::string data_csv   = "1,ok,EXTRA\n"; // 3 fields, expected 2
@@ -569,3 +690,1764 @@ TEST(ColumnarErrors, ReaderRejectsChunkOverlapsFooter) {
 
     EXPECT_THROW({ columnar::ColumnarReader r(p); }, std::runtime_error);
 }
+
+// ----------------- string column -----------------
+
+TEST(StringColumnTests, AppendAndSliceKeepOffsetsContiguous) {
+    StringColumn a;
+    a.push_back("alpha");
+    a.push_back("");
+    a.push_back("gamma");
+    a.push_back("d");
+
+    StringColumn b;
+    b.push_back("x");
+    b.Append(a, 1, 3);
+
+    ASSERT_EQ(b.size(), 4u);
+    EXPECT_EQ(b[0], "x");
+    EXPECT_EQ(b[1], "");
+    EXPECT_EQ(b[2], "gamma");
+    EXPECT_EQ(b[3], "d");
+    EXPECT_EQ(b.DataSize(), 7u);
+    EXPECT_EQ(b.Offsets(), (std::vector<StringColumn::Offset>{0, 1, 1, 6, 7}));
+    EXPECT_THROW(b.Append(a, 2, 3), std::out_of_range);
+
+    b.clear();
+    EXPECT_TRUE(b.empty());
+    EXPECT_EQ(b.Offsets().size(), 1u);
+}
+
+TEST(ColumnarRoundTrip, StringChunkWithManyValuesLoadsInBulk) {
+    const Schema schema{{"s", DataType::String}};
+    Batch batch(schema);
+    auto& col = std::get<StringColumn>(batch.GetColumn(0));
+    for (int i = 0; i < 10000; ++i) col.push_back(std::string(i % 37, static_cast<char>('a' + i % 26)));
+    batch.SetRowCount(col.size());
+
+    auto tmp = MakeTempDir();
+    const fs::path col_path = tmp / "strings.columnar";
+    {
+        columnar::ColumnarWriter wr(col_path, schema);
+        wr.WriteBatch(batch);
+        wr.Finish();
+    }
+
+    columnar::ColumnarReader reader(col_path);
+    ASSERT_EQ(reader.NumBatches(), 1u);
+    Batch got = reader.ReadBatch(0);
+    EXPECT_TRUE(std::get<StringColumn>(got.GetColumn(0)) == col);
+}
+
+// ----------------- mapped reader -----------------
+
+TEST(MappedReader, ViewsMatchStreamReader) {
+    const std::string schema_csv = "id,int64\nname,string\nscore,int64\n";
+    std::string data_csv;
+    for (int i = 0; i < 1000; ++i) {
+        data_csv += std::to_string(i * 7 - 300) + ",\"n" + std::to_string(i) + (i % 3 ? "" : ",x") + "\"," +
+                    std::to_string(i % 11) + "\n";
+    }
+
+    auto tmp = MakeTempDir();
+    const fs::path schema_path = tmp / "schema.csv";
+    const fs::path data_path   = tmp / "data.csv";
+    const fs::path col_path    = tmp / "out.columnar";
+    WriteFile(schema_path, schema_csv);
+    WriteFile(data_path, data_csv);
+    CsvToColumnar(schema_path, data_path, col_path, /*batch_rows*/ 128);
+
+    FlatTable expected = ReadAllFromColumnar(col_path);
+
+    columnar::ColumnarReader mapped(col_path, columnar::ReadMode::Mapped);
+    ASSERT_EQ(mapped.NumBatches(), 8u);
+
+    // Out of order on purpose: exercises both the sequential and the random advice paths.
+    std::vector<Batch> batches(mapped.NumBatches(), Batch(mapped.GetSchema()));
+    for (std::size_t i : {0u, 1u, 2u, 7u, 3u, 4u, 5u, 6u}) {
+        columnar::BatchView view = mapped.ReadBatchView(i);
+        ASSERT_EQ(view.ColCount(), 3u);
+        EXPECT_EQ(reinterpret_cast<std::uintptr_t>(view.Int64Column(0).data()) % alignof(std::int64_t), 0u);
+        batches[i] = view.ToBatch();
+    }
+    ExpectTablesEqual(expected, FlattenBatches(mapped.GetSchema(), batches));
+
+    columnar::BatchView view = mapped.ReadBatchView(1);
+    std::vector<std::string_view> names(view.StringColumnView(1).begin(), view.StringColumnView(1).end());
+    ASSERT_EQ(names.size(), 128u);
+    EXPECT_EQ(names[0], "n128");
+    EXPECT_EQ(names[1], "n129,x");
+    EXPECT_EQ(view.Int64Column(2)[5], 133 % 11);
+
+    columnar::ColumnarReader stream(col_path);
+    Batch a = stream.ReadBatch(5);
+    Batch b = mapped.ReadBatch(5);
+    EXPECT_EQ(std::get<std::vector<std::int64_t>>(a.GetColumn(0)), std::get<std::vector<std::int64_t>>(b.GetColumn(0)));
+    EXPECT_TRUE(std::get<StringColumn>(a.GetColumn(1)) == std::get<StringColumn>(b.GetColumn(1)));
+    EXPECT_EQ(stream.ReadBatchView(5).Int64Column(0)[3], std::get<std::vector<std::int64_t>>(a.GetColumn(0))[3]);
+}
+
+TEST(MappedReader, UnalignedChunksFromUnpaddedFilesAreCopied) {
+    auto tmp = MakeTempDir();
+    const fs::path p = tmp / "unpadded.columnar";
+
+    // Hand-written file without chunk padding: the int64 chunk starts at offset 20.
+    {
+        std::ofstream out(p, std::ios::binary | std::ios::trunc);
+        const char magic[4] = {'C','D','B','1'};
+        WriteBytes(out, magic, 4);
+        WriteObj(out, (std::uint32_t)1);
+        const std::uint64_t footer_offset = 16 + 4 + 3 * 8;
+        WriteObj(out, footer_offset);
+        WriteObj(out, (std::uint32_t)3);               // row_count
+        for (std::int64_t v : {5, -6, 7}) WriteObj(out, v);
+        WriteObj(out, (std::uint32_t)1);               // ncols
+        WriteString(out, "v");
+        WriteObj(out, (std::uint8_t)0);
+        WriteObj(out, (std::uint32_t)1);               // nrg
+        WriteObj(out, (std::uint32_t)3);
+        WriteObj(out, (std::uint64_t)20);
+        WriteObj(out, (std::uint64_t)24);
+    }
+
+    columnar::ColumnarReader reader(p, columnar::ReadMode::Mapped);
+    columnar::BatchView view = reader.ReadBatchView(0);
+    const auto col = view.Int64Column(0);
+    EXPECT_EQ(std::vector<std::int64_t>(col.begin(), col.end()), (std::vector<std::int64_t>{5, -6, 7}));
+}
+
+// ----------------- projection -----------------
+
+TEST(ColumnarProjection, ReadsOnlyRequestedColumnsInRequestedOrder) {
+    const std::string schema_csv = "a,int64\nb,string\nc,int64\nd,string\n";
+    std::string data_csv;
+    for (int i = 0; i < 300; ++i) {
+        data_csv += std::to_string(i) + ",b" + std::to_string(i) + "," + std::to_string(-i) + ",d" + std::to_string(i % 5) + "\n";
+    }
+
+    auto tmp = MakeTempDir();
+    const fs::path schema_path = tmp / "schema.csv";
+    const fs::path data_path   = tmp / "data.csv";
+    const fs::path col_path    = tmp / "out.columnar";
+    WriteFile(schema_path, schema_csv);
+    WriteFile(data_path, data_csv);
+    CsvToColumnar(schema_path, data_path, col_path, /*batch_rows*/ 64);
+
+    for (auto mode : {columnar::ReadMode::Stream, columnar::ReadMode::Mapped}) {
+        columnar::ColumnarReader reader(col_path, mode);
+        const std::vector<std::size_t> cols{reader.ColumnIndex("d"), reader.ColumnIndex("a")};
+
+        Batch b = reader.ReadBatch(2, cols);
+        ASSERT_EQ(b.ColCount(), 2u);
+        EXPECT_EQ(b.GetSchema()[0].name, "d");
+        EXPECT_EQ(b.GetSchema()[1].name, "a");
+        EXPECT_EQ(std::get<StringColumn>(b.GetColumn(0))[1], "d" + std::to_string(129 % 5));
+        EXPECT_EQ(std::get<std::vector<std::int64_t>>(b.GetColumn(1))[1], 129);
+
+        columnar::BatchView v = reader.ReadBatchView(4, cols);
+        ASSERT_EQ(v.RowCount(), 300u - 4 * 64);
+        EXPECT_EQ(v.Int64Column(1).back(), 299);
+
+        const DataVector c = reader.ReadColumn(reader.ColumnIndex("c"));
+        const auto& ints = std::get<std::vector<std::int64_t>>(c);
+        ASSERT_EQ(ints.size(), 300u);
+        for (int i = 0; i < 300; ++i) ASSERT_EQ(ints[i], -i);
+
+        const DataVector bcol = reader.ReadColumn(reader.ColumnIndex("b"));
+        const auto& strs = std::get<StringColumn>(bcol);
+        ASSERT_EQ(strs.size(), 300u);
+        EXPECT_EQ(strs[0], "b0");
+        EXPECT_EQ(strs[299], "b299");
+
+        EXPECT_THROW((void)reader.ColumnIndex("nope"), std::runtime_error);
+        const std::vector<std::size_t> bad{7};
+        EXPECT_THROW((void)reader.ReadBatch(0, bad), std::runtime_error);
+    }
+}
+
+// ----------------- chunk stats -----------------
+
+TEST(ChunkStatsTests, MinMaxAndDistinctEstimate) {
+    std::vector<std::int64_t> ints;
+    for (int i = 0; i < 10000; ++i) ints.push_back((i * 7919) % 1000 - 500);
+    const auto s = columnar::ComputeStats(ints);
+    EXPECT_TRUE(s.present);
+    EXPECT_EQ(s.min_int, -500);
+    EXPECT_EQ(s.max_int, 499);
+    EXPECT_NEAR(static_cast<double>(s.distinct), 1000.0, 150.0);
+
+    StringColumn strs;
+    strs.push_back("pear");
+    strs.push_back(std::string(40, 'z'));
+    strs.push_back("apple");
+    strs.push_back("pear");
+    const auto ss = columnar::ComputeStats(strs);
+    EXPECT_EQ(ss.min_str, "apple");
+    EXPECT_EQ(ss.max_str, std::string(columnar::kStatsPrefixLength, 'z'));
+    EXPECT_EQ(ss.distinct, 3u);
+}
+
+TEST(ChunkStatsTests, CandidateBatchesSkipBatchesOutsideRange) {
+    const std::string schema_csv = "ts,int64\nhost,string\n";
+    std::string data_csv;
+    for (int i = 0; i < 1000; ++i) {
+        data_csv += std::to_string(1'700'000'000 + i) + ",host" + std::to_string(i / 100) + "\n";
+    }
+
+    auto tmp = MakeTempDir();
+    WriteFile(tmp / "schema.csv", schema_csv);
+    WriteFile(tmp / "data.csv", data_csv);
+    CsvToColumnar(tmp / "schema.csv", tmp / "data.csv", tmp / "out.columnar", /*batch_rows*/ 100);
+
+    columnar::ColumnarReader reader(tmp / "out.columnar");
+    ASSERT_EQ(reader.NumBatches(), 10u);
+    EXPECT_EQ(reader.Version(), columnar::kColumnarVersion);
+
+    using columnar::CompareOp;
+    const std::vector<columnar::Predicate> range{
+        {0, CompareOp::Ge, std::int64_t{1'700'000'250}},
+        {0, CompareOp::Lt, std::int64_t{1'700'000'420}},
+    };
+    EXPECT_EQ(reader.CandidateBatches(range), (std::vector<std::size_t>{2, 3, 4}));
+
+    const std::vector<columnar::Predicate> host{{1, CompareOp::Eq, std::string("host7")}};
+    EXPECT_EQ(reader.CandidateBatches(host), (std::vector<std::size_t>{7}));
+
+    const std::vector<columnar::Predicate> none{{1, CompareOp::Gt, std::string("host9")}};
+    EXPECT_TRUE(reader.CandidateBatches(none).empty());
+
+    EXPECT_EQ(reader.CandidateBatches({}).size(), 10u);
+
+    const std::vector<columnar::Predicate> wrong_type{{0, CompareOp::Eq, std::string("x")}};
+    EXPECT_THROW((void)reader.CandidateBatches(wrong_type), std::runtime_error);
+}
+
+TEST(ChunkStatsTests, VersionOneFilesAreNeverPruned) {
+    auto tmp = MakeTempDir();
+    const fs::path p = tmp / "v1.columnar";
+    {
+        std::ofstream out(p, std::ios::binary | std::ios::trunc);
+        const char magic[4] = {'C','D','B','1'};
+        WriteBytes(out, magic, 4);
+        WriteObj(out, (std::uint32_t)1);
+        WriteObj(out, (std::uint64_t)(16 + 4 + 4 + 16));
+        WriteObj(out, (std::uint32_t)2);               // row_count
+        WriteObj(out, (std::uint32_t)0);               // padding
+        for (std::int64_t v : {1, 2}) WriteObj(out, v);
+        WriteObj(out, (std::uint32_t)1);               // ncols
+        WriteString(out, "v");
+        WriteObj(out, (std::uint8_t)0);
+        WriteObj(out, (std::uint32_t)1);               // nrg
+        WriteObj(out, (std::uint32_t)2);
+        WriteObj(out, (std::uint64_t)24);
+        WriteObj(out, (std::uint64_t)16);
+    }
+
+    columnar::ColumnarReader reader(p);
+    EXPECT_EQ(reader.Version(), 1u);
+    const std::vector<columnar::Predicate> pred{{0, columnar::CompareOp::Gt, std::int64_t{100}}};
+    EXPECT_EQ(reader.CandidateBatches(pred), (std::vector<std::size_t>{0}));
+    EXPECT_EQ(std::get<std::vector<std::int64_t>>(reader.ReadBatch(0).GetColumn(0)), (std::vector<std::int64_t>{1, 2}));
+}
+
+// ----------------- secondary indexes -----------------
+
+TEST(SecondaryIndexes, FindRowsInUnsortedFilesAndDetectStaleIndexes) {
+    // 3000 rows over 600 keys, scattered across 12 batches.
+    std::string csv;
+    std::vector<std::pair<std::int64_t, std::string>> rows;
+    for (int i = 0; i < 3000; ++i) {
+        const std::int64_t key = (i * 7919) % 600 - 300;
+        rows.emplace_back(key, "u" + std::to_string((i * 31) % 1000));
+        csv += std::to_string(key) + "," + rows.back().second + "\n";
+    }
+    auto tmp = MakeTempDir();
+    WriteFile(tmp / "schema.csv", "k,int64\nuser,string\n");
+    WriteFile(tmp / "data.csv", csv);
+    CsvToColumnar(tmp / "schema.csv", tmp / "data.csv", tmp / "t.columnar", /*batch_rows*/ 250);
+
+    const auto k_index = columnar::SecondaryIndexPath(tmp / "t.columnar", "k");
+    const auto user_index = columnar::SecondaryIndexPath(tmp / "t.columnar", "user");
+    EXPECT_EQ(k_index.filename(), "t.columnar.k.idx");
+    columnar::BuildSecondaryIndex(tmp / "t.columnar", 0, k_index);
+    columnar::BuildSecondaryIndex(tmp / "t.columnar", 1, user_index);
+
+    columnar::ColumnarReader reader(tmp / "t.columnar", columnar::ReadMode::Mapped);
+    const columnar::SecondaryIndex by_k(k_index);
+    const columnar::SecondaryIndex by_user(user_index);
+    ASSERT_TRUE(by_k.Matches(reader));
+    ASSERT_TRUE(by_user.Matches(reader));
+    EXPECT_EQ(by_k.Size(), rows.size());
+
+    const auto where = [&](auto pred) {
+        std::vector<columnar::RowLocation> locs;
+        for (std::size_t i = 0; i < rows.size(); ++i) {
+            if (pred(rows[i])) locs.push_back({static_cast<std::uint32_t>(i / 250), static_cast<std::uint32_t>(i % 250)});
+        }
+        return locs;
+    };
+    for (const std::int64_t key : {-301, -300, -1, 0, 17, 299, 300}) {
+        EXPECT_EQ(by_k.Find(key), where([&](const auto& r) { return r.first == key; })) << key;
+    }
+    EXPECT_EQ(by_k.Find(std::int64_t{-10}, std::int64_t{10}).size(),
+              where([](const auto& r) { return r.first >= -10 && r.first <= 10; }).size());
+    for (const char* user : {"u0", "u999", "u5", "u50", "v"}) {
+        EXPECT_EQ(by_user.Find(std::string(user)), where([&](const auto& r) { return r.second == user; })) << user;
+    }
+
+    const std::size_t all[] = {0, 1};
+    const Batch hit = reader.Lookup(by_user, std::string("u31"), all);
+    ASSERT_EQ(hit.RowCount(), 3u);
+    for (std::size_t i = 0; i < hit.RowCount(); ++i) EXPECT_EQ(std::get<StringColumn>(hit.GetColumn(1))[i], "u31");
+    EXPECT_THROW((void)by_k.Find(std::string("x")), std::runtime_error);
+
+    // Queries on an indexed equality only read the batches the index points at.
+    exec::QueryOptions query;
+    query.where = "user = 'u31'";
+    std::ostringstream out;
+    EXPECT_EQ(exec::RunQuery(tmp / "t.columnar", query, out).batches_scanned, 3u);
+    std::string want;
+    for (const auto& [k, user] : rows) {
+        if (user == "u31") want += std::to_string(k) + "," + user + "\n";
+    }
+    EXPECT_EQ(out.str(), want);
+
+    // Rewriting the data file makes both indexes stale.
+    WriteFile(tmp / "data.csv", csv + "1,u1\n");
+    CsvToColumnar(tmp / "schema.csv", tmp / "data.csv", tmp / "t.columnar", /*batch_rows*/ 250);
+    columnar::ColumnarReader rewritten(tmp / "t.columnar");
+    EXPECT_FALSE(by_k.Matches(rewritten));
+    EXPECT_THROW(rewritten.Lookup(by_user, std::string("u31"), all), std::runtime_error);
+    std::ostringstream fallback;
+    EXPECT_EQ(exec::RunQuery(tmp / "t.columnar", query, fallback).rows_matched, 3u);
+
+    WriteFile(tmp / "bad.idx", "CDX1");
+    EXPECT_THROW(columnar::SecondaryIndex(tmp / "bad.idx"), std::runtime_error);
+
+    // A truncated index is passed over like a stale one.
+    WriteFile(user_index, "CDX1");
+    std::ostringstream truncated;
+    EXPECT_EQ(exec::RunQuery(tmp / "t.columnar", query, truncated).rows_matched, 3u);
+
+    // So is a current index with a corrupt string offset or a location past the last batch.
+    // The file ends with count + 1 offsets and then the string bytes.
+    std::size_t string_bytes = 2;  // the appended "u1"
+    for (const auto& [k, user] : rows) string_bytes += user.size();
+    const auto patch = [&](std::size_t pos, std::uint64_t value) {
+        std::fstream f(user_index, std::ios::binary | std::ios::in | std::ios::out);
+        f.seekp(static_cast<std::streamoff>(pos));
+        f.write(reinterpret_cast<const char*>(&value), sizeof(value));
+    };
+    for (const bool bad_offset : {true, false}) {
+        columnar::BuildSecondaryIndex(tmp / "t.columnar", 1, user_index);
+        const std::size_t count = columnar::SecondaryIndex(user_index).Size();
+        ASSERT_TRUE(columnar::SecondaryIndex(user_index).Matches(rewritten));
+        const std::size_t offsets = fs::file_size(user_index) - string_bytes - (count + 1) * 8;
+        if (bad_offset) {
+            patch(offsets + count / 2 * 8, std::uint64_t{1} << 40);
+            EXPECT_THROW(columnar::SecondaryIndex{user_index}, std::runtime_error);
+        } else {
+            patch(offsets - count * 8 + count / 2 * 8, std::uint64_t{9999} << 32);
+            EXPECT_FALSE(columnar::SecondaryIndex(user_index).Matches(rewritten));
+        }
+        std::ostringstream corrupt;
+        EXPECT_EQ(exec::RunQuery(tmp / "t.columnar", query, corrupt).rows_matched, 3u) << bad_offset;
+    }
+}
+
+// ----------------- Bloom filters -----------------
+
+TEST(BloomFilters, NoFalseNegativesAndFewFalsePositives) {
+    std::vector<std::int64_t> ints;
+    StringColumn strings;
+    for (int i = 0; i < 10000; ++i) {
+        ints.push_back(static_cast<std::int64_t>(i) * 7919 - 5'000'000);
+        strings.push_back("user-" + std::to_string(i * 3));
+    }
+    const std::string int_filter = columnar::BuildBloomFilter(ints, ints.size());
+    const std::string str_filter = columnar::BuildBloomFilter(strings, strings.size());
+    for (std::size_t i = 0; i < ints.size(); ++i) {
+        ASSERT_TRUE(columnar::BloomMayContain(int_filter, columnar::BloomHash(ints[i]))) << columnar::BloomKernel();
+        ASSERT_TRUE(columnar::BloomMayContain(str_filter, columnar::BloomHash(strings[i])));
+    }
+
+    std::size_t false_positives = 0;
+    for (int i = 0; i < 100000; ++i) {
+        false_positives += columnar::BloomMayContain(int_filter, columnar::BloomHash(std::int64_t{i} * 7919 + 1));
+        false_positives += columnar::BloomMayContain(str_filter, columnar::BloomHash("user-" + std::to_string(i * 3 + 1)));
+    }
+    EXPECT_LT(false_positives, 200000u * 3 / 100);
+}
+
+TEST(BloomFilters, ReaderProbesRuleOutBatchesBeforeReadingThem) {
+    // Request ids are scattered, so every batch's min/max covers almost the whole range.
+    std::string csv;
+    for (int i = 0; i < 4000; ++i) {
+        const int id = (i * 2654435761u) % 100000;
+        csv += std::to_string(id) + ",req" + std::to_string(id) + "\n";
+    }
+    auto tmp = MakeTempDir();
+    WriteFile(tmp / "schema.csv", "id,int64\nrequest,string\n");
+    WriteFile(tmp / "data.csv", csv);
+    CsvToColumnar(tmp / "schema.csv", tmp / "data.csv", tmp / "plain.columnar", /*batch_rows*/ 250);
+
+    // Rewrite with filters on both columns.
+    columnar::WriterOptions options;
+    options.bloom_columns = {0, 1};
+    {
+        columnar::ColumnarReader in(tmp / "plain.columnar");
+        columnar::ColumnarWriter writer(tmp / "bloom.columnar", in.GetSchema(), options);
+        for (std::size_t idx = 0; idx < in.NumBatches(); ++idx) writer.WriteBatch(in.ReadBatch(idx));
+        writer.Finish();
+    }
+
+    for (const auto mode : {columnar::ReadMode::Stream, columnar::ReadMode::Mapped}) {
+        columnar::ColumnarReader reader(tmp / "bloom.columnar", mode);
+        ASSERT_EQ(reader.NumBatches(), 16u);
+        const int id = (1234 * 2654435761u) % 100000;
+        std::size_t candidates = 0;
+        for (std::size_t idx = 0; idx < reader.NumBatches(); ++idx) {
+            EXPECT_GT(reader.GetBatchMeta(idx).columns[1].bloom_size, 0u);
+            const bool by_id = reader.MayContain(idx, 0, std::int64_t{id});
+            if (idx == 1234 / 250) {
+                EXPECT_TRUE(by_id);
+                EXPECT_TRUE(reader.MayContain(idx, 1, "req" + std::to_string(id)));
+            }
+            candidates += by_id;
+        }
+        EXPECT_LE(candidates, 3u);
+        EXPECT_THROW((void)reader.MayContain(0, 0, std::string("x")), std::runtime_error);
+    }
+
+    columnar::ColumnarReader plain(tmp / "plain.columnar");
+    EXPECT_TRUE(plain.MayContain(0, 0, std::int64_t{-1}));
+
+    exec::QueryOptions query;
+    query.where = "request = 'req" + std::to_string((77 * 2654435761u) % 100000) + "'";
+    std::ostringstream with_blooms, without;
+    const auto bloom_stats = exec::RunQuery(tmp / "bloom.columnar", query, with_blooms);
+    const auto plain_stats = exec::RunQuery(tmp / "plain.columnar", query, without);
+    EXPECT_EQ(with_blooms.str(), without.str());
+    EXPECT_EQ(bloom_stats.rows_matched, 1u);
+    EXPECT_LE(bloom_stats.batches_scanned, 3u);
+    EXPECT_GT(plain_stats.batches_scanned, 10u);
+
+    // Aggregates prune batches the same way.
+    query.select = {"count(*)", "min(id)"};
+    std::ostringstream aggregated, aggregated_plain;
+    const auto agg_stats = exec::RunQuery(tmp / "bloom.columnar", query, aggregated);
+    const auto agg_plain_stats = exec::RunQuery(tmp / "plain.columnar", query, aggregated_plain);
+    EXPECT_EQ(aggregated.str(), "1," + std::to_string((77 * 2654435761u) % 100000) + "\n");
+    EXPECT_EQ(aggregated.str(), aggregated_plain.str());
+    EXPECT_LE(agg_stats.batches_scanned, 3u);
+    EXPECT_GT(agg_plain_stats.batches_scanned, 10u);
+}
+
+// ----------------- sort order -----------------
+
+TEST(SortedFiles, LookupAndRangeMatchScanAndWriterRejectsUnsortedRows) {
+    // Keys 0, 0, 0, 3, 3, 3, ... so runs of equal keys straddle batch boundaries.
+    const Schema schema{{"k", DataType::Int64}, {"v", DataType::String}};
+    std::vector<std::int64_t> keys;
+    for (int i = 0; i < 1000; ++i) keys.push_back((i / 3) * 3);
+
+    auto tmp = MakeTempDir();
+    columnar::WriterOptions options;
+    options.sort_by = {{0, false}};
+    {
+        columnar::ColumnarWriter writer(tmp / "sorted.columnar", schema, options);
+        for (std::size_t begin = 0; begin < keys.size(); begin += 64) {
+            Batch batch(schema);
+            for (std::size_t i = begin; i < std::min(keys.size(), begin + 64); ++i) {
+                std::get<std::vector<std::int64_t>>(batch.GetColumn(0)).push_back(keys[i]);
+                std::get<StringColumn>(batch.GetColumn(1)).push_back("v" + std::to_string(i));
+            }
+            batch.SetRowCount(std::min<std::size_t>(64, keys.size() - begin));
+            writer.WriteBatch(batch);
+            if (begin == 128) writer.WriteBatch(Batch(schema));
+        }
+        writer.Finish();
+    }
+
+    columnar::ColumnarReader reader(tmp / "sorted.columnar", columnar::ReadMode::Mapped);
+    ASSERT_EQ(reader.SortOrder().size(), 1u);
+    EXPECT_EQ(std::get<std::int64_t>(reader.GetBatchMeta(1).first_key[0]), 63);
+    EXPECT_EQ(std::get<std::int64_t>(reader.GetBatchMeta(1).last_key[0]), 126);
+
+    const auto scan = [&](std::int64_t lo, std::int64_t hi) {
+        std::vector<std::string> rows;
+        for (std::size_t i = 0; i < keys.size(); ++i) {
+            if (keys[i] >= lo && keys[i] <= hi) rows.push_back("v" + std::to_string(i));
+        }
+        return rows;
+    };
+    const auto values = [](const Batch& batch) {
+        const auto& col = std::get<StringColumn>(batch.GetColumn(0));
+        return std::vector<std::string>(col.begin(), col.end());
+    };
+    const std::size_t v_col[] = {1};
+    for (const std::int64_t lo : {-5, 0, 62, 63, 64, 190, 500, 996, 997, 2000}) {
+        for (const std::int64_t hi : {lo - 1, lo, lo + 1, lo + 70, std::int64_t{5000}}) {
+            EXPECT_EQ(values(reader.Range(lo, hi, v_col)), scan(lo, hi)) << lo << ".." << hi;
+        }
+    }
+    const Batch hit = reader.Lookup(std::int64_t{63});
+    ASSERT_EQ(hit.RowCount(), 3u);
+    EXPECT_EQ(std::get<StringColumn>(hit.GetColumn(1))[0], "v63");
+    EXPECT_THROW(reader.Lookup(std::string("x")), std::runtime_error);
+
+    // Descending string keys, as written by ExternalSort.
+    exec::SortOptions sort;
+    sort.keys = {exec::ParseSortKey("v:desc")};
+    sort.batch_rows = 50;
+    exec::ExternalSort(tmp / "sorted.columnar", tmp / "desc.columnar", sort);
+    columnar::ColumnarReader desc(tmp / "desc.columnar");
+    ASSERT_EQ(desc.SortOrder().size(), 1u);
+    EXPECT_TRUE(desc.SortOrder()[0].descending);
+    const Batch range = desc.Range(std::string("v10"), std::string("v11"), v_col);
+    EXPECT_EQ(values(range), (std::vector<std::string>{"v11", "v109", "v108", "v107", "v106", "v105", "v104",
+                                                       "v103", "v102", "v101", "v100", "v10"}));
+
+    // Unsorted rows fail within a batch and across batches; files without an order cannot Range.
+    Batch backwards(schema);
+    std::get<std::vector<std::int64_t>>(backwards.GetColumn(0)) = {2, 1};
+    std::get<StringColumn>(backwards.GetColumn(1)).push_back("a");
+    std::get<StringColumn>(backwards.GetColumn(1)).push_back("b");
+    backwards.SetRowCount(2);
+    columnar::ColumnarWriter bad(tmp / "bad.columnar", schema, options);
+    EXPECT_THROW(bad.WriteBatch(backwards), std::runtime_error);
+    Batch first(schema);
+    first.AppendRows(backwards, 0, 1);
+    Batch second(schema);
+    second.AppendRows(backwards, 1, 1);
+    bad.WriteBatch(first);
+    EXPECT_THROW(bad.WriteBatch(second), std::runtime_error);
+    bad.Finish();
+
+    {
+        columnar::ColumnarWriter plain(tmp / "plain.columnar", schema);
+        plain.WriteBatch(backwards);
+    }
+    columnar::ColumnarReader plain(tmp / "plain.columnar");
+    EXPECT_TRUE(plain.SortOrder().empty());
+    EXPECT_THROW(plain.Lookup(std::int64_t{1}), std::runtime_error);
+}
+
+// ----------------- int64 encodings -----------------
+
+static std::vector<std::int64_t> RoundTripInt64(const std::vector<std::int64_t>& values, columnar::Encoding enc) {
+    const auto stats = columnar::ComputeStats(values);
+    std::string bytes;
+    columnar::EncodeInt64(values, enc, stats, bytes);
+    std::vector<std::int64_t> out(values.size());
+    columnar::DecodeInt64(enc, bytes, out);
+    return out;
+}
+
+TEST(Int64Encoding, EveryEncodingRoundTripsEdgeValues) {
+    using columnar::Encoding;
+    std::vector<std::vector<std::int64_t>> inputs = {
+        {42},
+        {std::numeric_limits<std::int64_t>::min(), std::numeric_limits<std::int64_t>::max(), 0, -1, 1},
+        {},
+    };
+    std::vector<std::int64_t> mixed;
+    for (int i = 0; i < 1001; ++i) mixed.push_back((i * 2654435761LL) % 100003 - 50000);
+    inputs.push_back(mixed);
+
+    for (const auto& values : inputs) {
+        for (auto enc : {Encoding::Plain, Encoding::FrameOfReference, Encoding::Delta, Encoding::RunLength}) {
+            if (values.empty() && enc == Encoding::Delta) continue;
+            EXPECT_EQ(RoundTripInt64(values, enc), values) << columnar::EncodingName(enc) << " n=" << values.size();
+        }
+    }
+}
+
+TEST(Int64Encoding, ChoosesCompactEncodingsForTypicalShapes) {
+    using columnar::Encoding;
+    std::vector<std::int64_t> timestamps, small_enum, runs, random;
+    std::mt19937_64 rng(7);
+    for (int i = 0; i < 65536; ++i) {
+        timestamps.push_back(1'700'000'000'000LL + i * 1000LL);
+        small_enum.push_back((i * 7) % 5);
+        runs.push_back(i / 4096);
+        random.push_back(static_cast<std::int64_t>(rng()));
+    }
+    const auto choose = [](const std::vector<std::int64_t>& v) {
+        return columnar::ChooseInt64Encoding(v, columnar::ComputeStats(v));
+    };
+    EXPECT_EQ(choose(timestamps), Encoding::Delta);
+    EXPECT_EQ(choose(small_enum), Encoding::FrameOfReference);
+    EXPECT_EQ(choose(runs), Encoding::RunLength);
+    EXPECT_EQ(choose(random), Encoding::Plain);
+
+    for (int width = 0; width <= 64; ++width) {
+        std::vector<std::int64_t> v;
+        for (int i = 0; i < 37; ++i) {
+            const std::uint64_t x = static_cast<std::uint64_t>(i) * 0x9E3779B97F4A7C15ULL;
+            v.push_back(static_cast<std::int64_t>(width == 64 ? x : x & ((std::uint64_t{1} << width) - 1)));
+        }
+        EXPECT_EQ(RoundTripInt64(v, Encoding::FrameOfReference), v) << "width=" << width;
+    }
+}
+
+TEST(Int64Encoding, EncodedFilesShrinkAndReadBackInBothModes) {
+    const std::string schema_csv = "ts,int64\nstatus,int64\nname,string\n";
+    std::string data_csv;
+    for (int i = 0; i < 5000; ++i) {
+        data_csv += std::to_string(1'700'000'000 + i) + "," + std::to_string(200 + (i % 3)) + ",n" + std::to_string(i % 10) + "\n";
+    }
+
+    auto tmp = MakeTempDir();
+    WriteFile(tmp / "schema.csv", schema_csv);
+    WriteFile(tmp / "data.csv", data_csv);
+    CsvToColumnar(tmp / "schema.csv", tmp / "data.csv", tmp / "out.columnar", /*batch_rows*/ 1000);
+
+    columnar::ColumnarReader stream(tmp / "out.columnar");
+    columnar::ColumnarReader mapped(tmp / "out.columnar", columnar::ReadMode::Mapped);
+    ASSERT_EQ(stream.NumBatches(), 5u);
+    for (std::size_t b = 0; b < stream.NumBatches(); ++b) {
+        const auto& meta = stream.GetBatchMeta(b);
+        EXPECT_EQ(meta.columns[0].encoding, columnar::Encoding::Delta);
+        EXPECT_EQ(meta.columns[1].encoding, columnar::Encoding::FrameOfReference);
+        EXPECT_LT(meta.columns[0].size + meta.columns[1].size, 2 * 1000 * sizeof(std::int64_t) / 8);
+
+        const Batch batch = stream.ReadBatch(b);
+        const auto view = mapped.ReadBatchView(b);
+        const auto& ts = std::get<std::vector<std::int64_t>>(batch.GetColumn(0));
+        const auto status = view.Int64Column(1);
+        for (std::size_t r = 0; r < 1000; ++r) {
+            const auto i = static_cast<std::int64_t>(b * 1000 + r);
+            ASSERT_EQ(ts[r], 1'700'000'000 + i);
+            ASSERT_EQ(status[r], 200 + i % 3);
+        }
+    }
+
+    const auto ts = std::get<std::vector<std::int64_t>>(mapped.ReadColumn(0));
+    ASSERT_EQ(ts.size(), 5000u);
+    EXPECT_EQ(ts.back(), 1'700'004'999);
+}
+
+// ----------------- string dictionary -----------------
+
+TEST(StringDictionaryEncoding, RoundTripsAndFallsBackOnHighCardinality) {
+    StringColumn low;
+    const char* countries[] = {"se", "de", "", "us", "fr"};
+    for (int i = 0; i < 999; ++i) low.push_back(countries[(i * 3) % 5]);
+
+    std::string bytes;
+    ASSERT_TRUE(columnar::EncodeStringDictionary(low, columnar::ComputeStats(low), bytes));
+
+    columnar::StringDictionary dict;
+    columnar::DecodeStringDictionary(bytes, low.size(), dict);
+    ASSERT_EQ(dict.values.size(), 5u);
+    EXPECT_TRUE(std::is_sorted(dict.values.begin(), dict.values.end()));
+    ASSERT_EQ(dict.codes.size(), low.size());
+    for (std::size_t i = 0; i < low.size(); ++i) ASSERT_EQ(dict.values[dict.codes[i]], low[i]);
+    EXPECT_EQ(dict.Find("us"), std::optional<std::uint32_t>(4));
+    EXPECT_EQ(dict.Find("xx"), std::nullopt);
+
+    StringColumn unique;
+    for (int i = 0; i < 999; ++i) unique.push_back("id-" + std::to_string(i));
+    std::string untouched = "keep";
+    EXPECT_FALSE(columnar::EncodeStringDictionary(unique, columnar::ComputeStats(unique), untouched));
+    EXPECT_EQ(untouched, "keep");
+}
+
+TEST(StringDictionaryEncoding, ReaderExposesCodesAndMaterializesValues) {
+    const std::string schema_csv = "host,string\nid,string\n";
+    std::string data_csv;
+    for (int i = 0; i < 3000; ++i) {
+        data_csv += "host-" + std::to_string(i % 7) + ",req-" + std::to_string(i) + "\n";
+    }
+
+    auto tmp = MakeTempDir();
+    WriteFile(tmp / "schema.csv", schema_csv);
+    WriteFile(tmp / "data.csv", data_csv);
+    CsvToColumnar(tmp / "schema.csv", tmp / "data.csv", tmp / "out.columnar", /*batch_rows*/ 1000);
+
+    for (auto mode : {columnar::ReadMode::Stream, columnar::ReadMode::Mapped}) {
+        columnar::ColumnarReader reader(tmp / "out.columnar", mode);
+        ASSERT_EQ(reader.NumBatches(), 3u);
+        for (std::size_t b = 0; b < reader.NumBatches(); ++b) {
+            EXPECT_EQ(reader.GetBatchMeta(b).columns[0].encoding, columnar::Encoding::Dictionary);
+            EXPECT_EQ(reader.GetBatchMeta(b).columns[1].encoding, columnar::Encoding::Plain);
+            EXPECT_FALSE(reader.ReadDictionary(b, 1).has_value());
+
+            const auto dict = reader.ReadDictionary(b, 0);
+            ASSERT_TRUE(dict.has_value());
+            EXPECT_EQ(dict->values.size(), 7u);
+            const auto code = dict->Find("host-3");
+            ASSERT_TRUE(code.has_value());
+            const auto matches = std::count(dict->codes.begin(), dict->codes.end(), *code);
+            EXPECT_GE(matches, 142);
+
+            const Batch batch = reader.ReadBatch(b);
+            const auto view = reader.ReadBatchView(b);
+            const auto& hosts = std::get<StringColumn>(batch.GetColumn(0));
+            std::size_t r = 0;
+            for (const std::string_view v : view.StringColumnView(0)) {
+                const std::string expected = "host-" + std::to_string((b * 1000 + r) % 7);
+                ASSERT_EQ(v, expected);
+                ASSERT_EQ(hosts[r], expected);
+                ++r;
+            }
+            EXPECT_EQ(r, 1000u);
+        }
+    }
+}
+
+// ----------------- codecs -----------------
+
+TEST(Codecs, LzRoundTripsEdgeInputsAndRejectsCorruption) {
+    std::mt19937_64 rng(3);
+    std::string random(100000, '\0');
+    for (auto& c : random) c = static_cast<char>(rng());
+    std::string repetitive;
+    for (int i = 0; i < 20000; ++i) repetitive += "event=" + std::to_string(i % 17) + ";";
+
+    const std::vector<std::string> inputs = {"", "a", "abcabcabcabcabcabcabc", std::string(70000, 'x'), random, repetitive};
+    for (const auto& in : inputs) {
+        std::string packed;
+        columnar::Compress(columnar::Codec::Lz, in, packed);
+        std::string out(in.size(), '\0');
+        columnar::Decompress(columnar::Codec::Lz, packed, out);
+        EXPECT_EQ(out, in) << "size=" << in.size();
+    }
+
+    std::string packed;
+    columnar::Compress(columnar::Codec::Lz, repetitive, packed);
+    EXPECT_LT(packed.size(), repetitive.size() / 10);
+    std::string out(repetitive.size(), '\0');
+    EXPECT_THROW(columnar::Decompress(columnar::Codec::Lz, std::string_view(packed).substr(0, packed.size() / 2), out),
+                 std::runtime_error);
+    std::string shorter(repetitive.size() - 1, '\0');
+    EXPECT_THROW(columnar::Decompress(columnar::Codec::Lz, packed, shorter), std::runtime_error);
+
+    EXPECT_EQ(columnar::ParseCodec("lz"), columnar::Codec::Lz);
+    EXPECT_THROW((void)columnar::ParseCodec("brotli"), std::runtime_error);
+}
+
+TEST(Codecs, CompressedFilesReadBackInBothModes) {
+    const std::string schema_csv = "id,int64\nmsg,string\n";
+    std::string data_csv;
+    std::mt19937_64 rng(11);
+    for (int i = 0; i < 4000; ++i) {
+        data_csv += std::to_string(rng() % 1000000) + ",\"GET /api/v1/items/" + std::to_string(i) + " HTTP/1.1\"\n";
+    }
+
+    auto tmp = MakeTempDir();
+    WriteFile(tmp / "schema.csv", schema_csv);
+    WriteFile(tmp / "data.csv", data_csv);
+    CsvToColumnar(tmp / "schema.csv", tmp / "data.csv", tmp / "plain.columnar", /*batch_rows*/ 1000);
+
+    {
+        std::ifstream schema_in(tmp / "schema.csv");
+        std::ifstream data_in(tmp / "data.csv");
+        const Schema schema = LoadSchemaCsv(schema_in);
+        CsvBatchReader br(data_in, schema, 1000);
+        columnar::WriterOptions options;
+        options.codec = columnar::Codec::Lz;
+        columnar::ColumnarWriter wr(tmp / "lz.columnar", schema, options);
+        while (auto b = br.ReadNext()) wr.WriteBatch(*b);
+        wr.Finish();
+    }
+    EXPECT_LT(fs::file_size(tmp / "lz.columnar"), fs::file_size(tmp / "plain.columnar") * 3 / 4);
+
+    columnar::ColumnarReader plain(tmp / "plain.columnar");
+    for (auto mode : {columnar::ReadMode::Stream, columnar::ReadMode::Mapped}) {
+        columnar::ColumnarReader lz(tmp / "lz.columnar", mode);
+        ASSERT_EQ(lz.NumBatches(), plain.NumBatches());
+        EXPECT_EQ(lz.GetBatchMeta(0).columns[1].codec, columnar::Codec::Lz);
+        EXPECT_EQ(lz.GetBatchMeta(0).columns[1].uncompressed_size, plain.GetBatchMeta(0).columns[1].size);
+        for (std::size_t b = 0; b < lz.NumBatches(); ++b) {
+            const Batch expected = plain.ReadBatch(b);
+            const Batch got = lz.ReadBatch(b);
+            EXPECT_EQ(got.GetColumn(0), expected.GetColumn(0));
+            EXPECT_EQ(got.GetColumn(1), expected.GetColumn(1));
+            EXPECT_EQ(lz.ReadBatchView(b).ToBatch().GetColumn(1), expected.GetColumn(1));
+        }
+        EXPECT_EQ(lz.ReadColumn(1), plain.ReadColumn(1));
+    }
+}
+
+// ----------------- pipelined ingest -----------------
+
+TEST(SpscQueueTests, DeliversInOrderAndCloseUnblocksBothSides) {
+    utils::SpscQueue<std::string> q(2);
+    std::thread producer([&] {
+        for (int i = 0; i < 10000; ++i) ASSERT_TRUE(q.Push(std::to_string(i)));
+        q.Close();
+    });
+    int expected = 0;
+    while (auto v = q.Pop()) {
+        ASSERT_EQ(*v, std::to_string(expected));
+        ++expected;
+    }
+    producer.join();
+    EXPECT_EQ(expected, 10000);
+
+    utils::SpscQueue<int> abandoned(1);
+    bool pushed_after_close = true;
+    std::thread blocked([&] {
+        abandoned.Push(1);
+        pushed_after_close = abandoned.Push(2);  // full until the consumer closes
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    abandoned.Close();
+    blocked.join();
+    EXPECT_FALSE(pushed_after_close);
+}
+
+TEST(PipelinedIngest, WritesSameFileAsSequentialWriter) {
+    const std::string schema_csv = "id,int64\nname,string\nv,int64\n";
+    std::string data_csv;
+    for (int i = 0; i < 2500; ++i) {
+        data_csv += std::to_string(i) + ",\"n," + std::to_string(i % 13) + "\"," + std::to_string(i * i) + "\n";
+    }
+
+    auto tmp = MakeTempDir();
+    WriteFile(tmp / "schema.csv", schema_csv);
+    WriteFile(tmp / "data.csv", data_csv);
+    CsvToColumnar(tmp / "schema.csv", tmp / "data.csv", tmp / "seq.columnar", /*batch_rows*/ 100);
+
+    std::ifstream schema_in(tmp / "schema.csv");
+    const Schema schema = LoadSchemaCsv(schema_in);
+    for (std::size_t threads : {1u, 3u}) {
+        const fs::path out = tmp / ("pipe" + std::to_string(threads) + ".columnar");
+        {
+            columnar::ColumnarWriter wr(out, schema);
+            columnar::IngestOptions options;
+            options.threads = threads;
+            options.batch_rows = 100;
+            options.queue_depth = 1;
+            columnar::IngestCsv(tmp / "data.csv", wr, options);
+            wr.Finish();
+        }
+        std::ifstream a(tmp / "seq.columnar", std::ios::binary), b(out, std::ios::binary);
+        const std::string sa((std::istreambuf_iterator<char>(a)), {}), sb((std::istreambuf_iterator<char>(b)), {});
+        EXPECT_EQ(sa, sb) << "threads=" << threads;
+    }
+}
+
+TEST(PipelinedIngest, ParseErrorStopsAllStagesAndIsRethrown) {
+    std::string data_csv;
+    for (int i = 0; i < 5000; ++i) data_csv += std::to_string(i) + "\n";
+    data_csv += "oops\n";
+    for (int i = 0; i < 5000; ++i) data_csv += std::to_string(i) + "\n";
+
+    auto tmp = MakeTempDir();
+    WriteFile(tmp / "data.csv", data_csv);
+    const Schema schema{ColumnSchema{"v", DataType::Int64}};
+    columnar::ColumnarWriter wr(tmp / "out.columnar", schema);
+    columnar::IngestOptions options;
+    options.batch_rows = 10;
+    options.queue_depth = 1;
+    try {
+        columnar::IngestCsv(tmp / "data.csv", wr, options);
+        FAIL() << "expected a parse error";
+    } catch (const std::runtime_error& e) {
+        EXPECT_NE(std::string(e.what()).find("5001"), std::string::npos) << e.what();
+    }
+}
+
+TEST(ParallelEncoding, WideBatchesMatchSingleThreadedWriter) {
+    Schema schema;
+    for (int c = 0; c < 24; ++c) {
+        schema.push_back(ColumnSchema{"c" + std::to_string(c), c % 3 == 0 ? DataType::String : DataType::Int64});
+    }
+
+    std::vector<Batch> batches;
+    std::mt19937_64 rng(5);
+    for (int b = 0; b < 3; ++b) {
+        Batch batch(schema);
+        for (std::size_t c = 0; c < schema.size(); ++c) {
+            for (int r = 0; r < 700; ++r) {
+                if (schema[c].type == DataType::String) {
+                    std::get<StringColumn>(batch.GetColumn(c)).push_back("v" + std::to_string(rng() % (c * 40 + 2)));
+                } else {
+                    std::get<std::vector<std::int64_t>>(batch.GetColumn(c)).push_back(static_cast<std::int64_t>(rng() % (1ULL << c)));
+                }
+            }
+        }
+        batch.SetRowCount(700);
+        batches.push_back(std::move(batch));
+    }
+
+    auto tmp = MakeTempDir();
+    const auto write = [&](const fs::path& p, std::size_t threads) {
+        columnar::WriterOptions options;
+        options.codec = columnar::Codec::Lz;
+        options.encode_threads = threads;
+        columnar::ColumnarWriter wr(p, schema, options);
+        for (const auto& b : batches) wr.WriteBatch(b);
+        wr.Finish();
+        std::ifstream in(p, std::ios::binary);
+        return std::string((std::istreambuf_iterator<char>(in)), {});
+    };
+    const std::string single = write(tmp / "single.columnar", 1);
+    EXPECT_EQ(write(tmp / "pool.columnar", 4), single);
+
+    columnar::ColumnarReader reader(tmp / "pool.columnar", columnar::ReadMode::Mapped);
+    ASSERT_EQ(reader.NumBatches(), 3u);
+    const Batch back = reader.ReadBatch(2);
+    for (std::size_t c = 0; c < schema.size(); ++c) EXPECT_EQ(back.GetColumn(c), batches[2].GetColumn(c));
+}
+
+// ----------------- csv export -----------------
+
+TEST(CsvExport, MatchesCsvWriterBytesForAnyThreadCount) {
+    const std::string schema_csv = "id,int64\ntag,string\nnote,string\n";
+    std::string data_csv;
+    const char* tags[] = {"plain", "\"quoted\"\"tag\"", "\"a,b\"", "\"\"", "\"line\nbreak\""};
+    for (int i = 0; i < 1200; ++i) {
+        std::string note = i % 50 == 0 ? "\"has \"\"q\"\" and ,\"" : "note" + std::to_string(i);
+        data_csv += std::to_string(i * 7919 - 4000000) + "," + tags[i % 5] + "," + note + "\n";
+    }
+
+    auto tmp = MakeTempDir();
+    WriteFile(tmp / "schema.csv", schema_csv);
+    WriteFile(tmp / "data.csv", data_csv);
+    CsvToColumnar(tmp / "schema.csv", tmp / "data.csv", tmp / "out.columnar", /*batch_rows*/ 100);
+
+    // Reference: the row-at-a-time CSVWriter path.
+    columnar::ColumnarReader reader(tmp / "out.columnar");
+    ASSERT_EQ(reader.GetBatchMeta(0).columns[1].encoding, columnar::Encoding::Dictionary);
+    const std::vector<std::size_t> cols{2, 0, 1};
+    std::ostringstream expected;
+    {
+        CSVWriter w(expected);
+        for (std::size_t b = 0; b < reader.NumBatches(); ++b) {
+            const Batch batch = reader.ReadBatch(b, cols);
+            for (std::size_t r = 0; r < batch.RowCount(); ++r) {
+                ASSERT_TRUE(w.WriteNext({std::string(std::get<StringColumn>(batch.GetColumn(0))[r]),
+                                         std::to_string(std::get<std::vector<std::int64_t>>(batch.GetColumn(1))[r]),
+                                         std::string(std::get<StringColumn>(batch.GetColumn(2))[r])}));
+            }
+        }
+    }
+
+    for (std::size_t threads : {1u, 2u, 5u}) {
+        std::ostringstream got;
+        columnar::CsvExportOptions options;
+        options.threads = threads;
+        options.window = threads == 5 ? 1 : 0;
+        columnar::ExportCsv(tmp / "out.columnar", cols, got, options);
+        EXPECT_EQ(got.str(), expected.str()) << "threads=" << threads;
+    }
+
+    // Nulls, narrow integers and dictionary-encoded nullable strings match WriteBatch.
+    std::string nullable_csv;
+    for (int i = 0; i < 300; ++i) {
+        nullable_csv += std::to_string(i) + "," + (i % 4 == 0 ? "" : std::to_string(i % 100)) + "," +
+                        (i % 3 == 0 ? "" : tags[i % 5]) + "\n";
+    }
+    WriteFile(tmp / "nullable_schema.csv", "id,int64\nx,int32,nullable\ns,string,nullable\n");
+    WriteFile(tmp / "nullable.csv", nullable_csv);
+    CsvToColumnar(tmp / "nullable_schema.csv", tmp / "nullable.csv", tmp / "nullable.columnar", /*batch_rows*/ 64);
+    columnar::ColumnarReader nullable(tmp / "nullable.columnar");
+    ASSERT_EQ(nullable.GetBatchMeta(0).columns[2].encoding, columnar::Encoding::Dictionary);
+    std::ostringstream batch_bytes;
+    {
+        CSVWriter w(batch_bytes);
+        for (std::size_t b = 0; b < nullable.NumBatches(); ++b) ASSERT_TRUE(w.WriteBatch(nullable.ReadBatch(b)));
+    }
+    std::ostringstream exported;
+    columnar::ExportCsv(tmp / "nullable.columnar", nullable.AllColumns(), exported, {});
+    EXPECT_EQ(exported.str(), batch_bytes.str());
+}
+
+// ----------------- CSVWriter::WriteBatch -----------------
+
+TEST(CsvWriterBatch, MatchesWriteNextBytes) {
+    Schema schema{{"s", DataType::String}, {"n", DataType::Int64}, {"t", DataType::String}};
+    Batch batch(schema);
+    auto& s = std::get<StringColumn>(batch.GetColumn(0));
+    auto& n = std::get<std::vector<std::int64_t>>(batch.GetColumn(1));
+    auto& t = std::get<StringColumn>(batch.GetColumn(2));
+
+    std::mt19937_64 rng(15);
+    const std::string alphabet = "abcxyz ;,\"\n\r";
+    for (int i = 0; i < 3000; ++i) {
+        // Lengths straddle the 64-byte scan blocks; many values are empty.
+        std::string v(rng() % 90, 'a');
+        for (auto& ch : v) ch = alphabet[rng() % (rng() % 4 == 0 ? alphabet.size() : 6)];
+        s.push_back(v);
+        t.push_back(i % 3 == 0 ? "" : "t" + std::to_string(i));
+        n.push_back(static_cast<std::int64_t>(rng()));
+    }
+    n[0] = std::numeric_limits<std::int64_t>::min();
+    batch.SetRowCount(3000);
+
+    for (char delim : {',', ';'}) {
+        std::ostringstream expected;
+        {
+            CSVWriter w(expected, delim);
+            for (std::size_t r = 0; r < batch.RowCount(); ++r) {
+                ASSERT_TRUE(w.WriteNext({std::string(s[r]), std::to_string(n[r]), std::string(t[r])}));
+            }
+        }
+        std::ostringstream got;
+        CSVWriter w(got, delim);
+        ASSERT_TRUE(w.WriteBatch(batch));
+        EXPECT_EQ(got.str(), expected.str()) << "delimiter " << delim;
+    }
+}
+
+TEST(CsvWriterBatch, MatchesWriteNextAcrossFlushesAndTypes) {
+    // One batch of several MiB, so WriteBatch flushes mid-batch.
+    std::string data_csv;
+    for (int i = 0; i < 40000; ++i) {
+        data_csv += std::to_string(i % 7 == 0 ? -i : i) + "," + (i % 5 == 0 ? "" : std::to_string(i % 30000)) + "," +
+                    "2024-0" + std::to_string(1 + i % 9) + "-1" + std::to_string(i % 10) + "," +
+                    (i % 11 == 0 ? "\"x,\"\"y\"\"\"" : "value-" + std::to_string(i) + std::string(i % 150, 'p')) + "\n";
+    }
+    auto tmp = MakeTempDir();
+    WriteFile(tmp / "schema.csv", "id,int64\nsmall,int16,nullable\nday,date\ns,string,nullable\n");
+    WriteFile(tmp / "data.csv", data_csv);
+    CsvToColumnar(tmp / "schema.csv", tmp / "data.csv", tmp / "out.columnar", /*batch_rows*/ 40000);
+    const Batch batch = columnar::ColumnarReader(tmp / "out.columnar").ReadBatch(0);
+    ASSERT_EQ(batch.RowCount(), 40000u);
+
+    std::ostringstream expected;
+    {
+        CSVWriter w(expected);
+        WriteRowsWithWriteNext(batch, w);
+    }
+    ASSERT_GT(expected.str().size(), std::size_t{3} << 20);
+    std::ostringstream got;
+    CSVWriter w(got);
+    ASSERT_TRUE(w.WriteBatch(batch));
+    EXPECT_EQ(got.str(), expected.str());
+}
+
+// ----------------- exec: filters and queries -----------------
+
+TEST(ExecFilter, ParsesPushesNotDownAndReportsErrors) {
+    const Schema schema{{"age", DataType::Int64}, {"city", DataType::String}, {"zip", DataType::String}};
+    using columnar::CompareOp;
+
+    const exec::Expr e = exec::ParseWhere("NOT (age >= 18 and city = 'O''Hare') OR 5 < age || zip == 02134", schema);
+    ASSERT_EQ(e.kind, exec::ExprKind::Or);
+    ASSERT_EQ(e.children.size(), 4u);
+    EXPECT_EQ(e.children[0].compare.op, CompareOp::Lt);
+    EXPECT_EQ(e.children[1].compare.op, CompareOp::Ne);
+    EXPECT_EQ(std::get<std::string>(e.children[1].compare.value), "O'Hare");
+    EXPECT_EQ(e.children[2].compare.op, CompareOp::Gt);
+    EXPECT_EQ(std::get<std::int64_t>(e.children[2].compare.value), 5);
+    EXPECT_EQ(std::get<std::string>(e.children[3].compare.value), "02134");
+    EXPECT_EQ(exec::ReferencedColumns(e), (std::vector<std::size_t>{0, 1, 2}));
+
+    for (const char* bad : {"age = 'x'", "nope = 1", "age >", "(age = 1", "age = 1 city", "1 = 2",
+                            "age = 99999999999999999999"}) {
+        EXPECT_THROW((void)exec::ParseWhere(bad, schema), std::runtime_error) << bad;
+    }
+}
+
+TEST(ExecFilter, Int64KernelMatchesScalarForEveryOperator) {
+    std::mt19937_64 rng(16);
+    std::vector<std::int64_t> values(1000);
+    for (auto& v : values) v = static_cast<std::int64_t>(rng() % 21) - 10;
+    values[3] = std::numeric_limits<std::int64_t>::min();
+    values[999] = std::numeric_limits<std::int64_t>::max();
+
+    using columnar::CompareOp;
+    for (const auto op : {CompareOp::Eq, CompareOp::Ne, CompareOp::Lt, CompareOp::Le, CompareOp::Gt, CompareOp::Ge}) {
+        for (const std::int64_t needle : {std::int64_t{0}, std::int64_t{-10}, std::numeric_limits<std::int64_t>::min()}) {
+            // Lengths around the 64-row words and 4-lane vectors.
+            for (const std::size_t n : {0u, 3u, 64u, 67u, 1000u}) {
+                exec::Bitmap got(exec::BitmapWords(n), ~std::uint64_t{0});
+                exec::CompareInt64(std::span(values.data(), n), op, needle, got.data());
+                exec::Bitmap expected(exec::BitmapWords(n));
+                for (std::size_t i = 0; i < n; ++i) {
+                    const std::int64_t v = values[i];
+                    const bool hit = op == CompareOp::Eq ? v == needle : op == CompareOp::Ne ? v != needle
+                                   : op == CompareOp::Lt ? v < needle : op == CompareOp::Le ? v <= needle
+                                   : op == CompareOp::Gt ? v > needle : v >= needle;
+                    expected[i / 64] |= static_cast<std::uint64_t>(hit) << (i % 64);
+                }
+                ASSERT_EQ(got, expected) << exec::CompareKernel() << " op " << static_cast<int>(op) << " n " << n;
+            }
+        }
+    }
+}
+
+TEST(ExecQuery, StreamsMatchingRowsAndPrunesBatches) {
+    const std::string schema_csv = "ts,int64\nhost,string\nmsg,string\n";
+    std::string data_csv;
+    for (int i = 0; i < 1000; ++i) {
+        data_csv += std::to_string(1000 + i) + ",host" + std::to_string(i % 7) + "," +
+                    (i % 10 == 0 ? "\"a,b\"" : "m" + std::to_string(i)) + "\n";
+    }
+
+    auto tmp = MakeTempDir();
+    WriteFile(tmp / "schema.csv", schema_csv);
+    WriteFile(tmp / "data.csv", data_csv);
+    CsvToColumnar(tmp / "schema.csv", tmp / "data.csv", tmp / "out.columnar", /*batch_rows*/ 100);
+
+    exec::QueryOptions options;
+    options.where = "ts >= 1250 AND ts < 1420 AND (host = 'host3' OR NOT msg <> 'a,b')";
+    options.select = {"msg", "ts"};
+    std::ostringstream got;
+    const exec::QueryStats stats = exec::RunQuery(tmp / "out.columnar", options, got);
+
+    std::ostringstream expected;
+    std::size_t matched = 0;
+    for (int i = 250; i < 420; ++i) {
+        if (i % 7 != 3 && i % 10 != 0) continue;
+        expected << (i % 10 == 0 ? "\"a,b\"" : "m" + std::to_string(i)) << "," << 1000 + i << "\n";
+        ++matched;
+    }
+    EXPECT_EQ(got.str(), expected.str());
+    EXPECT_EQ(stats.batches, 10u);
+    EXPECT_EQ(stats.batches_scanned, 3u);
+    EXPECT_EQ(stats.rows_matched, matched);
+
+    // No filter streams every row; a filter matching nothing writes nothing.
+    std::ostringstream all;
+    exec::RunQuery(tmp / "out.columnar", {}, all);
+    EXPECT_EQ(all.str(), data_csv);
+
+    options.where = "host = 'nope'";
+    std::ostringstream none;
+    EXPECT_EQ(exec::RunQuery(tmp / "out.columnar", options, none).rows_matched, 0u);
+    EXPECT_TRUE(none.str().empty());
+}
+
+TEST(ExecAggregate, MatchesReferenceAcrossThreadsAndRadixPartitioning) {
+    // 50000 distinct (id, host) keys push every worker past the radix partitioning threshold.
+    const std::string schema_csv = "id,int64\nhost,string\nbytes,int64\n";
+    std::string data_csv;
+    struct Ref { std::int64_t count = 0, sum = 0, min = 0, max = 0; };
+    std::map<std::pair<std::int64_t, std::string>, Ref> ref;
+    std::mt19937_64 rng(17);
+    for (int i = 0; i < 200000; ++i) {
+        const std::int64_t id = static_cast<std::int64_t>(rng() % 25000) - 100;
+        const std::string host = "h" + std::to_string(rng() % 2);
+        const std::int64_t bytes = static_cast<std::int64_t>(rng() % 2001) - 1000;
+        data_csv += std::to_string(id) + "," + host + "," + std::to_string(bytes) + "\n";
+        if (bytes < -900) continue;  // filtered out below
+        Ref& r = ref[{id, host}];
+        r.min = r.count == 0 ? bytes : std::min(r.min, bytes);
+        r.max = r.count == 0 ? bytes : std::max(r.max, bytes);
+        r.sum += bytes;
+        ++r.count;
+    }
+
+    auto tmp = MakeTempDir();
+    WriteFile(tmp / "schema.csv", schema_csv);
+    WriteFile(tmp / "data.csv", data_csv);
+    CsvToColumnar(tmp / "schema.csv", tmp / "data.csv", tmp / "out.columnar", /*batch_rows*/ 20000);
+
+    columnar::ColumnarReader reader(tmp / "out.columnar");
+    const Schema& schema = reader.GetSchema();
+    exec::AggregateOptions options;
+    options.group_by = {0, 1};
+    for (const char* item : {"COUNT(*)", "sum(bytes)", "min(bytes)", "max( bytes )"}) {
+        options.aggregates.push_back(*exec::ParseAggregate(item, schema));
+    }
+    options.where = exec::ParseWhere("bytes >= -900", schema);
+
+    for (const std::size_t threads : {1u, 4u}) {
+        options.threads = threads;
+        const Batch out = exec::Aggregate(tmp / "out.columnar", options);
+        ASSERT_EQ(out.RowCount(), ref.size());
+        EXPECT_EQ(out.GetSchema()[4].name, "min(bytes)");
+        const auto& ids = std::get<std::vector<std::int64_t>>(out.GetColumn(0));
+        const auto& hosts = std::get<StringColumn>(out.GetColumn(1));
+        std::size_t r = 0;
+        for (const auto& [key, want] : ref) {
+            ASSERT_EQ(ids[r], key.first) << "threads " << threads << " row " << r;
+            ASSERT_EQ(hosts[r], key.second);
+            ASSERT_EQ(std::get<std::vector<std::int64_t>>(out.GetColumn(2))[r], want.count);
+            ASSERT_EQ(std::get<std::vector<std::int64_t>>(out.GetColumn(3))[r], want.sum);
+            ASSERT_EQ(std::get<std::vector<std::int64_t>>(out.GetColumn(4))[r], want.min);
+            ASSERT_EQ(std::get<std::vector<std::int64_t>>(out.GetColumn(5))[r], want.max);
+            ++r;
+        }
+    }
+
+    EXPECT_FALSE(exec::ParseAggregate("bytes", schema).has_value());
+    EXPECT_THROW((void)exec::ParseAggregate("median(bytes)", schema), std::runtime_error);
+    EXPECT_THROW((void)exec::ParseAggregate("sum(host)", schema), std::runtime_error);
+    EXPECT_THROW((void)exec::ParseAggregate("sum(*)", schema), std::runtime_error);
+}
+
+TEST(ExecAggregate, QueryOrdersColumnsAsSelectedAndFormatsAverages) {
+    const std::string schema_csv = "host,string\nbytes,int64\n";
+    const std::string data_csv = "b,1\na,2\nb,4\na,3\nc,9223372036854775807\n";
+    auto tmp = MakeTempDir();
+    WriteFile(tmp / "schema.csv", schema_csv);
+    WriteFile(tmp / "data.csv", data_csv);
+    CsvToColumnar(tmp / "schema.csv", tmp / "data.csv", tmp / "out.columnar", /*batch_rows*/ 2);
+
+    exec::QueryOptions options;
+    options.where = "host < 'c'";
+    options.group_by = {"host"};
+    options.select = {"avg(bytes)", "host", "count(*)"};
+    std::ostringstream got;
+    EXPECT_EQ(exec::RunQuery(tmp / "out.columnar", options, got).rows_matched, 2u);
+    EXPECT_EQ(got.str(), "2.5,a,2\n2.5,b,2\n");
+
+    options.select = {};
+    std::ostringstream keys;
+    exec::RunQuery(tmp / "out.columnar", options, keys);
+    EXPECT_EQ(keys.str(), "a,2\nb,2\n");
+
+    options.select = {"bytes"};
+    std::ostringstream bad;
+    EXPECT_THROW(exec::RunQuery(tmp / "out.columnar", options, bad), std::runtime_error);
+
+    options.where = "";
+    options.group_by = {};
+    options.select = {"sum(bytes)"};
+    EXPECT_THROW(exec::RunQuery(tmp / "out.columnar", options, bad), std::runtime_error);
+
+    // Without GROUP BY, no matching rows still give one row.
+    options.where = "host = 'z'";
+    options.select = {"count(*)", "sum(bytes)", "min(bytes)", "avg(bytes)"};
+    std::ostringstream empty;
+    exec::RunQuery(tmp / "out.columnar", options, empty);
+    EXPECT_EQ(empty.str(), "0,,,\n");
+}
+
+TEST(ExecAggregate, SumOverflowDoesNotDependOnThreads) {
+    // The running sum passes INT64_MAX but the total fits.
+    auto tmp = MakeTempDir();
+    WriteFile(tmp / "schema.csv", "bytes,int64\n");
+    WriteFile(tmp / "data.csv", "9223372036854775807\n1\n-2\n");
+    CsvToColumnar(tmp / "schema.csv", tmp / "data.csv", tmp / "out.columnar", /*batch_rows*/ 1);
+
+    columnar::ColumnarReader reader(tmp / "out.columnar");
+    exec::AggregateOptions options;
+    options.aggregates.push_back(*exec::ParseAggregate("sum(bytes)", reader.GetSchema()));
+    for (const std::size_t threads : {1u, 3u}) {
+        options.threads = threads;
+        const Batch out = exec::Aggregate(tmp / "out.columnar", options);
+        ASSERT_EQ(out.RowCount(), 1u);
+        EXPECT_EQ(std::get<std::vector<std::int64_t>>(out.GetColumn(0))[0], 9223372036854775806);
+    }
+}
+
+// ----------------- exec: hash join -----------------
+
+static std::vector<std::string> ColumnarRowsAsCsv(const fs::path& path) {
+    std::ostringstream out;
+    exec::RunQuery(path, {}, out);
+    std::vector<std::string> rows;
+    std::istringstream in(out.str());
+    for (std::string line; std::getline(in, line);) rows.push_back(line);
+    return rows;
+}
+
+TEST(ExecJoin, InnerAndLeftJoinsMatchNestedLoopInAnyMode) {
+    // Events reference customers 0..59; customers 0..39 exist, some twice.
+    std::string events_csv, customers_csv;
+    std::vector<std::pair<std::int64_t, std::string>> events, customers;
+    for (int i = 0; i < 3000; ++i) {
+        events.emplace_back((i * 7) % 60, "e" + std::to_string(i));
+        events_csv += std::to_string(events.back().first) + "," + events.back().second + "\n";
+    }
+    for (int c = 0; c < 40; ++c) {
+        for (int dup = 0; dup < (c % 5 == 0 ? 2 : 1); ++dup) {
+            customers.emplace_back(c, "name" + std::to_string(c) + "_" + std::to_string(dup));
+            customers_csv += std::to_string(c) + "," + customers.back().second + "\n";
+        }
+    }
+
+    auto tmp = MakeTempDir();
+    WriteFile(tmp / "ev_schema.csv", "customer,int64\nname,string\n");
+    WriteFile(tmp / "events.csv", events_csv);
+    WriteFile(tmp / "cu_schema.csv", "id,int64\nname,string\n");
+    WriteFile(tmp / "customers.csv", customers_csv);
+    CsvToColumnar(tmp / "ev_schema.csv", tmp / "events.csv", tmp / "events.columnar", /*batch_rows*/ 256);
+    CsvToColumnar(tmp / "cu_schema.csv", tmp / "customers.csv", tmp / "customers.columnar", /*batch_rows*/ 16);
+
+    const auto reference = [&](bool left_outer, bool events_left) {
+        std::vector<std::string> rows;
+        const auto& outer = events_left ? events : customers;
+        const auto& inner = events_left ? customers : events;
+        for (const auto& [k, v] : outer) {
+            bool hit = false;
+            for (const auto& [k2, v2] : inner) {
+                if (k2 != k) continue;
+                hit = true;
+                rows.push_back(std::to_string(k) + "," + v + "," + v2);
+            }
+            if (!hit && left_outer) rows.push_back(std::to_string(k) + "," + v + ",");
+        }
+        return rows;
+    };
+
+    exec::JoinOptions options;
+    options.left_key = "customer";
+    options.right_key = "id";
+    for (const std::size_t threads : {1u, 3u}) {
+        for (const std::size_t budget : {std::size_t{1} << 30, std::size_t{0}}) {
+            options.threads = threads;
+            options.memory_budget = budget;
+
+            options.type = exec::JoinType::Inner;
+            auto stats = exec::HashJoin(tmp / "events.columnar", tmp / "customers.columnar", tmp / "inner.columnar", options);
+            EXPECT_FALSE(stats.build_is_left);
+            EXPECT_EQ(stats.partitions > 1, budget == 0);
+            auto got = ColumnarRowsAsCsv(tmp / "inner.columnar");
+            auto want = reference(false, true);
+            EXPECT_EQ(stats.output_rows, want.size());
+            if (budget == 0) {
+                std::ranges::sort(got);
+                std::ranges::sort(want);
+            }
+            EXPECT_EQ(got, want) << "inner, threads " << threads << " budget " << budget;
+
+            options.type = exec::JoinType::Left;
+            exec::HashJoin(tmp / "events.columnar", tmp / "customers.columnar", tmp / "left.columnar", options);
+            got = ColumnarRowsAsCsv(tmp / "left.columnar");
+            want = reference(true, true);
+            if (budget == 0) {
+                std::ranges::sort(got);
+                std::ranges::sort(want);
+            }
+            EXPECT_EQ(got, want) << "left, threads " << threads << " budget " << budget;
+        }
+    }
+
+    // The smaller left side becomes the build side of an inner join; output order follows the probe.
+    options = {};
+    options.left_key = "id";
+    options.right_key = "customer";
+    options.right_columns = {"name"};
+    const auto stats = exec::HashJoin(tmp / "customers.columnar", tmp / "events.columnar", tmp / "swap.columnar", options);
+    EXPECT_TRUE(stats.build_is_left);
+    columnar::ColumnarReader swapped(tmp / "swap.columnar");
+    EXPECT_EQ(swapped.GetSchema()[2].name, "right.name");
+    auto got = ColumnarRowsAsCsv(tmp / "swap.columnar");
+    auto want = reference(false, false);
+    std::ranges::sort(got);
+    std::ranges::sort(want);
+    EXPECT_EQ(got, want);
+
+    options.right_key = "name";
+    EXPECT_THROW(exec::HashJoin(tmp / "customers.columnar", tmp / "events.columnar", tmp / "bad.columnar", options),
+                 std::runtime_error);
+}
+
+TEST(ExecJoin, RepartitionsBuildPartitionsOverTheBudget) {
+    // 500 distinct keys need more partitions than one pass writes at once.
+    std::string csv;
+    std::vector<std::string> want;
+    for (int k = 0; k < 500; ++k) {
+        csv += std::to_string(k) + ",v" + std::to_string(k) + "\n";
+        want.push_back(std::to_string(k) + ",v" + std::to_string(k) + ",v" + std::to_string(k));
+    }
+    auto tmp = MakeTempDir();
+    WriteFile(tmp / "schema.csv", "k,int64\nv,string\n");
+    WriteFile(tmp / "data.csv", csv);
+    CsvToColumnar(tmp / "schema.csv", tmp / "data.csv", tmp / "a.columnar", /*batch_rows*/ 64);
+
+    exec::JoinOptions options;
+    options.left_key = "k";
+    options.right_key = "k";
+    options.memory_budget = 0;
+    const auto stats = exec::HashJoin(tmp / "a.columnar", tmp / "a.columnar", tmp / "out.columnar", options);
+    EXPECT_GT(stats.partitions, 64u);
+    EXPECT_EQ(stats.build_rows, 500u);
+    auto got = ColumnarRowsAsCsv(tmp / "out.columnar");
+    std::ranges::sort(got);
+    std::ranges::sort(want);
+    EXPECT_EQ(got, want);
+}
+
+// ----------------- exec: external sort -----------------
+
+TEST(SpillDir, CreatesAFreshDirectoryAndRemovesOnlyItsOwn) {
+    auto tmp = MakeTempDir();
+    fs::create_directories(tmp / "spill" / "other");
+    WriteFile(tmp / "spill" / "other" / "keep.txt", "x");
+    fs::path first_path;
+    {
+        const exec::SpillDir first(tmp / "spill", "op");
+        const exec::SpillDir second(tmp / "spill", "op");
+        first_path = first.Path();
+        EXPECT_NE(first.Path(), second.Path());
+        EXPECT_TRUE(fs::is_directory(first.Path()));
+        EXPECT_TRUE(fs::is_directory(second.Path()));
+        WriteFile(first.Path() / "run.columnar", "r");
+    }
+    EXPECT_FALSE(fs::exists(first_path));
+    EXPECT_TRUE(fs::exists(tmp / "spill" / "other" / "keep.txt"));
+}
+
+TEST(ExecSort, MatchesStableSortInMemoryAndAcrossSpilledMergePasses) {
+    struct Row { std::int64_t k; std::string s; std::int64_t id; };
+    std::vector<Row> rows;
+    std::string csv;
+    std::mt19937 rng(7);
+    for (int i = 0; i < 5000; ++i) {
+        rows.push_back({static_cast<std::int64_t>(rng() % 50) - 25, "s" + std::to_string(rng() % 7), i});
+        csv += std::to_string(rows.back().k) + "," + rows.back().s + "," + std::to_string(i) + "\n";
+    }
+
+    auto tmp = MakeTempDir();
+    WriteFile(tmp / "schema.csv", "k,int64\ns,string\nid,int64\n");
+    WriteFile(tmp / "data.csv", csv);
+    CsvToColumnar(tmp / "schema.csv", tmp / "data.csv", tmp / "in.columnar", /*batch_rows*/ 300);
+
+    // k ascending, then s descending; equal keys keep input order.
+    std::ranges::stable_sort(rows, [](const Row& a, const Row& b) {
+        if (a.k != b.k) return a.k < b.k;
+        return a.s > b.s;
+    });
+    std::vector<std::string> want;
+    for (const auto& r : rows) want.push_back(std::to_string(r.k) + "," + r.s + "," + std::to_string(r.id));
+
+    exec::SortOptions options;
+    options.keys = {exec::ParseSortKey("k"), exec::ParseSortKey(" s : DESC ")};
+    options.batch_rows = 700;
+    for (const std::size_t threads : {1u, 3u}) {
+        for (const std::size_t budget : {std::size_t{1} << 30, std::size_t{40000}, std::size_t{0}}) {
+            options.threads = threads;
+            options.memory_budget = budget;
+            const auto stats = exec::ExternalSort(tmp / "in.columnar", tmp / "out.columnar", options);
+            EXPECT_EQ(stats.rows, rows.size());
+            EXPECT_EQ(stats.merge_passes == 0, budget == std::size_t{1} << 30);
+            if (budget == 0) {
+                EXPECT_EQ(stats.runs, 17u);
+                EXPECT_GT(stats.merge_passes, 1u);
+            }
+            EXPECT_EQ(ColumnarRowsAsCsv(tmp / "out.columnar"), want) << "threads " << threads << " budget " << budget;
+
+            columnar::ColumnarReader out(tmp / "out.columnar");
+            EXPECT_EQ(out.GetBatchMeta(0).row_count, 700u);
+        }
+    }
+
+    EXPECT_THROW(exec::ParseSortKey("k:sideways"), std::runtime_error);
+    options.keys = {exec::ParseSortKey("missing")};
+    EXPECT_THROW(exec::ExternalSort(tmp / "in.columnar", tmp / "bad.columnar", options), std::runtime_error);
+}
+
+TEST(NarrowTypes, ParseFilterAndExportEveryIntegerType) {
+    const std::string schema_csv = "i8,int8\ni16,int16\ni32,int32\nb,bool\nd,date\nts,timestamp\n";
+    std::string data_csv;
+    std::vector<std::string> expected_rows;
+    for (int i = 0; i < 300; ++i) {
+        const int i8 = i % 256 - 128;
+        const int i16 = i * 200 - 30000;
+        const std::int64_t i32 = std::int64_t{i} * 7000000 - 1000000000;
+        const std::string day = "2024-02-" + std::string(i % 29 < 9 ? "0" : "") + std::to_string(i % 29 + 1);
+        const std::string ts = day + "T12:30:" + (i % 60 < 10 ? "0" : "") + std::to_string(i % 60) +
+                               (i % 2 ? ".250000" : "");
+        data_csv += std::to_string(i8) + "," + std::to_string(i16) + "," + std::to_string(i32) + "," +
+                    (i % 3 == 0 ? "true" : "0") + "," + day + "," + ts + "\n";
+        expected_rows.push_back(std::to_string(i8) + "," + std::to_string(i16) + "," + std::to_string(i32) + "," +
+                                (i % 3 == 0 ? "true" : "false") + "," + day + "," + ts);
+    }
+
+    auto tmp = MakeTempDir();
+    WriteFile(tmp / "schema.csv", schema_csv);
+    WriteFile(tmp / "data.csv", data_csv);
+    CsvToColumnar(tmp / "schema.csv", tmp / "data.csv", tmp / "out.columnar", /*batch_rows*/ 64);
+
+    columnar::ColumnarReader reader(tmp / "out.columnar", columnar::ReadMode::Mapped);
+    EXPECT_EQ(reader.GetSchema()[0].type, DataType::Int8);
+    EXPECT_EQ(reader.GetSchema()[4].type, DataType::Date);
+    const Batch first = reader.ReadBatch(0);
+    EXPECT_EQ(std::get<std::vector<std::int8_t>>(first.GetColumn(0))[0], -128);
+    EXPECT_EQ(std::get<std::vector<std::int32_t>>(first.GetColumn(4))[0], 19754); // 2024-02-01
+    EXPECT_EQ(reader.GetBatchMeta(0).columns[5].stats.min_int, 1706790600000000); // 2024-02-01T12:30:00Z
+
+    // Unfiltered queries print the values as they were written, apart from bool spelling.
+    EXPECT_EQ(ColumnarRowsAsCsv(tmp / "out.columnar"), expected_rows);
+
+    // Each filter agrees with a scan of the expected rows, including literals outside the
+    // column's range.
+    const std::vector<std::pair<std::string, std::function<bool(int)>>> cases = {
+        {"i8 >= 100", [](int i) { return i % 256 - 128 >= 100; }},
+        {"i8 < 1000", [](int) { return true; }},
+        {"i8 = -129", [](int) { return false; }},
+        {"i16 <> -30000 AND i16 <= 0", [](int i) { return i != 0 && i * 200 <= 30000; }},
+        {"i32 > 0", [](int i) { return std::int64_t{i} * 7000000 > 1000000000; }},
+        {"b = 'true'", [](int i) { return i % 3 == 0; }},
+        {"d = '2024-02-29'", [](int i) { return i % 29 == 28; }},
+        {"ts < '2024-02-01T12:30:30Z' OR ts >= '2024-02-29 12:30'", [](int i) {
+             return (i % 29 == 0 && i % 60 < 30) || i % 29 == 28;
+         }},
+    };
+    for (const auto& [where, pred] : cases) {
+        exec::QueryOptions options;
+        options.where = where;
+        std::ostringstream got;
+        exec::RunQuery(tmp / "out.columnar", options, got);
+        std::string expected;
+        for (int i = 0; i < 300; ++i) {
+            if (pred(i)) expected += expected_rows[i] + "\n";
+        }
+        EXPECT_EQ(got.str(), expected) << where;
+    }
+
+    EXPECT_THROW(exec::ParseWhere("d = 'yesterday'", reader.GetSchema()), std::runtime_error);
+
+    // Out-of-range and malformed fields are rejected with the column's type.
+    WriteFile(tmp / "bad.csv", "128,0,0,1,2024-01-01,2024-01-01\n");
+    EXPECT_THROW(CsvToColumnar(tmp / "schema.csv", tmp / "bad.csv", tmp / "bad.columnar", 64), std::runtime_error);
+    WriteFile(tmp / "bad.csv", "0,0,0,1,2023-02-29,2024-01-01\n");
+    EXPECT_THROW(CsvToColumnar(tmp / "schema.csv", tmp / "bad.csv", tmp / "bad.columnar", 64), std::runtime_error);
+}
+
+TEST(NarrowTypes, NarrowedSchemaFromStatsAndRewriteKeepsValues) {
+    auto tmp = MakeTempDir();
+    WriteFile(tmp / "schema.csv", "small,int64\nmid,int64\nbig,int64\nname,string\nts,timestamp\n");
+    std::string data_csv;
+    for (int i = 0; i < 1000; ++i) {
+        data_csv += std::to_string(i % 100 - 50) + "," + std::to_string(i * 30) + "," +
+                    std::to_string(std::int64_t{i} << 40) + ",n" + std::to_string(i) + ",1970-01-01T00:00:01\n";
+    }
+    WriteFile(tmp / "data.csv", data_csv);
+    CsvToColumnar(tmp / "schema.csv", tmp / "data.csv", tmp / "wide.columnar", /*batch_rows*/ 128);
+
+    Schema narrowed = columnar::NarrowedSchema(columnar::ColumnarReader(tmp / "wide.columnar"));
+    EXPECT_EQ(narrowed[0].type, DataType::Int8);
+    EXPECT_EQ(narrowed[1].type, DataType::Int16);
+    EXPECT_EQ(narrowed[2].type, DataType::Int64);
+    EXPECT_EQ(narrowed[3].type, DataType::String);
+    EXPECT_EQ(narrowed[4].type, DataType::Timestamp);
+
+    columnar::WriterOptions options;
+    options.sort_by = {{1, false}};
+    columnar::RewriteColumnar(tmp / "wide.columnar", tmp / "narrow.columnar", narrowed, options);
+    EXPECT_EQ(ColumnarRowsAsCsv(tmp / "narrow.columnar"), ColumnarRowsAsCsv(tmp / "wide.columnar"));
+
+    // Encoded chunks were already bit-packed on disk; the gain is in memory.
+    columnar::ColumnarReader reader(tmp / "narrow.columnar");
+    EXPECT_EQ(std::get<std::vector<std::int8_t>>(reader.ReadBatch(0).GetColumn(0)).size(), 128u);
+    EXPECT_EQ(reader.Lookup(std::int64_t{300}).RowCount(), 1u);
+
+    // A type that cannot hold the values is refused rather than truncated.
+    narrowed[1].type = DataType::Int8;
+    EXPECT_THROW(columnar::RewriteColumnar(tmp / "wide.columnar", tmp / "bad.columnar", narrowed), std::runtime_error);
+
+    // Without any values, or with only nulls, there is nothing to narrow by.
+    WriteFile(tmp / "empty.csv", "");
+    CsvToColumnar(tmp / "schema.csv", tmp / "empty.csv", tmp / "empty.columnar", /*batch_rows*/ 128);
+    EXPECT_EQ(columnar::NarrowedSchema(columnar::ColumnarReader(tmp / "empty.columnar"))[0].type, DataType::Int64);
+    WriteFile(tmp / "nulls_schema.csv", "id,int64\nx,int64,nullable\n");
+    WriteFile(tmp / "nulls.csv", "1,\n2,\n");
+    CsvToColumnar(tmp / "nulls_schema.csv", tmp / "nulls.csv", tmp / "nulls.columnar", /*batch_rows*/ 128);
+    const Schema nulls = columnar::NarrowedSchema(columnar::ColumnarReader(tmp / "nulls.columnar"));
+    EXPECT_EQ(nulls[0].type, DataType::Int8);
+    EXPECT_EQ(nulls[1].type, DataType::Int64);
+}
+
+// ----------------- nullable columns -----------------
+
+TEST(NullableColumns, ValidityIsStoredOnlyForMixedChunksAndRoundTrips) {
+    // Batches of 4 rows: every x and s null, none null, then some of each.
+    const std::string data_csv = "0,,\n1,,\n2,,\n3,,\n4,10,a\n5,11,b\n6,12,c\n7,13,d\n8,,e\n9,20,\n10, ,f\n11,21,g\n";
+    auto tmp = MakeTempDir();
+    WriteFile(tmp / "schema.csv", "id,int64\nx,int32,nullable\ns,string,nullable\n");
+    WriteFile(tmp / "data.csv", data_csv);
+    CsvToColumnar(tmp / "schema.csv", tmp / "data.csv", tmp / "out.columnar", /*batch_rows*/ 4);
+
+    std::istringstream schema_in("a,int64\nb,string,nullable\nc,int8,\n");
+    const Schema schema = LoadSchemaCsv(schema_in);
+    EXPECT_FALSE(schema[0].nullable);
+    EXPECT_TRUE(schema[1].nullable);
+    EXPECT_FALSE(schema[2].nullable);
+    std::istringstream bad_flag("a,int64,maybe\n");
+    EXPECT_THROW(LoadSchemaCsv(bad_flag), std::runtime_error);
+
+    columnar::ColumnarReader reader(tmp / "out.columnar", columnar::ReadMode::Mapped);
+    ASSERT_EQ(reader.NumBatches(), 3u);
+    EXPECT_TRUE(reader.GetSchema()[1].nullable);
+    const auto& all_null = reader.GetBatchMeta(0).columns[1];
+    EXPECT_EQ(all_null.null_count, 4u);
+    EXPECT_TRUE(all_null.stats.all_null);
+    EXPECT_EQ(all_null.size, 0u);
+    EXPECT_EQ(all_null.validity_size, 0u);
+    EXPECT_EQ(reader.GetBatchMeta(1).columns[1].null_count, 0u);
+    EXPECT_EQ(reader.GetBatchMeta(1).columns[1].validity_size, 0u);
+    EXPECT_EQ(reader.GetBatchMeta(2).columns[1].null_count, 2u);
+    EXPECT_EQ(reader.GetBatchMeta(2).columns[1].validity_size, 8u);
+    EXPECT_EQ(reader.GetBatchMeta(2).columns[2].null_count, 1u);
+
+    const Batch mixed = reader.ReadBatch(2);
+    EXPECT_EQ(mixed.NullCount(0), 0u);
+    EXPECT_TRUE(mixed.IsNull(1, 0));
+    EXPECT_FALSE(mixed.IsNull(1, 1));
+    EXPECT_TRUE(mixed.IsNull(1, 2));
+    EXPECT_EQ(std::get<std::vector<std::int32_t>>(mixed.GetColumn(1))[3], 21);
+    EXPECT_TRUE(mixed.IsNull(2, 1));
+    EXPECT_EQ(std::get<StringColumn>(mixed.GetColumn(2))[2], "f");
+    const columnar::BatchView view = reader.ReadBatchView(2, std::vector<std::size_t>{1, 2});
+    EXPECT_EQ(std::vector<std::uint64_t>(view.Validity(0).begin(), view.Validity(0).end()), mixed.GetValidity(1));
+    EXPECT_TRUE(reader.ReadBatchView(1, std::vector<std::size_t>{1}).Validity(0).empty());
+
+    std::vector<std::uint64_t> valid;
+    const DataVector x = reader.ReadColumn(1, &valid);
+    EXPECT_EQ(std::get<std::vector<std::int32_t>>(x).size(), 12u);
+    EXPECT_EQ(utils::CountSet(valid), 6u);
+
+    // Nulls export as empty fields, so the file reads back as the input.
+    std::ostringstream csv;
+    columnar::ExportCsv(tmp / "out.columnar", reader.AllColumns(), csv);
+    std::string want = data_csv;
+    want.replace(want.find(", ,"), 3, ",,");
+    EXPECT_EQ(csv.str(), want);
+
+    // Columns not declared nullable still reject empty fields.
+    WriteFile(tmp / "strict.csv", "id,int64\nx,int32\ns,string\n");
+    EXPECT_THROW(CsvToColumnar(tmp / "strict.csv", tmp / "data.csv", tmp / "strict.columnar", 4), std::runtime_error);
+}
+
+TEST(NullableColumns, FiltersAggregatesJoinsAndSortsSkipOrGroupNulls) {
+    auto tmp = MakeTempDir();
+    WriteFile(tmp / "schema.csv", "k,string,nullable\nv,int64,nullable\n");
+    WriteFile(tmp / "data.csv", "a,1\n,2\na,\nb,5\n,\nb,7\nc,\n");
+    CsvToColumnar(tmp / "schema.csv", tmp / "data.csv", tmp / "in.columnar", /*batch_rows*/ 3);
+
+    const auto query = [&](const std::string& where, std::vector<std::string> group_by, std::vector<std::string> select) {
+        exec::QueryOptions options;
+        options.where = where;
+        options.group_by = std::move(group_by);
+        options.select = std::move(select);
+        std::ostringstream out;
+        exec::RunQuery(tmp / "in.columnar", options, out);
+        return out.str();
+    };
+    // Comparisons with null are false, negated or not.
+    EXPECT_EQ(query("v > 0", {}, {}), "a,1\n,2\nb,5\nb,7\n");
+    EXPECT_EQ(query("NOT v > 3", {}, {}), "a,1\n,2\n");
+    EXPECT_EQ(query("k = 'a' OR v = 7", {}, {"v"}), "1\n\n7\n");
+
+    // Null keys form the first group; aggregates skip null values and are null without any.
+    EXPECT_EQ(query("", {"k"}, {"k", "count(v)", "count(*)", "sum(v)", "min(v)"}),
+              ",1,2,2,2\na,1,2,1,1\nb,2,2,12,5\nc,0,1,,\n");
+
+    WriteFile(tmp / "names_schema.csv", "k,string\nname,string\n");
+    WriteFile(tmp / "names.csv", "a,alpha\nb,beta\n");
+    CsvToColumnar(tmp / "names_schema.csv", tmp / "names.csv", tmp / "names.columnar", /*batch_rows*/ 16);
+    exec::JoinOptions join;
+    join.left_key = "k";
+    join.right_key = "k";
+    join.type = exec::JoinType::Left;
+    join.memory_budget = 0;
+    exec::HashJoin(tmp / "names.columnar", tmp / "in.columnar", tmp / "left.columnar", join);
+    EXPECT_TRUE(columnar::ColumnarReader(tmp / "left.columnar").GetSchema()[2].nullable);
+    auto got = ColumnarRowsAsCsv(tmp / "left.columnar");
+    std::ranges::sort(got);
+    EXPECT_EQ(got, (std::vector<std::string>{"a,alpha,", "a,alpha,1", "b,beta,5", "b,beta,7"}));
+    join.type = exec::JoinType::Inner;
+    exec::HashJoin(tmp / "in.columnar", tmp / "names.columnar", tmp / "inner.columnar", join);
+    got = ColumnarRowsAsCsv(tmp / "inner.columnar");
+    std::ranges::sort(got);
+    EXPECT_EQ(got, (std::vector<std::string>{"a,,alpha", "a,1,alpha", "b,5,beta", "b,7,beta"}));
+
+    // Nulls sort first; a nullable key is not recorded as the file's sort order.
+    exec::SortOptions sort;
+    sort.keys = {exec::ParseSortKey("v")};
+    exec::ExternalSort(tmp / "in.columnar", tmp / "sorted.columnar", sort);
+    EXPECT_EQ(ColumnarRowsAsCsv(tmp / "sorted.columnar"),
+              (std::vector<std::string>{"a,", ",", "c,", "a,1", ",2", "b,5", "b,7"}));
+    EXPECT_TRUE(columnar::ColumnarReader(tmp / "sorted.columnar").SortOrder().empty());
+}
+
+// ----------------- append mode -----------------
+
+TEST(AppendMode, AddsBatchesUnderTheFileOrderAndKeepsOldFooterUntilFinish) {
+    auto tmp = MakeTempDir();
+    const fs::path path = tmp / "t.columnar";
+    std::istringstream schema_in("id,int64\nhost,string,nullable\n");
+    const Schema schema = LoadSchemaCsv(schema_in);
+    const auto write = [&](const std::string& csv, columnar::WriterOptions options) {
+        std::istringstream in(csv);
+        CsvBatchReader br(in, schema, /*batch_rows*/ 2);
+        columnar::ColumnarWriter writer(path, schema, options);
+        while (auto b = br.ReadNext()) writer.WriteBatch(*b);
+        writer.Finish();
+    };
+    const auto rows = [&] {
+        std::vector<std::string> out;
+        std::ostringstream csv;
+        columnar::ColumnarReader reader(path);
+        columnar::ExportCsv(path, reader.AllColumns(), csv);
+        std::istringstream in(csv.str());
+        for (std::string line; std::getline(in, line);) out.push_back(line);
+        return out;
+    };
+
+    columnar::WriterOptions first;
+    first.sort_by = {{0, false}};
+    first.bloom_columns = {1};
+    write("1,a\n2,b\n3,\n", first);
+    columnar::BuildSecondaryIndex(path, 0, tmp / "id.idx");
+
+    // The sort order and Bloom filters carry over from the file.
+    columnar::WriterOptions append;
+    append.append = true;
+    write("4,d\n5,e\n6,f\n", append);
+    EXPECT_EQ(rows(), (std::vector<std::string>{"1,a", "2,b", "3,", "4,d", "5,e", "6,f"}));
+    {
+        columnar::ColumnarReader reader(path, columnar::ReadMode::Mapped);
+        ASSERT_EQ(reader.NumBatches(), 4u);
+        ASSERT_EQ(reader.SortOrder().size(), 1u);
+        EXPECT_NE(reader.GetBatchMeta(3).columns[1].bloom_size, 0u);
+        EXPECT_FALSE(reader.MayContain(3, 1, std::string("zzz")));
+        EXPECT_EQ(std::get<std::int64_t>(reader.GetBatchMeta(3).last_key[0]), 6);
+        EXPECT_FALSE(columnar::SecondaryIndex(tmp / "id.idx").Matches(reader));
+    }
+
+    // Rows behind the file's last key, or another schema, are rejected; an unfinished
+    // append leaves the file as it was.
+    const auto size = fs::file_size(path);
+    EXPECT_THROW(write("5,x\n", append), std::runtime_error);
+    EXPECT_EQ(fs::file_size(path), size);
+    std::istringstream other_in("id,int64\nhost,string\n");
+    EXPECT_THROW(columnar::ColumnarWriter(path, LoadSchemaCsv(other_in), append), std::runtime_error);
+    EXPECT_EQ(rows().size(), 6u);
+
+    // A torn append leaves bytes past the footer; the old footer still reads and the next
+    // append goes after them.
+    {
+        std::ofstream torn(path, std::ios::binary | std::ios::app);
+        torn << std::string(37, '\x7f');
+    }
+    EXPECT_EQ(rows().size(), 6u);
+    write("7,g\n", append);
+    EXPECT_EQ(rows().back(), "7,g");
+    EXPECT_EQ(rows().size(), 7u);
+}
+
+TEST(AppendMode, NarrowedFileAcceptsItsDeclaredSchemaAndRangeChecksValues) {
+    auto tmp = MakeTempDir();
+    WriteFile(tmp / "schema.csv", "id,int64\nname,string\n");
+    WriteFile(tmp / "data.csv", "1,a\n-5,b\n100,c\n");
+    CsvToColumnar(tmp / "schema.csv", tmp / "data.csv", tmp / "wide.columnar", /*batch_rows*/ 2);
+    const Schema narrowed = columnar::NarrowedSchema(columnar::ColumnarReader(tmp / "wide.columnar"));
+    ASSERT_EQ(narrowed[0].type, DataType::Int8);
+    const fs::path path = tmp / "t.columnar";
+    columnar::RewriteColumnar(tmp / "wide.columnar", path, narrowed);
+
+    std::istringstream schema_in("id,int64\nname,string\n");
+    const Schema declared = LoadSchemaCsv(schema_in);
+    columnar::WriterOptions append;
+    append.append = true;
+    const auto ingest = [&](const std::string& csv) {
+        WriteFile(tmp / "more.csv", csv);
+        columnar::ColumnarWriter writer(path, declared, append);
+        EXPECT_EQ(writer.GetSchema()[0].type, DataType::Int8);
+        columnar::IngestCsv(tmp / "more.csv", writer);
+        writer.Finish();
+    };
+    ingest("7,d\n-128,e\n");
+    EXPECT_EQ(ColumnarRowsAsCsv(path), (std::vector<std::string>{"1,a", "-5,b", "100,c", "7,d", "-128,e"}));
+
+    // A value the stored type cannot hold is rejected, and the file stays as it was.
+    const auto size = fs::file_size(path);
+    EXPECT_THROW(ingest("300,f\n"), std::runtime_error);
+    EXPECT_EQ(fs::file_size(path), size);
+
+    // Declaring a narrower type than stored is still a mismatch.
+    std::istringstream narrower_in("id,int8\nname,string\n");
+    EXPECT_THROW(columnar::ColumnarWriter(tmp / "wide.columnar", LoadSchemaCsv(narrower_in), append), std::runtime_error);
+}